@@ -0,0 +1,279 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include "Tracing.h"
+#include "Assertions.h"
+#include "Console.h"
+#include "FileSystem.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per thread, about 2MB. At a few thousand zones per frame that's still several seconds of history.
+static constexpr u32 RING_SIZE = 64 * 1024;
+
+namespace
+{
+	struct Event
+	{
+		const char* name;
+		u64 start;
+		u64 end; // 0 for instants
+	};
+
+	struct ThreadBuffer
+	{
+		std::string name;
+		u32 id;
+		bool exited; // owning thread is gone, the buffer can be handed to a new one once it's been exported
+
+		// Only written by the owning thread. count is published with release semantics after each event.
+		std::unique_ptr<Event[]> events;
+		std::atomic<u64> count{0};
+		std::atomic<u32> capture{0};
+
+		// Set while the owning thread is inside RecordEvent(), see there.
+		std::atomic<bool> writing{false};
+	};
+
+	// Hands the buffer back when the thread exits.
+	struct ThreadBufferOwner
+	{
+		ThreadBuffer* buffer = nullptr;
+		~ThreadBufferOwner();
+	};
+} // namespace
+
+std::atomic<u32> Tracing::Internal::s_tier{static_cast<u32>(Tier::Off)};
+
+static std::mutex s_mutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+static std::atomic<u32> s_capture{0};
+static u64 s_capture_start = 0;
+static thread_local ThreadBufferOwner t_owner;
+
+ThreadBufferOwner::~ThreadBufferOwner()
+{
+	if (!buffer)
+		return;
+
+	std::unique_lock lock(s_mutex);
+	buffer->exited = true;
+}
+
+static ThreadBuffer* GetThreadBuffer()
+{
+	if (t_owner.buffer)
+		return t_owner.buffer;
+
+	std::unique_lock lock(s_mutex);
+
+	// Reuse the buffer of an exited thread if it holds nothing we haven't given up on,
+	// GS renderer switches respawn the rasterizer workers every time.
+	const u32 capture = s_capture.load(std::memory_order_relaxed);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : s_buffers)
+	{
+		if (buffer->exited && buffer->capture.load(std::memory_order_relaxed) != capture)
+		{
+			buffer->exited = false;
+			buffer->name.clear();
+			t_owner.buffer = buffer.get();
+			return t_owner.buffer;
+		}
+	}
+
+	std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+	buffer->id = static_cast<u32>(s_buffers.size()) + 1;
+	buffer->exited = false;
+	t_owner.buffer = buffer.get();
+	s_buffers.push_back(std::move(buffer));
+	return t_owner.buffer;
+}
+
+static void RecordEvent(const char* name, u64 start, u64 end)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	// Zones which began before Stop() end after it. Either this sees the tier off and drops the event,
+	// or Export() sees writing set and waits, so it never reads a slot which is being overwritten.
+	buffer->writing.store(true, std::memory_order_seq_cst);
+	if (Tracing::Internal::s_tier.load(std::memory_order_seq_cst) == static_cast<u32>(Tracing::Tier::Off))
+	{
+		buffer->writing.store(false, std::memory_order_release);
+		return;
+	}
+
+	// First event of a new capture on this thread, forget the previous one.
+	const u32 capture = s_capture.load(std::memory_order_acquire);
+	if (buffer->capture.load(std::memory_order_relaxed) != capture)
+	{
+		if (!buffer->events)
+			buffer->events = std::make_unique<Event[]>(RING_SIZE);
+
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->capture.store(capture, std::memory_order_release);
+	}
+
+	const u64 count = buffer->count.load(std::memory_order_relaxed);
+	Event& ev = buffer->events[count % RING_SIZE];
+	ev.name = name;
+	ev.start = start;
+	ev.end = end;
+	buffer->count.store(count + 1, std::memory_order_release);
+	buffer->writing.store(false, std::memory_order_release);
+}
+
+u64 Tracing::Internal::GetTimestamp()
+{
+	return Common::Timer::GetCurrentValue();
+}
+
+void Tracing::Internal::RecordZone(const char* name, u64 start, u64 end)
+{
+	RecordEvent(name, start, std::max(end, start + 1));
+}
+
+void Tracing::Internal::RecordInstant(const char* name, u64 time)
+{
+	RecordEvent(name, time, 0);
+}
+
+void Tracing::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	std::unique_lock lock(s_mutex);
+	buffer->name = name;
+}
+
+void Tracing::Start(Tier tier)
+{
+	{
+		std::unique_lock lock(s_mutex);
+		s_capture_start = Internal::GetTimestamp();
+		s_capture.fetch_add(1, std::memory_order_release);
+	}
+
+	Internal::s_tier.store(static_cast<u32>(tier), std::memory_order_release);
+	Console.WriteLn("(Tracing) Capture started");
+}
+
+void Tracing::Stop()
+{
+	Internal::s_tier.store(static_cast<u32>(Tier::Off), std::memory_order_seq_cst);
+}
+
+bool Tracing::IsCapturing()
+{
+	return IsEnabled(Tier::Frame);
+}
+
+static void WriteEscaped(std::FILE* fp, const char* str)
+{
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			std::fputc('\\', fp);
+		if (static_cast<unsigned char>(*str) >= 0x20)
+			std::fputc(*str, fp);
+	}
+}
+
+bool Tracing::Export(const char* filename)
+{
+	pxAssertMsg(!IsCapturing(), "Capture must be stopped before exporting");
+
+	auto fp = FileSystem::OpenManagedCFile(filename, "wb");
+	if (!fp)
+	{
+		Console.Error("(Tracing) Failed to open '%s' for writing", filename);
+		return false;
+	}
+
+	std::unique_lock lock(s_mutex);
+
+	// Let the writers which got in before Stop() finish, later ones drop their events.
+	for (const std::unique_ptr<ThreadBuffer>& buffer : s_buffers)
+	{
+		while (buffer->writing.load(std::memory_order_seq_cst))
+			std::this_thread::yield();
+	}
+
+	const u32 capture = s_capture.load(std::memory_order_relaxed);
+	const auto to_us = [](u64 value) {
+		return Common::Timer::ConvertValueToNanoseconds(value - s_capture_start) / 1000.0;
+	};
+
+	u64 total_events = 0;
+	u64 dropped_events = 0;
+	bool first = true;
+	std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp.get());
+	for (const std::unique_ptr<ThreadBuffer>& buffer : s_buffers)
+	{
+		if (buffer->capture.load(std::memory_order_acquire) != capture)
+			continue;
+
+		std::fprintf(fp.get(), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+			first ? "" : ",", buffer->id);
+		if (buffer->name.empty())
+			std::fprintf(fp.get(), "Thread %u", buffer->id);
+		else
+			WriteEscaped(fp.get(), buffer->name.c_str());
+		std::fputs("\"}}", fp.get());
+		first = false;
+
+		// When the ring wrapped, only the newest events are still there.
+		const u64 count = buffer->count.load(std::memory_order_acquire);
+		const u64 begin = (count > RING_SIZE) ? (count - RING_SIZE) : 0;
+		dropped_events += begin;
+		for (u64 i = begin; i < count; i++)
+		{
+			const Event& ev = buffer->events[i % RING_SIZE];
+			if (ev.start < s_capture_start)
+				continue;
+
+			std::fputs(",\n{\"name\":\"", fp.get());
+			WriteEscaped(fp.get(), ev.name);
+			if (ev.end == 0)
+			{
+				std::fprintf(fp.get(), "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", buffer->id, to_us(ev.start));
+			}
+			else
+			{
+				std::fprintf(fp.get(), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->id,
+					to_us(ev.start), Common::Timer::ConvertValueToNanoseconds(ev.end - ev.start) / 1000.0);
+			}
+			total_events++;
+		}
+	}
+	std::fputs("\n]}\n", fp.get());
+
+	if (std::ferror(fp.get()))
+	{
+		Console.Error("(Tracing) Failed to write '%s'", filename);
+		return false;
+	}
+
+	Console.WriteLn("(Tracing) Wrote %llu events to '%s' (%llu dropped when the ring buffers wrapped)",
+		static_cast<unsigned long long>(total_events), filename, static_cast<unsigned long long>(dropped_events));
+	return true;
+}
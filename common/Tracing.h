@@ -0,0 +1,97 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+#include <atomic>
+
+// Timeline tracing, for finding out where the time of a single slow frame went.
+//
+// When no capture is running, or the zone's tier isn't part of it, a zone costs a relaxed load and
+// records nothing. During a capture it also costs two timer reads and a store into the calling thread's
+// own ring buffer, without any locking. Captures are exported in the Chrome trace event format, which
+// both chrome://tracing and Perfetto open.
+namespace Tracing
+{
+	enum class Tier : u32
+	{
+		Off,
+		Frame, // A few zones per frame and thread: vsync, presentation, frame limiter
+		Detail, // Individual work items: GIF transfers, VU1 programs, rasterizer batches, audio mixing
+	};
+
+	namespace Internal
+	{
+		extern std::atomic<u32> s_tier;
+
+		u64 GetTimestamp();
+		void RecordZone(const char* name, u64 start, u64 end);
+		void RecordInstant(const char* name, u64 time);
+	} // namespace Internal
+
+	__fi bool IsEnabled(Tier tier)
+	{
+		return Internal::s_tier.load(std::memory_order_relaxed) >= static_cast<u32>(tier);
+	}
+
+	/// Names the calling thread's track in exported traces.
+	void SetThreadName(const char* name);
+
+	/// Starts a new capture recording zones up to the given tier, dropping the previous capture.
+	void Start(Tier tier);
+
+	/// Stops recording. The capture is kept until it is exported or a new one is started.
+	void Stop();
+
+	bool IsCapturing();
+
+	/// Writes the last capture as Chrome trace event JSON. Must be called after Stop(), waits for zones
+	/// which were still being recorded to finish.
+	bool Export(const char* filename);
+
+	/// Marks a point in time, e.g. a vsync. name must outlive the capture, only the pointer is stored.
+	__fi void Instant(const char* name, Tier tier = Tier::Frame)
+	{
+		if (IsEnabled(tier))
+			Internal::RecordInstant(name, Internal::GetTimestamp());
+	}
+
+	/// Records the time between construction and destruction, if condition is set.
+	/// name must outlive the capture, only the pointer is stored.
+	class ScopedZone
+	{
+	public:
+		__fi ScopedZone(const char* name, Tier tier = Tier::Detail, bool condition = true)
+			: m_name((condition && IsEnabled(tier)) ? name : nullptr)
+			, m_start(m_name ? Internal::GetTimestamp() : 0)
+		{
+		}
+
+		__fi ~ScopedZone()
+		{
+			if (m_name)
+				Internal::RecordZone(m_name, m_start, Internal::GetTimestamp());
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		const char* m_name;
+		u64 m_start;
+	};
+} // namespace Tracing
@@ -13,6 +13,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <condition_variable>
@@ -29,10 +30,12 @@
 #include "common/Console.h"
 #include "common/Exceptions.h"
 #include "common/FileSystem.h"
+#include "common/MD5Digest.h"
 #include "common/MemorySettingsInterface.h"
 #include "common/Path.h"
 #include "common/SettingsWrapper.h"
 #include "common/StringUtil.h"
+#include "common/Timer.h"
 
 #include "pcsx2/PrecompiledHeader.h"
 
@@ -43,6 +46,7 @@
 #include "pcsx2/Frontend/LogSink.h"
 #include "pcsx2/GS.h"
 #include "pcsx2/GS/GS.h"
+#include "pcsx2/GS/GSPerfMon.h"
 #include "pcsx2/GSDumpReplayer.h"
 #include "pcsx2/HostDisplay.h"
 #include "pcsx2/HostSettings.h"
@@ -65,6 +69,8 @@ namespace GSRunner
 	static void DestroyPlatformWindow();
 	static std::optional<WindowInfo> GetPlatformWindowInfo();
 	static void PumpPlatformMessages();
+
+	static bool RunWorkerProcesses(int argc, char* argv[]);
 } // namespace GSRunner
 
 static constexpr u32 WINDOW_WIDTH = 640;
@@ -73,13 +79,35 @@ static constexpr u32 WINDOW_HEIGHT = 480;
 static MemorySettingsInterface s_settings_interface;
 alignas(16) static SysMtgsThread s_mtgs_thread;
 
+static std::vector<std::string> s_dumps;
+static std::string s_output_dir;
 static std::string s_output_prefix;
+static std::string s_report_filename;
 static s32 s_loop_count = 1;
+static u32 s_parallel = 1;
+static std::optional<u32> s_worker_index;
 static std::optional<bool> s_use_window;
 
+// More than one dump, each gets its own subdirectory in the output directory, like test_run_dumps.py does.
+static bool s_batch_mode = false;
+
+// Hash every frame instead of writing it out, and only write the ones which differ from the baseline.
+static bool s_hash_frames = false;
+static std::string s_baseline_dir;
+
+// Owned by the CPU thread.
+static u32 s_frames_replayed = 0;
+
 // Owned by the GS thread.
 static u32 s_dump_frame_number = 0;
 
+// Owned by the GS thread while a dump is running.
+static std::FILE* s_hash_log = nullptr;
+static std::optional<std::vector<std::pair<u64, u64>>> s_baseline_hashes; // frame and VRAM hash of each presented frame
+static u32 s_hashed_frames = 0;
+static u32 s_frame_mismatches = 0;
+static u32 s_vram_mismatches = 0;
+
 bool GSRunner::SetCriticalFolders()
 {
 	EmuFolders::AppRoot = Path::Canonicalize(Path::GetDirectory(FileSystem::GetProgramPath()));
@@ -291,14 +319,52 @@ void Host::ReleaseHostDisplay(bool clear_state)
 	g_host_display.reset();
 }
 
+static void OnFrameHashed(u32 frame_number, u64 frame_hash, u64 vram_hash)
+{
+	const u32 index = s_hashed_frames++;
+	if (s_hash_log)
+		std::fputs(fmt::format("{} {:016x} {:016x}\n", frame_number, frame_hash, vram_hash).c_str(), s_hash_log);
+
+	if (!s_baseline_hashes.has_value())
+		return;
+
+	// replay is deterministic, so the Nth presented frame of the baseline is the one to compare with, even when looping
+	const bool in_baseline = (index < s_baseline_hashes->size());
+	if (!in_baseline || (*s_baseline_hashes)[index].second != vram_hash)
+		s_vram_mismatches++;
+	if (in_baseline && (*s_baseline_hashes)[index].first == frame_hash)
+		return;
+
+	s_frame_mismatches++;
+	if (!s_output_prefix.empty())
+	{
+		// when we wrap around, don't race other files
+		GSJoinSnapshotThreads();
+		GSQueueSnapshot(fmt::format("{}_frame{}.png", s_output_prefix, frame_number));
+	}
+}
+
 bool Host::BeginPresentFrame(bool frame_skip)
 {
-	// when we wrap around, don't race other files
-	GSJoinSnapshotThreads();
+	if (s_hash_frames)
+	{
+		// skipped frames aren't hashed, the callback would be left for the next frame and get our number
+		if (!frame_skip)
+		{
+			GSQueueFrameHash([frame_number = s_dump_frame_number](u64 frame_hash, u64 vram_hash) {
+				OnFrameHashed(frame_number, frame_hash, vram_hash);
+			});
+		}
+	}
+	else if (!s_output_prefix.empty())
+	{
+		// when we wrap around, don't race other files
+		GSJoinSnapshotThreads();
 
-	// queue dumping of this frame
-	std::string dump_path(fmt::format("{}_frame{}.png", s_output_prefix, s_dump_frame_number));
-	GSQueueSnapshot(dump_path);
+		// queue dumping of this frame
+		std::string dump_path(fmt::format("{}_frame{}.png", s_output_prefix, s_dump_frame_number));
+		GSQueueSnapshot(dump_path);
+	}
 
 	if (g_host_display->BeginPresent(frame_skip))
 		return true;
@@ -446,11 +512,20 @@ static void PrintCommandLineVersion()
 static void PrintCommandLineHelp(const char* progname)
 {
 	PrintCommandLineVersion();
-	std::fprintf(stderr, "Usage: %s [parameters] [--] [filename]\n", progname);
+	std::fprintf(stderr, "Usage: %s [parameters] [--] [filename or directory]\n", progname);
 	std::fprintf(stderr, "\n");
 	std::fprintf(stderr, "  -help: Displays this information and exits.\n");
 	std::fprintf(stderr, "  -version: Displays version information and exits.\n");
-	std::fprintf(stderr, "  -dumpdir <dir>: Frame dump directory (will be dumped as filename_frameN.png).\n");
+	std::fprintf(stderr, "  -dumpdir <dir>: Frame dump directory (will be dumped as filename_frameN.png).\n"
+						 "    When replaying several dumps, each gets its own subdirectory and emulog.txt.\n");
+	std::fprintf(stderr, "  -dumplist <file>: Replays the dumps listed in the file, one per line.\n");
+	std::fprintf(stderr, "  -parallel <count>: Splits the dumps over N worker processes. Defaults to 1.\n");
+	std::fprintf(stderr, "  -report <filename>: Writes a JSON line per dump with frames, timings, draw\n"
+						 "    counts and the MD5 of each dumped frame.\n");
+	std::fprintf(stderr, "  -hashes: Writes the hash of every frame and of GS memory to filename_hashes.txt\n"
+						 "    in the dump directory instead of writing images.\n");
+	std::fprintf(stderr, "  -baseline <dir>: Dump directory of a previous -hashes run. Implies -hashes, and\n"
+						 "    writes images of the frames whose hash differs from the baseline.\n");
 	std::fprintf(stderr, "  -loop <count>: Loops dump playback N times. Defaults to 1. 0 will loop infinitely.\n");
 	std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Defaults to Auto.\n");
 	std::fprintf(stderr, "  -window: Forces a window to be displayed.\n");
@@ -463,7 +538,75 @@ static void PrintCommandLineHelp(const char* progname)
 	std::fprintf(stderr, "\n");
 }
 
-static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& params)
+static bool AddDumpsFromDirectory(const std::string& path)
+{
+	FileSystem::FindResultsArray results;
+	FileSystem::FindFiles(path.c_str(), "*", FILESYSTEM_FIND_FILES, &results);
+
+	const size_t old_size = s_dumps.size();
+	for (const FILESYSTEM_FIND_DATA& fd : results)
+	{
+		if (VMManager::IsGSDumpFileName(fd.FileName))
+			s_dumps.push_back(fd.FileName);
+	}
+
+	// Workers rely on the order to agree on who replays what.
+	std::sort(s_dumps.begin() + old_size, s_dumps.end());
+	Console.WriteLn("Found %zu GS dumps in '%s'.", s_dumps.size() - old_size, path.c_str());
+	return (s_dumps.size() > old_size);
+}
+
+static bool AddDumpsFromList(const char* filename)
+{
+	std::optional<std::string> list(FileSystem::ReadFileToString(filename));
+	if (!list.has_value())
+	{
+		Console.Error("Failed to read dump list '%s'.", filename);
+		return false;
+	}
+
+	for (const std::string_view& line : StringUtil::SplitString(list.value(), '\n'))
+	{
+		const std::string_view path(StringUtil::StripWhitespace(line));
+		if (path.empty())
+			continue;
+
+		if (!VMManager::IsGSDumpFileName(path))
+		{
+			Console.Error(fmt::format("'{}' in dump list is not a GS dump.", path));
+			return false;
+		}
+
+		s_dumps.emplace_back(path);
+	}
+
+	return true;
+}
+
+static void SelectWorkerDumps(u32 index, u32 count)
+{
+	// Largest first, onto whichever worker has the least to do so far.
+	std::vector<std::pair<s64, size_t>> sizes;
+	sizes.reserve(s_dumps.size());
+	for (size_t i = 0; i < s_dumps.size(); i++)
+		sizes.emplace_back(FileSystem::GetPathFileSize(s_dumps[i].c_str()), i);
+	std::stable_sort(sizes.begin(), sizes.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+	std::vector<s64> load(count, 0);
+	std::vector<std::string> selected;
+	for (const auto& [size, i] : sizes)
+	{
+		const u32 worker = static_cast<u32>(std::min_element(load.begin(), load.end()) - load.begin());
+		load[worker] += std::max<s64>(size, 1);
+		if (worker == index)
+			selected.push_back(std::move(s_dumps[i]));
+	}
+
+	s_dumps = std::move(selected);
+	Console.WriteLn("Worker %u/%u replaying %zu dumps.", index + 1, count, s_dumps.size());
+}
+
+static bool ParseCommandLineArgs(int argc, char* argv[], std::string& filename)
 {
 	bool no_more_args = false;
 	for (int i = 1; i < argc; i++)
@@ -485,14 +628,14 @@ static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& param
 			}
 			else if (CHECK_ARG_PARAM("-dumpdir"))
 			{
-				s_output_prefix = StringUtil::StripWhitespace(argv[++i]);
-				if (s_output_prefix.empty())
+				s_output_dir = StringUtil::StripWhitespace(argv[++i]);
+				if (s_output_dir.empty())
 				{
 					Console.Error("Invalid dump directory specified.");
 					return false;
 				}
 
-				if (!FileSystem::DirectoryExists(s_output_prefix.c_str()) && !FileSystem::CreateDirectoryPath(s_output_prefix.c_str(), false))
+				if (!FileSystem::DirectoryExists(s_output_dir.c_str()) && !FileSystem::CreateDirectoryPath(s_output_dir.c_str(), false))
 				{
 					Console.Error("Failed to create output directory");
 					return false;
@@ -500,6 +643,47 @@ static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& param
 
 				continue;
 			}
+			else if (CHECK_ARG_PARAM("-dumplist"))
+			{
+				if (!AddDumpsFromList(argv[++i]))
+					return false;
+
+				s_batch_mode = true;
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-parallel"))
+			{
+				s_parallel = std::max(StringUtil::FromChars<u32>(argv[++i]).value_or(1), 1u);
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-worker"))
+			{
+				// Internal, passed to the processes started by -parallel.
+				s_worker_index = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-report"))
+			{
+				s_report_filename = argv[++i];
+				continue;
+			}
+			else if (CHECK_ARG("-hashes"))
+			{
+				s_hash_frames = true;
+				continue;
+			}
+			else if (CHECK_ARG_PARAM("-baseline"))
+			{
+				s_baseline_dir = StringUtil::StripWhitespace(argv[++i]);
+				if (!FileSystem::DirectoryExists(s_baseline_dir.c_str()))
+				{
+					Console.Error("Baseline directory '%s' does not exist.", s_baseline_dir.c_str());
+					return false;
+				}
+
+				s_hash_frames = true;
+				continue;
+			}
 			else if (CHECK_ARG_PARAM("-loop"))
 			{
 				s_loop_count = StringUtil::FromChars<s32>(argv[++i]).value_or(0);
@@ -533,6 +717,8 @@ static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& param
 #endif
 				else if (StringUtil::Strcasecmp(rname, "sw") == 0)
 					type = GSRendererType::SW;
+				else if (StringUtil::Strcasecmp(rname, "null") == 0)
+					type = GSRendererType::Null;
 				else
 				{
 					Console.Error("Unknown renderer '%s'", rname);
@@ -560,7 +746,7 @@ static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& param
 			else if (CHECK_ARG("-noshadercache"))
 			{
 				Console.WriteLn("Disabling shader cache");
-				s_settings_interface.SetBoolValue("EmuCore/GS", "disable_shader_cache", false);
+				s_settings_interface.SetBoolValue("EmuCore/GS", "disable_shader_cache", true);
 				continue;
 			}
 			else if (CHECK_ARG("-window"))
@@ -590,33 +776,320 @@ static bool ParseCommandLineArgs(int argc, char* argv[], VMBootParameters& param
 #undef CHECK_ARG_PARAM
 		}
 
-		if (!params.filename.empty())
-			params.filename += ' ';
-		params.filename += argv[i];
+		if (!filename.empty())
+			filename += ' ';
+		filename += argv[i];
 	}
 
-	if (params.filename.empty())
+	if (!filename.empty())
+	{
+		if (FileSystem::DirectoryExists(filename.c_str()))
+		{
+			if (!AddDumpsFromDirectory(filename))
+			{
+				Console.Error("Provided directory does not contain any GS dumps.");
+				return false;
+			}
+
+			s_batch_mode = true;
+		}
+		else if (!VMManager::IsGSDumpFileName(filename))
+		{
+			Console.Error("Provided filename is not a GS dump.");
+			return false;
+		}
+		else
+		{
+			s_dumps.push_back(filename);
+		}
+	}
+
+	if (s_dumps.empty())
 	{
 		Console.Error("No dump filename provided.");
 		return false;
 	}
 
-	if (!VMManager::IsGSDumpFileName(params.filename))
+	s_batch_mode |= (s_dumps.size() > 1 || s_parallel > 1);
+
+	if (s_hash_frames && s_output_dir.empty())
 	{
-		Console.Error("Provided filename is not a GS dump.");
+		Console.Error("Hashing frames requires a dump directory.");
 		return false;
 	}
 
+	if (s_batch_mode && !s_output_dir.empty())
+	{
+		// each dump logs next to its frames, the runner itself logs to the top of the output directory
+		CommonHost::SetFileLogPath(Path::Combine(s_output_dir,
+			s_worker_index.has_value() ? fmt::format("runner_worker{}.txt", s_worker_index.value() + 1) : std::string("runner.txt")));
+		s_settings_interface.SetBoolValue("Logging", "EnableFileLogging", true);
+		s_settings_interface.SetBoolValue("Logging", "EnableTimestamps", false);
+	}
+
+	if (s_worker_index.has_value())
+	{
+		const GSRendererType renderer = static_cast<GSRendererType>(
+			s_settings_interface.GetIntValue("EmuCore/GS", "Renderer", static_cast<int>(GSRendererType::Auto)));
+		if (renderer != GSRendererType::SW && renderer != GSRendererType::Null)
+		{
+			// the hardware shader caches can't be written by more than one process
+			Console.WriteLn("Disabling shader cache for worker process");
+			s_settings_interface.SetBoolValue("EmuCore/GS", "disable_shader_cache", true);
+		}
+	}
+
+	return true;
+}
+
+static std::string GetDumpTitle(const std::string& filename)
+{
+	// strip off all extensions
+	std::string_view title(Path::GetFileTitle(filename));
+	if (StringUtil::EndsWithNoCase(title, ".gs"))
+		title = Path::GetFileTitle(title);
+
+	return std::string(StringUtil::StripWhitespace(title));
+}
+
+static void SetOutputForDump(const std::string& filename)
+{
+	s_output_prefix.clear();
+	if (s_output_dir.empty())
+		return;
+
 	// set up the frame dump directory
-	if (!s_output_prefix.empty())
+	const std::string title(GetDumpTitle(filename));
+	if (s_batch_mode)
 	{
-		// strip off all extensions
-		std::string_view title(Path::GetFileTitle(params.filename));
-		if (StringUtil::EndsWithNoCase(title, ".gs"))
-			title = Path::GetFileTitle(title);
+		const std::string dir(Path::Combine(s_output_dir, title));
+		if (!FileSystem::DirectoryExists(dir.c_str()) && !FileSystem::CreateDirectoryPath(dir.c_str(), false))
+		{
+			Console.Error("Failed to create output directory '%s'", dir.c_str());
+			return;
+		}
+
+		CommonHost::SetFileLogPath(Path::Combine(dir, "emulog.txt"));
+		s_output_prefix = Path::Combine(dir, title);
+	}
+	else
+	{
+		s_output_prefix = Path::Combine(s_output_dir, title);
+	}
 
-		s_output_prefix = Path::Combine(s_output_prefix, StringUtil::StripWhitespace(title));
+	if (s_hash_frames)
+		Console.WriteLn(fmt::format("Saving frame hashes to {}_hashes.txt", s_output_prefix));
+	else
 		Console.WriteLn(fmt::format("Saving dumps as {}_frameN.png", s_output_prefix));
+}
+
+static std::string GetHashLogFileName(const std::string& prefix)
+{
+	return prefix + "_hashes.txt";
+}
+
+static void LoadBaselineHashes(const std::string& dump_filename)
+{
+	s_baseline_hashes.reset();
+	if (s_baseline_dir.empty())
+		return;
+
+	// same layout as the output directory
+	const std::string title(GetDumpTitle(dump_filename));
+	const std::string filename(GetHashLogFileName(
+		s_batch_mode ? Path::Combine(Path::Combine(s_baseline_dir, title), title) : Path::Combine(s_baseline_dir, title)));
+	std::optional<std::string> log(FileSystem::ReadFileToString(filename.c_str()));
+
+	// a dump which isn't in the baseline gets all of its frames written
+	s_baseline_hashes.emplace();
+	if (!log.has_value())
+	{
+		Console.Warning("No baseline hashes in '%s'.", filename.c_str());
+		return;
+	}
+
+	for (const std::string_view& line : StringUtil::SplitString(log.value(), '\n'))
+	{
+		const std::vector<std::string_view> fields(StringUtil::SplitString(line, ' '));
+		const std::optional<u64> frame_hash = (fields.size() == 3) ? StringUtil::FromChars<u64>(fields[1], 16) : std::nullopt;
+		const std::optional<u64> vram_hash = (fields.size() == 3) ? StringUtil::FromChars<u64>(fields[2], 16) : std::nullopt;
+		if (!frame_hash.has_value() || !vram_hash.has_value())
+		{
+			Console.Error("Malformed line in baseline hashes '%s'.", filename.c_str());
+			break;
+		}
+
+		s_baseline_hashes->emplace_back(frame_hash.value(), vram_hash.value());
+	}
+}
+
+static std::string EscapeJSONString(const std::string_view& str)
+{
+	std::string ret;
+	ret.reserve(str.size());
+	for (const char ch : str)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			ret += '\\';
+			ret += ch;
+		}
+		else if (static_cast<unsigned char>(ch) < 0x20)
+		{
+			ret += fmt::format("\\u{:04x}", static_cast<unsigned>(ch));
+		}
+		else
+		{
+			ret += ch;
+		}
+	}
+	return ret;
+}
+
+static std::string GetFrameHashesJSON()
+{
+	if (s_output_prefix.empty())
+		return "{}";
+
+	const std::string title(Path::GetFileName(s_output_prefix));
+	FileSystem::FindResultsArray results;
+	FileSystem::FindFiles(std::string(Path::GetDirectory(s_output_prefix)).c_str(), fmt::format("{}_frame*.png", title).c_str(),
+		FILESYSTEM_FIND_FILES, &results);
+
+	std::vector<std::pair<u32, std::string>> hashes;
+	for (const FILESYSTEM_FIND_DATA& fd : results)
+	{
+		const std::string_view name(Path::GetFileName(fd.FileName));
+		const std::optional<u32> frame = StringUtil::FromChars<u32>(
+			name.substr(title.size() + std::strlen("_frame"), name.size() - title.size() - std::strlen("_frame") - std::strlen(".png")));
+		std::optional<std::vector<u8>> data(FileSystem::ReadBinaryFile(fd.FileName.c_str()));
+		if (!frame.has_value() || !data.has_value())
+			continue;
+
+		MD5Digest digest;
+		digest.Update(data->data(), static_cast<u32>(data->size()));
+		u8 md5[16];
+		digest.Final(md5);
+
+		std::string hex;
+		for (const u8 byte : md5)
+			hex += fmt::format("{:02x}", byte);
+		hashes.emplace_back(frame.value(), std::move(hex));
+	}
+	std::sort(hashes.begin(), hashes.end());
+
+	std::string ret("{");
+	for (const auto& [frame, hash] : hashes)
+		ret += fmt::format("{}\"{}\":\"{}\"", (ret.size() > 1) ? "," : "", frame, hash);
+	ret += '}';
+	return ret;
+}
+
+static bool RunDump(const std::string& filename, std::FILE* report)
+{
+	Console.WriteLn(Color_StrongGreen, "Replaying '%s'...", filename.c_str());
+	SetOutputForDump(filename);
+
+	s_hashed_frames = 0;
+	s_frame_mismatches = 0;
+	s_vram_mismatches = 0;
+	if (s_hash_frames && !s_output_prefix.empty())
+	{
+		const std::string log_filename(GetHashLogFileName(s_output_prefix));
+		s_hash_log = FileSystem::OpenCFile(log_filename.c_str(), "wb");
+		if (!s_hash_log)
+			Console.Error("Failed to open hash log '%s'.", log_filename.c_str());
+
+		LoadBaselineHashes(filename);
+	}
+
+	Common::Timer timer;
+	s_frames_replayed = 0;
+
+	VMBootParameters params;
+	params.filename = filename;
+	const bool success = VMManager::Initialize(params);
+	if (success)
+	{
+		// run until end
+		GSDumpReplayer::SetLoopCount(s_loop_count);
+		VMManager::SetState(VMState::Running);
+		while (VMManager::GetState() == VMState::Running)
+			VMManager::Execute();
+		VMManager::Shutdown(false);
+
+		// the last frames may still be being written out
+		GSJoinSnapshotThreads();
+	}
+
+	const double time_ms = timer.GetTimeMilliseconds();
+	Console.WriteLn("Replayed %u frames of '%s' in %.2f ms.", s_frames_replayed, filename.c_str(), time_ms);
+
+	if (s_hash_log)
+	{
+		std::fclose(s_hash_log);
+		s_hash_log = nullptr;
+	}
+	if (s_baseline_hashes.has_value())
+	{
+		Console.WriteLn("%u of %u frames differ from the baseline (%u in GS memory).", s_frame_mismatches, s_hashed_frames,
+			s_vram_mismatches);
+		if (s_hashed_frames != s_baseline_hashes->size())
+			Console.Warning("Baseline has %zu frames.", s_baseline_hashes->size());
+	}
+
+	if (report)
+	{
+		// g_perfmon is only reset when the GS opens, so these are from this dump even after it's closed
+		std::fputs(fmt::format("{{\"dump\":\"{}\",\"success\":{},\"frames\":{},\"wall_time_ms\":{:.3f},"
+								"\"draws\":{},\"draw_calls\":{},\"prims\":{},\"readbacks\":{},\"frame_md5\":{}{}}}\n",
+					   EscapeJSONString(filename), success, s_frames_replayed, time_ms,
+					   success ? static_cast<u64>(g_perfmon.GetTotal(GSPerfMon::Draw)) : 0,
+					   success ? static_cast<u64>(g_perfmon.GetTotal(GSPerfMon::DrawCalls)) : 0,
+					   success ? static_cast<u64>(g_perfmon.GetTotal(GSPerfMon::Prim)) : 0,
+					   success ? static_cast<u64>(g_perfmon.GetTotal(GSPerfMon::Readbacks)) : 0,
+					   success ? GetFrameHashesJSON() : std::string("{}"),
+					   s_baseline_hashes.has_value() ?
+						   fmt::format(",\"hashed_frames\":{},\"baseline_frames\":{},\"frame_mismatches\":{},\"vram_mismatches\":{}",
+							   s_hashed_frames, s_baseline_hashes->size(), s_frame_mismatches, s_vram_mismatches) :
+						   std::string())
+						   .c_str(),
+			report);
+		std::fflush(report);
+	}
+
+	return success;
+}
+
+static std::string GetWorkerReportFileName(u32 index)
+{
+	return fmt::format("{}.worker{}", s_report_filename, index + 1);
+}
+
+static bool MergeWorkerReports()
+{
+	if (s_report_filename.empty())
+		return true;
+
+	std::string merged;
+	for (u32 i = 0; i < s_parallel; i++)
+	{
+		const std::string filename(GetWorkerReportFileName(i));
+		std::optional<std::string> part(FileSystem::ReadFileToString(filename.c_str()));
+		if (!part.has_value())
+		{
+			Console.Error("Missing report from worker %u.", i + 1);
+			continue;
+		}
+
+		merged += part.value();
+		FileSystem::DeleteFilePath(filename.c_str());
+	}
+
+	if (!FileSystem::WriteStringToFile(s_report_filename.c_str(), merged))
+	{
+		Console.Error("Failed to write report '%s'.", s_report_filename.c_str());
+		return false;
 	}
 
 	return true;
@@ -632,10 +1105,25 @@ int main(int argc, char* argv[])
 		return false;
 	}
 
-	VMBootParameters params;
-	if (!ParseCommandLineArgs(argc, argv, params))
+	std::string filename;
+	if (!ParseCommandLineArgs(argc, argv, filename))
 		return false;
 
+	if (s_parallel > 1)
+	{
+		if (!s_worker_index.has_value())
+		{
+			// Every worker pays the startup once, not once per dump.
+			Console.WriteLn("Replaying %zu dumps in %u worker processes.", s_dumps.size(), s_parallel);
+			Common::Timer timer;
+			const bool result = GSRunner::RunWorkerProcesses(argc, argv) && MergeWorkerReports();
+			Console.WriteLn("All workers finished in %.2f seconds.", timer.GetTimeSeconds());
+			return result ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		SelectWorkerDumps(s_worker_index.value(), s_parallel);
+	}
+
 	PerformanceMetrics::SetCPUThread(Threading::ThreadHandle::GetForCallingThread());
 	if (!VMManager::Internal::InitializeGlobals() || !VMManager::Internal::InitializeMemory())
 	{
@@ -652,16 +1140,28 @@ int main(int argc, char* argv[])
 	// apply new settings (e.g. pick up renderer change)
 	VMManager::ApplySettings();
 
-	if (VMManager::Initialize(params))
+	std::FILE* report = nullptr;
+	if (!s_report_filename.empty())
 	{
-		// run until end
-		GSDumpReplayer::SetLoopCount(s_loop_count);
-		VMManager::SetState(VMState::Running);
-		while (VMManager::GetState() == VMState::Running)
-			VMManager::Execute();
-		VMManager::Shutdown(false);
+		const std::string report_filename(s_worker_index.has_value() ? GetWorkerReportFileName(s_worker_index.value()) : s_report_filename);
+		report = FileSystem::OpenCFile(report_filename.c_str(), "wb");
+		if (!report)
+			Console.Error("Failed to open report '%s'.", report_filename.c_str());
+	}
+
+	u32 failed = 0;
+	for (const std::string& dump : s_dumps)
+	{
+		if (!RunDump(dump, report))
+			failed++;
 	}
 
+	if (report)
+		std::fclose(report);
+
+	if (s_batch_mode)
+		Console.WriteLn("Replayed %zu dumps, %u failed.", s_dumps.size(), failed);
+
 	InputManager::CloseSources();
 	VMManager::Internal::ReleaseMemory();
 	PerformanceMetrics::SetCPUThread(Threading::ThreadHandle());
@@ -672,6 +1172,8 @@ int main(int argc, char* argv[])
 
 void Host::CPUThreadVSync()
 {
+	s_frames_replayed++;
+
 	// update GS thread copy of frame number
 	GetMTGS().RunOnGSThread([frame_number = GSDumpReplayer::GetFrameNumber()]() { s_dump_frame_number = frame_number; });
 
@@ -776,4 +1278,74 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	return DefWindowProcW(hwnd, msg, wParam, lParam);
 }
 
+static void AppendQuotedArgument(std::wstring& cmdline, const std::wstring& arg)
+{
+	// CommandLineToArgvW() rules: backslashes are only special in front of a quote.
+	if (!cmdline.empty())
+		cmdline += L' ';
+
+	cmdline += L'"';
+	size_t backslashes = 0;
+	for (const wchar_t ch : arg)
+	{
+		if (ch == L'\\')
+		{
+			backslashes++;
+			continue;
+		}
+
+		cmdline.append((ch == L'"') ? (backslashes * 2 + 1) : backslashes, L'\\');
+		backslashes = 0;
+		cmdline += ch;
+	}
+	cmdline.append(backslashes * 2, L'\\');
+	cmdline += L'"';
+}
+
+bool GSRunner::RunWorkerProcesses(int argc, char* argv[])
+{
+	const std::wstring program(StringUtil::UTF8StringToWideString(FileSystem::GetProgramPath()));
+
+	std::vector<HANDLE> processes;
+	for (u32 i = 0; i < s_parallel; i++)
+	{
+		// -worker goes first, anything after -- would be taken as part of the filename
+		std::wstring cmdline;
+		AppendQuotedArgument(cmdline, program);
+		AppendQuotedArgument(cmdline, L"-worker");
+		AppendQuotedArgument(cmdline, std::to_wstring(i));
+		for (int j = 1; j < argc; j++)
+			AppendQuotedArgument(cmdline, StringUtil::UTF8StringToWideString(argv[j]));
+
+		STARTUPINFOW si = {};
+		si.cb = sizeof(si);
+		PROCESS_INFORMATION pi = {};
+		if (!CreateProcessW(program.c_str(), cmdline.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+		{
+			Console.Error("Failed to start worker %u: %u", i + 1, static_cast<unsigned>(GetLastError()));
+			continue;
+		}
+
+		CloseHandle(pi.hThread);
+		processes.push_back(pi.hProcess);
+	}
+
+	bool result = (processes.size() == s_parallel);
+	for (size_t i = 0; i < processes.size(); i++)
+	{
+		WaitForSingleObject(processes[i], INFINITE);
+
+		DWORD exit_code = EXIT_FAILURE;
+		GetExitCodeProcess(processes[i], &exit_code);
+		CloseHandle(processes[i]);
+		if (exit_code != EXIT_SUCCESS)
+		{
+			Console.Error("Worker %zu exited with code %u.", i + 1, static_cast<unsigned>(exit_code));
+			result = false;
+		}
+	}
+
+	return result;
+}
+
 #endif // _WIN32
@@ -39,6 +39,42 @@ def compare_frames(path1, path2):
         return False
 
 
+def read_hashes(path):
+    try:
+        with open(path, "r") as f:
+            return [line.split() for line in f.read().splitlines() if len(line) > 0]
+    except (FileNotFoundError, IOError):
+        return None
+
+
+def check_hashes(dir1, dir2, name, hashes1, hashes2):
+    # one line per presented frame: frame number, frame hash, GS memory hash
+    diff_frames = []
+    for i in range(max(len(hashes1), len(hashes2))):
+        if i >= len(hashes1) or i >= len(hashes2) or hashes1[i][1] != hashes2[i][1]:
+            framenum = int((hashes2[i] if i < len(hashes2) else hashes1[i])[0])
+            if framenum not in diff_frames:
+                diff_frames.append(framenum)
+
+    if len(diff_frames) == 0:
+        return True
+
+    # the test run only wrote images for the frames which differ from its baseline
+    write("<h1>{}</h1>".format(name))
+    write("<table width=\"100%\">")
+    for framenum in diff_frames:
+        imagename = "%s_frame%d.png" % (name, framenum)
+        write("<tr><td colspan=\"2\">Frame %d</td></tr>" % (framenum))
+        row = "<tr>"
+        for path in [os.path.join(dir1, imagename), os.path.join(dir2, imagename)]:
+            row += "<td><img src=\"%s\" /></td>" % Path(path).as_uri() if os.path.isfile(path) else "<td>No image</td>"
+        write(row + "</tr>")
+    write("</table>")
+    write("<pre>Difference in frame hashes [%s] for %s</pre>" % (",".join(map(str, diff_frames)), name))
+    print("*** Difference in frame hashes [%s] for %s" % (",".join(map(str, diff_frames)), name))
+    return False
+
+
 def check_regression_test(baselinedir, testdir, name):
     #print("Checking '%s'..." % name)
 
@@ -48,6 +84,11 @@ def check_regression_test(baselinedir, testdir, name):
         #print("*** %s is missing in test set" % name)
         return False
 
+    hashes1 = read_hashes(os.path.join(dir1, name + "_hashes.txt"))
+    hashes2 = read_hashes(os.path.join(dir2, name + "_hashes.txt"))
+    if hashes1 is not None and hashes2 is not None:
+        return check_hashes(dir1, dir2, name, hashes1, hashes2)
+
     images = glob.glob(os.path.join(dir1, "*_frame*.png"))
     diff_frames = []
     first_fail = True
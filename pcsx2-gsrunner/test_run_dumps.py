@@ -1,70 +1,40 @@
 import argparse
-import glob
 import sys
 import os
 import subprocess
-import multiprocessing
-from pathlib import Path
-from functools import partial
-
-def is_gs_path(path):
-    ppath = Path(path)
-    for extension in [[".gs"], [".gs", ".xz"], [".gs", ".zst"]]:
-        if ppath.suffixes == extension:
-            return True
-
-    return False
 
+def run_regression_tests(runner, gsdir, dumpdir, renderer, parallel=1, hashes=False, baselinedir=None):
+    if not os.path.isdir(dumpdir):
+        os.mkdir(dumpdir)
 
-def run_regression_test(runner, dumpdir, renderer, parallel, gspath):
+    # the runner finds the dumps itself, splits them over its worker processes, and writes each
+    # dump's frames and emulog.txt to its own subdirectory of dumpdir
     args = [runner]
-    gsname = Path(gspath).name
-    while gsname.rfind('.') >= 0:
-        gsname = gsname[:gsname.rfind('.')]
-
-    real_dumpdir = os.path.join(dumpdir, gsname).strip()
-    if not os.path.exists(real_dumpdir):
-        os.mkdir(real_dumpdir)
-
     if renderer is not None:
         args.extend(["-renderer", renderer])
-    args.extend(["-dumpdir", real_dumpdir])
-    args.extend(["-logfile", os.path.join(real_dumpdir, "emulog.txt")])
+    args.extend(["-dumpdir", dumpdir])
+    args.extend(["-report", os.path.join(dumpdir, "report.jsonl")])
+
+    # hashes only write the frames which differ from the baseline, if one is given
+    if baselinedir is not None:
+        args.extend(["-baseline", baselinedir])
+    elif hashes:
+        args.append("-hashes")
 
     # loop a couple of times for those stubborn merge/interlace dumps that don't render anything
     # the first time around
     args.extend(["-loop", "2"])
 
-    # disable shader cache for parallel runs, otherwise it'll have sharing violations
     if parallel > 1:
-        args.append("-noshadercache")
+        args.extend(["-parallel", str(parallel)])
 
     args.append("--")
-    args.append(gspath)
+    args.append(gsdir)
 
     print("Running '%s'" % (" ".join(args)))
-    subprocess.run(args)
-
-
-def run_regression_tests(runner, gsdir, dumpdir, renderer, parallel=1):
-    paths = glob.glob(gsdir + "/*.*", recursive=True)
-    gamepaths = list(filter(is_gs_path, paths))
-
-    if not os.path.isdir(dumpdir):
-        os.mkdir(dumpdir)
-
-    print("Found %u GS dumps" % len(gamepaths))
-
-    if parallel <= 1:
-        for game in gamepaths:
-            run_regression_test(runner, dumpdir, renderer, parallel, game)
-    else:
-        print("Processing %u games on %u processors" % (len(gamepaths), parallel))
-        func = partial(run_regression_test, runner, dumpdir, renderer, parallel)
-        pool = multiprocessing.Pool(parallel)
-        pool.map(func, gamepaths)
-        pool.close()
-
+    # like before, a dump failing to replay shows up in the report but doesn't fail the run
+    if subprocess.run(args).returncode != 0:
+        print("Some dumps failed to replay, see %s" % os.path.join(dumpdir, "report.jsonl"))
 
     return True
 
@@ -76,10 +46,13 @@ if __name__ == "__main__":
     parser.add_argument("-dumpdir", action="store", required=True, help="Base directory to dump frames to")
     parser.add_argument("-renderer", action="store", required=False, help="Renderer to use")
     parser.add_argument("-parallel", action="store", type=int, default=1, help="Number of proceeses to run")
+    parser.add_argument("-hashes", action="store_true", help="Write frame hashes instead of images")
+    parser.add_argument("-baselinedir", action="store", required=False, help="Hashes from a previous run, only frames which differ are written")
 
     args = parser.parse_args()
 
-    if not run_regression_tests(args.runner, os.path.realpath(args.gsdir), os.path.realpath(args.dumpdir), args.renderer, args.parallel):
+    if not run_regression_tests(args.runner, os.path.realpath(args.gsdir), os.path.realpath(args.dumpdir), args.renderer, args.parallel,
+                                args.hashes, os.path.realpath(args.baselinedir) if args.baselinedir is not None else None):
         sys.exit(1)
     else:
         sys.exit(0)
@@ -53,6 +53,13 @@ public:
 
 	virtual void SetBlockSize(uint bytes) {}
 	virtual void SetDataOffset(int bytes) {}
+	/// Number of chunks compressed readers may decompress ahead of sequential reads, 0 disables
+	virtual void SetPrefetchDepth(uint chunks) {}
+	/// Hint that reads are about to continue from `sector`, e.g. because the drive started seeking there
+	virtual void PrefetchHint(uint sector, uint count) {}
+	/// If the image is mapped in memory, returns a pointer to `count` contiguous sectors starting at `sector`
+	/// Returns null if the reader can't give direct access, in which case the sectors have to be read normally
+	virtual const u8* GetMappedSectors(uint sector, uint count) { return nullptr; }
 
 	uint GetBlockSize() const { return m_blocksize; }
 
@@ -105,6 +112,54 @@ public:
 	virtual void SetDataOffset(int bytes) override { m_dataoffset = bytes; }
 };
 
+// Maps the whole image into the address space, so sectors can be handed out without a read or a copy.
+// Only suitable for uncompressed images which won't be modified while they're open.
+class MappedFileReader : public AsyncFileReader
+{
+	DeclareNoncopyableObject(MappedFileReader);
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_fd;
+#endif
+
+	const u8* m_data;
+	u64 m_size;
+	int m_lastReadSize;
+
+	// Byte range we last asked the OS to page in ahead of us.
+	u64 m_hintStart;
+	u64 m_hintEnd;
+
+	bool GetSectorRange(uint sector, uint count, u64* offset, u64* size) const;
+	void HintRange(u64 offset, u64 size, bool sequential);
+	void AdvanceReadahead(u64 offset, u64 size);
+
+public:
+	MappedFileReader();
+	virtual ~MappedFileReader() override;
+
+	virtual bool Open(std::string fileName) override;
+
+	virtual int ReadSync(void* pBuffer, uint sector, uint count) override;
+
+	virtual void BeginRead(void* pBuffer, uint sector, uint count) override;
+	virtual int FinishRead(void) override;
+	virtual void CancelRead(void) override;
+
+	virtual void Close(void) override;
+
+	virtual uint GetBlockCount(void) const override;
+
+	virtual void SetBlockSize(uint bytes) override { m_blocksize = bytes; }
+	virtual void SetDataOffset(int bytes) override { m_dataoffset = bytes; }
+
+	virtual void PrefetchHint(uint sector, uint count) override;
+	virtual const u8* GetMappedSectors(uint sector, uint count) override;
+};
+
 class MultipartFileReader : public AsyncFileReader
 {
 	DeclareNoncopyableObject( MultipartFileReader );
@@ -395,7 +395,7 @@ s32 cdvdWriteConfig(const u8* config)
 }
 
 // Sets ElfCRC to the CRC of the game bound to the CDVD source.
-static __fi ElfObject* loadElf(std::string filename, bool isPSXElf)
+static __fi ElfObject* loadElf(SectorSource& source, std::string filename, bool isPSXElf)
 {
 	if (StringUtil::StartsWith(filename, "host:"))
 	{
@@ -426,8 +426,7 @@ static __fi ElfObject* loadElf(std::string filename, bool isPSXElf)
 		filename += ";1";
 	}
 
-	IsoFSCDVD isofs;
-	IsoFile file(isofs, filename);
+	IsoFile file(source, filename);
 	return new ElfObject(std::move(filename), file, isPSXElf);
 }
 
@@ -437,7 +436,8 @@ static __fi void _reloadElfInfo(std::string elfpath)
 	if (elfpath == LastELF)
 		return;
 
-	std::unique_ptr<ElfObject> elfptr(loadElf(elfpath, false));
+	IsoFSCDVD isofs;
+	std::unique_ptr<ElfObject> elfptr(loadElf(isofs, elfpath, false));
 	elfptr->loadHeaders();
 	ElfCRC = elfptr->getCRC();
 	ElfEntry = elfptr->header.e_entry;
@@ -572,6 +572,30 @@ void cdvdReloadElfInfo(std::string elfoverride)
 	}
 }
 
+void cdvdGetDiscInfo(SectorSource& source, std::string* serial, u32* crc)
+{
+	*serial = std::string();
+	*crc = 0;
+
+	try
+	{
+		std::string elfpath;
+		const int discType = GetPS2ElfName(source, elfpath);
+		*serial = ExecutablePathToSerial(elfpath);
+
+		// Same as cdvdReloadElfInfo(), PS1 discs only get a serial.
+		if (discType != 2)
+			return;
+
+		std::unique_ptr<ElfObject> elfptr(loadElf(source, std::move(elfpath), false));
+		*crc = elfptr->getCRC();
+	}
+	catch ([[maybe_unused]] Exception::FileNotFound& e)
+	{
+		Console.Error("Failed to load ELF info");
+	}
+}
+
 void cdvdReadKey(u8, u16, u32 arg2, u8* key)
 {
 	s32 numbers = 0, letters = 0;
@@ -1326,6 +1350,9 @@ static uint cdvdStartSeek(uint newsector, CDVD_MODE_TYPE mode)
 {
 	cdvd.SeekToSector = newsector;
 
+	// Give the source the emulated seek time to get the data off the host disk.
+	DoCDVDseekHint(newsector);
+
 	uint delta = abs((s32)(cdvd.SeekToSector - cdvd.Sector));
 	uint seektime;
 	bool isSeeking = cdvd.nCommand == N_CD_SEEK;
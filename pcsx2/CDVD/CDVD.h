@@ -177,6 +177,12 @@ extern void cdvdWrite(u8 key, u8 rt);
 
 extern void cdvdReloadElfInfo(std::string elfoverride = std::string());
 extern u32 cdvdGetElfCRC(const std::string& path);
+
+class SectorSource;
+
+// Reads the serial and ELF CRC of a disc without touching the ones of the running game, e.g. for the game list.
+extern void cdvdGetDiscInfo(SectorSource& source, std::string* serial, u32* crc);
+
 extern s32 cdvdCtrlTrayOpen();
 extern s32 cdvdCtrlTrayClose();
 
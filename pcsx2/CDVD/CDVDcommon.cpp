@@ -69,12 +69,11 @@ static void CheckNullCDVD()
 //////////////////////////////////////////////////////////////////////////////////////////
 // Disk Type detection stuff (from cdvdGigaherz)
 //
-static int CheckDiskTypeFS(int baseType)
+static int CheckDiskTypeFS(SectorSource& source, int baseType)
 {
-	IsoFSCDVD isofs;
 	try
 	{
-		IsoDirectory rootdir(isofs);
+		IsoDirectory rootdir(source);
 
 		try
 		{
@@ -234,7 +233,8 @@ static int FindDiskType(int mType)
 
 	if (dataTracks > 0)
 	{
-		iCDType = CheckDiskTypeFS(iCDType);
+		IsoFSCDVD isofs;
+		iCDType = CheckDiskTypeFS(isofs, iCDType);
 	}
 
 	if (audioTracks > 0)
@@ -481,6 +481,13 @@ s32 DoCDVDreadSector(u8* buffer, u32 lsn, int mode)
 	return ret;
 }
 
+void DoCDVDseekHint(u32 lsn)
+{
+	CheckNullCDVD();
+	if (CDVD->seekHint != NULL)
+		CDVD->seekHint(lsn);
+}
+
 s32 DoCDVDreadTrack(u32 lsn, int mode)
 {
 	CheckNullCDVD();
@@ -549,6 +556,22 @@ void DoCDVDresetDiskTypeCache()
 	diskTypeCached = -1;
 }
 
+s32 DoCDVDdetectIsoDiskType(InputIsoFile& iso)
+{
+	IsoFSImage source(iso);
+
+	// Images are a single data track, so this is what FindDiskType() ends up doing for them.
+	int baseType = CDVD_TYPE_DETCTDVDS;
+	if (iso.GetBlockCount() <= 452849)
+	{
+		u8 buffer[2048];
+		if (source.readSector(buffer, 16) && std::memcmp(buffer + 166, buffer + 171, sizeof(u16)) == 0)
+			baseType = CDVD_TYPE_DETCTCD;
+	}
+
+	return CheckDiskTypeFS(source, baseType);
+}
+
 ////////////////////////////////////////////////////////
 //
 // CDVD null interface for Run BIOS menu
@@ -642,4 +665,5 @@ CDVD_API CDVDapi_NoDisc =
 
 		NODISCreadSector,
 		NODISCgetDualInfo,
+		nullptr, // seekHint
 };
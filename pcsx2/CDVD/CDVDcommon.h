@@ -111,6 +111,10 @@ typedef s32(CALLBACK* _CDVDctrlTrayClose)();
 typedef s32(CALLBACK* _CDVDreadSector)(u8* buffer, u32 lsn, int mode);
 typedef s32(CALLBACK* _CDVDgetDualInfo)(s32* dualType, u32* _layer1start);
 
+// Notifies the source that the drive started seeking to lsn, so it can start loading data early.
+// Optional, may be null.
+typedef void(CALLBACK* _CDVDseekHint)(u32 lsn);
+
 typedef void(CALLBACK* _CDVDnewDiskCB)(void (*callback)());
 
 enum class CDVD_SourceType : uint8_t
@@ -142,6 +146,7 @@ struct CDVD_API
 	// special functions, not in external interface yet
 	_CDVDreadSector readSector;
 	_CDVDgetDualInfo getDualInfo;
+	_CDVDseekHint seekHint;
 };
 
 // ----------------------------------------------------------------------------
@@ -162,7 +167,13 @@ extern CDVD_SourceType CDVDsys_GetSourceType();
 extern bool DoCDVDopen();
 extern void DoCDVDclose();
 extern s32 DoCDVDreadSector(u8* buffer, u32 lsn, int mode);
+extern void DoCDVDseekHint(u32 lsn);
 extern s32 DoCDVDreadTrack(u32 lsn, int mode);
 extern s32 DoCDVDgetBuffer(u8* buffer);
 extern s32 DoCDVDdetectDiskType();
 extern void DoCDVDresetDiskTypeCache();
+
+class InputIsoFile;
+
+// Detects the disc type of an image opened outside of the CDVD interface, without changing any global state.
+extern s32 DoCDVDdetectIsoDiskType(InputIsoFile& iso);
@@ -541,4 +541,5 @@ CDVD_API CDVDapi_Disc =
 
 		DISCreadSector,
 		DISCgetDualInfo,
+		nullptr, // seekHint
 };
@@ -322,10 +322,7 @@ s32 CALLBACK ISOreadSector(u8* tempbuffer, u32 lsn, int mode)
 		return 0;
 	}
 
-	iso.ReadSync(cdbuffer, lsn);
-
-
-	u8* pbuffer = cdbuffer;
+	int poffset = 0;
 	int psize = 0;
 
 	switch (mode)
@@ -336,26 +333,44 @@ s32 CALLBACK ISOreadSector(u8* tempbuffer, u32 lsn, int mode)
 			//	break;
 
 		case CDVD_MODE_2340:
-			pbuffer += 12;
+			poffset = 12;
 			psize = 2340;
 			break;
 		case CDVD_MODE_2328:
-			pbuffer += 24;
+			poffset = 24;
 			psize = 2328;
 			break;
 		case CDVD_MODE_2048:
-			pbuffer += 24;
+			poffset = 24;
 			psize = 2048;
 			break;
 
 			jNO_DEFAULT
 	}
 
-	memcpy(tempbuffer, pbuffer, psize);
+	// If the image is mapped and the requested part of the sector is actually stored in it,
+	// copy it straight out of the mapping rather than going through cdbuffer.
+	const int blockofs = iso.GetBlockOffset();
+	if (poffset >= blockofs && (poffset + psize) <= (blockofs + static_cast<int>(iso.GetBlockSize())))
+	{
+		if (const u8* mapped = iso.GetMappedSector(lsn))
+		{
+			memcpy(tempbuffer, mapped + (poffset - blockofs), psize);
+			return 0;
+		}
+	}
+
+	iso.ReadSync(cdbuffer, lsn);
+	memcpy(tempbuffer, cdbuffer + poffset, psize);
 
 	return 0;
 }
 
+void CALLBACK ISOseekHint(u32 lsn)
+{
+	iso.SeekHint(lsn);
+}
+
 s32 CALLBACK ISOreadTrack(u32 lsn, int mode)
 {
 	int _lsn = lsn;
@@ -424,4 +439,5 @@ CDVD_API CDVDapi_Iso =
 
 		ISOreadSector,
 		ISOgetDualInfo,
+		ISOseekHint,
 };
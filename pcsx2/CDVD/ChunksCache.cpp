@@ -15,44 +15,184 @@
 
 #include "PrecompiledHeader.h"
 #include "ChunksCache.h"
+#include "common/Assertions.h"
+
+ChunksCache::ChunksCache(uint initialLimitMb, uint chunkSize)
+	: m_head(INVALID_SLOT)
+	, m_tail(INVALID_SLOT)
+	, m_chunkSize(chunkSize)
+	, m_maxSlots(0)
+{
+	SetLimit(initialLimitMb);
+}
 
 void ChunksCache::SetLimit(uint megabytes)
 {
-	m_limit = (s64)megabytes * 1024 * 1024;
+	m_maxSlots = std::max<u32>(static_cast<u32>((s64)megabytes * 1024 * 1024 / m_chunkSize), 1);
 	MatchLimit();
 }
 
-void ChunksCache::MatchLimit(bool removeAll)
+void ChunksCache::Clear()
+{
+	m_index.clear();
+	m_entries.clear();
+	m_slabs.clear();
+	m_freeSlots.clear();
+	m_head = INVALID_SLOT;
+	m_tail = INVALID_SLOT;
+}
+
+void ChunksCache::MatchLimit()
 {
-	std::list<CacheEntry*>::reverse_iterator rit;
-	while (!m_entries.empty() && (removeAll || m_size > m_limit))
+	while (m_tail != INVALID_SLOT && m_index.size() > m_maxSlots)
+		Evict(m_tail);
+
+	if (m_entries.size() <= m_maxSlots)
+		return;
+
+	// Chunks living past the limit move down into free slots, so the slabs above it can be released.
+	// There are always enough, every slot below the limit is either cached or free.
+	std::vector<u32> lowFree;
+	for (const u32 slot : m_freeSlots)
 	{
-		rit = m_entries.rbegin();
-		m_size -= (*rit)->size;
-		delete (*rit);
-		m_entries.pop_back();
+		if (slot < m_maxSlots)
+			lowFree.push_back(slot);
+	}
+	for (auto& [chunk, slot] : m_index)
+	{
+		if (slot < m_maxSlots)
+			continue;
+
+		pxAssert(!lowFree.empty());
+		const u32 to = lowFree.back();
+		lowFree.pop_back();
+		MoveSlot(slot, to);
+		slot = to;
 	}
+
+	m_freeSlots = std::move(lowFree);
+	m_entries.resize(m_maxSlots);
+	m_slabs.resize((m_maxSlots + SLOTS_PER_SLAB - 1) / SLOTS_PER_SLAB);
 }
 
-void ChunksCache::Take(void* pMallocedSrc, s64 offset, int length, int coverage)
+void ChunksCache::Unlink(u32 slot)
 {
-	m_entries.push_front(new CacheEntry(pMallocedSrc, offset, length, coverage));
-	m_size += length;
-	MatchLimit();
+	CacheEntry& e = m_entries[slot];
+	if (e.prev != INVALID_SLOT)
+		m_entries[e.prev].next = e.next;
+	else
+		m_head = e.next;
+	if (e.next != INVALID_SLOT)
+		m_entries[e.next].prev = e.prev;
+	else
+		m_tail = e.prev;
+	e.prev = e.next = INVALID_SLOT;
+}
+
+void ChunksCache::LinkFront(u32 slot)
+{
+	CacheEntry& e = m_entries[slot];
+	e.prev = INVALID_SLOT;
+	e.next = m_head;
+	if (m_head != INVALID_SLOT)
+		m_entries[m_head].prev = slot;
+	m_head = slot;
+	if (m_tail == INVALID_SLOT)
+		m_tail = slot;
+}
+
+void ChunksCache::Evict(u32 slot)
+{
+	Unlink(slot);
+	m_index.erase(m_entries[slot].offset / m_chunkSize);
+	m_freeSlots.push_back(slot);
+}
+
+// Keeps the chunk's place in the LRU list, the caller updates the index
+void ChunksCache::MoveSlot(u32 from, u32 to)
+{
+	const CacheEntry& e = m_entries[to] = m_entries[from];
+	if (e.prev != INVALID_SLOT)
+		m_entries[e.prev].next = to;
+	else
+		m_head = to;
+	if (e.next != INVALID_SLOT)
+		m_entries[e.next].prev = to;
+	else
+		m_tail = to;
+	if (e.size > 0)
+		memcpy(SlotData(to), SlotData(from), e.size);
+}
+
+u32 ChunksCache::AllocateSlot()
+{
+	// Reuse a slot in an existing slab before growing
+	if (!m_freeSlots.empty())
+	{
+		const u32 slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return slot;
+	}
+
+	const u32 allocated = static_cast<u32>(m_entries.size());
+	if (allocated < m_maxSlots)
+	{
+		if (allocated % SLOTS_PER_SLAB == 0)
+			m_slabs.push_back(std::make_unique<u8[]>(static_cast<size_t>(m_chunkSize) * SLOTS_PER_SLAB));
+		m_entries.push_back(CacheEntry{0, 0, 0, INVALID_SLOT, INVALID_SLOT});
+		return allocated;
+	}
+
+	// Full, recycle the least recently used chunk
+	const u32 slot = m_tail;
+	Unlink(slot);
+	m_index.erase(m_entries[slot].offset / m_chunkSize);
+	return slot;
+}
+
+void ChunksCache::Take(const void* pSrc, s64 offset, int length, int coverage)
+{
+	pxAssert(offset % m_chunkSize == 0 && coverage <= static_cast<int>(m_chunkSize) && length <= coverage);
+
+	const s64 chunk = offset / m_chunkSize;
+	u32 slot;
+	auto it = m_index.find(chunk);
+	if (it != m_index.end())
+	{
+		slot = it->second;
+		Unlink(slot);
+	}
+	else
+	{
+		slot = AllocateSlot();
+		m_index.emplace(chunk, slot);
+	}
+
+	CacheEntry& e = m_entries[slot];
+	e.offset = offset;
+	e.coverage = coverage;
+	e.size = length;
+	if (length > 0)
+		memcpy(SlotData(slot), pSrc, length);
+	LinkFront(slot);
 }
 
 // By design, succeed only if the entire request is in a single cached chunk
 int ChunksCache::Read(void* pDest, s64 offset, int length)
 {
-	for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+	auto it = m_index.find(offset / m_chunkSize);
+	if (it == m_index.end())
+		return -1;
+
+	const u32 slot = it->second;
+	const CacheEntry& e = m_entries[slot];
+	if ((offset + length) > (e.offset + e.coverage))
+		return -1;
+
+	if (slot != m_head)
 	{
-		CacheEntry* e = *it;
-		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
-		{
-			if (it != m_entries.begin())
-				m_entries.splice(m_entries.begin(), m_entries, it); // Move to top (MRU)
-			return CopyAvailable(e->data, e->offset, e->size, pDest, offset, length);
-		}
+		Unlink(slot);
+		LinkFront(slot); // Move to top (MRU)
 	}
-	return -1;
+	return CopyAvailable(SlotData(slot), e.offset, e.size, pDest, offset, length);
 }
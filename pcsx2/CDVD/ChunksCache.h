@@ -15,54 +15,66 @@
 
 #pragma once
 
-#include "zlib_indexed.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
+// Size bounded LRU cache of decompressed chunks.
+// Chunks must start on a multiple of the chunk size given at construction and may not cover more than one chunk,
+// which lets lookups go straight to the chunk through a hash of its index instead of searching all entries.
+// Chunk data lives in slots carved out of a few large slabs rather than in one allocation per chunk.
 class ChunksCache
 {
 public:
-	ChunksCache(uint initialLimitMb)
-		: m_entries(0)
-		, m_size(0)
-		, m_limit(initialLimitMb * 1024 * 1024){};
+	ChunksCache(uint initialLimitMb, uint chunkSize);
 	~ChunksCache() { Clear(); };
 	void SetLimit(uint megabytes);
-	void Clear() { MatchLimit(true); };
+	void Clear();
 
-	void Take(void* pMallocedSrc, s64 offset, int length, int coverage);
+	// Copies length bytes of src into the cache, replacing any chunk already cached at offset.
+	// coverage is the amount of the original request that src represents, can be larger than length at EOF.
+	void Take(const void* pSrc, s64 offset, int length, int coverage);
 	int Read(void* pDest, s64 offset, int length);
 
-	static int CopyAvailable(void* pSrc, s64 srcOffset, int srcSize,
+	// Bytes held by the slabs, shrinks along with the limit.
+	size_t GetAllocatedSize() const { return m_slabs.size() * SLOTS_PER_SLAB * static_cast<size_t>(m_chunkSize); }
+
+	static int CopyAvailable(const void* pSrc, s64 srcOffset, int srcSize,
 							 void* pDst, s64 dstOffset, int maxCopySize)
 	{
 		int available = std::clamp(maxCopySize, 0, std::max((int)(srcOffset + srcSize - dstOffset), 0));
-		memcpy(pDst, (char*)pSrc + (dstOffset - srcOffset), available);
+		memcpy(pDst, (const char*)pSrc + (dstOffset - srcOffset), available);
 		return available;
 	};
 
 private:
-	class CacheEntry
-	{
-	public:
-		CacheEntry(void* pMallocedSrc, s64 offset, int length, int coverage)
-			: data(pMallocedSrc)
-			, offset(offset)
-			, coverage(coverage)
-			, size(length){};
-
-		~CacheEntry()
-		{
-			if (data)
-				free(data);
-		};
+	static constexpr u32 SLOTS_PER_SLAB = 16;
+	static constexpr u32 INVALID_SLOT = 0xFFFFFFFFu;
 
-		void* data;
+	struct CacheEntry
+	{
 		s64 offset;
 		int coverage;
 		int size;
+		// Intrusive LRU list, head is the most recently used
+		u32 prev;
+		u32 next;
 	};
 
-	std::list<CacheEntry*> m_entries;
-	void MatchLimit(bool removeAll = false);
-	s64 m_size;
-	s64 m_limit;
+	u8* SlotData(u32 slot) { return m_slabs[slot / SLOTS_PER_SLAB].get() + (slot % SLOTS_PER_SLAB) * static_cast<size_t>(m_chunkSize); }
+	u32 AllocateSlot();
+	void Unlink(u32 slot);
+	void LinkFront(u32 slot);
+	void Evict(u32 slot);
+	void MoveSlot(u32 from, u32 to);
+	void MatchLimit();
+
+	std::unordered_map<s64, u32> m_index; // chunk number -> slot
+	std::vector<CacheEntry> m_entries; // one per allocated slot
+	std::vector<std::unique_ptr<u8[]>> m_slabs;
+	std::vector<u32> m_freeSlots;
+	u32 m_head;
+	u32 m_tail;
+	u32 m_chunkSize;
+	u32 m_maxSlots;
 };
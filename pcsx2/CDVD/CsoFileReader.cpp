@@ -38,8 +38,26 @@ struct CsoHeader
 	u8 reserved[2];
 };
 
+struct CsoFileReader::DecompressContext
+{
+	z_stream stream;
+	std::unique_ptr<u8[]> readBuffer;
+	bool initialized = false;
+
+	~DecompressContext()
+	{
+		if (initialized)
+			inflateEnd(&stream);
+	}
+};
+
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
 
+CsoFileReader::~CsoFileReader(void)
+{
+	Close();
+}
+
 bool CsoFileReader::CanHandle(const std::string& fileName, const std::string& displayName)
 {
 	bool supported = false;
@@ -143,14 +161,7 @@ bool CsoFileReader::InitializeBuffers()
 	u32 numFrames = (u32)((m_totalSize + m_frameSize - 1) / m_frameSize);
 
 	// We might read a bit of alignment too, so be prepared.
-	if (m_frameSize + (1 << m_indexShift) < CSO_READ_BUFFER_SIZE)
-	{
-		m_readBuffer = new u8[CSO_READ_BUFFER_SIZE];
-	}
-	else
-	{
-		m_readBuffer = new u8[m_frameSize + (1 << m_indexShift)];
-	}
+	m_readBufferSize = std::max<u32>(m_frameSize + (1 << m_indexShift), CSO_READ_BUFFER_SIZE);
 
 	const u32 indexSize = numFrames + 1;
 	m_index = new u32[indexSize];
@@ -160,17 +171,45 @@ bool CsoFileReader::InitializeBuffers()
 		return false;
 	}
 
-	m_z_stream = new z_stream;
-	m_z_stream->zalloc = Z_NULL;
-	m_z_stream->zfree = Z_NULL;
-	m_z_stream->opaque = Z_NULL;
-	if (inflateInit2(m_z_stream, -15) != Z_OK)
+	std::unique_ptr<DecompressContext> ctx = AcquireContext();
+	if (!ctx)
+		return false;
+
+	ReleaseContext(std::move(ctx));
+	return true;
+}
+
+std::unique_ptr<CsoFileReader::DecompressContext> CsoFileReader::AcquireContext()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_contextsMutex);
+		if (!m_contexts.empty())
+		{
+			std::unique_ptr<DecompressContext> ctx = std::move(m_contexts.back());
+			m_contexts.pop_back();
+			return ctx;
+		}
+	}
+
+	std::unique_ptr<DecompressContext> ctx = std::make_unique<DecompressContext>();
+	ctx->stream.zalloc = Z_NULL;
+	ctx->stream.zfree = Z_NULL;
+	ctx->stream.opaque = Z_NULL;
+	if (inflateInit2(&ctx->stream, -15) != Z_OK)
 	{
 		Console.Error("Unable to initialize zlib for CSO decompression.");
-		return false;
+		return nullptr;
 	}
 
-	return true;
+	ctx->initialized = true;
+	ctx->readBuffer = std::make_unique<u8[]>(m_readBufferSize);
+	return ctx;
+}
+
+void CsoFileReader::ReleaseContext(std::unique_ptr<DecompressContext> ctx)
+{
+	std::lock_guard<std::mutex> lock(m_contextsMutex);
+	m_contexts.push_back(std::move(ctx));
 }
 
 void CsoFileReader::Close2()
@@ -182,17 +221,8 @@ void CsoFileReader::Close2()
 		fclose(m_src);
 		m_src = NULL;
 	}
-	if (m_z_stream)
-	{
-		inflateEnd(m_z_stream);
-		m_z_stream = NULL;
-	}
+	m_contexts.clear();
 
-	if (m_readBuffer)
-	{
-		delete[] m_readBuffer;
-		m_readBuffer = NULL;
-	}
 	if (m_index)
 	{
 		delete[] m_index;
@@ -235,6 +265,7 @@ int CsoFileReader::ReadChunk(void *dst, s64 chunkID)
 	if (!compressed)
 	{
 		// Just read directly, easy.
+		std::lock_guard<std::mutex> lock(m_srcMutex);
 		if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
 		{
 			Console.Error("Unable to seek to uncompressed CSO data.");
@@ -244,26 +275,37 @@ int CsoFileReader::ReadChunk(void *dst, s64 chunkID)
 	}
 	else
 	{
-		if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
-		{
-			Console.Error("Unable to seek to compressed CSO data.");
+		std::unique_ptr<DecompressContext> ctx = AcquireContext();
+		if (!ctx)
 			return 0;
+
+		u32 readRawBytes;
+		{
+			std::lock_guard<std::mutex> lock(m_srcMutex);
+			if (FileSystem::FSeek64(m_src, frameRawPos, SEEK_SET) != 0)
+			{
+				Console.Error("Unable to seek to compressed CSO data.");
+				ReleaseContext(std::move(ctx));
+				return 0;
+			}
+			// This might be less bytes than frameRawSize in case of padding on the last frame.
+			// This is because the index positions must be aligned.
+			readRawBytes = fread(ctx->readBuffer.get(), 1, frameRawSize, m_src);
 		}
-		// This might be less bytes than frameRawSize in case of padding on the last frame.
-		// This is because the index positions must be aligned.
-		const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
 
-		m_z_stream->next_in = m_readBuffer;
-		m_z_stream->avail_in = readRawBytes;
-		m_z_stream->next_out = static_cast<Bytef*>(dst);
-		m_z_stream->avail_out = m_frameSize;
+		z_stream* stream = &ctx->stream;
+		stream->next_in = ctx->readBuffer.get();
+		stream->avail_in = readRawBytes;
+		stream->next_out = static_cast<Bytef*>(dst);
+		stream->avail_out = m_frameSize;
 
-		int status = inflate(m_z_stream, Z_FINISH);
-		bool success = status == Z_STREAM_END && m_z_stream->total_out == m_frameSize;
+		int status = inflate(stream, Z_FINISH);
+		bool success = status == Z_STREAM_END && stream->total_out == m_frameSize;
 
 		if (!success)
 			Console.Error("Unable to decompress CSO frame using zlib.");
-		inflateReset(m_z_stream);
+		inflateReset(stream);
+		ReleaseContext(std::move(ctx));
 
 		return success ? m_frameSize : 0;
 	}
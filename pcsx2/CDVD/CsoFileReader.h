@@ -27,6 +27,10 @@
 #include "ThreadedFileReader.h"
 #include "ChunksCache.h"
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
@@ -41,16 +45,17 @@ public:
 		: m_frameSize(0)
 		, m_frameShift(0)
 		, m_indexShift(0)
-		, m_readBuffer(0)
+		, m_readBufferSize(0)
 		, m_index(0)
 		, m_totalSize(0)
 		, m_src(0)
-		, m_z_stream(0)
 	{
 		m_blocksize = 2048;
+		// Each caller gets its own zlib stream, and file access is locked.
+		m_concurrentReadChunk = true;
 	};
 
-	~CsoFileReader(void) { Close(); };
+	~CsoFileReader(void);
 
 	static bool CanHandle(const std::string& fileName, const std::string& displayName);
 	bool Open2(std::string fileName) override;
@@ -66,20 +71,26 @@ public:
 	};
 
 private:
+	// zlib stream and compressed data buffer for one in-flight ReadChunk.
+	struct DecompressContext;
+
 	static bool ValidateHeader(const CsoHeader& hdr);
 	bool ReadFileHeader();
 	bool InitializeBuffers();
-	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
-	bool DecompressFrame(Bytef* dst, u32 frame, u32 readBufferSize);
-	bool DecompressFrame(u32 frame, u32 readBufferSize);
+	std::unique_ptr<DecompressContext> AcquireContext();
+	void ReleaseContext(std::unique_ptr<DecompressContext> ctx);
 
 	u32 m_frameSize;
 	u8 m_frameShift;
 	u8 m_indexShift;
-	u8* m_readBuffer;;
+	u32 m_readBufferSize;
 	u32* m_index;
 	u64 m_totalSize;
 	// The actual source cso file handle.
 	FILE* m_src;
-	z_stream* m_z_stream;
+	// Seeks and reads on m_src have to happen together.
+	std::mutex m_srcMutex;
+	// Idle contexts, ReadChunk creates more when several threads decompress at once.
+	std::vector<std::unique_ptr<DecompressContext>> m_contexts;
+	std::mutex m_contextsMutex;
 };
@@ -197,7 +197,7 @@ GzippedFileReader::GzippedFileReader(void)
 	, m_pIndex(0)
 	, m_zstates(0)
 	, m_src(0)
-	, m_cache(GZFILE_CACHE_SIZE_MB)
+	, m_cache(GZFILE_CACHE_SIZE_MB, GZFILE_READ_CHUNK_SIZE)
 {
 	m_blocksize = 2048;
 	AsyncPrefetchReset();
@@ -484,13 +484,10 @@ int GzippedFileReader::_ReadSync(void* pBuffer, s64 offset, uint bytesToRead)
 		for (int i = 0; i < size; i += GZFILE_READ_CHUNK_SIZE)
 		{
 			int available = CLAMP(res - i, 0, GZFILE_READ_CHUNK_SIZE);
-			void* chunk = available ? malloc(available) : 0;
-			if (available)
-				memcpy(chunk, extracted + i, available);
-			m_cache.Take(chunk, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
+			m_cache.Take(extracted + i, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
 		}
-		free(extracted);
 	}
+	free(extracted);
 
 	int duration = NOW() - s;
 	if (duration > 10)
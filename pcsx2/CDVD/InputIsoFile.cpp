@@ -56,6 +56,22 @@ int InputIsoFile::ReadSync(u8* dst, uint lsn)
 	return m_reader->ReadSync(dst + m_blockofs, lsn, 1);
 }
 
+const u8* InputIsoFile::GetMappedSector(uint lsn)
+{
+	if (lsn >= m_blocks)
+		return nullptr;
+
+	return m_reader->GetMappedSectors(lsn, 1);
+}
+
+void InputIsoFile::SeekHint(uint lsn)
+{
+	if (lsn >= m_blocks)
+		return;
+
+	m_reader->PrefetchHint(lsn, std::min(MaxReadUnit, m_blocks - lsn));
+}
+
 void InputIsoFile::BeginRead2(uint lsn)
 {
 	m_current_lsn = lsn;
@@ -84,6 +100,11 @@ void InputIsoFile::BeginRead2(uint lsn)
 		m_read_count = std::min(ReadUnit, m_blocks - m_read_lsn);
 	}
 
+	// Mapped images don't need to go through the read buffer at all
+	m_read_ptr = m_reader->GetMappedSectors(m_read_lsn, m_read_count);
+	if (m_read_ptr)
+		return;
+
 	m_reader->BeginRead(m_readbuffer, m_read_lsn, m_read_count);
 	m_read_inprogress = true;
 }
@@ -149,7 +170,8 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	length = end - _offset;
 
 	uint read_offset = (m_current_lsn - m_read_lsn) * m_blocksize;
-	memcpy(dst + diff, m_readbuffer + ndiff + read_offset, length);
+	const u8* src = m_read_ptr ? m_read_ptr : m_readbuffer;
+	memcpy(dst + diff, src + ndiff + read_offset, length);
 
 	if (m_type == ISOTYPE_CD && diff >= 12)
 	{
@@ -185,6 +207,7 @@ void InputIsoFile::_init()
 	ReadUnit = 0;
 	m_current_lsn = -1;
 	m_read_lsn = -1;
+	m_read_ptr = nullptr;
 	m_reader = NULL;
 }
 
@@ -213,8 +236,23 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 	m_reader = CompressedFileReader::GetNewReader(m_filename);
 	isCompressed = m_reader != NULL;
 
-	// If it wasn't compressed, let's open it has a FlatFileReader.
-	if (!isCompressed)
+	// If it wasn't compressed, try mapping it, so sectors can be read straight out of the page cache.
+	// A read error or the file shrinking underneath us faults instead of failing the read, so it's
+	// opt-in, and never done when write sharing is enabled.
+	bool isOpened = false;
+	if (!isCompressed && EmuConfig.CdvdMapImages && !EmuConfig.CdvdShareWrite)
+	{
+		m_reader = new MappedFileReader();
+		isOpened = m_reader->Open(m_filename);
+		if (!isOpened)
+		{
+			delete m_reader;
+			m_reader = NULL;
+		}
+	}
+
+	// Otherwise, let's open it has a FlatFileReader.
+	if (!m_reader)
 	{
 		// Allow write sharing of the iso based on the ini settings.
 		// Mostly useful for romhacking, where the disc is frequently
@@ -222,7 +260,7 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 		m_reader = new FlatFileReader(EmuConfig.CdvdShareWrite);
 	}
 
-	if (!m_reader->Open(m_filename))
+	if (!isOpened && !m_reader->Open(m_filename))
 		return false;
 
 	// It might actually be a blockdump file.
@@ -264,6 +302,9 @@ bool InputIsoFile::Open(std::string srcfile, bool testOnly)
 		m_reader = MultipartFileReader::DetectMultipart(m_reader);
 	}
 
+	// Only bother spinning up decompression workers when we're actually going to run off this image
+	m_reader->SetPrefetchDepth(EmuConfig.CdvdPrefetchDepth);
+
 	m_blocks = m_reader->GetBlockCount();
 
 	Console.WriteLn(Color_StrongBlue, "isoFile open ok: %s", m_filename.c_str());
@@ -295,7 +336,7 @@ bool InputIsoFile::IsOpened() const
 
 bool InputIsoFile::tryIsoType(u32 _size, s32 _offset, s32 _blockofs)
 {
-	static u8 buf[2456];
+	u8 buf[2456]; // game list scanning detects images on several threads
 
 	m_blocksize = _size;
 	m_offset = _offset;
@@ -18,6 +18,9 @@
 
 #include "IsoFSCDVD.h"
 #include "CDVD/CDVDcommon.h"
+#include "CDVD/IsoFileFormats.h"
+
+#include <cstring>
 
 IsoFSCDVD::IsoFSCDVD()
 {
@@ -35,3 +38,27 @@ int IsoFSCDVD::getNumSectors()
 
 	return td.lsn;
 }
+
+IsoFSImage::IsoFSImage(InputIsoFile& iso)
+	: m_iso(iso)
+{
+}
+
+bool IsoFSImage::readSector(unsigned char* buffer, int lba)
+{
+	if (lba < 0 || static_cast<uint>(lba) >= m_iso.GetBlockCount())
+		return false;
+
+	// Same as ISOreadSector() in 2048 byte mode, the user data is always 24 bytes into the raw sector.
+	u8 raw[2456];
+	if (m_iso.ReadSync(raw, static_cast<uint>(lba)) < 0)
+		return false;
+
+	std::memcpy(buffer, raw + 24, 2048);
+	return true;
+}
+
+int IsoFSImage::getNumSectors()
+{
+	return static_cast<int>(m_iso.GetBlockCount());
+}
@@ -19,6 +19,8 @@
 
 #include "SectorSource.h"
 
+class InputIsoFile;
+
 class IsoFSCDVD : public SectorSource
 {
 public:
@@ -29,3 +31,19 @@ public:
 
 	virtual int getNumSectors();
 };
+
+// Reads an image opened outside of the CDVD interface, so it doesn't touch any of the global CDVD
+// state. Several of these can be used from different threads at once.
+class IsoFSImage : public SectorSource
+{
+public:
+	IsoFSImage(InputIsoFile& iso);
+	virtual ~IsoFSImage() = default;
+
+	virtual bool readSector(unsigned char* buffer, int lba);
+
+	virtual int getNumSectors();
+
+private:
+	InputIsoFile& m_iso;
+};
@@ -63,6 +63,8 @@ protected:
 	bool m_read_inprogress;
 	uint m_read_lsn;
 	uint m_read_count;
+	// Points into the image when the reader has it mapped, in which case m_readbuffer is unused
+	const u8* m_read_ptr;
 	u8 m_readbuffer[MaxReadUnit * CD_FRAMESIZE_RAW];
 
 public:
@@ -74,6 +76,7 @@ public:
 	isoType GetType() const { return m_type; }
 	uint GetBlockCount() const { return m_blocks; }
 	int GetBlockOffset() const { return m_blockofs; }
+	uint GetBlockSize() const { return m_blocksize; }
 
 	const std::string& GetFilename() const
 	{
@@ -86,6 +89,10 @@ public:
 	bool Detect(bool readType = true);
 
 	int ReadSync(u8* dst, uint lsn);
+	// Returns the raw block (without m_blockofs applied) if the image is mapped in memory, otherwise null
+	const u8* GetMappedSector(uint lsn);
+	// Lets the reader start loading data around lsn while the emulated drive is still seeking
+	void SeekHint(uint lsn);
 
 	void BeginRead2(uint lsn);
 	int FinishRead3(u8* dest, uint mode);
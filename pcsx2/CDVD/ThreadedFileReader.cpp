@@ -16,12 +16,21 @@
 #include "PrecompiledHeader.h"
 #include "ThreadedFileReader.h"
 
+#include "common/ThreadPool.h"
 #include "common/Threading.h"
+#include "common/Timer.h"
 
 // Make sure buffer size is bigger than the cutoff where PCSX2 emulates a seek
 // If buffers are smaller than that, we can't keep up with linear reads
 static constexpr u32 MINIMUM_SIZE = 128 * 1024;
 
+// Number of chunks that need to be read in order before we start prefetching
+static constexpr u32 PREFETCH_SEQUENTIAL_THRESHOLD = 2;
+// Keep a few depths worth of chunks around, so the read thread doesn't lose chunks before it gets to them
+static constexpr u32 PREFETCH_CACHE_MULTIPLIER = 4;
+// Decompression is CPU bound, but we don't want to steal all the cores from the emulator
+static constexpr int MAX_PREFETCH_WORKERS = 4;
+
 ThreadedFileReader::ThreadedFileReader()
 {
 	m_readThread = std::thread([](ThreadedFileReader* r){ r->Loop(); }, this);
@@ -29,6 +38,7 @@ ThreadedFileReader::ThreadedFileReader()
 
 ThreadedFileReader::~ThreadedFileReader()
 {
+	StopPrefetch();
 	m_quit = true;
 	(void)std::lock_guard<std::mutex>{m_mtx};
 	m_condition.notify_one();
@@ -125,7 +135,7 @@ void ThreadedFileReader::Loop()
 					}
 					else
 					{
-						int amt = ReadChunk(static_cast<char*>(buf->ptr) + bufsize, chunk.chunkID);
+						int amt = ReadChunkCached(static_cast<char*>(buf->ptr) + bufsize, chunk.chunkID);
 						if (amt <= 0)
 							break;
 						buf->size.store(bufsize + amt, std::memory_order_release);
@@ -175,7 +185,7 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 		}
 		buf.size.store(0, std::memory_order_relaxed);
 	}
-	int size = ReadChunk(buf.ptr, block.chunkID);
+	int size = ReadChunkCached(buf.ptr, block.chunkID);
 	if (size > 0)
 	{
 		buf.offset = block.offset;
@@ -186,6 +196,134 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 	return nullptr;
 }
 
+int ThreadedFileReader::ReadChunkCached(void* dst, s64 chunkID)
+{
+	std::shared_ptr<PrefetchedChunk> entry;
+	{
+		std::unique_lock<std::mutex> lock(m_prefetchMtx);
+		if (m_prefetchDepth == 0)
+		{
+			lock.unlock();
+			return ReadChunkTimed(dst, chunkID);
+		}
+
+		if (chunkID == m_prefetchLastChunk + 1)
+			m_prefetchSequentialRun++;
+		else if (chunkID != m_prefetchLastChunk)
+			m_prefetchSequentialRun = 0;
+		m_prefetchLastChunk = chunkID;
+
+		if (std::shared_ptr<PrefetchedChunk>* cached = m_prefetchCache.Lookup(chunkID))
+		{
+			entry = *cached;
+			if (!entry->started)
+			{
+				// No worker has picked it up yet, decompressing straight into the destination is quicker than waiting
+				entry->started = true;
+				entry->ready = true;
+				m_prefetchCache.Remove(chunkID);
+				entry.reset();
+			}
+		}
+
+		if (m_prefetchSequentialRun >= PREFETCH_SEQUENTIAL_THRESHOLD)
+			QueuePrefetch(chunkID);
+
+		// We hold a reference, so it doesn't matter if the chunk gets evicted while we wait
+		if (entry)
+			m_prefetchCondition.wait(lock, [&entry]() { return entry->ready; });
+	}
+
+	if (entry && entry->size > 0)
+	{
+		memcpy(dst, entry->data.get(), entry->size);
+		m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+		return entry->size;
+	}
+
+	m_prefetchMisses.fetch_add(1, std::memory_order_relaxed);
+	return ReadChunkTimed(dst, chunkID);
+}
+
+int ThreadedFileReader::ReadChunkTimed(void* dst, s64 chunkID)
+{
+	std::unique_lock<std::mutex> lock(m_readChunkMtx, std::defer_lock);
+	if (!m_concurrentReadChunk)
+		lock.lock();
+
+	const Common::Timer::Value start = Common::Timer::GetCurrentValue();
+	const int amt = ReadChunk(dst, chunkID);
+	m_decompressTicks.fetch_add(Common::Timer::GetCurrentValue() - start, std::memory_order_relaxed);
+	m_chunksDecompressed.fetch_add(1, std::memory_order_relaxed);
+	return amt;
+}
+
+void ThreadedFileReader::QueuePrefetch(s64 chunkID)
+{
+	if (!m_prefetchPool)
+	{
+		// Readers which can't decompress concurrently would just have their workers fight over the lock
+		const int workers = m_concurrentReadChunk ?
+			std::clamp(static_cast<int>(cb::ThreadPool::GetNumLogicalCores()) / 2, 1, MAX_PREFETCH_WORKERS) : 1;
+		m_prefetchPool = std::make_unique<cb::ThreadPool>(workers);
+	}
+
+	for (s64 next = chunkID + 1; next <= chunkID + static_cast<s64>(m_prefetchDepth); next++)
+	{
+		if (ChunkForOffset(static_cast<u64>(next) * m_prefetchChunkSize).chunkID != next)
+			break;
+		if (m_prefetchCache.Lookup(next))
+			continue;
+
+		std::shared_ptr<PrefetchedChunk> entry = std::make_shared<PrefetchedChunk>();
+		m_prefetchCache.Insert(next, entry);
+		m_prefetchIssued.fetch_add(1, std::memory_order_relaxed);
+		m_prefetchPool->Schedule([this, entry = std::move(entry), next]() {
+			{
+				std::lock_guard<std::mutex> lock(m_prefetchMtx);
+				if (entry->started)
+					return;
+
+				entry->started = true;
+				if (m_prefetchCancelled.load(std::memory_order_relaxed))
+				{
+					entry->ready = true;
+					m_prefetchCondition.notify_all();
+					return;
+				}
+			}
+
+			entry->data = std::make_unique<u8[]>(m_prefetchChunkSize);
+			const int size = ReadChunkTimed(entry->data.get(), next);
+			{
+				std::lock_guard<std::mutex> lock(m_prefetchMtx);
+				entry->size = size;
+				entry->ready = true;
+			}
+			m_prefetchCondition.notify_all();
+		});
+	}
+}
+
+void ThreadedFileReader::StopPrefetch()
+{
+	std::unique_ptr<cb::ThreadPool> pool;
+	{
+		std::lock_guard<std::mutex> lock(m_prefetchMtx);
+		pool = std::move(m_prefetchPool);
+	}
+
+	// The pool waits for all queued jobs on destruction, which bail out early once cancelled
+	m_prefetchCancelled.store(true, std::memory_order_relaxed);
+	pool.reset();
+	m_prefetchCancelled.store(false, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_prefetchMtx);
+	m_prefetchCache.Clear();
+	m_prefetchLastChunk = -1;
+	m_prefetchSequentialRun = 0;
+}
+
 bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 {
 	char* write = static_cast<char*>(target);
@@ -213,7 +351,7 @@ bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 		}
 		else
 		{
-			int amt = ReadChunk(write, chunk.chunkID);
+			int amt = ReadChunkCached(write, chunk.chunkID);
 			if (amt < static_cast<int>(chunk.length))
 				return false;
 			write += chunk.length;
@@ -259,7 +397,12 @@ bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, co
 bool ThreadedFileReader::Open(std::string fileName)
 {
 	CancelAndWaitUntilStopped();
-	return Open2(std::move(fileName));
+	StopPrefetch();
+	if (!Open2(std::move(fileName)))
+		return false;
+
+	m_prefetchChunkSize = ChunkForOffset(0).length;
+	return true;
 }
 
 int ThreadedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
@@ -366,6 +509,22 @@ void ThreadedFileReader::CancelRead(void)
 void ThreadedFileReader::Close(void)
 {
 	CancelAndWaitUntilStopped();
+	StopPrefetch();
+
+	const PrefetchStats stats = GetPrefetchStats();
+	if (stats.hits > 0 || stats.misses > 0)
+	{
+		DevCon.WriteLn("ThreadedFileReader: %llu prefetch hits, %llu misses, %llu chunks prefetched, %llu chunks decompressed in %.2f ms",
+			static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+			static_cast<unsigned long long>(stats.prefetched), static_cast<unsigned long long>(stats.decompressed),
+			stats.decompressTimeMS);
+	}
+	m_prefetchHits.store(0, std::memory_order_relaxed);
+	m_prefetchMisses.store(0, std::memory_order_relaxed);
+	m_prefetchIssued.store(0, std::memory_order_relaxed);
+	m_chunksDecompressed.store(0, std::memory_order_relaxed);
+	m_decompressTicks.store(0, std::memory_order_relaxed);
+
 	for (auto& buf : m_buffer)
 		buf.size.store(0, std::memory_order_relaxed);
 	Close2();
@@ -380,3 +539,23 @@ void ThreadedFileReader::SetDataOffset(int bytes)
 {
 	m_dataoffset = bytes;
 }
+
+void ThreadedFileReader::SetPrefetchDepth(uint chunks)
+{
+	StopPrefetch();
+
+	std::lock_guard<std::mutex> lock(m_prefetchMtx);
+	m_prefetchDepth = chunks;
+	m_prefetchCache.SetMaxCapacity(std::max<u32>(chunks * PREFETCH_CACHE_MULTIPLIER, 1));
+}
+
+ThreadedFileReader::PrefetchStats ThreadedFileReader::GetPrefetchStats() const
+{
+	PrefetchStats stats;
+	stats.hits = m_prefetchHits.load(std::memory_order_relaxed);
+	stats.misses = m_prefetchMisses.load(std::memory_order_relaxed);
+	stats.prefetched = m_prefetchIssued.load(std::memory_order_relaxed);
+	stats.decompressed = m_chunksDecompressed.load(std::memory_order_relaxed);
+	stats.decompressTimeMS = Common::Timer::ConvertValueToMilliseconds(m_decompressTicks.load(std::memory_order_relaxed));
+	return stats;
+}
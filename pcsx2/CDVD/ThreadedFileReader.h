@@ -16,12 +16,19 @@
 #pragma once
 
 #include "AsyncFileReader.h"
+#include "common/LRUCache.h"
 
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
 
+namespace cb
+{
+	class ThreadPool;
+}
+
 /// A file reader for use with compressed formats
 /// Calls decompression code on a separate thread to make a synchronous decompression API async
 class ThreadedFileReader : public AsyncFileReader
@@ -41,6 +48,10 @@ protected:
 	/// Use to avoid overrunning stack because PCSX2 likes to allocate 2448-byte buffers
 	int m_internalBlockSize = 0;
 
+	/// Set true if `ReadChunk` may be called from several threads at once
+	/// Otherwise calls from the prefetch workers and the read thread are serialized
+	bool m_concurrentReadChunk = false;
+
 	/// Get the block containing the given offset
 	virtual Chunk ChunkForOffset(u64 offset) = 0;
 	/// Synchronously read the given block into `dst`
@@ -86,6 +97,42 @@ private:
 	/// View while holding `m_mtx`.  If false, you may touch decompression functions from other threads
 	bool m_running = false;
 
+	/// A chunk decompressed by the prefetch workers
+	/// `data` and `size` may only be read once `ready` is set (while holding `m_prefetchMtx`)
+	/// A ready chunk with a size of 0 failed or was taken over by a direct read, and should be read again
+	struct PrefetchedChunk
+	{
+		std::unique_ptr<u8[]> data;
+		int size = 0;
+		bool started = false;
+		bool ready = false;
+	};
+
+	/// Number of chunks to decompress ahead of a sequential read, 0 disables prefetching
+	u32 m_prefetchDepth = 0;
+	/// Size of a single chunk, all chunks but the last one are expected to be the same size
+	u32 m_prefetchChunkSize = 0;
+	/// Last chunk requested by a non-prefetch read, used to detect sequential access
+	s64 m_prefetchLastChunk = -1;
+	/// Number of consecutive chunks read in order
+	u32 m_prefetchSequentialRun = 0;
+	/// Decompressed chunks, entries are shared with the worker filling them so eviction never frees a buffer in use
+	LRUCache<s64, std::shared_ptr<PrefetchedChunk>> m_prefetchCache;
+	std::unique_ptr<cb::ThreadPool> m_prefetchPool;
+	std::mutex m_prefetchMtx;
+	/// Signalled whenever a prefetched chunk becomes ready
+	std::condition_variable m_prefetchCondition;
+	/// Tells queued prefetch jobs to bail out, set while tearing down the pool
+	std::atomic<bool> m_prefetchCancelled{false};
+	/// Serializes `ReadChunk` when `m_concurrentReadChunk` is false
+	std::mutex m_readChunkMtx;
+
+	std::atomic<u64> m_prefetchHits{0};
+	std::atomic<u64> m_prefetchMisses{0};
+	std::atomic<u64> m_prefetchIssued{0};
+	std::atomic<u64> m_chunksDecompressed{0};
+	std::atomic<u64> m_decompressTicks{0};
+
 	/// Get the internal block size
 	u32 InternalBlockSize() const { return m_internalBlockSize ? m_internalBlockSize : m_blocksize; }
 	/// memcpy from internal to external blocks
@@ -96,6 +143,17 @@ private:
 	/// Main loop of read thread
 	void Loop();
 
+	/// Read a chunk through the prefetch cache, falling back to `ReadChunk` on a miss
+	/// Also tracks the access pattern and queues readahead when it looks sequential
+	int ReadChunkCached(void* dst, s64 chunkID);
+	/// Call `ReadChunk`, serializing and timing it as needed
+	int ReadChunkTimed(void* dst, s64 chunkID);
+	/// Queue decompression of the `m_prefetchDepth` chunks following `chunkID`
+	/// Call while holding `m_prefetchMtx`
+	void QueuePrefetch(s64 chunkID);
+	/// Wait for all prefetch jobs to finish and drop the prefetch cache
+	void StopPrefetch();
+
 	/// Load the given block into one of the `m_buffer` buffers if necessary and return a pointer to its contents if successful
 	Buffer* GetBlockPtr(const Chunk& block);
 	/// Decompress from offset to size into
@@ -116,4 +174,17 @@ public:
 	void Close(void) final override;
 	void SetBlockSize(uint bytes) final override;
 	void SetDataOffset(int bytes) final override;
+	void SetPrefetchDepth(uint chunks) final override;
+
+	struct PrefetchStats
+	{
+		u64 hits;
+		u64 misses;
+		u64 prefetched;
+		u64 decompressed;
+		/// Total time spent in `ReadChunk`, across all threads
+		double decompressTimeMS;
+	};
+
+	PrefetchStats GetPrefetchStats() const;
 };
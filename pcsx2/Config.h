@@ -524,6 +524,8 @@ struct Pcsx2Config
 			EnableEECache : 1;
 		bool
 			EnableFastmem : 1;
+		bool
+			EnableBlockCache : 1;
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -1191,6 +1193,7 @@ struct Pcsx2Config
 		CdvdVerboseReads : 1, // enables cdvd read activity verbosely dumped to the console
 		CdvdDumpBlocks : 1, // enables cdvd block dumping
 		CdvdShareWrite : 1, // allows the iso to be modified while it's loaded
+		CdvdMapImages : 1, // maps uncompressed isos into memory, a read error on the image then crashes instead of failing the read
 		EnablePatches : 1, // enables patch detection and application
 		EnableCheats : 1, // enables cheat detection and application
 		EnablePINE : 1, // enables inter-process communication
@@ -1208,6 +1211,8 @@ struct Pcsx2Config
 		UseBOOT2Injection : 1,
 		BackupSavestate : 1,
 		SavestateZstdCompression : 1,
+		EnableRewind : 1, // periodically snapshots the VM in memory so it can be stepped back
+		IncrementalSavestates : 1, // save states only store the EE RAM pages changed since a base state
 		// enables simulated ejection of memory cards when loading savestates
 		McdEnableEjection : 1,
 		McdFolderAutoManage : 1,
@@ -1251,6 +1256,11 @@ struct Pcsx2Config
 	// slots (3 each)
 	McdOptions Mcd[8];
 	std::string GzipIsoIndexTemplate; // for quick-access index with gzipped ISO
+	uint CdvdPrefetchDepth; // number of CSO/CHD chunks decompressed ahead of sequential reads, 0 disables
+	int SavestateCompressionLevel; // zstd level for savestate components, see SavestateZstdCompression
+	uint RewindFrequency; // frames between rewind snapshots
+	uint RewindBufferSize; // memory budget for compressed rewind snapshots, in megabytes
+	uint TracingTier; // Tracing::Tier recorded by the trace capture hotkey, 1 = per frame zones, 2 = detailed
 
 	// Set at runtime, not loaded from config.
 	std::string CurrentBlockdump;
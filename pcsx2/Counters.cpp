@@ -19,6 +19,8 @@
 #include <time.h>
 #include <cmath>
 
+#include "common/Tracing.h"
+
 #include "Common.h"
 #include "R3000A.h"
 #include "Counters.h"
@@ -563,6 +565,8 @@ static __fi void frameLimitUpdateCore()
 // certain amount of time passes if such time hasn't passed yet.
 static __fi void frameLimit()
 {
+	Tracing::ScopedZone zone("Frame Limiter", Tracing::Tier::Frame);
+
 	// Framelimiter off in settings? Framelimiter go brrr.
 	if (EmuConfig.GS.LimitScalar == 0.0f || s_use_vsync_for_timing)
 	{
@@ -20,11 +20,12 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 
 #include "common/RedtapeWindows.h"
 #include "common/Path.h"
 
-#include "DEV9/SimpleQueue.h"
+#include "HddSectorCache.h"
 
 class ATA
 {
@@ -38,6 +39,8 @@ private:
 
 	std::FILE* hddImage = nullptr;
 	u64 hddImageSize;
+	//Held over each access of hddImage, and over filling/taking from sectorCache along with it
+	std::mutex hddImageMutex;
 
 	bool hddSparse = false;
 	u64 hddSparseBlockSize;
@@ -116,13 +119,10 @@ private:
 	u32 currentWriteLength;
 	u64 currentWriteSectors;
 
-	struct WriteQueueEntry
-	{
-		u8* data;
-		u32 length;
-		u64 sector;
-	};
-	SimpleQueue<WriteQueueEntry> writeQueue;
+	//Written sectors wait here until the ioThread writes them back
+	//Also caches recently read sectors, 16MB worth
+	HddSectorCache sectorCache{256};
+	std::unique_ptr<u8[]> writeBackBuffer;
 
 	std::thread ioThread;
 	bool ioRunning = false;
@@ -138,6 +138,15 @@ private:
 	void (ATA::*waitingCmd)() = nullptr;
 	//Write Buffer(s)
 
+	//Read ahead
+	//Sequential DMA reads have the following sectors loaded into sectorCache by the ioThread
+	static constexpr u32 readAheadSectors = 256;
+	bool ioReadAhead;
+	u64 readAheadSector;
+	u64 lastReadEnd = 0;
+	std::unique_ptr<u8[]> readAheadBuffer;
+	//Read ahead
+
 	//Read Buffer
 	int rdTransferred = 0;
 	int wrTransferred = 0;
@@ -164,12 +173,32 @@ private:
 
 	u8 sceSec[256 * 2] = {0};
 
+	//Latency
+	//Power of 2 buckets in us, from <1us to >=16ms
+	static constexpr int latencyBuckets = 16;
+	struct LatencyHistogram
+	{
+		u32 buckets[latencyBuckets] = {0};
+		u32 count = 0;
+		u64 totalUs = 0;
+	};
+	//Time from the command register write until data is ready or the command completed
+	LatencyHistogram cmdLatency[256];
+	std::chrono::steady_clock::time_point cmdStart;
+	bool cmdTimed = false;
+	//Updated by the ioThread
+	LatencyHistogram writeBackLatency;
+	LatencyHistogram readAheadLatency;
+	//Latency
+
 public:
 	ATA();
 	~ATA();
 
 	int Open(const std::string& hddPath);
 	void Close();
+	//Writes back all cached writes and flushes the image
+	void Flush();
 
 	void ATA_HardReset();
 
@@ -218,7 +247,9 @@ private:
 	//Transfer
 	void IO_Thread();
 	void IO_Read();
+	void IO_ReadAhead();
 	bool IO_Write();
+	void IO_WriteImage(u64 sector, u32 length, u8* data);
 	bool IO_SparseZero(u64 byteOffset, u64 byteSize);
 	void IO_SparseCacheUpdateLocation(u64 Offset);
 	void IO_SparseCacheLoad();
@@ -231,6 +262,10 @@ private:
 	//Commands
 	void IDE_ExecCmd(u16 value);
 
+	void CmdLatencyEnd();
+	static void RecordLatency(LatencyHistogram* histogram, std::chrono::steady_clock::duration latency);
+	void LogLatency();
+
 	bool PreCmd();
 	void HDD_Unk();
 
@@ -88,9 +88,14 @@ int ATA::Open(const std::string& hddPath)
 
 	InitSparseSupport(hddPath);
 
+	writeBackBuffer = std::make_unique<u8[]>(HddSectorCache::BLOCK_SIZE);
+	readAheadBuffer = std::make_unique<u8[]>(HddSectorCache::BLOCK_SIZE);
+	lastReadEnd = 0;
+
 	{
 		std::lock_guard ioSignallock(ioMutex);
 		ioRead = false;
+		ioReadAhead = false;
 		ioWrite = false;
 	}
 
@@ -249,13 +254,18 @@ void ATA::Close()
 		ioRunning = false;
 	}
 
-	//verify queue
-	if (!writeQueue.IsQueueEmpty())
+	//verify cache
+	if (sectorCache.HasDirty())
 	{
-		Console.Error("DEV9: ATA: Write queue not empty, possible data loss");
+		Console.Error("DEV9: ATA: Write cache not empty, possible data loss");
 		pxAssert(false);
 		abort(); //All data must be written at this point
 	}
+	sectorCache.Clear();
+	writeBackBuffer = nullptr;
+	readAheadBuffer = nullptr;
+
+	LogLatency();
 
 	//Close File Handle
 	if (hddSparse)
@@ -278,6 +288,19 @@ void ATA::Close()
 	readBuffer = nullptr;
 }
 
+void ATA::Flush()
+{
+	if (!ioRunning)
+		return;
+
+	std::unique_lock ioWaitHandle(ioMutex);
+	ioWrite = true;
+	ioReady.notify_all();
+
+	//ioWrite is cleared once the cache is written back and the image flushed
+	ioThreadIdle_cv.wait(ioWaitHandle, [&] { return ioThreadIdle_bool && !(ioRead | ioReadAhead | ioWrite); });
+}
+
 void ATA::ResetBegin()
 {
 	PreCmdExecuteDeviceDiag();
@@ -486,7 +509,7 @@ void ATA::Async(uint cycles)
 			waitingCmd = nullptr;
 			(this->*cmd)();
 		}
-		else if (!writeQueue.IsQueueEmpty()) //Flush cache
+		else if (sectorCache.HasDirty()) //Flush cache
 		{
 			//Log_Info("Starting async write");
 			{
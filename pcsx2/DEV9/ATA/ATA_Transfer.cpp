@@ -39,14 +39,16 @@ void ATA::IO_Thread()
 		ioThreadIdle_bool = true;
 		ioThreadIdle_cv.notify_all();
 
-		ioReady.wait(ioWaitHandle, [&] { return ioRead | ioWrite; });
+		ioReady.wait(ioWaitHandle, [&] { return ioRead | ioReadAhead | ioWrite; });
 		ioThreadIdle_bool = false;
 
 		int ioType = -1;
 		if (ioRead)
 			ioType = 0;
-		else if (ioWrite)
+		else if (ioReadAhead)
 			ioType = 1;
+		else if (ioWrite)
+			ioType = 2;
 
 		ioWaitHandle.unlock();
 
@@ -54,6 +56,8 @@ void ATA::IO_Thread()
 		if (ioType == 0)
 			IO_Read();
 		else if (ioType == 1)
+			IO_ReadAhead();
+		else if (ioType == 2)
 		{
 			if (!IO_Write())
 			{
@@ -81,13 +85,20 @@ void ATA::IO_Read()
 		abort();
 	}
 
-	const u64 pos = lba * 512;
-	if (FileSystem::FSeek64(hddImage, pos, SEEK_SET) != 0 ||
-		std::fread(readBuffer,  512, nsector, hddImage) != static_cast<size_t>(nsector))
+	if (!sectorCache.Read(lba, nsector, readBuffer))
 	{
-		Console.Error("DEV9: ATA: File read error");
-		pxAssert(false);
-		abort();
+		std::lock_guard imageLock(hddImageMutex);
+
+		const u64 pos = lba * 512;
+		if (FileSystem::FSeek64(hddImage, pos, SEEK_SET) != 0 ||
+			std::fread(readBuffer, 512, nsector, hddImage) != static_cast<size_t>(nsector))
+		{
+			Console.Error("DEV9: ATA: File read error");
+			pxAssert(false);
+			abort();
+		}
+		//Also picks up any sectors written since
+		sectorCache.Fill(lba, nsector, readBuffer);
 	}
 	{
 		std::lock_guard ioSignallock(ioMutex);
@@ -95,17 +106,81 @@ void ATA::IO_Read()
 	}
 }
 
+void ATA::IO_ReadAhead()
+{
+	u64 sector;
+	{
+		std::lock_guard ioSignallock(ioMutex);
+		sector = readAheadSector;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	bool didRead = false;
+
+	//Whole cache blocks, so that the next read ahead skips what we already have
+	const u64 imageSectors = hddImageSize / 512;
+	const u64 end = std::min(sector + readAheadSectors, imageSectors);
+	for (u64 block = sector - sector % HddSectorCache::BLOCK_SECTORS; block < end; block += HddSectorCache::BLOCK_SECTORS)
+	{
+		const u32 count = std::min<u64>(HddSectorCache::BLOCK_SECTORS, imageSectors - block);
+
+		//Don't hold up the EE thread for longer than a block
+		std::lock_guard imageLock(hddImageMutex);
+		if (sectorCache.Contains(block, count))
+			continue;
+
+		if (FileSystem::FSeek64(hddImage, block * 512, SEEK_SET) != 0 ||
+			std::fread(readAheadBuffer.get(), 512, count, hddImage) != count)
+		{
+			//Only speculative, the actual read will report the error
+			break;
+		}
+		sectorCache.Fill(block, count, readAheadBuffer.get());
+		didRead = true;
+	}
+
+	if (didRead)
+		RecordLatency(&readAheadLatency, std::chrono::steady_clock::now() - start);
+
+	{
+		std::lock_guard ioSignallock(ioMutex);
+		ioReadAhead = false;
+	}
+}
+
 bool ATA::IO_Write()
 {
-	WriteQueueEntry entry;
-	if (!writeQueue.Dequeue(&entry))
+	std::unique_lock imageLock(hddImageMutex);
+
+	u64 sector;
+	u32 count;
+	if (!sectorCache.TakeDirty(&sector, &count, writeBackBuffer.get()))
 	{
+		//All written back
+		if (std::fflush(hddImage) != 0)
+		{
+			Console.Error("DEV9: ATA: File write error");
+			pxAssert(false);
+			abort();
+		}
+		imageLock.unlock();
+
 		std::lock_guard ioSignallock(ioMutex);
 		ioWrite = false;
 		return false;
 	}
 
-	u64 imagePos = entry.sector * 512;
+	const auto start = std::chrono::steady_clock::now();
+	IO_WriteImage(sector, count * 512, writeBackBuffer.get());
+	imageLock.unlock();
+
+	RecordLatency(&writeBackLatency, std::chrono::steady_clock::now() - start);
+	return true;
+}
+
+void ATA::IO_WriteImage(u64 sector, u32 length, u8* data)
+{
+	u64 imagePos = sector * 512;
 	if (FileSystem::FSeek64(hddImage, imagePos, SEEK_SET) != 0)
 	{
 		Console.Error("DEV9: ATA: File seek error");
@@ -115,27 +190,27 @@ bool ATA::IO_Write()
 	if (hddSparse)
 	{
 		u32 written = 0;
-		while (written != entry.length)
+		while (written != length)
 		{
 			IO_SparseCacheUpdateLocation(imagePos + written);
 			// Align to sparse block size.
 			u32 writeSize = hddSparseBlockSize - ((imagePos + written) % hddSparseBlockSize);
 			// Limit to size of write.
-			writeSize = std::min(writeSize, entry.length - written);
+			writeSize = std::min(writeSize, length - written);
 
 			pxAssert(writeSize > 0);
 			pxAssert(writeSize <= hddSparseBlockSize);
 			pxAssert((imagePos + written) >= HddSparseStart);
 			pxAssert((imagePos + written) - HddSparseStart + writeSize <= hddSparseBlockSize);
 
-			bool sparseWrite = IsAllZero(&entry.data[written], writeSize);
+			bool sparseWrite = IsAllZero(&data[written], writeSize);
 
 			if (sparseWrite)
 			{
 #if defined(PCSX2_DEBUG) || defined(PCSX2_DEVBUILD)
 				std::unique_ptr<u8[]> zeroBlock = std::make_unique<u8[]>(writeSize);
 				memset(zeroBlock.get(), 0, writeSize);
-				pxAssert(memcmp(&entry.data[written], zeroBlock.get(), writeSize) == 0);
+				pxAssert(memcmp(&data[written], zeroBlock.get(), writeSize) == 0);
 #endif
 
 				if (!IO_SparseZero(imagePos + written, writeSize))
@@ -163,15 +238,14 @@ bool ATA::IO_Write()
 				{
 					std::unique_ptr<u8[]> zeroBlock = std::make_unique<u8[]>(writeSize);
 					memset(zeroBlock.get(), 0, writeSize);
-					pxAssert(memcmp(&entry.data[written], zeroBlock.get(), writeSize) != 0);
+					pxAssert(memcmp(&data[written], zeroBlock.get(), writeSize) != 0);
 				}
 #endif
 				// Update cache.
 				if (hddSparseBlockValid)
-					memcpy(&hddSparseBlock[(imagePos + written) - HddSparseStart], &entry.data[written], writeSize);
+					memcpy(&hddSparseBlock[(imagePos + written) - HddSparseStart], &data[written], writeSize);
 
-				if (std::fwrite(&entry.data[written], writeSize, 1, hddImage) != 1 ||
-					std::fflush(hddImage) != 0)
+				if (std::fwrite(&data[written], writeSize, 1, hddImage) != 1)
 				{
 					Console.Error("DEV9: ATA: File write error");
 					pxAssert(false);
@@ -184,15 +258,14 @@ bool ATA::IO_Write()
 	}
 	else
 	{
-		if (std::fwrite(entry.data, entry.length, 1, hddImage) != 1 || std::fflush(hddImage) != 0)
+		//Flushed once the cache has been written back
+		if (std::fwrite(data, length, 1, hddImage) != 1)
 		{
 			Console.Error("DEV9: ATA: File write error");
 			pxAssert(false);
 			abort();
 		}
 	}
-	delete[] entry.data;
-	return true;
 }
 
 void ATA::IO_SparseCacheLoad()
@@ -462,29 +535,11 @@ void ATA::HDD_ReadAsync(void (ATA::*drqCMD)())
 //Do one of the other
 void ATA::HDD_ReadSync(void (ATA::*drqCMD)())
 {
-	//unique_lock instead of lock_guard as also used for cv
-	std::unique_lock ioWaitHandle(ioMutex);
-	//Set ioWrite false to prevent reading & writing at the same time
-	const bool ioWritePaused = ioWrite;
-	ioWrite = false;
-
-	//wait until thread waiting
-	ioThreadIdle_cv.wait(ioWaitHandle, [&] { return ioThreadIdle_bool; });
-	ioWaitHandle.unlock();
-
+	//hddImageMutex keeps us from reading while the ioThread writes back
 	nsectorLeft = 0;
 
 	if (!HDD_CanAssessOrSetError())
-	{
-		if (ioWritePaused)
-		{
-			ioWaitHandle.lock();
-			ioWrite = true;
-			ioWaitHandle.unlock();
-			ioReady.notify_all();
-		}
 		return;
-	}
 
 	nsectorLeft = nsector;
 	if (readBufferLen < nsector * 512)
@@ -496,13 +551,21 @@ void ATA::HDD_ReadSync(void (ATA::*drqCMD)())
 
 	IO_Read();
 
-	if (ioWritePaused)
+	//Have the ioThread fetch what follows a sequential read
+	const u64 lba = HDD_GetLBA();
+	if (lba == lastReadEnd)
 	{
-		ioWaitHandle.lock();
-		ioWrite = true;
-		ioWaitHandle.unlock();
+		{
+			std::lock_guard ioSignallock(ioMutex);
+			if (!ioReadAhead)
+			{
+				readAheadSector = lba + nsector;
+				ioReadAhead = true;
+			}
+		}
 		ioReady.notify_all();
 	}
+	lastReadEnd = lba + nsector;
 
 	(this->*drqCMD)();
 }
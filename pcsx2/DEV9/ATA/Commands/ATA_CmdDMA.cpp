@@ -21,6 +21,7 @@
 void ATA::DRQCmdDMADataToHost()
 {
 	//Ready to Start DMA
+	CmdLatencyEnd();
 	regStatus &= ~ATA_STAT_BUSY;
 	regStatus |= ATA_STAT_DRQ;
 	dmaReady = true;
@@ -53,7 +54,7 @@ void ATA::DRQCmdDMADataFromHost()
 	currentWriteLength = nsector * 512;
 	currentWriteSectors = HDD_GetLBA();
 
-
+	CmdLatencyEnd();
 	regStatus &= ~ATA_STAT_BUSY;
 	regStatus |= ATA_STAT_DRQ;
 	dmaReady = true;
@@ -62,11 +63,8 @@ void ATA::DRQCmdDMADataFromHost()
 }
 void ATA::PostCmdDMADataFromHost()
 {
-	WriteQueueEntry entry{0};
-	entry.data = currentWrite;
-	entry.length = currentWriteLength;
-	entry.sector = currentWriteSectors;
-	writeQueue.Enqueue(entry);
+	sectorCache.Write(currentWriteSectors, currentWriteLength / 512, currentWrite);
+	delete[] currentWrite;
 	currentWrite = nullptr;
 	currentWriteLength = 0;
 	currentWriteSectors = 0;
@@ -28,6 +28,7 @@ void ATA::PreCmdExecuteDeviceDiag()
 
 void ATA::PostCmdExecuteDeviceDiag()
 {
+	CmdLatencyEnd();
 	regStatus &= ~ATA_STAT_BUSY;
 	regStatus |= ATA_STAT_READY;
 
@@ -20,6 +20,7 @@
 
 void ATA::PostCmdNoData()
 {
+	CmdLatencyEnd();
 	regStatus &= ~ATA_STAT_BUSY;
 
 	if (regControlEnableIRQ)
@@ -15,11 +15,16 @@
 
 #include "PrecompiledHeader.h"
 
+#include "common/StringUtil.h"
+
 #include "DEV9/ATA/ATA.h"
 #include "DEV9/DEV9.h"
 
 void ATA::IDE_ExecCmd(u16 value)
 {
+	cmdStart = std::chrono::steady_clock::now();
+	cmdTimed = true;
+
 	switch (value)
 	{
 		case 0x00:
@@ -97,6 +102,59 @@ void ATA::IDE_ExecCmd(u16 value)
 	}
 }
 
+void ATA::CmdLatencyEnd()
+{
+	//Only the first DRQ of a command counts
+	if (!cmdTimed)
+		return;
+	cmdTimed = false;
+	RecordLatency(&cmdLatency[regCommand & 0xFF], std::chrono::steady_clock::now() - cmdStart);
+}
+
+void ATA::RecordLatency(LatencyHistogram* histogram, std::chrono::steady_clock::duration latency)
+{
+	const u64 us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+	int bucket = 0;
+	while (bucket < latencyBuckets - 1 && us >= (1ULL << bucket))
+		bucket++;
+
+	histogram->buckets[bucket]++;
+	histogram->count++;
+	histogram->totalUs += us;
+}
+
+void ATA::LogLatency()
+{
+	auto log = [](const char* name, LatencyHistogram* histogram) {
+		if (histogram->count == 0)
+			return;
+
+		std::string line = StringUtil::StdStringFromFormat("DEV9: ATA: %s latency, %u samples, avg %lluus:",
+			name, histogram->count, static_cast<unsigned long long>(histogram->totalUs / histogram->count));
+		for (int i = 0; i < latencyBuckets; i++)
+		{
+			if (histogram->buckets[i] == 0)
+				continue;
+			if (i == latencyBuckets - 1)
+				line += StringUtil::StdStringFromFormat(" >=%lluus %u", 1ULL << (i - 1), histogram->buckets[i]);
+			else
+				line += StringUtil::StdStringFromFormat(" <%lluus %u", 1ULL << i, histogram->buckets[i]);
+		}
+		Console.WriteLn(line);
+
+		*histogram = {};
+	};
+
+	for (int cmd = 0; cmd < 256; cmd++)
+	{
+		const std::string name = StringUtil::StdStringFromFormat("Cmd %02x", cmd);
+		log(name.c_str(), &cmdLatency[cmd]);
+	}
+	log("Read ahead", &readAheadLatency);
+	log("Write back", &writeBackLatency);
+}
+
 void ATA::HDD_Unk()
 {
 	Console.Error("DEV9: ATA: Unknown cmd %x", regCommand);
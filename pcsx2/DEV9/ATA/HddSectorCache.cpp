@@ -0,0 +1,216 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "HddSectorCache.h"
+
+HddSectorCache::HddSectorCache(u32 maxCleanBlocks)
+	: maxCleanBlocks{maxCleanBlocks}
+{
+}
+
+HddSectorCache::Block* HddSectorCache::GetBlock(u64 index, bool create)
+{
+	auto it = blockMap.find(index);
+	if (it != blockMap.end())
+	{
+		//Mark as most recently used
+		blocks.splice(blocks.begin(), blocks, it->second);
+		return &*it->second;
+	}
+
+	if (!create)
+		return nullptr;
+
+	blocks.push_front({index, {}, {}, std::make_unique<u8[]>(BLOCK_SIZE)});
+	blockMap[index] = blocks.begin();
+	return &blocks.front();
+}
+
+void HddSectorCache::Evict()
+{
+	//Dirty blocks are never evicted, they become clean once written back
+	size_t cleanBlocks = blocks.size() - dirtyBlocks.size();
+	auto it = blocks.end();
+	while (cleanBlocks > maxCleanBlocks && it != blocks.begin())
+	{
+		--it;
+		if (it->dirty.none())
+		{
+			blockMap.erase(it->index);
+			it = blocks.erase(it);
+			cleanBlocks--;
+		}
+	}
+}
+
+bool HddSectorCache::IsCached(u64 sector, u32 count)
+{
+	for (u64 pos = sector; pos < sector + count;)
+	{
+		const u32 offset = pos % BLOCK_SECTORS;
+		const u32 len = std::min<u64>(BLOCK_SECTORS - offset, sector + count - pos);
+		auto it = blockMap.find(pos / BLOCK_SECTORS);
+		if (it == blockMap.end())
+			return false;
+		for (u32 i = offset; i < offset + len; i++)
+		{
+			if (!it->second->valid[i])
+				return false;
+		}
+		pos += len;
+	}
+	return true;
+}
+
+bool HddSectorCache::Read(u64 sector, u32 count, u8* data)
+{
+	std::lock_guard cacheLock(cacheMutex);
+
+	//Check first, so we don't touch the LRU order on a miss
+	if (!IsCached(sector, count))
+		return false;
+
+	for (u64 pos = sector; pos < sector + count;)
+	{
+		const u32 offset = pos % BLOCK_SECTORS;
+		const u32 len = std::min<u64>(BLOCK_SECTORS - offset, sector + count - pos);
+		Block* block = GetBlock(pos / BLOCK_SECTORS, false);
+		memcpy(&data[(pos - sector) * 512], &block->data[offset * 512], len * 512);
+		pos += len;
+	}
+	return true;
+}
+
+bool HddSectorCache::Contains(u64 sector, u32 count)
+{
+	std::lock_guard cacheLock(cacheMutex);
+	return IsCached(sector, count);
+}
+
+void HddSectorCache::Fill(u64 sector, u32 count, u8* data)
+{
+	std::lock_guard cacheLock(cacheMutex);
+
+	for (u64 pos = sector; pos < sector + count;)
+	{
+		const u32 offset = pos % BLOCK_SECTORS;
+		const u32 len = std::min<u64>(BLOCK_SECTORS - offset, sector + count - pos);
+		Block* block = GetBlock(pos / BLOCK_SECTORS, true);
+		u8* src = &data[(pos - sector) * 512];
+
+		if (block->valid.none())
+		{
+			memcpy(&block->data[offset * 512], src, len * 512);
+			for (u32 i = offset; i < offset + len; i++)
+				block->valid[i] = true;
+		}
+		else
+		{
+			for (u32 i = offset; i < offset + len; i++)
+			{
+				u8* cached = &block->data[i * 512];
+				u8* image = &src[(i - offset) * 512];
+				if (block->valid[i])
+					memcpy(image, cached, 512);
+				else
+				{
+					memcpy(cached, image, 512);
+					block->valid[i] = true;
+				}
+			}
+		}
+		pos += len;
+	}
+	Evict();
+}
+
+void HddSectorCache::Write(u64 sector, u32 count, const u8* data)
+{
+	std::lock_guard cacheLock(cacheMutex);
+
+	for (u64 pos = sector; pos < sector + count;)
+	{
+		const u32 offset = pos % BLOCK_SECTORS;
+		const u32 len = std::min<u64>(BLOCK_SECTORS - offset, sector + count - pos);
+		Block* block = GetBlock(pos / BLOCK_SECTORS, true);
+
+		memcpy(&block->data[offset * 512], &data[(pos - sector) * 512], len * 512);
+		for (u32 i = offset; i < offset + len; i++)
+		{
+			block->valid[i] = true;
+			block->dirty[i] = true;
+		}
+		dirtyBlocks.insert(block->index);
+		pos += len;
+	}
+	Evict();
+}
+
+bool HddSectorCache::HasDirty()
+{
+	std::lock_guard cacheLock(cacheMutex);
+	return !dirtyBlocks.empty();
+}
+
+bool HddSectorCache::TakeDirty(u64* sector, u32* count, u8* data)
+{
+	std::lock_guard cacheLock(cacheMutex);
+
+	if (dirtyBlocks.empty())
+		return false;
+
+	//Sweep upwards through the image, then wrap around
+	auto dirtyIt = dirtyBlocks.lower_bound(writeBackPos / BLOCK_SECTORS);
+	if (dirtyIt == dirtyBlocks.end())
+		dirtyIt = dirtyBlocks.begin();
+
+	Block& block = *blockMap[*dirtyIt];
+
+	u32 start = 0;
+	while (!block.dirty[start])
+		start++;
+	u32 end = start;
+	while (end < BLOCK_SECTORS && block.dirty[end])
+	{
+		block.dirty[end] = false;
+		end++;
+	}
+
+	memcpy(data, &block.data[start * 512], (end - start) * 512);
+	*sector = block.index * BLOCK_SECTORS + start;
+	*count = end - start;
+	writeBackPos = *sector + *count;
+
+	if (block.dirty.none())
+	{
+		dirtyBlocks.erase(dirtyIt);
+		Evict();
+	}
+	return true;
+}
+
+void HddSectorCache::Clear()
+{
+	std::lock_guard cacheLock(cacheMutex);
+	blocks.clear();
+	blockMap.clear();
+	dirtyBlocks.clear();
+	writeBackPos = 0;
+}
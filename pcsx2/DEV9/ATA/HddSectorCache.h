@@ -0,0 +1,79 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <bitset>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include "common/Pcsx2Types.h"
+
+/*
+ * Write-back cache of HDD image sectors, in blocks of BLOCK_SECTORS.
+ * Sectors written by the guest are kept dirty until the IO thread takes them with TakeDirty(),
+ * and stay cached (clean) afterwards, so reads never see older data from the image.
+ * The cache does no file IO itself.
+ * Callers must hold a lock over both the image read and Fill(), and over TakeDirty() and the
+ * image write, otherwise a block could be evicted and refilled with stale image data.
+ */
+class HddSectorCache
+{
+public:
+	static constexpr u32 BLOCK_SECTORS = 128;
+	static constexpr u32 BLOCK_SIZE = BLOCK_SECTORS * 512;
+
+	explicit HddSectorCache(u32 maxCleanBlocks);
+
+	// Copies sector..sector+count into data if all of them are cached
+	bool Read(u64 sector, u32 count, u8* data);
+	bool Contains(u64 sector, u32 count);
+	// Caches sectors read from the image. Sectors which are already cached are newer
+	// than the image, these are copied back into data instead
+	void Fill(u64 sector, u32 count, u8* data);
+	void Write(u64 sector, u32 count, const u8* data);
+
+	bool HasDirty();
+	// Takes the next run of dirty sectors, in ascending sector order from the last taken run.
+	// Returns false if there is nothing to write back.
+	bool TakeDirty(u64* sector, u32* count, u8* data);
+
+	void Clear();
+
+private:
+	struct Block
+	{
+		u64 index;
+		std::bitset<BLOCK_SECTORS> valid;
+		std::bitset<BLOCK_SECTORS> dirty;
+		std::unique_ptr<u8[]> data;
+	};
+
+	const u32 maxCleanBlocks;
+
+	std::mutex cacheMutex;
+	// Most recently used at front
+	std::list<Block> blocks;
+	std::unordered_map<u64, std::list<Block>::iterator> blockMap;
+	std::set<u64> dirtyBlocks;
+	u64 writeBackPos = 0;
+
+	bool IsCached(u64 sector, u32 count);
+	Block* GetBlock(u64 index, bool create);
+	void Evict();
+};
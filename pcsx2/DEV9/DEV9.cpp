@@ -1059,6 +1059,14 @@ void DEV9async(u32 cycles)
 	dev9.ata->Async(cycles);
 }
 
+void DEV9FlushHDD()
+{
+	if (!isRunning)
+		return;
+
+	dev9.ata->Flush();
+}
+
 void DEV9CheckChanges(const Pcsx2Config& old_config)
 {
 	if (!isRunning)
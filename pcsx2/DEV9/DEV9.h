@@ -717,6 +717,7 @@ void DEV9write8(u32 addr, u8 value);
 void DEV9write16(u32 addr, u16 value);
 void DEV9write32(u32 addr, u32 value);
 void DEV9CheckChanges(const Pcsx2Config& old_config);
+void DEV9FlushHDD();
 
 #ifdef _WIN32
 #pragma warning(error : 4013)
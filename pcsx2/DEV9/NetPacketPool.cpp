@@ -0,0 +1,150 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "NetPacketPool.h"
+#include "net.h"
+
+namespace
+{
+	//packet must stay the first member, refs are found from the NetPacket*
+	struct PoolEntry
+	{
+		NetPacket packet;
+		std::atomic<int> refs{0};
+		PoolEntry* nextFree = nullptr;
+	};
+
+	//Packets are allocated in slabs, which are kept until exit
+	constexpr size_t SLAB_SIZE = 64;
+
+	std::mutex poolMutex;
+	std::vector<std::unique_ptr<PoolEntry[]>> slabs;
+	PoolEntry* freeList = nullptr;
+	std::atomic<size_t> inUse{0};
+
+	PoolEntry* GetEntry(NetPacket* pkt)
+	{
+		return reinterpret_cast<PoolEntry*>(pkt);
+	}
+
+	PoolEntry* AcquireEntry()
+	{
+		std::lock_guard lock(poolMutex);
+		if (freeList == nullptr)
+		{
+			std::unique_ptr<PoolEntry[]> slab = std::make_unique<PoolEntry[]>(SLAB_SIZE);
+			for (size_t i = 0; i < SLAB_SIZE; i++)
+			{
+				slab[i].nextFree = freeList;
+				freeList = &slab[i];
+			}
+			slabs.push_back(std::move(slab));
+		}
+
+		PoolEntry* entry = freeList;
+		freeList = entry->nextFree;
+		return entry;
+	}
+
+	void ReleaseEntry(PoolEntry* entry)
+	{
+		if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return;
+
+		inUse.fetch_sub(1, std::memory_order_relaxed);
+		std::lock_guard lock(poolMutex);
+		entry->nextFree = freeList;
+		freeList = entry;
+	}
+} // namespace
+
+NetPacketRef NetPacketRef::Allocate()
+{
+	PoolEntry* entry = AcquireEntry();
+	entry->refs.store(1, std::memory_order_relaxed);
+	entry->packet.size = 0;
+	inUse.fetch_add(1, std::memory_order_relaxed);
+
+	NetPacketRef ret;
+	ret.pkt = &entry->packet;
+	return ret;
+}
+
+NetPacketRef::NetPacketRef(const NetPacketRef& other)
+	: pkt{other.pkt}
+{
+	if (pkt != nullptr)
+		GetEntry(pkt)->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+NetPacketRef::NetPacketRef(NetPacketRef&& other) noexcept
+	: pkt{other.pkt}
+{
+	other.pkt = nullptr;
+}
+
+NetPacketRef& NetPacketRef::operator=(const NetPacketRef& other)
+{
+	//other may be this, so hold on to its packet before letting go of ours
+	NetPacket* const otherPkt = other.pkt;
+	if (otherPkt != nullptr)
+		GetEntry(otherPkt)->refs.fetch_add(1, std::memory_order_relaxed);
+	reset();
+	pkt = otherPkt;
+	return *this;
+}
+
+NetPacketRef& NetPacketRef::operator=(NetPacketRef&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		pkt = other.pkt;
+		other.pkt = nullptr;
+	}
+	return *this;
+}
+
+NetPacketRef::~NetPacketRef()
+{
+	reset();
+}
+
+void NetPacketRef::reset()
+{
+	if (pkt != nullptr)
+	{
+		ReleaseEntry(GetEntry(pkt));
+		pkt = nullptr;
+	}
+}
+
+size_t NetPacketPool::GetInUseCount()
+{
+	return inUse.load(std::memory_order_relaxed);
+}
+
+size_t NetPacketPool::GetAllocatedCount()
+{
+	std::lock_guard lock(poolMutex);
+	return slabs.size() * SLAB_SIZE;
+}
@@ -0,0 +1,54 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+struct NetPacket;
+
+//Reference to a NetPacket from a pool, shared between smap, the PacketReader parsers and the sessions.
+//A session can receive straight into the packet which is later handed to smap, with the headers written
+//in front of the payload, instead of copying the data at each step.
+//The packet goes back to the pool when the last reference is dropped, from any thread.
+class NetPacketRef
+{
+	NetPacket* pkt = nullptr;
+
+public:
+	NetPacketRef() = default;
+	NetPacketRef(const NetPacketRef& other);
+	NetPacketRef(NetPacketRef&& other) noexcept;
+	NetPacketRef& operator=(const NetPacketRef& other);
+	NetPacketRef& operator=(NetPacketRef&& other) noexcept;
+	~NetPacketRef();
+
+	//Gets a packet from the pool, with a size of 0
+	static NetPacketRef Allocate();
+
+	NetPacket* get() const { return pkt; }
+	NetPacket* operator->() const { return pkt; }
+	explicit operator bool() const { return pkt != nullptr; }
+
+	void reset();
+};
+
+namespace NetPacketPool
+{
+	//Packets handed out and not yet returned
+	size_t GetInUseCount();
+	//Packets the pool has allocated in total
+	size_t GetAllocatedCount();
+} // namespace NetPacketPool
@@ -26,6 +26,8 @@ namespace PacketReader::IP
 		virtual bool VerifyChecksum(IP_Address srcIP, IP_Address dstIP) { return false; }
 		virtual void CalculateChecksum(IP_Address srcIP, IP_Address dstIP) {}
 		virtual IP_Payload* Clone() const = 0;
+		//Data received into a pooled packet, if any
+		virtual PayloadPooled* GetPooled() { return nullptr; }
 		virtual ~IP_Payload() {}
 	};
 
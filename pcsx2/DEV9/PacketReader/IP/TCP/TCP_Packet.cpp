@@ -238,6 +238,11 @@ namespace PacketReader::IP::TCP
 		return (u8)protocol;
 	}
 
+	PayloadPooled* TCP_Packet::GetPooled()
+	{
+		return payload->GetPooled();
+	}
+
 	void TCP_Packet::ReComputeHeaderLen()
 	{
 		int opOffset = 20;
@@ -89,6 +89,7 @@ namespace PacketReader::IP::TCP
 		virtual TCP_Packet* Clone() const;
 
 		virtual u8 GetProtocol();
+		virtual PayloadPooled* GetPooled();
 
 		virtual bool VerifyChecksum(IP_Address srcIP, IP_Address dstIP);
 		virtual void CalculateChecksum(IP_Address srcIP, IP_Address dstIP);
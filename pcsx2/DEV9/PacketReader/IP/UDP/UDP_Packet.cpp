@@ -84,6 +84,11 @@ namespace PacketReader::IP::UDP
 		return (u8)protocol;
 	}
 
+	PayloadPooled* UDP_Packet::GetPooled()
+	{
+		return payload->GetPooled();
+	}
+
 	void UDP_Packet::CalculateChecksum(IP_Address srcIP, IP_Address dstIP)
 	{
 		int pHeaderLen = (12) + headerLength + payload->GetLength();
@@ -46,6 +46,7 @@ namespace PacketReader::IP::UDP
 		virtual UDP_Packet* Clone() const;
 
 		virtual u8 GetProtocol();
+		virtual PayloadPooled* GetPooled();
 
 		virtual bool VerifyChecksum(IP_Address srcIP, IP_Address dstIP);
 		virtual void CalculateChecksum(IP_Address srcIP, IP_Address dstIP);
@@ -17,14 +17,19 @@
 
 #include <memory>
 
+#include "DEV9/NetPacketPool.h"
+
 namespace PacketReader
 {
+	class PayloadPooled;
+
 	class Payload
 	{
 	public:
 		virtual int GetLength() = 0;
 		virtual void WriteBytes(u8* buffer, int* offset) = 0;
 		virtual Payload* Clone() const = 0;
+		virtual PayloadPooled* GetPooled() { return nullptr; }
 		virtual ~Payload() {}
 	};
 
@@ -110,4 +115,48 @@ namespace PacketReader
 			return ret;
 		}
 	};
+
+	//Bytes inside a pooled packet, kept alive by the class
+	//Clones share the packet instead of copying the data
+	class PayloadPooled : public Payload
+	{
+	public:
+		u8* data;
+
+	private:
+		NetPacketRef packet;
+		int length;
+
+	public:
+		PayloadPooled(NetPacketRef pkt, u8* ptr, int len)
+			: data{ptr}
+			, packet{std::move(pkt)}
+			, length{len}
+		{
+		}
+		PayloadPooled(const PayloadPooled&) = default;
+		virtual int GetLength()
+		{
+			return length;
+		}
+		virtual void WriteBytes(u8* buffer, int* offset)
+		{
+			//Already in place when writing the frame into the packet we were received into
+			if (data != &buffer[*offset])
+				memcpy(&buffer[*offset], data, length);
+			*offset += length;
+		}
+		virtual PayloadPooled* Clone() const
+		{
+			return new PayloadPooled(*this);
+		}
+		virtual PayloadPooled* GetPooled()
+		{
+			return this;
+		}
+		const NetPacketRef& GetPacket() const
+		{
+			return packet;
+		}
+	};
 } // namespace PacketReader
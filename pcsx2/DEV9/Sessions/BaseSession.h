@@ -58,6 +58,10 @@ namespace Sessions
 		virtual bool Send(PacketReader::IP::IP_Payload* payload) = 0;
 		virtual void Reset() = 0;
 
+		//Socket which becomes readable when the session has something to receive, so the
+		//adapter only has to poll it then. -1 if the session has to be polled every time.
+		virtual int GetRecvSocket() { return -1; }
+
 		virtual ~BaseSession() {}
 
 	protected:
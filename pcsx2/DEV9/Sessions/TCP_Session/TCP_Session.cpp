@@ -80,7 +80,7 @@ namespace Sessions
 	{
 	}
 
-	TCP_Packet* TCP_Session::CreateBasePacket(PayloadData* data)
+	TCP_Packet* TCP_Session::CreateBasePacket(Payload* data)
 	{
 		//DevCon.WriteLn("Creating Base Packet");
 		if (data == nullptr)
@@ -91,6 +91,10 @@ namespace Sessions
 		virtual PacketReader::IP::IP_Payload* Recv();
 		virtual bool Send(PacketReader::IP::IP_Payload* payload);
 		virtual void Reset();
+#ifdef __POSIX__
+		//Also becomes writable once the connection to the server completes
+		virtual int GetRecvSocket() { return client; }
+#endif
 
 		virtual ~TCP_Session();
 
@@ -146,7 +150,7 @@ namespace Sessions
 		void CloseByRemoteRST();
 
 		//Returned TCP_Packet Takes ownership of data
-		PacketReader::IP::TCP::TCP_Packet* CreateBasePacket(PacketReader::PayloadData* data = nullptr);
+		PacketReader::IP::TCP::TCP_Packet* CreateBasePacket(PacketReader::Payload* data = nullptr);
 
 		void CloseSocket();
 	};
@@ -27,6 +27,7 @@
 #endif
 
 #include "TCP_Session.h"
+#include "DEV9/net.h"
 
 using namespace PacketReader;
 using namespace PacketReader::IP;
@@ -87,10 +88,15 @@ namespace Sessions
 		else
 			maxSize = std::min<uint>(maxSegmentSize, windowSize.load());
 
+		//Receive straight to where the payload goes in the frame sent to the PS2
+		//Ethernet + IPv4 (without options) + TCP headers, with the timestamp option if used
+		const int payloadOffset = 14 + 20 + 20 + (sendTimeStamps ? 12 : 0);
+		maxSize = std::min<uint>(maxSize, sizeof(NetPacket::buffer) - payloadOffset);
+
 		if (maxSize != 0 &&
 			myNumberACKed.load())
 		{
-			std::unique_ptr<u8[]> buffer;
+			NetPacketRef packet;
 			int err = 0;
 			int recived;
 
@@ -105,8 +111,8 @@ namespace Sessions
 				if (available > maxSize)
 					Console.WriteLn("DEV9: TCP: Got a lot of data: %d Using: %d", available, maxSize);
 
-				buffer = std::make_unique<u8[]>(maxSize);
-				recived = recv(client, (char*)buffer.get(), maxSize, 0);
+				packet = NetPacketRef::Allocate();
+				recived = recv(client, &packet->buffer[payloadOffset], maxSize, 0);
 				if (recived == -1)
 #ifdef _WIN32
 					err = WSAGetLastError();
@@ -170,8 +176,7 @@ namespace Sessions
 				}
 				DevCon.WriteLn("DEV9: TCP: [SRV]Sending %d bytes", recived);
 
-				PayloadData* recivedData = new PayloadData(recived);
-				memcpy(recivedData->data.get(), buffer.get(), recived);
+				PayloadPooled* recivedData = new PayloadPooled(packet, (u8*)&packet->buffer[payloadOffset], recived);
 
 				TCP_Packet* iRet = CreateBasePacket(recivedData);
 				IncrementMyNumber((u32)recived);
@@ -20,7 +20,6 @@
 #ifdef __POSIX__
 #define SOCKET_ERROR -1
 #include <errno.h>
-#include <sys/ioctl.h>
 #include <netinet/in.h>
 #endif
 
@@ -33,6 +32,7 @@
 
 #include "UDP_FixedPort.h"
 #include "DEV9/PacketReader/IP/UDP/UDP_Packet.h"
+#include "DEV9/net.h"
 
 using namespace PacketReader;
 using namespace PacketReader::IP;
@@ -101,107 +101,38 @@ namespace Sessions
 		if (!open.load())
 			return nullptr;
 
-		int ret;
-		fd_set sReady;
-		fd_set sExcept;
-
-		timeval nowait{0};
-		FD_ZERO(&sReady);
-		FD_ZERO(&sExcept);
-		FD_SET(client, &sReady);
-		FD_SET(client, &sExcept);
-		ret = select(client + 1, &sReady, nullptr, &sExcept, &nowait);
-
-		bool hasData;
-		if (ret == SOCKET_ERROR)
-		{
-			hasData = false;
-			Console.WriteLn("DEV9: UDP: select failed. Error Code: %d",
-#ifdef _WIN32
-				WSAGetLastError());
-#elif defined(__POSIX__)
-				errno);
-#endif
-		}
-		else if (FD_ISSET(client, &sExcept))
+		UDP_RecvQueue::Datagram datagram;
+		switch (recvQueue.Recv(client, &datagram))
 		{
-			hasData = false;
-
-			int error = 0;
-#ifdef _WIN32
-			int len = sizeof(error);
-			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
-				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", WSAGetLastError());
-#elif defined(__POSIX__)
-			socklen_t len = sizeof(error);
-			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
-				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", errno);
-#endif
-			else
-				Console.Error("DEV9: UDP: Recv Error: %d", error);
-		}
-		else
-			hasData = FD_ISSET(client, &sReady);
-
-		if (hasData)
-		{
-			u_long available = 0;
-			PayloadData* recived = nullptr;
-			std::unique_ptr<u8[]> buffer;
-			sockaddr endpoint{0};
-
-			//FIONREAD returns total size of all available messages
-			//but we will read one message at a time
-#ifdef _WIN32
-			ret = ioctlsocket(client, FIONREAD, &available);
-#elif defined(__POSIX__)
-			ret = ioctl(client, FIONREAD, &available);
-#endif
-			if (ret != SOCKET_ERROR)
-			{
-				buffer = std::make_unique<u8[]>(available);
-
-#ifdef _WIN32
-				int fromlen = sizeof(endpoint);
-#elif defined(__POSIX__)
-				socklen_t fromlen = sizeof(endpoint);
-#endif
-				ret = recvfrom(client, (char*)buffer.get(), available, 0, &endpoint, &fromlen);
-			}
-
-			if (ret == SOCKET_ERROR)
+			case UDP_RecvQueue::Result::Received:
 			{
-				Console.Error("UDP Recv Error: %d",
-#ifdef _WIN32
-					WSAGetLastError());
-#elif defined(__POSIX__)
-					errno);
-#endif
-				RaiseEventConnectionClosed();
-				return nullptr;
-			}
-
-			recived = new PayloadData(ret);
-			memcpy(recived->data.get(), buffer.get(), ret);
+				u8* data = (u8*)&datagram.packet->buffer[UDP_RecvQueue::PAYLOAD_OFFSET];
+				PayloadPooled* recived = new PayloadPooled(std::move(datagram.packet), data, datagram.length);
 
-			UDP_Packet* iRet = new UDP_Packet(recived);
-			iRet->destinationPort = port;
+				UDP_Packet* iRet = new UDP_Packet(recived);
+				iRet->destinationPort = port;
 
-			sockaddr_in* sockaddr = (sockaddr_in*)&endpoint;
-			destIP = *(IP_Address*)&sockaddr->sin_addr;
-			iRet->sourcePort = ntohs(sockaddr->sin_port);
-			{
-				std::lock_guard numberlock(connectionSentry);
-
-				for (size_t i = 0; i < connections.size(); i++)
+				destIP = *(IP_Address*)&datagram.endpoint.sin_addr;
+				iRet->sourcePort = ntohs(datagram.endpoint.sin_port);
 				{
-					UDP_BaseSession* s = connections[i];
-					if (s->WillRecive(destIP))
-						return iRet;
+					std::lock_guard numberlock(connectionSentry);
+
+					for (size_t i = 0; i < connections.size(); i++)
+					{
+						UDP_BaseSession* s = connections[i];
+						if (s->WillRecive(destIP))
+							return iRet;
+					}
 				}
+				Console.Error("DEV9: UDP: Unexpected packet, dropping");
+				delete iRet;
+				return nullptr;
 			}
-			Console.Error("DEV9: UDP: Unexpected packet, dropping");
-			delete iRet;
+			case UDP_RecvQueue::Result::Error:
+				RaiseEventConnectionClosed();
+				return nullptr;
+			case UDP_RecvQueue::Result::Empty:
+				break;
 		}
 		return nullptr;
 	}
@@ -25,6 +25,7 @@
 
 #include "DEV9/Sessions/BaseSession.h"
 #include "UDP_BaseSession.h"
+#include "UDP_RecvQueue.h"
 #include "UDP_Session.h"
 
 namespace Sessions
@@ -39,6 +40,7 @@ namespace Sessions
 #elif defined(__POSIX__)
 		int client = INVALID_SOCKET;
 #endif
+		UDP_RecvQueue recvQueue;
 
 	public:
 		const u16 port = 0;
@@ -53,6 +55,9 @@ namespace Sessions
 		virtual PacketReader::IP::IP_Payload* Recv();
 		virtual bool Send(PacketReader::IP::IP_Payload* payload);
 		virtual void Reset();
+#ifdef __POSIX__
+		virtual int GetRecvSocket() { return client; }
+#endif
 
 		UDP_Session* NewClientSession(ConnectionKey parNewKey, bool parIsBrodcast, bool parIsMulticast);
 
@@ -0,0 +1,190 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#ifdef __POSIX__
+#define SOCKET_ERROR -1
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#endif
+
+#ifdef _WIN32
+#include "common/RedtapeWindows.h"
+#include <winsock2.h>
+#endif
+
+#include "UDP_RecvQueue.h"
+#include "DEV9/net.h"
+
+namespace Sessions
+{
+	static constexpr int CAPACITY = sizeof(NetPacket::buffer) - UDP_RecvQueue::PAYLOAD_OFFSET;
+
+#ifdef _WIN32
+	UDP_RecvQueue::Result UDP_RecvQueue::Recv(SOCKET client, Datagram* datagram)
+#elif defined(__POSIX__)
+	UDP_RecvQueue::Result UDP_RecvQueue::Recv(int client, Datagram* datagram)
+#endif
+	{
+		if (pending.empty())
+		{
+			const Result ret = RecvBatch(client);
+			if (ret != Result::Received)
+				return ret;
+		}
+
+		*datagram = std::move(pending.front());
+		pending.pop_front();
+		return Result::Received;
+	}
+
+	void UDP_RecvQueue::Clear()
+	{
+		pending.clear();
+	}
+
+#ifdef __linux__
+	UDP_RecvQueue::Result UDP_RecvQueue::RecvBatch(int client)
+	{
+		mmsghdr msgs[BATCH_SIZE]{};
+		iovec iovs[BATCH_SIZE];
+		sockaddr_in endpoints[BATCH_SIZE];
+
+		for (int i = 0; i < BATCH_SIZE; i++)
+		{
+			if (!spare[i])
+				spare[i] = NetPacketRef::Allocate();
+
+			iovs[i].iov_base = &spare[i]->buffer[PAYLOAD_OFFSET];
+			iovs[i].iov_len = CAPACITY;
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_name = &endpoints[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(endpoints[i]);
+		}
+
+		const int count = recvmmsg(client, msgs, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+		if (count == SOCKET_ERROR)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				return Result::Empty;
+
+			Console.Error("DEV9: UDP: Recv Error: %d", errno);
+			return Result::Error;
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+			{
+				Console.Error("DEV9: UDP: Dropping datagram larger than %d bytes", CAPACITY);
+				continue;
+			}
+			pending.push_back({std::move(spare[i]), static_cast<int>(msgs[i].msg_len), endpoints[i]});
+		}
+
+		return pending.empty() ? Result::Empty : Result::Received;
+	}
+#else
+#ifdef _WIN32
+	UDP_RecvQueue::Result UDP_RecvQueue::RecvBatch(SOCKET client)
+#elif defined(__POSIX__)
+	UDP_RecvQueue::Result UDP_RecvQueue::RecvBatch(int client)
+#endif
+	{
+		int ret;
+		fd_set sReady;
+		fd_set sExcept;
+
+		timeval nowait{0};
+		FD_ZERO(&sReady);
+		FD_ZERO(&sExcept);
+		FD_SET(client, &sReady);
+		FD_SET(client, &sExcept);
+		ret = select(client + 1, &sReady, nullptr, &sExcept, &nowait);
+
+		if (ret == SOCKET_ERROR)
+		{
+			Console.Error("DEV9: UDP: Select Failed. Error Code: %d",
+#ifdef _WIN32
+				WSAGetLastError());
+#elif defined(__POSIX__)
+				errno);
+#endif
+			return Result::Empty;
+		}
+		else if (FD_ISSET(client, &sExcept))
+		{
+			int error = 0;
+#ifdef _WIN32
+			int len = sizeof(error);
+			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
+				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", WSAGetLastError());
+#elif defined(__POSIX__)
+			socklen_t len = sizeof(error);
+			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
+				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", errno);
+#endif
+			else
+				Console.Error("DEV9: UDP: Recv Error: %d", error);
+			return Result::Empty;
+		}
+		else if (!FD_ISSET(client, &sReady))
+			return Result::Empty;
+
+		if (!spare[0])
+			spare[0] = NetPacketRef::Allocate();
+
+		sockaddr_in endpoint{0};
+		bool truncated;
+#ifdef _WIN32
+		int fromlen = sizeof(endpoint);
+		ret = recvfrom(client, &spare[0]->buffer[PAYLOAD_OFFSET], CAPACITY, 0, (sockaddr*)&endpoint, &fromlen);
+		truncated = ret == SOCKET_ERROR && WSAGetLastError() == WSAEMSGSIZE;
+#elif defined(__POSIX__)
+		iovec iov{&spare[0]->buffer[PAYLOAD_OFFSET], CAPACITY};
+		msghdr msg{};
+		msg.msg_name = &endpoint;
+		msg.msg_namelen = sizeof(endpoint);
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		ret = recvmsg(client, &msg, 0);
+		truncated = ret != SOCKET_ERROR && (msg.msg_flags & MSG_TRUNC);
+#endif
+
+		if (truncated)
+		{
+			Console.Error("DEV9: UDP: Dropping datagram larger than %d bytes", CAPACITY);
+			return Result::Empty;
+		}
+
+		if (ret == SOCKET_ERROR)
+		{
+			Console.Error("DEV9: UDP: Recv Error: %d",
+#ifdef _WIN32
+				WSAGetLastError());
+#elif defined(__POSIX__)
+				errno);
+#endif
+			return Result::Error;
+		}
+
+		pending.push_back({std::move(spare[0]), ret, endpoint});
+		return Result::Received;
+	}
+#endif
+} // namespace Sessions
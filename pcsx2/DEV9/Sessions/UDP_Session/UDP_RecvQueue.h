@@ -0,0 +1,74 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <deque>
+#ifdef _WIN32
+#include <winsock2.h>
+#elif defined(__POSIX__)
+#include <netinet/in.h>
+#endif
+
+#include "DEV9/NetPacketPool.h"
+
+namespace Sessions
+{
+	//Receives datagrams straight into pooled packets, at the offset the UDP payload
+	//ends up at in the frame sent to the PS2, so the frame can be built in place.
+	//On Linux, recvmmsg reads several datagrams per call, the ones not yet
+	//returned are kept for the next calls.
+	class UDP_RecvQueue
+	{
+	public:
+		//Ethernet + IPv4 (without options) + UDP headers
+		static constexpr int PAYLOAD_OFFSET = 14 + 20 + 8;
+		static constexpr int BATCH_SIZE = 8;
+
+		struct Datagram
+		{
+			NetPacketRef packet;
+			int length;
+			sockaddr_in endpoint;
+		};
+
+		enum class Result
+		{
+			Received,
+			Empty,
+			Error,
+		};
+
+	private:
+		std::deque<Datagram> pending;
+		//Packets handed to the last batch which didn't receive anything
+		NetPacketRef spare[BATCH_SIZE];
+
+	public:
+		//Errors are logged, on Error the socket should be closed
+#ifdef _WIN32
+		Result Recv(SOCKET client, Datagram* datagram);
+#elif defined(__POSIX__)
+		Result Recv(int client, Datagram* datagram);
+#endif
+		void Clear();
+
+	private:
+#ifdef _WIN32
+		Result RecvBatch(SOCKET client);
+#elif defined(__POSIX__)
+		Result RecvBatch(int client);
+#endif
+	};
+} // namespace Sessions
@@ -20,7 +20,6 @@
 #ifdef __POSIX__
 #define SOCKET_ERROR -1
 #include <errno.h>
-#include <sys/ioctl.h>
 #include <netinet/in.h>
 #endif
 
@@ -33,6 +32,7 @@
 
 #include "UDP_Session.h"
 #include "DEV9/PacketReader/IP/UDP/UDP_Packet.h"
+#include "DEV9/net.h"
 
 using namespace PacketReader;
 using namespace PacketReader::IP;
@@ -88,96 +88,27 @@ namespace Sessions
 			return nullptr;
 		}
 
-		int ret;
-		fd_set sReady;
-		fd_set sExcept;
-
-		timeval nowait{0};
-		FD_ZERO(&sReady);
-		FD_ZERO(&sExcept);
-		FD_SET(client, &sReady);
-		FD_SET(client, &sExcept);
-		ret = select(client + 1, &sReady, nullptr, &sExcept, &nowait);
-
-		bool hasData;
-		if (ret == SOCKET_ERROR)
-		{
-			hasData = false;
-			Console.Error("DEV9: UDP: Select Failed. Error Code: %d",
-#ifdef _WIN32
-				WSAGetLastError());
-#elif defined(__POSIX__)
-				errno);
-#endif
-		}
-		else if (FD_ISSET(client, &sExcept))
+		UDP_RecvQueue::Datagram datagram;
+		switch (recvQueue.Recv(client, &datagram))
 		{
-			hasData = false;
-
-			int error = 0;
-#ifdef _WIN32
-			int len = sizeof(error);
-			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
-				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", WSAGetLastError());
-#elif defined(__POSIX__)
-			socklen_t len = sizeof(error);
-			if (getsockopt(client, SOL_SOCKET, SO_ERROR, (char*)&error, &len) < 0)
-				Console.Error("DEV9: UDP: Unkown UDP Connection Error (getsockopt Error: %d)", errno);
-#endif
-			else
-				Console.Error("DEV9: UDP: Recv Error: %d", error);
-		}
-		else
-			hasData = FD_ISSET(client, &sReady);
+			case UDP_RecvQueue::Result::Received:
+			{
+				u8* data = (u8*)&datagram.packet->buffer[UDP_RecvQueue::PAYLOAD_OFFSET];
+				PayloadPooled* recived = new PayloadPooled(std::move(datagram.packet), data, datagram.length);
 
-		if (hasData)
-		{
-			u_long available = 0;
-			PayloadData* recived = nullptr;
-			std::unique_ptr<u8[]> buffer;
-			sockaddr endpoint{0};
+				UDP_Packet* iRet = new UDP_Packet(recived);
+				iRet->destinationPort = srcPort;
+				iRet->sourcePort = destPort;
 
-			//FIONREAD returns total size of all available messages
-			//but we will read one message at a time
-#ifdef _WIN32
-			ret = ioctlsocket(client, FIONREAD, &available);
-#elif defined(__POSIX__)
-			ret = ioctl(client, FIONREAD, &available);
-#endif
-			if (ret != SOCKET_ERROR)
-			{
-				buffer = std::make_unique<u8[]>(available);
+				deathClockStart.store(std::chrono::steady_clock::now());
 
-#ifdef _WIN32
-				int fromlen = sizeof(endpoint);
-#elif defined(__POSIX__)
-				socklen_t fromlen = sizeof(endpoint);
-#endif
-				ret = recvfrom(client, (char*)buffer.get(), available, 0, &endpoint, &fromlen);
+				return iRet;
 			}
-
-			if (ret == SOCKET_ERROR)
-			{
-				Console.Error("DEV9: UDP: Recv Error: %d",
-#ifdef _WIN32
-					WSAGetLastError());
-#elif defined(__POSIX__)
-					errno);
-#endif
+			case UDP_RecvQueue::Result::Error:
 				RaiseEventConnectionClosed();
 				return nullptr;
-			}
-
-			recived = new PayloadData(ret);
-			memcpy(recived->data.get(), buffer.get(), ret);
-
-			UDP_Packet* iRet = new UDP_Packet(recived);
-			iRet->destinationPort = srcPort;
-			iRet->sourcePort = destPort;
-
-			deathClockStart.store(std::chrono::steady_clock::now());
-
-			return iRet;
+			case UDP_RecvQueue::Result::Empty:
+				break;
 		}
 
 		if (std::chrono::steady_clock::now() - deathClockStart.load() > MAX_IDLE)
@@ -24,6 +24,7 @@
 #endif
 
 #include "UDP_BaseSession.h"
+#include "UDP_RecvQueue.h"
 
 namespace Sessions
 {
@@ -37,6 +38,7 @@ namespace Sessions
 #elif defined(__POSIX__)
 		int client = INVALID_SOCKET;
 #endif
+		UDP_RecvQueue recvQueue;
 
 		u16 srcPort = 0;
 		u16 destPort = 0;
@@ -63,6 +65,10 @@ namespace Sessions
 		virtual bool WillRecive(PacketReader::IP::IP_Address parDestIP);
 		virtual bool Send(PacketReader::IP::IP_Payload* payload);
 		virtual void Reset();
+#ifdef __POSIX__
+		//Sessions of a fixed port share its socket, which the fixed port receives on
+		virtual int GetRecvSocket() { return isFixedPort ? -1 : client; }
+#endif
 
 		virtual ~UDP_Session();
 
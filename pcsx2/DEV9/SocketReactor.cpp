@@ -0,0 +1,107 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "common/Console.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "SocketReactor.h"
+
+#ifdef __linux__
+
+SocketReactor::SocketReactor()
+{
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0)
+		Console.Error("DEV9: Socket: epoll_create1 failed. Error Code: %d, polling all connections", errno);
+}
+
+SocketReactor::~SocketReactor()
+{
+	if (epollFd >= 0)
+		::close(epollFd);
+}
+
+bool SocketReactor::IsAvailable() const
+{
+	return epollFd >= 0;
+}
+
+bool SocketReactor::Add(int fd)
+{
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	event.data.fd = fd;
+
+	//A watched socket which got closed is gone from the epoll set, even though we still know its descriptor
+	if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == 0)
+		return true;
+	if (errno == ENOENT && epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0)
+		return true;
+
+	Console.Error("DEV9: Socket: Failed to watch socket. Error Code: %d", errno);
+	return false;
+}
+
+void SocketReactor::Remove(int fd)
+{
+	//Fails if the socket was already closed, which is fine
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void SocketReactor::Poll(std::vector<int>* ready)
+{
+	epoll_event events[64];
+	int count;
+	do
+	{
+		count = epoll_wait(epollFd, events, std::size(events), 0);
+		for (int i = 0; i < count; i++)
+			ready->push_back(events[i].data.fd);
+	} while (count == static_cast<int>(std::size(events)));
+
+	if (count < 0 && errno != EINTR)
+		Console.Error("DEV9: Socket: epoll_wait failed. Error Code: %d", errno);
+}
+
+#else
+
+SocketReactor::SocketReactor() = default;
+SocketReactor::~SocketReactor() = default;
+
+bool SocketReactor::IsAvailable() const
+{
+	return false;
+}
+
+bool SocketReactor::Add(int fd)
+{
+	return false;
+}
+
+void SocketReactor::Remove(int fd)
+{
+}
+
+void SocketReactor::Poll(std::vector<int>* ready)
+{
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+//Waits on the sockets of the socket adapter's sessions, so only the ones with something
+//to receive have to be polled. Uses epoll where available, elsewhere IsAvailable() is
+//false and every session has to be polled on every receive.
+class SocketReactor
+{
+#ifdef __linux__
+	int epollFd = -1;
+#endif
+
+public:
+	SocketReactor();
+	~SocketReactor();
+
+	SocketReactor(const SocketReactor&) = delete;
+	SocketReactor& operator=(const SocketReactor&) = delete;
+
+	bool IsAvailable() const;
+
+	//Starts watching a socket, or watches it again if it was closed and the descriptor got reused
+	bool Add(int fd);
+	//Closed sockets are dropped automatically, this is only needed for ones which stay open
+	void Remove(int fd);
+
+	//Appends the sockets which became readable, writable or failed since the last call, without blocking.
+	//Sockets are edge triggered, whoever reads them has to keep going until there is nothing left.
+	void Poll(std::vector<int>* ready);
+};
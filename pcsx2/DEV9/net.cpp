@@ -43,15 +43,15 @@ volatile bool RxRunning = false;
 //rx thread
 void NetRxThread()
 {
-	NetPacket tmp;
+	NetPacketRef tmp;
 	while (RxRunning)
 	{
-		while (rx_fifo_can_rx() && nif->recv(&tmp))
+		while (rx_fifo_can_rx() && nif->recvPooled(&tmp))
 		{
 			std::lock_guard rx_lock(rx_mutex);
 			//Check if we can still rx
 			if (rx_fifo_can_rx())
-				rx_process(&tmp);
+				rx_process(tmp.get());
 			else
 				Console.Error("DEV9: rx_fifo_can_rx() false after nif->recv(), dropping");
 		}
@@ -194,6 +194,13 @@ bool NetAdapter::recv(NetPacket* pkt)
 	return false;
 }
 
+bool NetAdapter::recvPooled(NetPacketRef* pkt)
+{
+	if (!*pkt)
+		*pkt = NetPacketRef::Allocate();
+	return recv(pkt->get());
+}
+
 bool NetAdapter::send(NetPacket* pkt)
 {
 	return InternalServerSend(pkt);
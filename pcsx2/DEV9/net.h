@@ -33,6 +33,8 @@
 
 #include "Config.h"
 
+#include "NetPacketPool.h"
+
 #include "PacketReader/IP/IP_Address.h"
 #include "InternalServers/DHCP_Server.h"
 #include "InternalServers/DNS_Logger.h"
@@ -118,6 +120,8 @@ public:
 	virtual bool blocks() = 0;
 	virtual bool isInitialised() = 0;
 	virtual bool recv(NetPacket* pkt); //gets a packet
+	//gets a packet, the adapter may replace pkt with a pooled packet it already built the frame in
+	virtual bool recvPooled(NetPacketRef* pkt);
 	virtual bool send(NetPacket* pkt); //sends the packet and deletes it when done
 	virtual void reset(){};
 	virtual void reloadSettings() = 0;
@@ -98,12 +98,17 @@ void rx_process(NetPacket* pk)
 	}
 
 	int pstart = (dev9.rxfifo_wr_ptr) & 16383;
-	int i = 0;
-	while (i < bytes)
+	if (pstart + bytes > 16384)
 	{
-		dev9_rxfifo_write(pk->buffer[i++]);
-		dev9.rxfifo_wr_ptr &= 16383;
+		const int was = 16384 - pstart;
+		memcpy(dev9.rxfifo + pstart, pk->buffer, was);
+		memcpy(dev9.rxfifo, pk->buffer + was, bytes - was);
 	}
+	else
+	{
+		memcpy(dev9.rxfifo + pstart, pk->buffer, bytes);
+	}
+	dev9.rxfifo_wr_ptr = (pstart + bytes) & 16383;
 
 	//increase RXBD
 	std::unique_lock<std::mutex> reset_lock(reset_mutex);
@@ -43,6 +43,7 @@
 #include "Sessions/UDP_Session/UDP_Session.h"
 
 #include "PacketReader/EthernetFrame.h"
+#include "PacketReader/NetLib.h"
 #include "PacketReader/ARP/ARP_Packet.h"
 #include "PacketReader/IP/ICMP/ICMP_Packet.h"
 #include "PacketReader/IP/TCP/TCP_Packet.h"
@@ -302,11 +303,33 @@ bool SocketAdapter::isInitialised()
 
 bool SocketAdapter::recv(NetPacket* pkt)
 {
-	if (NetAdapter::recv(pkt))
+	NetPacketRef ref;
+	if (!recvPooled(&ref))
+		return false;
+
+	*pkt = *ref.get();
+	return true;
+}
+
+bool SocketAdapter::recvPooled(NetPacketRef* pkt)
+{
+	if (!*pkt)
+		*pkt = NetPacketRef::Allocate();
+
+	if (NetAdapter::recv(pkt->get()))
 		return true;
 
 	EthernetFrame* bFrame;
-	if (!vRecBuffer.Dequeue(&bFrame))
+	if (vRecBuffer.Dequeue(&bFrame))
+	{
+		bFrame->WritePacket(pkt->get());
+		InspectRecv(pkt->get());
+
+		delete bFrame;
+		return true;
+	}
+
+	if (!reactor.IsAvailable())
 	{
 		std::vector<ConnectionKey> keys = connections.GetKeys();
 		for (size_t i = 0; i < keys.size(); i++)
@@ -317,34 +340,140 @@ bool SocketAdapter::recv(NetPacket* pkt)
 			if (!connections.TryGetValue(key, &session))
 				continue;
 
-			IP_Payload* pl = session->Recv();
+			if (RecvFromSession(session, pkt))
+				return true;
+		}
+		return false;
+	}
 
-			if (pl != nullptr)
-			{
-				IP_Packet* ipPkt = new IP_Packet(pl);
-				ipPkt->destinationIP = session->sourceIP;
-				ipPkt->sourceIP = session->destIP;
+	UpdateReadySessions();
+
+	//Round robin over the sessions which may have data, a session stays
+	//ready until it has nothing left, as the reactor won't report it again
+	while (!readySessions.empty())
+	{
+		const ConnectionKey key = readySessions.front();
+		readySessions.pop_front();
 
-				EthernetFrame frame(ipPkt);
-				memcpy(frame.sourceMAC, internalMAC, 6);
-				memcpy(frame.destinationMAC, ps2MAC, 6);
-				frame.protocol = (u16)EtherType::IPv4;
+		BaseSession* session;
+		if (!connections.TryGetValue(key, &session))
+		{
+			readySet.erase(key);
+			alwaysPolled.erase(key);
+			continue;
+		}
 
-				frame.WritePacket(pkt);
-				InspectRecv(pkt);
-				return true;
+		if (RecvFromSession(session, pkt))
+		{
+			readySessions.push_back(key);
+			return true;
+		}
+		readySet.erase(key);
+	}
+	return false;
+}
+
+bool SocketAdapter::RecvFromSession(BaseSession* session, NetPacketRef* pkt)
+{
+	IP_Payload* pl = session->Recv();
+
+	if (pl == nullptr)
+		return false;
+
+	IP_Packet* ipPkt = new IP_Packet(pl);
+	ipPkt->destinationIP = session->sourceIP;
+	ipPkt->sourceIP = session->destIP;
+
+	EthernetFrame frame(ipPkt);
+	memcpy(frame.sourceMAC, internalMAC, 6);
+	memcpy(frame.destinationMAC, ps2MAC, 6);
+	frame.protocol = (u16)EtherType::IPv4;
+
+	//If the session received the data into a pooled packet, right where it ends up
+	//in the frame, write the headers in front of it instead of copying the data
+	PayloadPooled* pooled = pl->GetPooled();
+	if (pooled != nullptr)
+	{
+		const int frameLength = 14 + ipPkt->GetLength();
+		NetPacket* target = pooled->GetPacket().get();
+		if (pooled->data + pooled->GetLength() == (u8*)&target->buffer[frameLength])
+			*pkt = pooled->GetPacket();
+	}
+
+	frame.WritePacket(pkt->get());
+	InspectRecv(pkt->get());
+	return true;
+}
+
+//Called from the EE thread
+void SocketAdapter::WakeSession(ConnectionKey key)
+{
+	if (reactor.IsAvailable())
+		wakeQueue.Enqueue(key);
+}
+
+void SocketAdapter::UpdateReadySessions()
+{
+	const auto markReady = [this](const ConnectionKey& key) {
+		if (readySet.insert(key).second)
+			readySessions.push_back(key);
+	};
+
+	//Sessions which were created or sent to, may have replies queued or a new socket to watch
+	ConnectionKey key;
+	while (wakeQueue.Dequeue(&key))
+	{
+		BaseSession* session;
+		if (!connections.TryGetValue(key, &session))
+			continue;
+
+		const int fd = session->GetRecvSocket();
+		if (fd == -1)
+			alwaysPolled.insert(key);
+		else
+		{
+			auto search = socketSessions.find(fd);
+			if (search == socketSessions.end() || search->second != key)
+			{
+				//Descriptor is either new, or was reused after the previous session closed
+				if (reactor.Add(fd))
+					socketSessions[fd] = key;
+				else
+					alwaysPolled.insert(key);
 			}
 		}
+		markReady(key);
 	}
-	else
+
+	readySockets.clear();
+	reactor.Poll(&readySockets);
+	for (const int fd : readySockets)
 	{
-		bFrame->WritePacket(pkt);
-		InspectRecv(pkt);
+		auto search = socketSessions.find(fd);
+		if (search != socketSessions.end())
+			markReady(search->second);
+	}
 
-		delete bFrame;
-		return true;
+	for (const ConnectionKey& polledKey : alwaysPolled)
+		markReady(polledKey);
+
+	//Sessions also time out and change state in Recv(), so poll everything once in a while
+	const auto now = std::chrono::steady_clock::now();
+	if (now - lastSweep > std::chrono::milliseconds(100))
+	{
+		lastSweep = now;
+		for (const ConnectionKey& sweepKey : connections.GetKeys())
+			markReady(sweepKey);
+
+		//Forget sockets of closed sessions
+		for (auto iter = socketSessions.begin(); iter != socketSessions.end();)
+		{
+			if (!connections.ContainsKey(iter->second))
+				iter = socketSessions.erase(iter);
+			else
+				++iter;
+		}
 	}
-	return false;
 }
 
 bool SocketAdapter::send(NetPacket* pkt)
@@ -510,7 +639,9 @@ bool SocketAdapter::SendICMP(ConnectionKey Key, IP_Packet* ipPkt)
 	if (existingSession != nullptr)
 	{
 		s = static_cast<ICMP_Session*>(existingSession);
-		return s->Send(ipPkt->GetPayload(), ipPkt);
+		const bool ret = s->Send(ipPkt->GetPayload(), ipPkt);
+		WakeSession(Key);
+		return ret;
 	}
 
 	DevCon.WriteLn("DEV9: Socket: Creating New ICMP Connection");
@@ -520,7 +651,9 @@ bool SocketAdapter::SendICMP(ConnectionKey Key, IP_Packet* ipPkt)
 	s->destIP = ipPkt->destinationIP;
 	s->sourceIP = dhcpServer.ps2IP;
 	connections.Add(Key, s);
-	return s->Send(ipPkt->GetPayload(), ipPkt);
+	const bool ret = s->Send(ipPkt->GetPayload(), ipPkt);
+	WakeSession(Key);
+	return ret;
 }
 
 bool SocketAdapter::SendIGMP(ConnectionKey Key, IP_Packet* ipPkt)
@@ -531,11 +664,11 @@ bool SocketAdapter::SendIGMP(ConnectionKey Key, IP_Packet* ipPkt)
 
 bool SocketAdapter::SendTCP(ConnectionKey Key, IP_Packet* ipPkt)
 {
+	//Only the ports are needed here, the session parses the rest
 	IP_PayloadPtr* ipPayload = static_cast<IP_PayloadPtr*>(ipPkt->GetPayload());
-	TCP_Packet tcp(ipPayload->data, ipPayload->GetLength());
-
-	Key.ps2Port = tcp.sourcePort;
-	Key.srvPort = tcp.destinationPort;
+	int offset = 0;
+	NetLib::ReadUInt16(ipPayload->data, &offset, &Key.ps2Port);
+	NetLib::ReadUInt16(ipPayload->data, &offset, &Key.srvPort);
 
 	int res = SendFromConnection(Key, ipPkt);
 	if (res == 1)
@@ -544,24 +677,26 @@ bool SocketAdapter::SendTCP(ConnectionKey Key, IP_Packet* ipPkt)
 		return false;
 	else
 	{
-		Console.WriteLn("DEV9: Socket: Creating New TCP Connection to %d", tcp.destinationPort);
+		Console.WriteLn("DEV9: Socket: Creating New TCP Connection to %d", Key.srvPort);
 		TCP_Session* s = new TCP_Session(Key, adapterIP);
 
 		s->AddConnectionClosedHandler([&](BaseSession* session) { HandleConnectionClosed(session); });
 		s->destIP = ipPkt->destinationIP;
 		s->sourceIP = dhcpServer.ps2IP;
 		connections.Add(Key, s);
-		return s->Send(ipPkt->GetPayload());
+		const bool ret = s->Send(ipPkt->GetPayload());
+		WakeSession(Key);
+		return ret;
 	}
 }
 
 bool SocketAdapter::SendUDP(ConnectionKey Key, IP_Packet* ipPkt)
 {
+	//Only the ports are needed here, the session parses the rest
 	IP_PayloadPtr* ipPayload = static_cast<IP_PayloadPtr*>(ipPkt->GetPayload());
-	UDP_Packet udp(ipPayload->data, ipPayload->GetLength());
-
-	Key.ps2Port = udp.sourcePort;
-	Key.srvPort = udp.destinationPort;
+	int offset = 0;
+	NetLib::ReadUInt16(ipPayload->data, &offset, &Key.ps2Port);
+	NetLib::ReadUInt16(ipPayload->data, &offset, &Key.srvPort);
 
 	const int res = SendFromConnection(Key, ipPkt);
 	if (res == 1)
@@ -572,14 +707,14 @@ bool SocketAdapter::SendUDP(ConnectionKey Key, IP_Packet* ipPkt)
 	{
 		UDP_Session* s = nullptr;
 
-		if (udp.sourcePort == udp.destinationPort || //Used for LAN games that assume the destination port
+		if (Key.ps2Port == Key.srvPort || //Used for LAN games that assume the destination port
 			ipPkt->destinationIP == dhcpServer.broadcastIP || //Broadcast packets
 			ipPkt->destinationIP == IP_Address{255, 255, 255, 255} || //Limited Broadcast packets
 			(ipPkt->destinationIP.bytes[0] & 0xF0) == 0xE0) //Multicast address start with 0b1110
 		{
 			UDP_FixedPort* fPort = nullptr;
 			BaseSession* fSession;
-			if (fixedUDPPorts.TryGetValue(udp.sourcePort, &fSession))
+			if (fixedUDPPorts.TryGetValue(Key.ps2Port, &fSession))
 			{
 				//DevCon.WriteLn("DEV9: Socket: Using Existing UDPFixedPort");
 				fPort = static_cast<UDP_FixedPort*>(fSession);
@@ -588,29 +723,30 @@ bool SocketAdapter::SendUDP(ConnectionKey Key, IP_Packet* ipPkt)
 			{
 				ConnectionKey fKey{0};
 				fKey.protocol = (u8)IP_Type::UDP;
-				fKey.ps2Port = udp.sourcePort;
+				fKey.ps2Port = Key.ps2Port;
 				fKey.srvPort = 0;
 
-				Console.WriteLn("DEV9: Socket: Creating New UDPFixedPort with port %d", udp.destinationPort);
+				Console.WriteLn("DEV9: Socket: Creating New UDPFixedPort with port %d", Key.srvPort);
 
-				fPort = new UDP_FixedPort(fKey, adapterIP, udp.sourcePort);
+				fPort = new UDP_FixedPort(fKey, adapterIP, Key.ps2Port);
 				fPort->AddConnectionClosedHandler([&](BaseSession* session) { HandleFixedPortClosed(session); });
 
 				fPort->destIP = {0, 0, 0, 0};
 				fPort->sourceIP = dhcpServer.ps2IP;
 
 				connections.Add(fKey, fPort);
-				fixedUDPPorts.Add(udp.sourcePort, fPort);
+				fixedUDPPorts.Add(Key.ps2Port, fPort);
+				WakeSession(fKey);
 			}
 
-			Console.WriteLn("DEV9: Socket: Creating New UDP Connection from FixedPort %d", udp.destinationPort);
+			Console.WriteLn("DEV9: Socket: Creating New UDP Connection from FixedPort %d", Key.srvPort);
 			s = fPort->NewClientSession(Key,
 				ipPkt->destinationIP == dhcpServer.broadcastIP || ipPkt->destinationIP == IP_Address{255, 255, 255, 255},
 				(ipPkt->destinationIP.bytes[0] & 0xF0) == 0xE0);
 		}
 		else
 		{
-			Console.WriteLn("DEV9: Socket: Creating New UDP Connection to %d", udp.destinationPort);
+			Console.WriteLn("DEV9: Socket: Creating New UDP Connection to %d", Key.srvPort);
 			s = new UDP_Session(Key, adapterIP);
 		}
 
@@ -618,7 +754,9 @@ bool SocketAdapter::SendUDP(ConnectionKey Key, IP_Packet* ipPkt)
 		s->destIP = ipPkt->destinationIP;
 		s->sourceIP = dhcpServer.ps2IP;
 		connections.Add(Key, s);
-		return s->Send(ipPkt->GetPayload());
+		const bool ret = s->Send(ipPkt->GetPayload());
+		WakeSession(Key);
+		return ret;
 	}
 }
 
@@ -627,7 +765,11 @@ int SocketAdapter::SendFromConnection(ConnectionKey Key, IP_Packet* ipPkt)
 	BaseSession* s = nullptr;
 	connections.TryGetValue(Key, &s);
 	if (s != nullptr)
-		return s->Send(ipPkt->GetPayload()) ? 1 : 0;
+	{
+		const bool ret = s->Send(ipPkt->GetPayload());
+		WakeSession(Key);
+		return ret ? 1 : 0;
+	}
 	else
 		return -1;
 }
@@ -692,6 +834,10 @@ SocketAdapter::~SocketAdapter()
 	connections.Clear();
 	fixedUDPPorts.Clear(); //fixedUDP sessions already deleted via connections
 
+	ConnectionKey wakeKey;
+	while (wakeQueue.Dequeue(&wakeKey))
+		;
+
 	//Clear out vRecBuffer
 	while (!vRecBuffer.IsQueueEmpty())
 	{
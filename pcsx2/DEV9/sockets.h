@@ -14,6 +14,10 @@
  */
 
 #pragma once
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "net.h"
@@ -22,6 +26,7 @@
 #include "PacketReader/EthernetFrame.h"
 #include "Sessions/BaseSession.h"
 #include "SimpleQueue.h"
+#include "SocketReactor.h"
 #include "ThreadSafeMap.h"
 
 class SocketAdapter : public NetAdapter
@@ -40,12 +45,25 @@ class SocketAdapter : public NetAdapter
 	ThreadSafeMap<Sessions::ConnectionKey, Sessions::BaseSession*> connections;
 	ThreadSafeMap<u16, Sessions::BaseSession*> fixedUDPPorts;
 
+	//Sessions which may have something to receive, queued by send and by the reactor
+	SimpleQueue<Sessions::ConnectionKey> wakeQueue;
+
+	//Only touched by the rx thread
+	SocketReactor reactor;
+	std::unordered_map<int, Sessions::ConnectionKey> socketSessions;
+	std::unordered_set<Sessions::ConnectionKey> alwaysPolled;
+	std::deque<Sessions::ConnectionKey> readySessions;
+	std::unordered_set<Sessions::ConnectionKey> readySet;
+	std::vector<int> readySockets;
+	std::chrono::steady_clock::time_point lastSweep;
+
 public:
 	SocketAdapter();
 	virtual bool blocks();
 	virtual bool isInitialised();
 	//gets a packet.rv :true success
 	virtual bool recv(NetPacket* pkt);
+	virtual bool recvPooled(NetPacketRef* pkt);
 	//sends the packet and deletes it when done (if successful).rv :true success
 	virtual bool send(NetPacket* pkt);
 	virtual void reset();
@@ -64,6 +82,10 @@ private:
 
 	int SendFromConnection(Sessions::ConnectionKey Key, PacketReader::IP::IP_Packet* ipPkt);
 
+	void WakeSession(Sessions::ConnectionKey key);
+	void UpdateReadySessions();
+	bool RecvFromSession(Sessions::BaseSession* session, NetPacketRef* pkt);
+
 	//Event must only be raised once per connection
 	void HandleConnectionClosed(Sessions::BaseSession* sender);
 	void HandleFixedPortClosed(Sessions::BaseSession* sender);
@@ -20,6 +20,7 @@
 #include "common/Path.h"
 #include "common/Timer.h"
 #include "common/Threading.h"
+#include "common/Tracing.h"
 #include "Frontend/CommonHost.h"
 #include "Frontend/FullscreenUI.h"
 #include "Frontend/GameList.h"
@@ -256,6 +257,7 @@ void CommonHost::SetCommonDefaultSettings(SettingsInterface& si)
 void CommonHost::CPUThreadInitialize()
 {
 	Threading::SetNameOfCurrentThread("CPU Thread");
+	Tracing::SetThreadName("CPU Thread");
 	PerformanceMetrics::SetCPUThread(Threading::ThreadHandle::GetForCallingThread());
 
 	// neither of these should ever fail.
@@ -17,6 +17,7 @@
 #include "common/Assertions.h"
 #include "common/FileSystem.h"
 #include "common/Path.h"
+#include "common/Tracing.h"
 #include "Frontend/CommonHost.h"
 #include "Frontend/FullscreenUI.h"
 #include "Frontend/InputManager.h"
@@ -31,6 +32,8 @@
 #include "Frontend/Achievements.h"
 #endif
 
+#include <ctime>
+
 static s32 s_current_save_slot = 1;
 static std::optional<LimiterModeType> s_limiter_mode_prior_to_hold_interaction;
 
@@ -122,6 +125,32 @@ static void HotkeySaveStateSlot(s32 slot)
 	VMManager::SaveStateToSlot(slot);
 }
 
+static void HotkeyToggleTraceCapture()
+{
+	if (!Tracing::IsCapturing())
+	{
+		Tracing::Start(static_cast<Tracing::Tier>(std::clamp<u32>(EmuConfig.TracingTier, 1, 2)));
+		Host::AddIconOSDMessage("TraceCapture", ICON_FA_STOPWATCH, "Trace capture started.", Host::OSD_QUICK_DURATION);
+		return;
+	}
+
+	Tracing::Stop();
+
+	const std::time_t now = std::time(nullptr);
+	char timestamp[32];
+	std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+	const std::string filename(Path::Combine(EmuFolders::Logs, fmt::format("trace_{}.json", timestamp)));
+	if (Tracing::Export(filename.c_str()))
+	{
+		Host::AddIconOSDMessage("TraceCapture", ICON_FA_STOPWATCH, fmt::format("Trace saved to '{}'.", Path::GetFileName(filename)),
+			Host::OSD_INFO_DURATION);
+	}
+	else
+	{
+		Host::AddIconOSDMessage("TraceCapture", ICON_FA_EXCLAMATION_TRIANGLE, "Failed to save trace.", Host::OSD_ERROR_DURATION);
+	}
+}
+
 BEGIN_HOTKEY_LIST(g_common_hotkeys)
 DEFINE_HOTKEY("OpenPauseMenu", "System", "Open Pause Menu", [](s32 pressed) {
 	if (!pressed && VMManager::HasValidVM())
@@ -191,6 +220,14 @@ DEFINE_HOTKEY("FrameAdvance", "System", "Frame Advance", [](s32 pressed) {
 	if (!pressed && VMManager::HasValidVM())
 		VMManager::FrameAdvance(1);
 })
+DEFINE_HOTKEY("Rewind", "System", "Rewind", [](s32 pressed) {
+	if (!pressed && VMManager::HasValidVM())
+		VMManager::RewindState();
+})
+DEFINE_HOTKEY("ToggleTraceCapture", "System", "Start/Stop Trace Capture", [](s32 pressed) {
+	if (!pressed)
+		HotkeyToggleTraceCapture();
+})
 DEFINE_HOTKEY("ShutdownVM", "System", "Shut Down Virtual Machine", [](s32 pressed) {
 	if (!pressed && VMManager::HasValidVM())
 		Host::RequestVMShutdown(true, true, EmuConfig.SaveStateOnShutdown);
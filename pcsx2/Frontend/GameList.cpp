@@ -25,16 +25,23 @@
 #include "common/Path.h"
 #include "common/ProgressCallback.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
 #include <cstdio>
 #include <ctime>
 #include <fstream>
 #include <string_view>
+#include <thread>
 #include <utility>
 
+#include "AsyncFileReader.h"
 #include "CDVD/CDVD.h"
+#include "CDVD/IsoFileFormats.h"
+#include "CDVD/IsoFS/IsoFSCDVD.h"
 #include "Elfheader.h"
 #include "VMManager.h"
 
@@ -47,8 +54,14 @@ namespace GameList
 	enum : u32
 	{
 		GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
-		GAME_LIST_CACHE_VERSION = 32,
+		GAME_LIST_CACHE_VERSION = 33,
 
+		// Rewrite the cache once at least this many records, and a quarter of the file, are out of date.
+		GAME_LIST_CACHE_MIN_STALE_RECORDS = 32,
+
+		// Scanning is mostly waiting on reads, especially from network shares, so this is independent of the
+		// number of cores. Not too many though, or local hard drives end up seeking back and forth.
+		MAX_SCAN_THREADS = 8,
 
 		PLAYED_TIME_SERIAL_LENGTH = 32,
 		PLAYED_TIME_LAST_TIME_LENGTH = 20, // uint64
@@ -56,6 +69,29 @@ namespace GameList
 		PLAYED_TIME_LINE_LENGTH = PLAYED_TIME_SERIAL_LENGTH + 1 + PLAYED_TIME_LAST_TIME_LENGTH + 1 + PLAYED_TIME_TOTAL_TIME_LENGTH,
 	};
 
+	struct CacheHeader
+	{
+		u32 signature;
+		u32 version;
+	};
+
+	// Followed by the path, serial and title, without terminators.
+	struct CacheRecord
+	{
+		u64 total_size;
+		u64 last_modified_time;
+		u32 crc;
+		u32 path_length;
+		u32 serial_length;
+		u32 title_length;
+		u8 type;
+		u8 region;
+		u8 compatibility_rating;
+		u8 pad;
+		u32 reserved;
+	};
+	static_assert(sizeof(CacheRecord) == 40, "Cache record has no implicit padding");
+
 	struct PlayedTimeEntry
 	{
 		std::time_t last_played_time;
@@ -77,12 +113,14 @@ namespace GameList
 	static bool GetGameListEntryFromCache(const std::string& path, GameList::Entry* entry);
 	static void ScanDirectory(const char* path, bool recursive, bool only_cache, const std::vector<std::string>& excluded_paths,
 		const PlayedTimeMap& played_time_map, ProgressCallback* progress);
+	static void ScanFiles(const std::vector<FILESYSTEM_FIND_DATA>& files, const PlayedTimeMap& played_time_map, u32 progress_base,
+		ProgressCallback* progress);
 	static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map);
 	static bool ScanFile(
 		std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock, const PlayedTimeMap& played_time_map);
 
 	static void LoadCache();
-	static bool LoadEntriesFromCache(std::FILE* stream);
+	static bool LoadEntriesFromCache(const u8* data, size_t size, size_t* valid_size);
 	static bool OpenCacheForWriting();
 	static bool WriteEntryToCache(const GameList::Entry* entry);
 	static void CloseCacheFileStream();
@@ -100,7 +138,12 @@ namespace GameList
 static std::vector<GameList::Entry> s_entries;
 static std::recursive_mutex s_mutex;
 static GameList::CacheMap s_cache_map;
+
+// Entries are only ever appended to the cache file, the last record for a path wins when loading.
 static std::FILE* s_cache_write_stream = nullptr;
+static std::mutex s_cache_write_mutex;
+static u32 s_cache_record_count = 0;
+static bool s_cache_needs_rewrite = false;
 
 const char* GameList::EntryTypeToString(EntryType type)
 {
@@ -169,24 +212,23 @@ void GameList::FillBootParametersForEntry(VMBootParameters* params, const Entry*
 
 bool GameList::GetIsoSerialAndCRC(const std::string& path, s32* disc_type, std::string* serial, u32* crc)
 {
-	// This isn't great, we really want to make it all thread-local...
-	CDVD = &CDVDapi_Iso;
-	if (CDVD->open(path.c_str()) != 0)
-		return false;
-
-	*disc_type = DoCDVDdetectDiskType();
-	cdvdReloadElfInfo();
-
-	*serial = DiscSerial;
-	*crc = ElfCRC;
+	// Doesn't go through the CDVD interface, so several images can be scanned at once, and a running game isn't affected.
+	std::unique_ptr<InputIsoFile> iso = std::make_unique<InputIsoFile>();
+	try
+	{
+		if (!iso->Open(path))
+			return false;
 
-	DoCDVDclose();
+		IsoFSImage source(*iso);
+		*disc_type = DoCDVDdetectIsoDiskType(*iso);
+		cdvdGetDiscInfo(source, serial, crc);
+	}
+	catch (Exception::BaseException& e)
+	{
+		Console.Error("Failed to read '%s': %s", path.c_str(), e.DiagMsg().c_str());
+		return false;
+	}
 
-	// TODO(Stenzek): These globals are **awful**. Clean it up.
-	DiscSerial.clear();
-	ElfCRC = 0;
-	ElfEntry = -1;
-	LastELF.clear();
 	return true;
 }
 
@@ -308,11 +350,6 @@ bool GameList::GetIsoListEntry(const std::string& path, GameList::Entry* entry)
 	if (!FileSystem::StatFile(path.c_str(), &sd))
 		return false;
 
-	// This isn't great, we really want to make it all thread-local...
-	CDVD = &CDVDapi_Iso;
-	if (CDVD->open(path.c_str()) != 0)
-		return false;
-
 	s32 disc_type;
 	if (!GetIsoSerialAndCRC(path, &disc_type, &entry->serial, &entry->crc))
 		return false;
@@ -373,92 +410,44 @@ bool GameList::GetGameListEntryFromCache(const std::string& path, GameList::Entr
 	return true;
 }
 
-static bool ReadString(std::FILE* stream, std::string* dest)
+bool GameList::LoadEntriesFromCache(const u8* data, size_t size, size_t* valid_size)
 {
-	u32 size;
-	if (std::fread(&size, sizeof(size), 1, stream) != 1)
+	CacheHeader header;
+	if (size < sizeof(header))
 		return false;
 
-	dest->resize(size);
-	if (size > 0 && std::fread(dest->data(), size, 1, stream) != 1)
+	std::memcpy(&header, data, sizeof(header));
+	if (header.signature != GAME_LIST_CACHE_SIGNATURE || header.version != GAME_LIST_CACHE_VERSION)
 		return false;
 
-	return true;
-}
-
-static bool ReadU8(std::FILE* stream, u8* dest)
-{
-	return std::fread(dest, sizeof(u8), 1, stream) > 0;
-}
-
-static bool ReadU32(std::FILE* stream, u32* dest)
-{
-	return std::fread(dest, sizeof(u32), 1, stream) > 0;
-}
-
-static bool ReadU64(std::FILE* stream, u64* dest)
-{
-	return std::fread(dest, sizeof(u64), 1, stream) > 0;
-}
-
-static bool WriteString(std::FILE* stream, const std::string& str)
-{
-	const u32 size = static_cast<u32>(str.size());
-	return (std::fwrite(&size, sizeof(size), 1, stream) > 0 && (size == 0 || std::fwrite(str.data(), size, 1, stream) > 0));
-}
-
-static bool WriteU8(std::FILE* stream, u8 dest)
-{
-	return std::fwrite(&dest, sizeof(u8), 1, stream) > 0;
-}
-
-static bool WriteU32(std::FILE* stream, u32 dest)
-{
-	return std::fwrite(&dest, sizeof(u32), 1, stream) > 0;
-}
-
-static bool WriteU64(std::FILE* stream, u64 dest)
-{
-	return std::fwrite(&dest, sizeof(u64), 1, stream) > 0;
-}
-
-bool GameList::LoadEntriesFromCache(std::FILE* stream)
-{
-	u32 file_signature, file_version;
-	s64 start_pos, file_size;
-	if (!ReadU32(stream, &file_signature) || !ReadU32(stream, &file_version) || file_signature != GAME_LIST_CACHE_SIGNATURE ||
-		file_version != GAME_LIST_CACHE_VERSION || (start_pos = FileSystem::FTell64(stream)) < 0 ||
-		FileSystem::FSeek64(stream, 0, SEEK_END) != 0 || (file_size = FileSystem::FTell64(stream)) < 0 ||
-		FileSystem::FSeek64(stream, start_pos, SEEK_SET) != 0)
+	size_t pos = sizeof(header);
+	while ((size - pos) >= sizeof(CacheRecord))
 	{
-		Console.Warning("Game list cache is corrupted");
-		return false;
-	}
-
-	while (FileSystem::FTell64(stream) != file_size)
-	{
-		std::string path;
-		GameList::Entry ge;
+		CacheRecord record;
+		std::memcpy(&record, data + pos, sizeof(record));
 
-		u8 type;
-		u8 region;
-		u8 compatibility_rating;
-		u64 last_modified_time;
-
-		if (!ReadString(stream, &path) || !ReadString(stream, &ge.serial) || !ReadString(stream, &ge.title) || !ReadU8(stream, &type) ||
-			!ReadU8(stream, &region) || !ReadU64(stream, &ge.total_size) || !ReadU64(stream, &last_modified_time) ||
-			!ReadU32(stream, &ge.crc) || !ReadU8(stream, &compatibility_rating) || region >= static_cast<u8>(Region::Count) ||
-			type >= static_cast<u8>(EntryType::Count) || compatibility_rating > static_cast<u8>(CompatibilityRating::Perfect))
+		const size_t strings_size = static_cast<size_t>(record.path_length) + record.serial_length + record.title_length;
+		if (strings_size > (size - pos - sizeof(record)) || record.region >= static_cast<u8>(Region::Count) ||
+			record.type >= static_cast<u8>(EntryType::Count) || record.compatibility_rating > static_cast<u8>(CompatibilityRating::Perfect))
 		{
-			Console.Warning("Game list cache entry is corrupted");
-			return false;
+			break;
 		}
 
+		const char* strings = reinterpret_cast<const char*>(data + pos + sizeof(record));
+		pos += sizeof(record) + strings_size;
+		s_cache_record_count++;
+
+		std::string path(strings, record.path_length);
+		GameList::Entry ge;
 		ge.path = path;
-		ge.region = static_cast<Region>(region);
-		ge.type = static_cast<EntryType>(type);
-		ge.compatibility_rating = static_cast<CompatibilityRating>(compatibility_rating);
-		ge.last_modified_time = static_cast<std::time_t>(last_modified_time);
+		ge.serial.assign(strings + record.path_length, record.serial_length);
+		ge.title.assign(strings + record.path_length + record.serial_length, record.title_length);
+		ge.region = static_cast<Region>(record.region);
+		ge.type = static_cast<EntryType>(record.type);
+		ge.compatibility_rating = static_cast<CompatibilityRating>(record.compatibility_rating);
+		ge.total_size = record.total_size;
+		ge.last_modified_time = static_cast<std::time_t>(record.last_modified_time);
+		ge.crc = record.crc;
 
 		auto iter = UnorderedStringMapFind(s_cache_map, ge.path);
 		if (iter != s_cache_map.end())
@@ -467,6 +456,7 @@ bool GameList::LoadEntriesFromCache(std::FILE* stream)
 			s_cache_map.emplace(std::move(path), std::move(ge));
 	}
 
+	*valid_size = pos;
 	return true;
 }
 
@@ -478,18 +468,39 @@ static std::string GetCacheFilename()
 void GameList::LoadCache()
 {
 	const std::string cache_filename(GetCacheFilename());
-	auto stream = FileSystem::OpenManagedCFile(cache_filename.c_str(), "rb");
-	if (!stream)
-		return;
+	s_cache_record_count = 0;
+	s_cache_needs_rewrite = false;
 
-	if (!LoadEntriesFromCache(stream.get()))
+	bool valid;
+	size_t size, valid_size = 0;
+	{
+		// Parse the records straight out of the mapping, instead of reading them a field at a time.
+		MappedFileReader reader;
+		reader.SetBlockSize(1);
+		if (!reader.Open(cache_filename))
+			return;
+
+		size = reader.GetBlockCount();
+		const u8* data = reader.GetMappedSectors(0, static_cast<uint>(size));
+		valid = (data && LoadEntriesFromCache(data, size, &valid_size));
+	}
+
+	if (!valid)
 	{
 		Console.Warning("Deleting corrupted cache file '%s'", cache_filename.c_str());
-		stream.reset();
 		s_cache_map.clear();
 		DeleteCacheFile();
 		return;
 	}
+
+	if (valid_size != size)
+	{
+		// Most likely we crashed while appending. Anything after the last good record can't be appended to,
+		// so start a new file, and write everything out again once the scan is done.
+		Console.Warning("Game list cache has %zu trailing bytes, it will be rewritten", size - valid_size);
+		DeleteCacheFile();
+		s_cache_needs_rewrite = true;
+	}
 }
 
 bool GameList::OpenCacheForWriting()
@@ -503,10 +514,9 @@ bool GameList::OpenCacheForWriting()
 	if (s_cache_write_stream)
 	{
 		// check the header
-		u32 signature, version;
-		if (ReadU32(s_cache_write_stream, &signature) && signature == GAME_LIST_CACHE_SIGNATURE &&
-			ReadU32(s_cache_write_stream, &version) && version == GAME_LIST_CACHE_VERSION &&
-			FileSystem::FSeek64(s_cache_write_stream, 0, SEEK_END) == 0)
+		CacheHeader header;
+		if (std::fread(&header, sizeof(header), 1, s_cache_write_stream) == 1 && header.signature == GAME_LIST_CACHE_SIGNATURE &&
+			header.version == GAME_LIST_CACHE_VERSION && FileSystem::FSeek64(s_cache_write_stream, 0, SEEK_END) == 0)
 		{
 			return true;
 		}
@@ -520,9 +530,11 @@ bool GameList::OpenCacheForWriting()
 	if (!s_cache_write_stream)
 		return false;
 
+	s_cache_record_count = 0;
 
 	// new cache file, write header
-	if (!WriteU32(s_cache_write_stream, GAME_LIST_CACHE_SIGNATURE) || !WriteU32(s_cache_write_stream, GAME_LIST_CACHE_VERSION))
+	const CacheHeader header = {GAME_LIST_CACHE_SIGNATURE, GAME_LIST_CACHE_VERSION};
+	if (std::fwrite(&header, sizeof(header), 1, s_cache_write_stream) != 1)
 	{
 		Console.Error("Failed to write game list cache header");
 		std::fclose(s_cache_write_stream);
@@ -536,22 +548,33 @@ bool GameList::OpenCacheForWriting()
 
 bool GameList::WriteEntryToCache(const Entry* entry)
 {
-	bool result = true;
-	result &= WriteString(s_cache_write_stream, entry->path);
-	result &= WriteString(s_cache_write_stream, entry->serial);
-	result &= WriteString(s_cache_write_stream, entry->title);
-	result &= WriteU8(s_cache_write_stream, static_cast<u8>(entry->type));
-	result &= WriteU8(s_cache_write_stream, static_cast<u8>(entry->region));
-	result &= WriteU64(s_cache_write_stream, entry->total_size);
-	result &= WriteU64(s_cache_write_stream, static_cast<u64>(entry->last_modified_time));
-	result &= WriteU32(s_cache_write_stream, entry->crc);
-	result &= WriteU8(s_cache_write_stream, static_cast<u8>(entry->compatibility_rating));
-
-	// flush after each entry, that way we don't end up with a corrupted file if we crash scanning.
-	if (result)
-		result = (std::fflush(s_cache_write_stream) == 0);
-
-	return result;
+	CacheRecord record = {};
+	record.total_size = entry->total_size;
+	record.last_modified_time = static_cast<u64>(entry->last_modified_time);
+	record.crc = entry->crc;
+	record.path_length = static_cast<u32>(entry->path.size());
+	record.serial_length = static_cast<u32>(entry->serial.size());
+	record.title_length = static_cast<u32>(entry->title.size());
+	record.type = static_cast<u8>(entry->type);
+	record.region = static_cast<u8>(entry->region);
+	record.compatibility_rating = static_cast<u8>(entry->compatibility_rating);
+
+	std::vector<u8> data(sizeof(record) + entry->path.size() + entry->serial.size() + entry->title.size());
+	u8* ptr = data.data();
+	std::memcpy(ptr, &record, sizeof(record));
+	ptr += sizeof(record);
+	std::memcpy(ptr, entry->path.data(), entry->path.size());
+	ptr += entry->path.size();
+	std::memcpy(ptr, entry->serial.data(), entry->serial.size());
+	ptr += entry->serial.size();
+	std::memcpy(ptr, entry->title.data(), entry->title.size());
+
+	// one write per entry, and flush after it, that way we don't end up with a corrupted file if we crash scanning.
+	if (std::fwrite(data.data(), data.size(), 1, s_cache_write_stream) != 1 || std::fflush(s_cache_write_stream) != 0)
+		return false;
+
+	s_cache_record_count++;
+	return true;
 }
 
 void GameList::CloseCacheFileStream()
@@ -566,6 +589,7 @@ void GameList::CloseCacheFileStream()
 void GameList::DeleteCacheFile()
 {
 	pxAssert(!s_cache_write_stream);
+	s_cache_record_count = 0;
 
 	const std::string cache_filename(GetCacheFilename());
 	if (cache_filename.empty() || !FileSystem::FileExists(cache_filename.c_str()))
@@ -581,6 +605,7 @@ void GameList::RewriteCacheFile()
 {
 	CloseCacheFileStream();
 	DeleteCacheFile();
+	s_cache_needs_rewrite = false;
 
 	if (OpenCacheForWriting())
 	{
@@ -610,14 +635,13 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
                     (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES),
 		&files);
 
-	u32 files_scanned = 0;
 	progress->SetProgressRange(static_cast<u32>(files.size()));
 	progress->SetProgressValue(0);
 
+	// Known files and cache hits are cheap, only the rest goes to the scanner threads.
+	std::vector<FILESYSTEM_FIND_DATA> files_to_scan;
 	for (FILESYSTEM_FIND_DATA& ffd : files)
 	{
-		files_scanned++;
-
 		if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) || IsPathExcluded(excluded_paths, ffd.FileName))
 		{
 			continue;
@@ -629,15 +653,86 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
 			continue;
 		}
 
-		progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-		ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map);
-		progress->SetProgressValue(files_scanned);
+		files_to_scan.push_back(std::move(ffd));
 	}
 
-	progress->SetProgressValue(files_scanned);
+	if (!files_to_scan.empty() && !progress->IsCancelled())
+		ScanFiles(files_to_scan, played_time_map, static_cast<u32>(files.size() - files_to_scan.size()), progress);
+
+	progress->SetProgressValue(static_cast<u32>(files.size()));
 	progress->PopState();
 }
 
+void GameList::ScanFiles(const std::vector<FILESYSTEM_FIND_DATA>& files, const PlayedTimeMap& played_time_map, u32 progress_base,
+	ProgressCallback* progress)
+{
+	const u32 num_files = static_cast<u32>(files.size());
+	const u32 num_threads = std::min<u32>(num_files, MAX_SCAN_THREADS);
+
+	std::atomic<u32> next_file{0};
+	std::atomic_bool cancelled{false};
+	std::mutex done_mutex;
+	std::condition_variable done_cv;
+	u32 files_done = 0;
+	u32 threads_running = num_threads;
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_threads);
+	for (u32 i = 0; i < num_threads; i++)
+	{
+		threads.emplace_back([&]() {
+			Threading::SetNameOfCurrentThread("Game List Scanner");
+
+			for (;;)
+			{
+				const u32 index = next_file.fetch_add(1, std::memory_order_relaxed);
+				if (index >= num_files || cancelled.load(std::memory_order_relaxed))
+					break;
+
+				{
+					std::unique_lock lock(s_mutex);
+					ScanFile(files[index].FileName, files[index].ModificationTime, lock, played_time_map);
+				}
+
+				std::unique_lock done_lock(done_mutex);
+				files_done++;
+				done_cv.notify_one();
+			}
+
+			std::unique_lock done_lock(done_mutex);
+			threads_running--;
+			done_cv.notify_one();
+		});
+	}
+
+	// The progress callback is only ever used from this thread, the workers just report how far they got.
+	std::unique_lock done_lock(done_mutex);
+	while (threads_running > 0)
+	{
+		done_cv.wait_for(done_lock, std::chrono::milliseconds(100));
+
+		const u32 done = files_done;
+		done_lock.unlock();
+
+		if (progress->IsCancelled())
+			cancelled.store(true, std::memory_order_relaxed);
+
+		const u32 current = std::min(next_file.load(std::memory_order_relaxed), num_files);
+		if (current > 0)
+		{
+			progress->SetFormattedStatusText(
+				"Scanning '%s'...", FileSystem::GetDisplayNameFromPath(files[current - 1].FileName).c_str());
+		}
+		progress->SetProgressValue(progress_base + done);
+
+		done_lock.lock();
+	}
+	done_lock.unlock();
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map)
 {
 	Entry entry;
@@ -670,10 +765,13 @@ bool GameList::ScanFile(
 	entry.path = std::move(path);
 	entry.last_modified_time = timestamp;
 
-	if (s_cache_write_stream || OpenCacheForWriting())
 	{
-		if (!WriteEntryToCache(&entry))
-			Console.Warning("Failed to write entry '%s' to cache", entry.path.c_str());
+		std::unique_lock cache_lock(s_cache_write_mutex);
+		if (s_cache_write_stream || OpenCacheForWriting())
+		{
+			if (!WriteEntryToCache(&entry))
+				Console.Warning("Failed to write entry '%s' to cache", entry.path.c_str());
+		}
 	}
 
 	auto iter = UnorderedStringMapFind(played_time_map, entry.serial);
@@ -803,6 +901,19 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
 		}
 	}
 
+	// Records are only ever appended, so once enough of them are for files which were rescanned or are gone,
+	// write the file out again with just the current entries. Not if we were cancelled though, we'd lose the rest.
+	if (!progress->IsCancelled())
+	{
+		std::unique_lock lock(s_mutex);
+		const u32 stale_records = s_cache_record_count - std::min(s_cache_record_count, static_cast<u32>(s_entries.size()));
+		if (s_cache_needs_rewrite || (stale_records >= GAME_LIST_CACHE_MIN_STALE_RECORDS && stale_records >= (s_cache_record_count / 4)))
+		{
+			DevCon.WriteLn("Compacting game list cache (%u of %u records are stale)", stale_records, s_cache_record_count);
+			RewriteCacheFile();
+		}
+	}
+
 	// don't need unused cache entries
 	CloseCacheFileStream();
 	s_cache_map.clear();
@@ -825,12 +936,11 @@ bool GameList::RescanPath(const std::string& path)
 			return false;
 	}
 
-	// re-scan!
-	if (!ScanFile(path, sd.ModificationTime, lock, played_time))
-		return true;
+	// re-scan! the new entry is appended to the cache, and replaces the old one next time it's loaded.
+	ScanFile(path, sd.ModificationTime, lock, played_time);
 
-	// update cache.. this is far from ideal, but since everything's variable length, all we can do.
-	RewriteCacheFile();
+	std::unique_lock cache_lock(s_cache_write_mutex);
+	CloseCacheFileStream();
 	return true;
 }
 
@@ -37,6 +37,7 @@
 #include "Frontend/ImGuiOverlays.h"
 #include "GS.h"
 #include "GS/GS.h"
+#include "GS/GSDrawProfiler.h"
 #include "GS/GSVector.h"
 #include "Host.h"
 #include "HostDisplay.h"
@@ -63,6 +64,7 @@ namespace ImGuiManager
 	static void DrawSettingsOverlay();
 	static void DrawInputsOverlay();
 	static void DrawInputRecordingOverlay();
+	static void DrawGSDrawProfilerOverlay();
 #endif
 } // namespace ImGuiManager
 
@@ -659,6 +661,89 @@ void ImGuiManager::DrawInputRecordingOverlay()
 }
 #endif
 
+#ifdef PCSX2_CORE
+void ImGuiManager::DrawGSDrawProfilerOverlay()
+{
+	// Draws are listed most expensive first, there's only room for so many.
+	static constexpr size_t MAX_ROWS = 24;
+	static constexpr const char* prim_names[] = {"point", "line", "tri", "sprite"};
+	static constexpr const char* texture_names[] = {"-", "hit", "upload", "target"};
+
+	if (!GSDrawProfiler::HasCapture())
+		return;
+
+	const GSDrawProfiler::Capture& capture = GSDrawProfiler::GetCapture();
+	std::vector<const GSDrawProfiler::DrawRecord*> sorted;
+	sorted.reserve(capture.draws.size());
+	float total_cpu_ms = 0.0f, total_raster_ms = 0.0f;
+	for (const GSDrawProfiler::DrawRecord& d : capture.draws)
+	{
+		sorted.push_back(&d);
+		total_cpu_ms += d.cpu_ms;
+		total_raster_ms += d.raster_ms;
+	}
+	const size_t rows = std::min(sorted.size(), MAX_ROWS);
+	std::partial_sort(sorted.begin(), sorted.begin() + rows, sorted.end(), [](const auto* lhs, const auto* rhs) {
+		return (lhs->cpu_ms + lhs->raster_ms) > (rhs->cpu_ms + rhs->raster_ms);
+	});
+
+	const float scale = ImGuiManager::GetGlobalScale();
+	const float margin = std::ceil(10.0f * scale);
+
+	ImGui::SetNextWindowPos(ImVec2(margin, margin * 4.0f));
+	ImGui::SetNextWindowBgAlpha(0.75f);
+	ImGui::PushFont(ImGuiManager::GetFixedFont());
+	if (ImGui::Begin("##gs_draw_profiler", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		ImGui::Text("Frame %llu: %zu draws, GS thread %.2f ms, rasterizer %.2f ms, GPU %.2f ms (average)",
+			static_cast<unsigned long long>(capture.frame),
+			capture.draws.size(), total_cpu_ms, total_raster_ms, capture.gpu_average_ms);
+
+		if (ImGui::BeginTable("##draws", 9, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+		{
+			ImGui::TableSetupColumn("Draw");
+			ImGui::TableSetupColumn("Prim");
+			ImGui::TableSetupColumn("Count");
+			ImGui::TableSetupColumn("Pixels");
+			ImGui::TableSetupColumn("Selector");
+			ImGui::TableSetupColumn("Texture");
+			ImGui::TableSetupColumn("Calls");
+			ImGui::TableSetupColumn("CPU ms");
+			ImGui::TableSetupColumn("Raster ms");
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < rows; i++)
+			{
+				const GSDrawProfiler::DrawRecord& d = *sorted[i];
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", d.index);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted((d.prim_class < std::size(prim_names)) ? prim_names[d.prim_class] : "?");
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", d.prims);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", d.pixels);
+				ImGui::TableNextColumn();
+				ImGui::Text("%08X%016llX", d.selector_hi, static_cast<unsigned long long>(d.selector));
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(texture_names[static_cast<u8>(d.texture)]);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", d.draw_calls);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", d.cpu_ms);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", d.raster_ms);
+			}
+
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+	ImGui::PopFont();
+}
+#endif
+
 void ImGuiManager::RenderOverlays()
 {
 	DrawPerformanceOverlay();
@@ -666,5 +751,6 @@ void ImGuiManager::RenderOverlays()
 	DrawInputRecordingOverlay();
 	DrawSettingsOverlay();
 	DrawInputsOverlay();
+	DrawGSDrawProfilerOverlay();
 #endif
 }
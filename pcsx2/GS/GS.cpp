@@ -24,6 +24,7 @@
 #endif
 
 #include "GS.h"
+#include "GSDrawProfiler.h"
 #include "GSGL.h"
 #include "GSUtil.h"
 #include "GSExtra.h"
@@ -539,6 +540,12 @@ void GSQueueSnapshot(const std::string& path, u32 gsdump_frames)
 		g_gs_renderer->QueueSnapshot(path, gsdump_frames);
 }
 
+void GSQueueFrameHash(std::function<void(u64 frame_hash, u64 vram_hash)> callback)
+{
+	if (g_gs_renderer)
+		g_gs_renderer->QueueFrameHash(std::move(callback));
+}
+
 void GSStopGSDump()
 {
 	if (g_gs_renderer)
@@ -721,7 +728,7 @@ void GSgetStats(std::string& info)
 	{
 		if (GSConfig.TexturePreloading == TexturePreloadingLevel::Full)
 		{
-			info = StringUtil::StdStringFromFormat("%s HW | HC: %d MB | %d P | %d D | %d DC | %d B | %d RB | %d TC | %d TU",
+			info = StringUtil::StdStringFromFormat("%s HW | HC: %d MB | %d P | %d D | %d DC | %d B | %d RB | %d TC | %d TU | %d IV %.2fms",
 				api_name,
 				(int)std::ceil(GSRendererHW::GetInstance()->GetTextureCache()->GetTotalHashCacheMemoryUsage() / 1048576.0f),
 				(int)pm.Get(GSPerfMon::Prim),
@@ -730,11 +737,13 @@ void GSgetStats(std::string& info)
 				(int)std::ceil(pm.Get(GSPerfMon::Barriers)),
 				(int)std::ceil(pm.Get(GSPerfMon::Readbacks)),
 				(int)std::ceil(pm.Get(GSPerfMon::TextureCopies)),
-				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)));
+				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)),
+				(int)std::ceil(pm.Get(GSPerfMon::Invalidations)),
+				pm.Get(GSPerfMon::InvalidationTime));
 		}
 		else
 		{
-			info = StringUtil::StdStringFromFormat("%s HW | %d P | %d D | %d DC | %d B | %d RB | %d TC | %d TU",
+			info = StringUtil::StdStringFromFormat("%s HW | %d P | %d D | %d DC | %d B | %d RB | %d TC | %d TU | %d IV %.2fms",
 				api_name,
 				(int)pm.Get(GSPerfMon::Prim),
 				(int)pm.Get(GSPerfMon::Draw),
@@ -742,7 +751,9 @@ void GSgetStats(std::string& info)
 				(int)std::ceil(pm.Get(GSPerfMon::Barriers)),
 				(int)std::ceil(pm.Get(GSPerfMon::Readbacks)),
 				(int)std::ceil(pm.Get(GSPerfMon::TextureCopies)),
-				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)));
+				(int)std::ceil(pm.Get(GSPerfMon::TextureUploads)),
+				(int)std::ceil(pm.Get(GSPerfMon::Invalidations)),
+				pm.Get(GSPerfMon::InvalidationTime));
 		}
 	}
 }
@@ -1604,6 +1615,18 @@ BEGIN_HOTKEY_LIST(g_gs_hotkeys)
 				GSStopGSDump();
 		});
 	}},
+	{"GSDrawProfile", "Graphics", "Profile Draws of Next Frame", [](s32 pressed) {
+		if (!pressed)
+		{
+			// Pressing it again closes the overlay.
+			GetMTGS().RunOnGSThread([]() {
+				if (GSDrawProfiler::HasCapture())
+					GSDrawProfiler::ClearCapture();
+				else
+					GSDrawProfiler::RequestCapture();
+			});
+		}
+	}},
 	{"ToggleSoftwareRendering", "Graphics", "Toggle Software Rendering", [](s32 pressed) {
 		if (!pressed)
 			GetMTGS().ToggleSoftwareRendering();
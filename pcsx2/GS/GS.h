@@ -22,6 +22,7 @@
 #include "pcsx2/GS/config.h"
 #include "gsl/span"
 
+#include <functional>
 #include <map>
 
 #ifdef None
@@ -71,6 +72,10 @@ void GSgifTransfer3(u8* mem, u32 size);
 void GSvsync(u32 field, bool registers_written);
 int GSfreeze(FreezeAction mode, freezeData* data);
 void GSQueueSnapshot(const std::string& path, u32 gsdump_frames = 0);
+/// Hashes the next presented frame and GS local memory, and calls back on the GS thread before any queued
+/// snapshot of that frame is taken. Much cheaper than writing out images when all that matters is whether
+/// the output changed. Local memory isn't kept up to date by the hardware renderers, only the frame is.
+void GSQueueFrameHash(std::function<void(u64 frame_hash, u64 vram_hash)> callback);
 void GSStopGSDump();
 void GSPresentCurrentFrame();
 void GSThrottlePresentation();
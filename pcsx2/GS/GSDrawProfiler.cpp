@@ -0,0 +1,251 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GSDrawProfiler.h"
+#include "GS.h"
+#include "GSPerfMon.h"
+
+#include "common/Console.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/Timer.h"
+#include "pcsx2/Config.h"
+#include "pcsx2/Host.h"
+#include "pcsx2/PerformanceMetrics.h"
+
+#include "fmt/core.h"
+
+#include <ctime>
+
+namespace
+{
+	enum class State
+	{
+		Idle,
+		Armed, // recording starts at the next vsync
+		Recording,
+		Finishing, // waiting a vsync for the rasterizer workers
+	};
+
+	struct PendingDraw
+	{
+		GSDrawProfiler::DrawRecord record;
+		std::shared_ptr<GSDrawProfiler::RasterStats> raster;
+		u64 start;
+		double counters[GSPerfMon::CounterLast];
+		bool hardware;
+	};
+} // namespace
+
+// Only counted for the hardware renderers, the software renderer reuses some of them for other things.
+static constexpr GSPerfMon::counter_t s_hw_counters[] = {
+	GSPerfMon::DrawCalls,
+	GSPerfMon::Barriers,
+	GSPerfMon::TextureUploads,
+	GSPerfMon::TextureCopies,
+	GSPerfMon::Readbacks,
+};
+
+bool GSDrawProfiler::Internal::s_recording = false;
+GSDrawProfiler::DrawRecord* GSDrawProfiler::Internal::s_current = nullptr;
+
+static State s_state = State::Idle;
+static std::vector<PendingDraw> s_pending;
+static u64 s_pending_frame = 0;
+static GSDrawProfiler::Capture s_capture;
+static bool s_has_capture = false;
+
+static PendingDraw* GetPendingDraw()
+{
+	return GSDrawProfiler::Internal::s_current ? &s_pending.back() : nullptr;
+}
+
+void GSDrawProfiler::BeginDraw(u32 index, u8 prim_class, u32 prims, u32 vertices, u32 pixels)
+{
+	PendingDraw& pd = s_pending.emplace_back();
+	pd.record = {};
+	pd.record.index = index;
+	pd.record.prim_class = prim_class;
+	pd.record.prims = prims;
+	pd.record.vertices = vertices;
+	pd.record.pixels = pixels;
+	pd.hardware = false;
+
+	for (GSPerfMon::counter_t counter : s_hw_counters)
+		pd.counters[counter] = g_perfmon.GetTotal(counter);
+
+	Internal::s_current = &pd.record;
+	pd.start = Common::Timer::GetCurrentValue();
+}
+
+void GSDrawProfiler::EndDraw()
+{
+	PendingDraw* pd = GetPendingDraw();
+	if (!pd)
+		return;
+
+	pd->record.cpu_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() - pd->start));
+
+	if (pd->hardware)
+	{
+		const auto delta = [pd](GSPerfMon::counter_t counter) {
+			return static_cast<u32>(g_perfmon.GetTotal(counter) - pd->counters[counter]);
+		};
+		pd->record.draw_calls = delta(GSPerfMon::DrawCalls);
+		pd->record.barriers = delta(GSPerfMon::Barriers);
+		pd->record.texture_uploads = delta(GSPerfMon::TextureUploads);
+		pd->record.texture_copies = delta(GSPerfMon::TextureCopies);
+		pd->record.readbacks = delta(GSPerfMon::Readbacks);
+
+		// The lookup itself doesn't say, but a cached source which had to be refreshed uploads.
+		if (pd->record.texture == TextureLookup::Hit && pd->record.texture_uploads > 0)
+			pd->record.texture = TextureLookup::Upload;
+	}
+
+	Internal::s_current = nullptr;
+}
+
+void GSDrawProfiler::CountHardwareStats()
+{
+	if (PendingDraw* pd = GetPendingDraw())
+		pd->hardware = true;
+}
+
+std::shared_ptr<GSDrawProfiler::RasterStats> GSDrawProfiler::GetRasterStats()
+{
+	PendingDraw* pd = GetPendingDraw();
+	if (!pd)
+		return {};
+
+	if (!pd->raster)
+		pd->raster = std::make_shared<RasterStats>();
+
+	return pd->raster;
+}
+
+void GSDrawProfiler::RequestCapture()
+{
+	if (s_state == State::Idle)
+		s_state = State::Armed;
+}
+
+static void PublishCapture()
+{
+	s_capture.frame = s_pending_frame;
+	s_capture.gpu_average_ms = GSConfig.OsdShowGPU ? PerformanceMetrics::GetGPUAverageTime() : 0.0f;
+	s_capture.draws.clear();
+	s_capture.draws.reserve(s_pending.size());
+
+	for (PendingDraw& pd : s_pending)
+	{
+		GSDrawProfiler::DrawRecord& record = s_capture.draws.emplace_back(pd.record);
+		if (pd.raster)
+		{
+			record.pixels = pd.raster->pixels.load(std::memory_order_acquire);
+			record.raster_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(pd.raster->ticks.load(std::memory_order_acquire)));
+		}
+	}
+
+	s_pending.clear();
+	s_pending.shrink_to_fit();
+	s_has_capture = true;
+
+	const std::time_t now = std::time(nullptr);
+	char timestamp[32];
+	std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+	const std::string filename(Path::Combine(EmuFolders::Logs, fmt::format("gsdraws_{}.csv", timestamp)));
+	if (GSDrawProfiler::ExportCSV(filename.c_str(), s_capture))
+	{
+		Host::AddKeyedOSDMessage("GSDrawProfiler",
+			fmt::format("Captured {} draws, saved to '{}'.", s_capture.draws.size(), Path::GetFileName(filename)), 5.0f);
+	}
+}
+
+void GSDrawProfiler::OnVSync()
+{
+	switch (s_state)
+	{
+		case State::Armed:
+			s_pending.clear();
+			s_pending_frame = g_perfmon.GetFrame();
+			Internal::s_recording = true;
+			s_state = State::Recording;
+			break;
+
+		case State::Recording:
+			Internal::s_recording = false;
+			s_state = State::Finishing;
+			break;
+
+		case State::Finishing:
+			PublishCapture();
+			s_state = State::Idle;
+			break;
+
+		case State::Idle:
+		default:
+			break;
+	}
+}
+
+bool GSDrawProfiler::HasCapture()
+{
+	return s_has_capture;
+}
+
+const GSDrawProfiler::Capture& GSDrawProfiler::GetCapture()
+{
+	return s_capture;
+}
+
+void GSDrawProfiler::ClearCapture()
+{
+	s_capture = {};
+	s_has_capture = false;
+}
+
+bool GSDrawProfiler::ExportCSV(const char* filename, const Capture& capture)
+{
+	static constexpr const char* prim_names[] = {"point", "line", "triangle", "sprite"};
+	static constexpr const char* texture_names[] = {"none", "hit", "upload", "target"};
+
+	auto fp = FileSystem::OpenManagedCFile(filename, "wb");
+	if (!fp)
+	{
+		Console.Error("(GSDrawProfiler) Failed to open '%s' for writing", filename);
+		return false;
+	}
+
+	std::fprintf(fp.get(), "# frame %llu, %zu draws, average GPU time %.3f ms\n", static_cast<unsigned long long>(capture.frame), capture.draws.size(), capture.gpu_average_ms);
+	std::fputs("draw,prim,prims,vertices,pixels,selector,texture,draw_calls,barriers,texture_uploads,texture_copies,readbacks,cpu_ms,raster_ms\n", fp.get());
+	for (const DrawRecord& d : capture.draws)
+	{
+		std::fprintf(fp.get(), "%u,%s,%u,%u,%u,%08X%016llX,%s,%u,%u,%u,%u,%u,%.4f,%.4f\n", d.index,
+			(d.prim_class < std::size(prim_names)) ? prim_names[d.prim_class] : "invalid", d.prims, d.vertices, d.pixels,
+			d.selector_hi, static_cast<unsigned long long>(d.selector), texture_names[static_cast<u8>(d.texture)], d.draw_calls, d.barriers,
+			d.texture_uploads, d.texture_copies, d.readbacks, d.cpu_ms, d.raster_ms);
+	}
+
+	if (std::ferror(fp.get()))
+	{
+		Console.Error("(GSDrawProfiler) Failed to write '%s'", filename);
+		return false;
+	}
+
+	DevCon.WriteLn("(GSDrawProfiler) Wrote %zu draws of frame %llu to '%s'", capture.draws.size(),
+		static_cast<unsigned long long>(capture.frame), filename);
+	return true;
+}
@@ -0,0 +1,108 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Records every draw of a single frame, to find out which of them are expensive.
+//
+// GSState::FlushPrim() wraps each draw, and the renderers fill in what only they know: the selector
+// of the pipeline which drew it, what the texture cache had to do, and for the software renderer the
+// time the rasterizer workers spent on it. Everything runs on the GS thread, apart from the rasterizer
+// stats, which the workers accumulate into RasterStats.
+namespace GSDrawProfiler
+{
+	enum class TextureLookup : u8
+	{
+		None, // not textured
+		Hit, // cached and up to date
+		Upload, // new, or had to be updated from GS memory
+		Target, // sampled from a render target
+	};
+
+	struct DrawRecord
+	{
+		u32 index; // GSState::s_n, matches the numbering of GS dumps
+		u8 prim_class; // GS_PRIM_CLASS
+		TextureLookup texture;
+		u32 prims;
+		u32 vertices;
+		u32 pixels; // rasterized by the SW renderer, bounding box area clipped to the scissor for HW
+		u64 selector; // GSScanlineSelector for SW, low bits of the pixel shader selector for HW
+		u32 selector_hi;
+
+		// HW only, GSPerfMon counters during the draw.
+		u32 draw_calls;
+		u32 barriers;
+		u32 texture_uploads;
+		u32 texture_copies;
+		u32 readbacks;
+
+		float cpu_ms; // on the GS thread
+		float raster_ms; // SW only, summed over all the rasterizer workers
+	};
+
+	struct Capture
+	{
+		u64 frame;
+		float gpu_average_ms; // per frame around the capture, 0 if GPU timing is off
+		std::vector<DrawRecord> draws;
+	};
+
+	// Filled in by the rasterizer workers while the draw is in flight.
+	struct RasterStats
+	{
+		std::atomic<u64> ticks{0};
+		std::atomic<u32> pixels{0};
+	};
+
+	namespace Internal
+	{
+		extern bool s_recording;
+		extern DrawRecord* s_current;
+	} // namespace Internal
+
+	__fi bool IsRecording() { return Internal::s_recording; }
+
+	/// The draw being recorded, or null. Only valid between BeginDraw() and EndDraw().
+	__fi DrawRecord* GetCurrentDraw() { return Internal::s_current; }
+
+	void BeginDraw(u32 index, u8 prim_class, u32 prims, u32 vertices, u32 pixels);
+	void EndDraw();
+
+	/// Called by the hardware renderers, fills in the GSPerfMon counters of the current draw.
+	void CountHardwareStats();
+
+	/// Stats the rasterizer workers should add to for the current draw.
+	std::shared_ptr<RasterStats> GetRasterStats();
+
+	/// Records the frame after the next vsync.
+	void RequestCapture();
+
+	/// Starts and ends recording. Captures are complete one vsync after recording ends, so the
+	/// software renderer's workers are done with the last draws.
+	void OnVSync();
+
+	bool HasCapture();
+	const Capture& GetCapture();
+	void ClearCapture();
+
+	bool ExportCSV(const char* filename, const Capture& capture);
+} // namespace GSDrawProfiler
@@ -18,6 +18,7 @@
 #include "common/AlignedMalloc.h"
 #include "common/FileSystem.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 
 #include "GSDump.h"
 #include "GSLzma.h"
@@ -42,6 +43,8 @@ void GSDumpFile::Repack(void* ptr, size_t size)
 
 GSDumpFile::~GSDumpFile()
 {
+	StopStreaming();
+
 	if (m_fp)
 		fclose(m_fp);
 	if (m_repack_fp)
@@ -114,14 +117,21 @@ bool GSDumpFile::GetPreviewImageFromDump(const char* filename, u32* width, u32*
 	return true;
 }
 
-bool GSDumpFile::ReadFile()
+size_t GSDumpFile::ReadBytes(void* ptr, size_t size)
+{
+	const size_t read = Read(ptr, size);
+	m_position += read;
+	return read;
+}
+
+bool GSDumpFile::ReadHeader()
 {
 	u32 ss;
-	if (Read(&m_crc, sizeof(m_crc)) != sizeof(m_crc) || Read(&ss, sizeof(ss)) != sizeof(ss))
+	if (ReadBytes(&m_crc, sizeof(m_crc)) != sizeof(m_crc) || ReadBytes(&ss, sizeof(ss)) != sizeof(ss))
 		return false;
 
 	m_state_data.resize(ss);
-	if (Read(m_state_data.data(), ss) != ss)
+	if (ReadBytes(m_state_data.data(), ss) != ss)
 		return false;
 
 	// Pull serial out of new header, if present.
@@ -152,12 +162,22 @@ bool GSDumpFile::ReadFile()
 
 		// Read the real state data
 		m_state_data.resize(header.state_size);
-		if (Read(m_state_data.data(), header.state_size) != header.state_size)
+		if (ReadBytes(m_state_data.data(), header.state_size) != header.state_size)
 			return false;
 	}
 
 	m_regs_data.resize(8192);
-	if (Read(m_regs_data.data(), m_regs_data.size()) != m_regs_data.size())
+	if (ReadBytes(m_regs_data.data(), m_regs_data.size()) != m_regs_data.size())
+		return false;
+
+	m_frame_index.clear();
+	m_frame_index.push_back({m_position, 0});
+	return true;
+}
+
+bool GSDumpFile::ReadFile()
+{
+	if (!ReadHeader())
 		return false;
 
 	// read all the packet data in
@@ -168,7 +188,7 @@ bool GSDumpFile::ReadFile()
 		m_packet_data.resize(std::max<size_t>(packet_data_size * 2, 8 * _1mb));
 
 		const size_t read_size = m_packet_data.size() - packet_data_size;
-		const size_t read = Read(m_packet_data.data() + packet_data_size, read_size);
+		const size_t read = ReadBytes(m_packet_data.data() + packet_data_size, read_size);
 		if (read != read_size)
 		{
 			if (!IsEof())
@@ -253,6 +273,251 @@ bool GSDumpFile::ReadFile()
 	return true;
 }
 
+bool GSDumpFile::Seek(u64 offset)
+{
+	if (offset < m_position)
+	{
+		if (!Rewind())
+			return false;
+
+		m_position = 0;
+	}
+
+	ByteArray scratch(std::min<u64>(offset - m_position, 256 * _1kb));
+	while (m_position < offset)
+	{
+		const size_t size = static_cast<size_t>(std::min<u64>(offset - m_position, scratch.size()));
+		if (ReadBytes(scratch.data(), size) != size)
+			return false;
+	}
+
+	return true;
+}
+
+bool GSDumpFile::ReadPacket(GSData* packet, ByteArray* data)
+{
+	*packet = {};
+	packet->path = GSTransferPath::Dummy;
+	if (ReadBytes(&packet->id, sizeof(packet->id)) != sizeof(packet->id))
+		return false;
+
+	switch (packet->id)
+	{
+		case GSType::Transfer:
+		{
+			u32 length;
+			if (ReadBytes(&packet->path, sizeof(packet->path)) != sizeof(packet->path) ||
+				ReadBytes(&length, sizeof(length)) != sizeof(length))
+			{
+				return false;
+			}
+			packet->length = length;
+		}
+		break;
+		case GSType::VSync:
+			packet->length = 1;
+			break;
+		case GSType::ReadFIFO2:
+			packet->length = 4;
+			break;
+		case GSType::Registers:
+			packet->length = 8192;
+			break;
+		default:
+			Console.Error("(GSDump) Unknown packet type %u", static_cast<u32>(packet->id));
+			return false;
+	}
+
+	const size_t offset = data->size();
+	data->resize(offset + packet->length);
+	const size_t read = ReadBytes(data->data() + offset, packet->length);
+	if (read != packet->length)
+	{
+		// Same as ReadFile(), drop the truncated packet at the end of "bad" dumps.
+		Console.Error("(GSDump) Dropping last packet of %u bytes (we only have %u bytes)",
+			static_cast<u32>(packet->length), static_cast<u32>(read));
+		data->resize(offset);
+		return false;
+	}
+
+	return true;
+}
+
+void GSDumpFile::StartStreaming()
+{
+	pxAssert(!m_stream_thread.joinable() && !m_frame_index.empty());
+
+	m_stream_stop = false;
+	m_stream_end = false;
+	m_stream_thread = std::thread(&GSDumpFile::StreamThread, this);
+}
+
+void GSDumpFile::StopStreaming()
+{
+	if (!m_stream_thread.joinable())
+		return;
+
+	{
+		std::unique_lock lock(m_stream_mutex);
+		m_stream_stop = true;
+		m_space_cv.notify_one();
+	}
+
+	m_stream_thread.join();
+
+	m_chunks.clear();
+	m_queued_bytes = 0;
+	m_current_chunk.reset();
+	m_current_index = 0;
+}
+
+bool GSDumpFile::PushChunk(std::unique_ptr<PacketChunk> chunk)
+{
+	// Pointers can only be filled in once the buffer is done growing.
+	const u8* data = chunk->data.data();
+	for (GSData& packet : chunk->packets)
+	{
+		packet.data = data;
+		data += packet.length;
+	}
+
+	std::unique_lock lock(m_stream_mutex);
+	m_space_cv.wait(lock, [this]() { return m_stream_stop || m_queued_bytes < STREAM_WINDOW_SIZE; });
+	if (m_stream_stop)
+		return false;
+
+	m_queued_bytes += chunk->data.size();
+	m_chunks.push_back(std::move(chunk));
+	m_chunk_cv.notify_one();
+	return true;
+}
+
+void GSDumpFile::StreamThread()
+{
+	Threading::SetNameOfCurrentThread("GS Dump Reader");
+
+	std::unique_ptr<PacketChunk> chunk;
+	ByteArray skipped;
+	GSData packet;
+
+	try
+	{
+		for (;;)
+		{
+			if (!chunk)
+			{
+				chunk = std::make_unique<PacketChunk>();
+				chunk->data.reserve(STREAM_CHUNK_SIZE);
+			}
+
+			const bool skip = (m_next_frame < m_skip_to_frame);
+			if (skip)
+				skipped.clear();
+
+			if (!ReadPacket(&packet, skip ? &skipped : &chunk->data))
+				break;
+
+			if (!skip)
+				chunk->packets.push_back(packet);
+
+			m_next_packet++;
+			if (packet.id == GSType::VSync)
+			{
+				m_next_frame++;
+
+				std::unique_lock lock(m_stream_mutex);
+				if (m_next_frame == m_frame_index.size())
+					m_frame_index.push_back({m_position, m_next_packet});
+			}
+
+			if (chunk->data.size() >= STREAM_CHUNK_SIZE && !PushChunk(std::move(chunk)))
+				return;
+		}
+	}
+	catch (const char*)
+	{
+		// The decompressors throw on errors, treat whatever we got up to that as the whole dump.
+		Console.Error("(GSDump) Failed to decompress packet %u", m_next_packet);
+	}
+
+	if (chunk && !chunk->packets.empty() && !PushChunk(std::move(chunk)))
+		return;
+
+	std::unique_lock lock(m_stream_mutex);
+	if (!IsEof())
+		Console.Error("(GSDump) Stopped reading at packet %u, the dump is corrupted", m_next_packet);
+	m_packet_count = std::max(m_packet_count, m_next_packet);
+	m_stream_end = true;
+	m_chunk_cv.notify_one();
+}
+
+const GSDumpFile::GSData* GSDumpFile::GetNextPacket()
+{
+	for (;;)
+	{
+		if (m_current_chunk && m_current_index < m_current_chunk->packets.size())
+			return &m_current_chunk->packets[m_current_index++];
+
+		std::unique_lock lock(m_stream_mutex);
+		if (m_current_chunk)
+		{
+			m_queued_bytes -= m_current_chunk->data.size();
+			m_current_chunk.reset();
+			m_space_cv.notify_one();
+		}
+
+		if (!m_stream_thread.joinable())
+			return nullptr;
+
+		m_chunk_cv.wait(lock, [this]() { return !m_chunks.empty() || m_stream_end; });
+		if (m_chunks.empty())
+			return nullptr;
+
+		m_current_chunk = std::move(m_chunks.front());
+		m_current_index = 0;
+		m_chunks.pop_front();
+	}
+}
+
+void GSDumpFile::SeekToFrame(u32 frame)
+{
+	StopStreaming();
+
+	FrameIndexEntry start;
+	{
+		std::unique_lock lock(m_stream_mutex);
+		m_next_frame = std::min<u32>(frame, static_cast<u32>(m_frame_index.size() - 1));
+		start = m_frame_index[m_next_frame];
+	}
+
+	m_next_packet = start.packet;
+	m_skip_to_frame = frame;
+
+	try
+	{
+		if (!Seek(start.offset))
+		{
+			Console.Error("(GSDump) Failed to seek to frame %u", m_next_frame);
+			m_stream_end = true;
+			return;
+		}
+	}
+	catch (const char*)
+	{
+		Console.Error("(GSDump) Failed to decompress up to frame %u", m_next_frame);
+		m_stream_end = true;
+		return;
+	}
+
+	StartStreaming();
+}
+
+u32 GSDumpFile::GetPacketCount()
+{
+	std::unique_lock lock(m_stream_mutex);
+	return m_packet_count;
+}
+
 /******************************************************************/
 GSDumpLzma::GSDumpLzma(FILE* file, FILE* repack_file)
 	: GSDumpFile(file, repack_file)
@@ -352,8 +617,23 @@ size_t GSDumpLzma::Read(void* ptr, size_t size)
 	return off;
 }
 
+bool GSDumpLzma::Rewind()
+{
+	lzma_end(&m_strm);
+	_aligned_free(m_inbuf);
+	_aligned_free(m_area);
+
+	if (FileSystem::FSeek64(m_fp, 0, SEEK_SET) != 0)
+		return false;
+
+	Initialize();
+	return true;
+}
+
 GSDumpLzma::~GSDumpLzma()
 {
+	StopStreaming();
+
 	lzma_end(&m_strm);
 
 	if (m_inbuf)
@@ -441,8 +721,23 @@ size_t GSDumpDecompressZst::Read(void* ptr, size_t size)
 	return off;
 }
 
+bool GSDumpDecompressZst::Rewind()
+{
+	if (FileSystem::FSeek64(m_fp, 0, SEEK_SET) != 0)
+		return false;
+
+	ZSTD_DCtx_reset(m_strm, ZSTD_reset_session_only);
+	m_inbuf.pos = 0;
+	m_inbuf.size = 0;
+	m_avail = 0;
+	m_start = 0;
+	return true;
+}
+
 GSDumpDecompressZst::~GSDumpDecompressZst()
 {
+	StopStreaming();
+
 	ZSTD_freeDStream(m_strm);
 
 	if (m_inbuf.src)
@@ -458,6 +753,11 @@ GSDumpRaw::GSDumpRaw(FILE* file, FILE* repack_file)
 {
 }
 
+GSDumpRaw::~GSDumpRaw()
+{
+	StopStreaming();
+}
+
 bool GSDumpRaw::IsEof()
 {
 	return !!feof(m_fp);
@@ -477,3 +777,18 @@ size_t GSDumpRaw::Read(void* ptr, size_t size)
 
 	return ret;
 }
+
+bool GSDumpRaw::Rewind()
+{
+	return (FileSystem::FSeek64(m_fp, 0, SEEK_SET) == 0);
+}
+
+bool GSDumpRaw::Seek(u64 offset)
+{
+	// Nothing to decode, the file is the data.
+	if (FileSystem::FSeek64(m_fp, static_cast<s64>(offset), SEEK_SET) != 0)
+		return false;
+
+	m_position = offset;
+	return true;
+}
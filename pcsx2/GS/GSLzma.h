@@ -15,8 +15,12 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <lzma.h>
@@ -313,19 +317,66 @@ public:
 	__fi const ByteArray& GetStateData() const { return m_state_data; }
 	__fi const GSDataArray& GetPackets() const { return m_dump_packets; }
 
+	/// Reads everything in front of the packets: CRC, serial, GS state and registers.
+	bool ReadHeader();
+
+	/// Reads the header and every packet into memory, for tools which need random access to them.
 	bool ReadFile();
 
+	/// Decodes the packets following the header on a worker thread, keeping at most STREAM_WINDOW_SIZE
+	/// bytes of them ahead of the consumer.
+	void StartStreaming();
+	void StopStreaming();
+
+	/// Returns the next packet of the stream, valid until the next call, or nullptr at the end of the dump.
+	const GSData* GetNextPacket();
+
+	/// Continues the stream from the first packet of the given frame. Frames which aren't indexed yet
+	/// still have to be decoded, but their packets are dropped instead of going through the window.
+	void SeekToFrame(u32 frame);
+
+	/// Number of packets in the dump, 0 until the stream has reached the end once.
+	u32 GetPacketCount();
+
 protected:
 	GSDumpFile(FILE* file, FILE* repack_file);
 
 	virtual bool IsEof() = 0;
 	virtual size_t Read(void* ptr, size_t size) = 0;
 
+	/// Goes back to the start of the file, resetting the decoder.
+	virtual bool Rewind() = 0;
+
+	/// Moves to the given offset in the decompressed data. Compressed dumps can't do better than
+	/// decoding their way there, starting over if it's behind the current position.
+	virtual bool Seek(u64 offset);
+
 	void Repack(void* ptr, size_t size);
 
 	FILE* m_fp = nullptr;
+	u64 m_position = 0; // in the decompressed data
 
 private:
+	static constexpr size_t STREAM_CHUNK_SIZE = 1 * _1mb;
+	static constexpr size_t STREAM_WINDOW_SIZE = 64 * _1mb;
+
+	struct PacketChunk
+	{
+		ByteArray data;
+		GSDataArray packets;
+	};
+
+	struct FrameIndexEntry
+	{
+		u64 offset; // in the decompressed data
+		u32 packet;
+	};
+
+	size_t ReadBytes(void* ptr, size_t size);
+	bool ReadPacket(GSData* packet, ByteArray* data);
+	void StreamThread();
+	bool PushChunk(std::unique_ptr<PacketChunk> chunk);
+
 	FILE* m_repack_fp = nullptr;
 
 	std::string m_serial;
@@ -336,6 +387,28 @@ private:
 	std::vector<u8> m_packet_data;
 
 	GSDataArray m_dump_packets;
+
+	// Owned by the stream thread while it runs.
+	u32 m_next_packet = 0;
+	u32 m_next_frame = 0;
+	u32 m_skip_to_frame = 0;
+
+	std::thread m_stream_thread;
+	std::mutex m_stream_mutex;
+	std::condition_variable m_chunk_cv;
+	std::condition_variable m_space_cv;
+	std::deque<std::unique_ptr<PacketChunk>> m_chunks;
+	size_t m_queued_bytes = 0;
+	bool m_stream_stop = false;
+	bool m_stream_end = false;
+
+	// Start of every frame seen so far, protected by m_stream_mutex.
+	std::vector<FrameIndexEntry> m_frame_index;
+	u32 m_packet_count = 0;
+
+	// Only touched by the consumer.
+	std::unique_ptr<PacketChunk> m_current_chunk;
+	size_t m_current_index = 0;
 };
 
 class GSDumpLzma : public GSDumpFile
@@ -358,6 +431,7 @@ public:
 
 	bool IsEof() final;
 	size_t Read(void* ptr, size_t size) final;
+	bool Rewind() final;
 };
 
 class GSDumpDecompressZst : public GSDumpFile
@@ -382,14 +456,17 @@ public:
 
 	bool IsEof() final;
 	size_t Read(void* ptr, size_t size) final;
+	bool Rewind() final;
 };
 
 class GSDumpRaw : public GSDumpFile
 {
 public:
 	GSDumpRaw(FILE* file, FILE* repack_file);
-	virtual ~GSDumpRaw() = default;
+	virtual ~GSDumpRaw();
 
 	bool IsEof() final;
 	size_t Read(void* ptr, size_t size) final;
+	bool Rewind() final;
+	bool Seek(u64 offset) final;
 };
@@ -30,6 +30,9 @@ public:
 		Quad,
 		SyncPoint,
 		Barriers,
+		Invalidations,
+		InvalidationTargets, // targets looked at by the invalidations
+		InvalidationTime, // ms spent invalidating the texture cache
 		CounterLast,
 
 		// Reused counters for HW.
@@ -40,6 +43,7 @@ public:
 protected:
 	double m_counters[CounterLast] = {};
 	double m_stats[CounterLast] = {};
+	double m_totals[CounterLast] = {};
 	u64 m_frame = 0;
 	clock_t m_lastframe = 0;
 	int m_count = 0;
@@ -56,6 +60,8 @@ public:
 
 	void Put(counter_t c, double val) { m_counters[c] += val; }
 	double Get(counter_t c) { return m_stats[c]; }
+	/// Sum of a counter since the last Reset(), rather than the average per frame.
+	double GetTotal(counter_t c) { return m_totals[c] + m_counters[c]; }
 	void Update();
 
 	__fi void AddDisplayFramebufferSpriteBlit() { m_disp_fb_sprite_blits++; }
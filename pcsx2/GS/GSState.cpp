@@ -15,6 +15,7 @@
 
 #include "PrecompiledHeader.h"
 #include "GSState.h"
+#include "GSDrawProfiler.h"
 #include "GSGL.h"
 #include "GSUtil.h"
 #include "common/StringUtil.h"
@@ -1910,6 +1911,14 @@ void GSState::FlushPrim()
 
 		m_context->SaveReg();
 
+		const bool profile = GSDrawProfiler::IsRecording();
+		if (profile)
+		{
+			const GSVector4i bbox = GSVector4i(m_vt.m_min.p.floor().xyxy(m_vt.m_max.p.ceil())).rintersect(GSVector4i(m_context->scissor.in));
+			GSDrawProfiler::BeginDraw(s_n, static_cast<u8>(m_vt.m_primclass), m_index.tail / GSUtil::GetVertexCount(PRIM->PRIM),
+				static_cast<u32>(m_vertex.next), bbox.rempty() ? 0 : static_cast<u32>(bbox.width() * bbox.height()));
+		}
+
 		try
 		{
 			Draw();
@@ -1925,6 +1934,9 @@ void GSState::FlushPrim()
 			Console.Error("GS: Memory allocation failure.");
 		}
 
+		if (profile)
+			GSDrawProfiler::EndDraw();
+
 		m_context->RestoreReg();
 
 		g_perfmon.Put(GSPerfMon::Draw, 1);
@@ -19,6 +19,32 @@
 #include "GS/GSExtra.h"
 #include "GS/Renderers/SW/GSScanlineEnvironment.h"
 #include "common/emitter/tools.h"
+#include "common/Timer.h"
+
+#include <mutex>
+#include <vector>
+
+// How much code generation was done on demand, and how much ahead of time by Pregenerate().
+struct GSCodeGenStats
+{
+	u32 generated; // on demand, while drawing
+	u32 pregenerated;
+	u32 pregenerated_used; // pregenerated, and then looked up while drawing
+	u64 generate_ticks;
+	u64 pregenerate_ticks;
+	u64 avoided_ticks; // pregeneration time of the functions which were used, i.e. time taken off the draw threads
+
+	GSCodeGenStats& operator+=(const GSCodeGenStats& rhs)
+	{
+		generated += rhs.generated;
+		pregenerated += rhs.pregenerated;
+		pregenerated_used += rhs.pregenerated_used;
+		generate_ticks += rhs.generate_ticks;
+		pregenerate_ticks += rhs.pregenerate_ticks;
+		avoided_ticks += rhs.avoided_ticks;
+		return *this;
+	}
+};
 
 template <class KEY, class VALUE>
 class GSFunctionMap
@@ -142,17 +168,31 @@ public:
 	}
 };
 
+// Functions can be generated ahead of time from another thread with Pregenerate(), m_lock protects
+// everything code generation touches. The draw thread only takes it when a key misses m_map_active.
 template <class CG, class KEY, class VALUE>
 class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>
 {
+	struct GeneratedFunction
+	{
+		VALUE f;
+		u64 ticks;
+		bool pregenerated;
+		bool used;
+	};
+
 	std::string m_name;
 	void* m_param;
-	std::unordered_map<u64, VALUE> m_cgmap;
+	std::mutex m_lock;
+	std::unordered_map<u64, GeneratedFunction> m_cgmap;
 	GSCodeBuffer m_cb;
 	size_t m_total_code_size;
+	GSCodeGenStats m_stats = {};
 
 	enum { MAX_SIZE = 8192 };
 
+	GeneratedFunction& Generate(KEY key, bool pregenerate);
+
 public:
 	GSCodeGeneratorFunctionMap(const char* name, void* param)
 		: m_name(name)
@@ -170,78 +210,149 @@ public:
 
 	VALUE GetDefaultFunction(KEY key)
 	{
-		VALUE ret = NULL;
+		std::unique_lock lock(m_lock);
 
 		auto i = m_cgmap.find(key);
 
 		if (i != m_cgmap.end())
 		{
-			ret = i->second;
+			GeneratedFunction& gf = i->second;
+			if (gf.pregenerated && !gf.used)
+			{
+				m_stats.pregenerated_used++;
+				m_stats.avoided_ticks += gf.ticks;
+			}
+
+			gf.used = true;
+			return gf.f;
 		}
-		else
+
+		GeneratedFunction& gf = Generate(key, false);
+		gf.used = true;
+		return gf.f;
+	}
+
+	/// Generates the function for key unless it already exists. Can be called from any thread.
+	void Pregenerate(KEY key)
+	{
+		std::unique_lock lock(m_lock);
+
+		if (m_cgmap.find(key) == m_cgmap.end())
+			Generate(key, true);
+	}
+
+	/// Returns the keys of all the functions which were looked up for drawing.
+	std::vector<u64> GetUsedKeys()
+	{
+		std::unique_lock lock(m_lock);
+
+		std::vector<u64> keys;
+		for (const auto& it : m_cgmap)
 		{
-			void* code_ptr = m_cb.GetBuffer(MAX_SIZE);
+			if (it.second.used)
+				keys.push_back(it.first);
+		}
 
-			CG* cg = new CG(m_param, key, code_ptr, MAX_SIZE);
-			ASSERT(cg->getSize() < MAX_SIZE);
+		return keys;
+	}
+
+	GSCodeGenStats GetCodeGenStats()
+	{
+		std::unique_lock lock(m_lock);
+		return m_stats;
+	}
+
+	void PrintStats() override
+	{
+		GSFunctionMap<KEY, VALUE>::PrintStats();
+
+		const GSCodeGenStats stats = GetCodeGenStats();
+		printf("%s: %u generated while drawing (%.2f ms), %u pregenerated (%.2f ms), %u of those used (%.2f ms of codegen avoided)\n",
+			m_name.c_str(), stats.generated, Common::Timer::ConvertValueToMilliseconds(stats.generate_ticks), stats.pregenerated,
+			Common::Timer::ConvertValueToMilliseconds(stats.pregenerate_ticks), stats.pregenerated_used,
+			Common::Timer::ConvertValueToMilliseconds(stats.avoided_ticks));
+	}
+};
+
+template <class CG, class KEY, class VALUE>
+typename GSCodeGeneratorFunctionMap<CG, KEY, VALUE>::GeneratedFunction& GSCodeGeneratorFunctionMap<CG, KEY, VALUE>::Generate(KEY key, bool pregenerate)
+{
+	const u64 start = Common::Timer::GetCurrentValue();
+	void* code_ptr = m_cb.GetBuffer(MAX_SIZE);
+
+	CG* cg = new CG(m_param, key, code_ptr, MAX_SIZE);
+	ASSERT(cg->getSize() < MAX_SIZE);
 
 #if 0
-			fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg->getSize(), (u64)key);
-			GSScanlineSelector sel(key);
-			sel.Print();
+	fprintf(stderr, "%s Location:%p Size:%zu Key:%llx\n", m_name.c_str(), code_ptr, cg->getSize(), (u64)key);
+	GSScanlineSelector sel(key);
+	sel.Print();
 #endif
 
-			m_total_code_size += cg->getSize();
-
-			m_cb.ReleaseBuffer(cg->getSize());
+	m_total_code_size += cg->getSize();
 
-			ret = (VALUE)cg->getCode();
+	m_cb.ReleaseBuffer(cg->getSize());
 
-			m_cgmap[key] = ret;
+	const VALUE ret = (VALUE)cg->getCode();
 
 #ifdef ENABLE_VTUNE
 
-			// vtune method registration
+	// vtune method registration
 
-			// if(iJIT_IsProfilingActive()) // always > 0
-			{
-				std::string name = fmt::format("%s<%016llx>()", m_name.c_str(), (u64)key);
+	// if(iJIT_IsProfilingActive()) // always > 0
+	{
+		std::string name = fmt::format("%s<%016llx>()", m_name.c_str(), (u64)key);
 
-				iJIT_Method_Load ml;
+		iJIT_Method_Load ml;
 
-				memset(&ml, 0, sizeof(ml));
+		memset(&ml, 0, sizeof(ml));
 
-				ml.method_id = iJIT_GetNewMethodID();
-				ml.method_name = (char*)name.c_str();
-				ml.method_load_address = (void*)cg->getCode();
-				ml.method_size = (unsigned int)cg->getSize();
+		ml.method_id = iJIT_GetNewMethodID();
+		ml.method_name = (char*)name.c_str();
+		ml.method_load_address = (void*)cg->getCode();
+		ml.method_size = (unsigned int)cg->getSize();
 
-				iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, &ml);
+		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, &ml);
 /*
-				name = format("c:/temp1/%s_%016llx.bin", m_name.c_str(), (u64)key);
+		name = format("c:/temp1/%s_%016llx.bin", m_name.c_str(), (u64)key);
 
-				if(FILE* fp = fopen(name.c_str(), "wb"))
-				{
-					fputc(0x0F, fp); fputc(0x0B, fp);
-					fputc(0xBB, fp); fputc(0x6F, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
-					fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
+		if(FILE* fp = fopen(name.c_str(), "wb"))
+		{
+			fputc(0x0F, fp); fputc(0x0B, fp);
+			fputc(0xBB, fp); fputc(0x6F, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
+			fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
 
-					fwrite(cg->getCode(), cg->getSize(), 1, fp);
+			fwrite(cg->getCode(), cg->getSize(), 1, fp);
 
-					fputc(0xBB, fp); fputc(0xDE, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
-					fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
-					fputc(0x0F, fp); fputc(0x0B, fp);
+			fputc(0xBB, fp); fputc(0xDE, fp); fputc(0x00, fp); fputc(0x00, fp); fputc(0x00, fp);
+			fputc(0x64, fp); fputc(0x67, fp); fputc(0x90, fp);
+			fputc(0x0F, fp); fputc(0x0B, fp);
 
-					fclose(fp);
-				}
+			fclose(fp);
+		}
 */
-			}
+	}
 
 #endif
 
-			delete cg;
-		}
+	delete cg;
 
-		return ret;
+	const u64 ticks = Common::Timer::GetCurrentValue() - start;
+	if (pregenerate)
+	{
+		m_stats.pregenerated++;
+		m_stats.pregenerate_ticks += ticks;
 	}
-};
+	else
+	{
+		m_stats.generated++;
+		m_stats.generate_ticks += ticks;
+	}
+
+	GeneratedFunction& gf = m_cgmap[key];
+	gf.f = ret;
+	gf.ticks = ticks;
+	gf.pregenerated = pregenerate;
+	gf.used = false;
+	return gf;
+}
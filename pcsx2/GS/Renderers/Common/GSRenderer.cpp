@@ -15,7 +15,9 @@
 
 #include "PrecompiledHeader.h"
 #include "GSRenderer.h"
+#include "GS/GSDrawProfiler.h"
 #include "GS/GSGL.h"
+#include "GS/GSXXH.h"
 #include "Host.h"
 #include "HostDisplay.h"
 #include "PerformanceMetrics.h"
@@ -627,6 +629,8 @@ void GSRenderer::VSync(u32 field, bool registers_written)
 {
 	Flush(GSFlushReason::VSYNC);
 
+	GSDrawProfiler::OnVSync();
+
 	if (s_dump && s_n >= s_saven)
 	{
 		m_regs->Dump(root_sw + StringUtil::StdStringFromFormat("%05d_f%lld_gs_reg.txt", s_n, g_perfmon.GetFrame()));
@@ -734,6 +738,21 @@ void GSRenderer::VSync(u32 field, bool registers_written)
 	g_gs_device->RestoreAPIState();
 	PerformanceMetrics::Update(registers_written, fb_sprite_frame, false);
 
+	if (m_frame_hash_callback)
+	{
+		// internal resolution, without aspect correction, that's what the renderer produced
+		u32 frame_width, frame_height;
+		std::vector<u32> frame_pixels;
+		const u64 frame_hash = (!blank_frame && SaveSnapshotToMemory(0, 0, false, false, &frame_width, &frame_height, &frame_pixels)) ?
+								   GSXXH3_64bits(frame_pixels.data(), frame_pixels.size() * sizeof(u32)) : 0;
+		const u64 vram_hash = GSXXH3_64bits(m_mem.m_vm8, GSLocalMemory::m_vmsize);
+
+		// may queue a snapshot of this frame
+		std::function<void(u64, u64)> callback(std::move(m_frame_hash_callback));
+		m_frame_hash_callback = {};
+		callback(frame_hash, vram_hash);
+	}
+
 	// snapshot
 	// wx is dumb and call this from the UI thread...
 #ifndef PCSX2_CORE
@@ -849,6 +868,14 @@ void GSRenderer::VSync(u32 field, bool registers_written)
 #endif
 }
 
+void GSRenderer::QueueFrameHash(std::function<void(u64, u64)> callback)
+{
+	if (m_frame_hash_callback)
+		return;
+
+	m_frame_hash_callback = std::move(callback);
+}
+
 void GSRenderer::QueueSnapshot(const std::string& path, u32 gsdump_frames)
 {
 	if (!m_snapshot.empty())
@@ -40,6 +40,7 @@ private:
 #endif
 	std::string m_snapshot;
 	u32 m_dump_frames = 0;
+	std::function<void(u64, u64)> m_frame_hash_callback;
 	u32 m_skipped_duplicate_frames = 0;
 
 protected:
@@ -70,6 +71,7 @@ public:
 		u32* width, u32* height, std::vector<u32>* pixels);
 
 	void QueueSnapshot(const std::string& path, u32 gsdump_frames);
+	void QueueFrameHash(std::function<void(u64, u64)> callback);
 	void StopGSDump();
 	void PresentCurrentFrame();
 
@@ -16,6 +16,7 @@
 #include "PrecompiledHeader.h"
 #include "GSRendererHW.h"
 #include "GSTextureReplacements.h"
+#include "GS/GSDrawProfiler.h"
 #include "GS/GSGL.h"
 #include "Host.h"
 #include "common/Align.h"
@@ -1293,6 +1294,10 @@ void GSRendererHW::Draw()
 		DumpVertices(m_dump_root + s);
 	}
 
+	GSDrawProfiler::DrawRecord* const profile = GSDrawProfiler::GetCurrentDraw();
+	if (profile)
+		GSDrawProfiler::CountHardwareStats();
+
 	if (IsBadFrame())
 	{
 		GL_INS("Warning skipping a draw call (%d)", s_n);
@@ -1553,6 +1558,9 @@ void GSRendererHW::Draw()
 			m_tc->LookupSource(TEX0, env.TEXA, tmm.coverage, (GSConfig.HWMipmap >= HWMipmapLevel::Basic ||
 				GSConfig.TriFilter == TriFiltering::Forced) ? &hash_lod_range : nullptr);
 
+		if (profile && m_src)
+			profile->texture = m_src->m_target ? GSDrawProfiler::TextureLookup::Target : GSDrawProfiler::TextureLookup::Hit;
+
 		const int tw = 1 << TEX0.TW;
 		const int th = 1 << TEX0.TH;
 #if 0
@@ -3957,6 +3965,12 @@ void GSRendererHW::DrawPrims(GSTexture* rt, GSTexture* ds, GSTextureCache::Sourc
 
 	m_conf.drawlist = (m_conf.require_full_barrier && m_vt.m_primclass == GS_SPRITE_CLASS) ? &m_drawlist : nullptr;
 
+	if (GSDrawProfiler::DrawRecord* profile = GSDrawProfiler::GetCurrentDraw())
+	{
+		profile->selector = m_conf.ps.key_lo;
+		profile->selector_hi = m_conf.ps.key_hi;
+	}
+
 	g_gs_device->RenderHW(m_conf);
 }
 
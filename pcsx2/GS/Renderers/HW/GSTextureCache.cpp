@@ -23,8 +23,42 @@
 #include "GS/GSXXH.h"
 #include "common/Align.h"
 #include "common/HashCombine.h"
+#include "common/Timer.h"
 
 u8* GSTextureCache::m_temp;
+u32 GSTextureCache::s_target_ranges_version = 1;
+
+namespace
+{
+	// Adds the time spent invalidating to the per-frame stats.
+	class ScopedInvalidationTimer
+	{
+	public:
+		ScopedInvalidationTimer()
+			: m_start(Common::Timer::GetCurrentValue())
+		{
+		}
+
+		~ScopedInvalidationTimer()
+		{
+			g_perfmon.Put(GSPerfMon::Invalidations, 1);
+			g_perfmon.Put(GSPerfMon::InvalidationTime, Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() - m_start));
+		}
+
+	private:
+		u64 m_start;
+	};
+} // namespace
+
+/// Last block a transfer to rect can touch, including the rows below it where InvalidateVideoMem() looks
+/// for targets starting in the middle of the transfer. Overestimates, but that only costs a few more checks.
+static u32 GetTransferEndBlock(u32 bp, u32 bw, u32 psm, const GSVector4i& rect)
+{
+	const GSVector2i& pgs = GSLocalMemory::m_psm[psm].pgs;
+	const u32 rows = (static_cast<u32>(std::max(rect.w, 0)) + pgs.y - 1) / pgs.y;
+	const u32 cols = (static_cast<u32>(std::max(rect.z, 0)) + pgs.x - 1) / pgs.x;
+	return bp + (rows * std::max(bw, 1u) + cols) * 32;
+}
 
 GSTextureCache::GSTextureCache()
 {
@@ -819,6 +853,8 @@ void GSTextureCache::InvalidateVideoMemType(int type, u32 bp)
 // Called each time you want to write to the GS memory
 void GSTextureCache::InvalidateVideoMem(const GSOffset& off, const GSVector4i& rect, bool eewrite, bool target)
 {
+	ScopedInvalidationTimer timer;
+
 	u32 bp = off.bp();
 	u32 bw = off.bw();
 	u32 psm = off.psm();
@@ -959,13 +995,17 @@ void GSTextureCache::InvalidateVideoMem(const GSOffset& off, const GSVector4i& r
 	if (!target)
 		return;
 
+	// Transfers which wrap around the end of memory can hit anything.
+	const u32 end_block = GetTransferEndBlock(bp, bw, psm, r);
+	const u32 start_block = (end_block > MAX_BP) ? 0 : bp;
+
 	for (int type = 0; type < 2; type++)
 	{
 		auto& list = m_dst[type];
-		for (auto i = list.begin(); i != list.end();)
+		FindTargetsInRange(type, start_block, std::min(end_block, MAX_BP));
+		for (const TargetRangeIndex::Range& range : m_dst_candidates)
 		{
-			auto j = i;
-			Target* t = *j;
+			Target* t = range.t;
 
 			// GH: (I think) this code is completely broken. Typical issue:
 			// EE write an alpha channel into 32 bits texture
@@ -1024,14 +1064,12 @@ void GSTextureCache::InvalidateVideoMem(const GSOffset& off, const GSVector4i& r
 					}
 					if (!ComputeSurfaceOffset(off, r, t).is_valid)
 					{
-						i = list.erase(j);
+						list.EraseIndex(range.index);
 						GL_CACHE("TC: Remove Target(%s) %d (0x%x)", to_string(type),
 							t->m_texture ? t->m_texture->GetID() : 0,
 							t->m_TEX0.TBP0);
 						delete t;
 					}
-					else
-						++i;
 					continue;
 				}
 			}
@@ -1044,8 +1082,6 @@ void GSTextureCache::InvalidateVideoMem(const GSOffset& off, const GSVector4i& r
 				t->m_dirty_alpha = false;
 			}
 
-			++i;
-
 			// GH: Try to detect texture write that will overlap with a target buffer
 			// TODO Use ComputeSurfaceOffset below.
 			if (GSUtil::HasSharedBits(psm, t->m_TEX0.PSM))
@@ -1135,9 +1171,11 @@ void GSTextureCache::InvalidateVideoMem(const GSOffset& off, const GSVector4i& r
 // Called each time you want to read from the GS memory
 void GSTextureCache::InvalidateLocalMem(const GSOffset& off, const GSVector4i& r)
 {
+	ScopedInvalidationTimer timer;
+
 	const u32 bp = off.bp();
 	const u32 psm = off.psm();
-	[[maybe_unused]] const u32 bw = off.bw();
+	const u32 bw = off.bw();
 
 	GL_CACHE("TC: InvalidateLocalMem off(0x%x, %u, %s) r(%d, %d => %d, %d)",
 		bp,
@@ -1160,9 +1198,16 @@ void GSTextureCache::InvalidateLocalMem(const GSOffset& off, const GSVector4i& r
 
 		if (!GSConfig.UserHacks_DisableDepthSupport)
 		{
+			FindTargetsInRange(DepthStencil, bp, bp);
+			if (m_dst_candidates.empty())
+				return;
+
 			auto& dss = m_dst[DepthStencil];
 			for (auto it = dss.rbegin(); it != dss.rend(); ++it)  // Iterate targets from LRU to MRU.
 			{
+				if (!IsTargetCandidate(it.Index()))
+					continue;
+
 				Target* t = *it;
 				if (GSUtil::HasSharedBits(bp, psm, t->m_TEX0.TBP0, t->m_TEX0.PSM))
 				{
@@ -1174,6 +1219,13 @@ void GSTextureCache::InvalidateLocalMem(const GSOffset& off, const GSVector4i& r
 		return;
 	}
 
+	// Reads overwrite each other, so they still have to go in list order, but only targets starting
+	// within the transfer can match.
+	const u32 end_block = GetTransferEndBlock(bp, bw, psm, r);
+	FindTargetsInRange(RenderTarget, bp, std::min(end_block, MAX_BP));
+	if (m_dst_candidates.empty())
+		return;
+
 	// This is a shorter but potentially slower version of the below, commented out code.
 	// It works for all the games mentioned below and fixes a couple of other ones as well
 	// (Busen0: Wizardry and Chaos Legion).
@@ -1181,6 +1233,9 @@ void GSTextureCache::InvalidateLocalMem(const GSOffset& off, const GSVector4i& r
 	auto& rts = m_dst[RenderTarget];
 	for (auto it = rts.rbegin(); it != rts.rend(); ++it)  // Iterate targets from LRU to MRU.
 	{
+		if (!IsTargetCandidate(it.Index()))
+			continue;
+
 		Target* t = *it;
 		if (t->m_TEX0.PSM != PSM_PSMZ32 && t->m_TEX0.PSM != PSM_PSMZ24 && t->m_TEX0.PSM != PSM_PSMZ16 && t->m_TEX0.PSM != PSM_PSMZ16S)
 		{
@@ -2228,6 +2283,60 @@ GSTextureCache::Target* GSTextureCache::CreateTarget(const GIFRegTEX0& TEX0, int
 	return t;
 }
 
+void GSTextureCache::FindTargetsInRange(int type, u32 start, u32 end)
+{
+	TargetRangeIndex& index = m_dst_ranges[type];
+	if (index.version != s_target_ranges_version)
+	{
+		index.ranges.clear();
+		for (auto i = m_dst[type].begin(); i != m_dst[type].end(); ++i)
+		{
+			// Targets which haven't been drawn to yet, or wrap around, can still be hit at their first block.
+			Target* t = *i;
+			index.ranges.push_back({t->m_TEX0.TBP0, std::max(t->m_TEX0.TBP0, t->m_end_block), t, i.Index()});
+		}
+
+		std::sort(index.ranges.begin(), index.ranges.end(),
+			[](const TargetRangeIndex::Range& lhs, const TargetRangeIndex::Range& rhs) { return lhs.start < rhs.start; });
+
+		index.max_end.resize(index.ranges.size());
+		u32 max_end = 0;
+		for (size_t i = 0; i < index.ranges.size(); i++)
+		{
+			max_end = std::max(max_end, index.ranges[i].end);
+			index.max_end[i] = max_end;
+		}
+
+		index.version = s_target_ranges_version;
+	}
+
+	// Nothing starting after the end can overlap, and walking back from there, we can stop as soon as
+	// none of the remaining targets reach the start.
+	// Candidates are also stamped by their list index, so IsTargetCandidate() doesn't have to search.
+	m_dst_candidates.clear();
+	if (++m_dst_candidate_mark == 0)
+	{
+		std::fill(m_dst_candidate_marks.begin(), m_dst_candidate_marks.end(), 0);
+		m_dst_candidate_mark = 1;
+	}
+
+	size_t i = std::upper_bound(index.ranges.begin(), index.ranges.end(), end,
+		[](u32 value, const TargetRangeIndex::Range& range) { return value < range.start; }) - index.ranges.begin();
+	for (; i > 0 && index.max_end[i - 1] >= start; i--)
+	{
+		const TargetRangeIndex::Range& range = index.ranges[i - 1];
+		if (range.end < start)
+			continue;
+
+		m_dst_candidates.push_back(range);
+		if (range.index >= m_dst_candidate_marks.size())
+			m_dst_candidate_marks.resize(range.index + 1u, 0);
+		m_dst_candidate_marks[range.index] = m_dst_candidate_mark;
+	}
+
+	g_perfmon.Put(GSPerfMon::InvalidationTargets, static_cast<double>(m_dst_candidates.size()));
+}
+
 void GSTextureCache::Read(Target* t, const GSVector4i& r)
 {
 	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
@@ -2753,6 +2862,13 @@ GSTextureCache::Target::Target(const GIFRegTEX0& TEX0, const bool depth_supporte
 	m_TEX0 = TEX0;
 	m_32_bits_fmt |= (GSLocalMemory::m_psm[TEX0.PSM].trbpp != 16);
 	m_dirty_alpha = GSLocalMemory::m_psm[TEX0.PSM].trbpp != 24;
+
+	s_target_ranges_version++;
+}
+
+GSTextureCache::Target::~Target()
+{
+	s_target_ranges_version++;
 }
 
 void GSTextureCache::Target::Update(bool reset_age)
@@ -2876,7 +2992,12 @@ void GSTextureCache::Target::UpdateValidity(const GSVector4i& rect)
 	// TODO: This is not correct when the PSM changes. e.g. a 512x448 target being shuffled will become 512x896 temporarily, and
 	// at the moment, we blow the valid rect out to twice the size. The only thing stopping everything breaking is the fact
 	// that we clamp the draw rect to the target size in GSRendererHW::Draw().
-	m_end_block = GSLocalMemory::m_psm[m_TEX0.PSM].info.bn(m_valid.z - 1, m_valid.w - 1, m_TEX0.TBP0, m_TEX0.TBW); // Valid only for color formats
+	const u32 end_block = GSLocalMemory::m_psm[m_TEX0.PSM].info.bn(m_valid.z - 1, m_valid.w - 1, m_TEX0.TBP0, m_TEX0.TBW); // Valid only for color formats
+	if (end_block != m_end_block)
+	{
+		m_end_block = end_block;
+		s_target_ranges_version++;
+	}
 
 	// GL_CACHE("UpdateValidity (0x%x->0x%x) from R:%d,%d Valid: %d,%d", m_TEX0.TBP0, m_end_block, rect.z, rect.w, m_valid.z, m_valid.w);
 }
@@ -200,6 +200,7 @@ public:
 
 	public:
 		Target(const GIFRegTEX0& TEX0, const bool depth_supported, const int type);
+		~Target() override;
 
 		void UpdateValidity(const GSVector4i& rect);
 
@@ -295,6 +296,23 @@ public:
 		bool operator()(const SurfaceOffsetKey& lhs, const SurfaceOffsetKey& rhs) const;
 	};
 
+	// Blocks covered by the targets of one type, sorted by the first block, so invalidations only
+	// have to look at the targets they can touch instead of walking the whole list.
+	struct TargetRangeIndex
+	{
+		struct Range
+		{
+			u32 start;
+			u32 end;
+			Target* t;
+			u16 index; // in m_dst
+		};
+
+		std::vector<Range> ranges;
+		std::vector<u32> max_end; // highest end of ranges[0..i]
+		u32 version = 0;
+	};
+
 protected:
 	PaletteMap m_palette_map;
 	SourceMap m_src;
@@ -303,6 +321,11 @@ protected:
 	u64 m_hash_cache_replacement_memory_usage;
 	FastList<Target*> m_dst[2];
 	FastList<TargetHeightElem> m_target_heights;
+	TargetRangeIndex m_dst_ranges[2];
+	std::vector<TargetRangeIndex::Range> m_dst_candidates;
+	std::vector<u32> m_dst_candidate_marks; // by m_dst index, equal to m_dst_candidate_mark for candidates
+	u32 m_dst_candidate_mark = 0;
+	static u32 s_target_ranges_version; // bumped when a target is created, deleted or covers different blocks
 	static u8* m_temp;
 	constexpr static size_t S_SURFACE_OFFSET_CACHE_MAX_SIZE = std::numeric_limits<u16>::max();
 	std::unordered_map<SurfaceOffsetKey, SurfaceOffset, SurfaceOffsetKeyHash, SurfaceOffsetKeyEqual> m_surface_offset_cache;
@@ -311,6 +334,13 @@ protected:
 	Source* CreateSource(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, Target* t = NULL, bool half_right = false, int x_offset = 0, int y_offset = 0, const GSVector2i* lod = nullptr, const GSVector4i* src_range = nullptr);
 	Target* CreateTarget(const GIFRegTEX0& TEX0, int w, int h, int type, const bool clear);
 
+	/// Fills m_dst_candidates with the targets which may cover any of the blocks [start, end].
+	void FindTargetsInRange(int type, u32 start, u32 end);
+	__fi bool IsTargetCandidate(u16 index) const
+	{
+		return index < m_dst_candidate_marks.size() && m_dst_candidate_marks[index] == m_dst_candidate_mark;
+	}
+
 	/// Expands a target when the block pointer for a display framebuffer is within another target, but the read offset
 	/// plus the height is larger than the current size of the target.
 	void ScaleTargetForDisplay(Target* t, const GIFRegTEX0& dispfb, int real_w, int real_h);
@@ -113,6 +113,22 @@ void GSDrawScanline::EndDraw(u64 frame, u64 ticks, int actual, int total, int pr
 	m_ds_map.UpdateStats(frame, ticks, actual, total, prims);
 }
 
+void GSDrawScanline::GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds)
+{
+	const std::vector<u64> sp_keys = m_sp_map.GetUsedKeys();
+	const std::vector<u64> ds_keys = m_ds_map.GetUsedKeys();
+
+	sp.insert(sp.end(), sp_keys.begin(), sp_keys.end());
+	ds.insert(ds.end(), ds_keys.begin(), ds_keys.end());
+}
+
+GSCodeGenStats GSDrawScanline::GetCodeGenStats()
+{
+	GSCodeGenStats stats = m_sp_map.GetCodeGenStats();
+	stats += m_ds_map.GetCodeGenStats();
+	return stats;
+}
+
 #if _M_SSE >= 0x501
 typedef GSVector8i VectorI;
 typedef GSVector8  VectorF;
@@ -86,6 +86,11 @@ public:
 	{
 		m_ds_map.PrintStats();
 	}
+
+	void GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds);
+	void PregenerateSetupPrim(u64 key) { m_sp_map.Pregenerate(key); }
+	void PregenerateDrawScanline(u64 key) { m_ds_map.Pregenerate(key); }
+	GSCodeGenStats GetCodeGenStats();
 };
 
 MULTI_ISA_UNSHARED_END
@@ -21,6 +21,7 @@
 #include "PerformanceMetrics.h"
 #include "common/AlignedMalloc.h"
 #include "common/StringUtil.h"
+#include "common/Tracing.h"
 
 #ifdef PCSX2_CORE
 #include "VMManager.h"
@@ -67,7 +68,7 @@ GSRasterizer::GSRasterizer(IDrawScanline* ds, int id, int threads)
 
 	for (int i = 0; i < rows; i++)
 	{
-		m_scanline[i] = (i % threads) == id ? 1 : 0;
+		m_scanline[i] = static_cast<u8>(i % threads);
 	}
 }
 
@@ -89,7 +90,7 @@ bool GSRasterizer::IsOneOfMyScanlines(int top) const
 {
 	ASSERT(top >= 0 && top < 2048);
 
-	return m_scanline[top >> m_thread_height] != 0;
+	return m_scanline[top >> m_thread_height] == m_id;
 }
 
 bool GSRasterizer::IsOneOfMyScanlines(int top, int bottom) const
@@ -101,7 +102,7 @@ bool GSRasterizer::IsOneOfMyScanlines(int top, int bottom) const
 
 	while (top < bottom)
 	{
-		if (m_scanline[top++])
+		if (m_scanline[top++] == m_id)
 		{
 			return true;
 		}
@@ -114,9 +115,9 @@ int GSRasterizer::FindMyNextScanline(int top) const
 {
 	int i = top >> m_thread_height;
 
-	if (m_scanline[i] == 0)
+	if (m_scanline[i] != m_id)
 	{
-		while (m_scanline[++i] == 0)
+		while (m_scanline[++i] != m_id)
 			;
 
 		top = i << m_thread_height;
@@ -147,6 +148,8 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	if (data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0)
 		return;
 
+	Tracing::ScopedZone zone("SW Raster");
+
 	m_pixels.actual = 0;
 	m_pixels.total = 0;
 	m_primcount = 0;
@@ -154,6 +157,8 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	if constexpr (ENABLE_DRAW_STATS)
 		data->start = __rdtsc();
 
+	const u64 profile_start = data->profile ? Common::Timer::GetCurrentValue() : 0;
+
 	m_ds->BeginDraw(data);
 
 	const GSVertexSW* vertex = data->vertex;
@@ -261,6 +266,12 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	m_pixels.sum += m_pixels.actual;
 
+	if (data->profile)
+	{
+		data->profile->ticks.fetch_add(Common::Timer::GetCurrentValue() - profile_start, std::memory_order_relaxed);
+		data->profile->pixels.fetch_add(m_pixels.actual, std::memory_order_relaxed);
+	}
+
 	if constexpr (ENABLE_DRAW_STATS)
 		m_ds->EndDraw(data->frame, __rdtsc() - data->start, m_pixels.actual, m_pixels.total, m_primcount);
 }
@@ -1162,12 +1173,21 @@ GSRasterizerList::GSRasterizerList(int threads)
 {
 	m_thread_height = compute_best_thread_height(threads);
 
+	// More tiles than workers, so there's something left to steal when a draw only covers a few of them.
+	// Every tile a draw touches sets up all of its primitives again, which is why there aren't more.
 	const int rows = (2048 >> m_thread_height) + 16;
+	const int tiles = std::clamp(threads * TILES_PER_WORKER, 1, std::min(2048 >> m_thread_height, 255));
+
 	m_scanline = static_cast<u8*>(_aligned_malloc(rows, 64));
 
 	for (int i = 0; i < rows; i++)
 	{
-		m_scanline[i] = static_cast<u8>(i % threads);
+		m_scanline[i] = static_cast<u8>(i % tiles);
+	}
+
+	for (int i = 0; i < tiles; i++)
+	{
+		m_tiles.push_back(std::make_unique<Tile>());
 	}
 
 	PerformanceMetrics::SetGSSWThreadCount(threads);
@@ -1175,13 +1195,115 @@ GSRasterizerList::GSRasterizerList(int threads)
 
 GSRasterizerList::~GSRasterizerList()
 {
+	m_exit.store(true, std::memory_order_release);
+
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		worker->sema.NotifyOfWork();
+	}
+
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		worker->thread.join();
+	}
+
 	PerformanceMetrics::SetGSSWThreadCount(0);
 	_aligned_free(m_scanline);
 }
 
+void GSRasterizerList::StartWorkers()
+{
+	const int workers = static_cast<int>(m_r.size());
+	const int tiles = static_cast<int>(m_tiles.size());
+
+	for (int i = 0; i < workers; i++)
+	{
+		std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+
+		for (int tile = i; tile < tiles; tile += workers)
+		{
+			worker->order.push_back(static_cast<u8>(tile));
+		}
+
+		// Steal from the neighbours first, they're the most likely to share a cache.
+		for (int j = 1; j < workers; j++)
+		{
+			for (int tile = (i + j) % workers; tile < tiles; tile += workers)
+			{
+				worker->order.push_back(static_cast<u8>(tile));
+			}
+		}
+
+		m_workers.push_back(std::move(worker));
+	}
+
+	for (int i = 0; i < workers; i++)
+	{
+		m_workers[i]->thread = std::thread(&GSRasterizerList::WorkerThread, this, i);
+	}
+}
+
+void GSRasterizerList::WorkerThread(int i)
+{
+	OnWorkerStartup(i);
+
+	Worker& worker = *m_workers[i];
+
+	while (true)
+	{
+		worker.sema.WaitForWorkWithSpin();
+		if (m_exit.load(std::memory_order_acquire))
+			break;
+
+		// Every draw notifies every worker, so we're guaranteed another pass over the tiles after it's been
+		// queued. A tile claimed by someone else is their responsibility, they'll see the new draws.
+		bool found_work;
+		do
+		{
+			found_work = false;
+
+			for (const u8 tile : worker.order)
+			{
+				found_work |= DrawTile(i, tile);
+			}
+		} while (found_work);
+	}
+
+	OnWorkerShutdown(i);
+}
+
+bool GSRasterizerList::DrawTile(int worker, int tile)
+{
+	Tile& t = *m_tiles[tile];
+
+	if (t.queue.empty() || t.claimed.load(std::memory_order_relaxed) || t.claimed.exchange(true, std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	GSRasterizer& r = *m_r[worker];
+	auto draw = [&r](GSRingHeap::SharedPtr<GSRasterizerData>& item) { r.Draw(item.get()); };
+
+	r.SetTile(tile);
+
+	while (t.queue.consume_one(draw))
+		;
+
+	t.claimed.store(false, std::memory_order_release);
+
+	Worker& w = *m_workers[worker];
+	w.tiles_drawn++;
+	if ((tile % static_cast<int>(m_workers.size())) != worker)
+		w.tiles_stolen++;
+
+	return true;
+}
+
 void GSRasterizerList::OnWorkerStartup(int i)
 {
-	Threading::SetNameOfCurrentThread(StringUtil::StdStringFromFormat("GS-SW-%d", i).c_str());
+	const std::string name(StringUtil::StdStringFromFormat("GS-SW-%d", i));
+	Threading::SetNameOfCurrentThread(name.c_str());
+	Tracing::SetThreadName(name.c_str());
 
 	Threading::ThreadHandle handle(Threading::ThreadHandle::GetForCallingThread());
 
@@ -1214,11 +1336,23 @@ void GSRasterizerList::Queue(const GSRingHeap::SharedPtr<GSRasterizerData>& data
 	ASSERT(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
 
 	int top = r.top >> m_thread_height;
-	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_workers.size());
+	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_tiles.size());
+
+	if (top >= bottom)
+		return;
 
 	while (top < bottom)
 	{
-		m_workers[m_scanline[top++]]->Push(data);
+		Tile& tile = *m_tiles[m_scanline[top++]];
+
+		while (!tile.queue.push(data))
+			std::this_thread::yield();
+	}
+
+	// Any worker may take the tiles, not just their owners.
+	for (const std::unique_ptr<Worker>& worker : m_workers)
+	{
+		worker->sema.NotifyOfWork();
 	}
 }
 
@@ -1226,20 +1360,23 @@ void GSRasterizerList::Sync()
 {
 	if (!IsSynced())
 	{
-		for (size_t i = 0; i < m_workers.size(); i++)
+		// Workers only go idle after a pass over all the tiles which found nothing to do.
+		for (const std::unique_ptr<Worker>& worker : m_workers)
 		{
-			m_workers[i]->Wait();
+			worker->sema.WaitForEmptyWithSpin();
 		}
 
+		ASSERT(IsSynced());
+
 		g_perfmon.Put(GSPerfMon::SyncPoint, 1);
 	}
 }
 
 bool GSRasterizerList::IsSynced() const
 {
-	for (size_t i = 0; i < m_workers.size(); i++)
+	for (const std::unique_ptr<Tile>& tile : m_tiles)
 	{
-		if (!m_workers[i]->IsEmpty())
+		if (!tile->queue.empty())
 		{
 			return false;
 		}
@@ -1252,10 +1389,63 @@ int GSRasterizerList::GetPixels(bool reset)
 {
 	int pixels = 0;
 
-	for (size_t i = 0; i < m_workers.size(); i++)
+	for (size_t i = 0; i < m_r.size(); i++)
 	{
 		pixels += m_r[i]->GetPixels(reset);
 	}
 
 	return pixels;
 }
+
+void GSRasterizerList::PrintStats()
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		const Worker& worker = *m_workers[i];
+		Console.WriteLn("GS-SW-%zu: %llu tiles drawn, %llu stolen (%.1f%%)", i,
+			static_cast<unsigned long long>(worker.tiles_drawn), static_cast<unsigned long long>(worker.tiles_stolen),
+			worker.tiles_drawn ? (100.0 * worker.tiles_stolen / worker.tiles_drawn) : 0.0);
+	}
+
+	const GSCodeGenStats stats = GetCodeGenStats();
+	Console.WriteLn("GS-SW: %u functions generated while drawing (%.2f ms), %u pregenerated (%.2f ms), %u of those used (%.2f ms of codegen avoided)",
+		stats.generated, Common::Timer::ConvertValueToMilliseconds(stats.generate_ticks), stats.pregenerated,
+		Common::Timer::ConvertValueToMilliseconds(stats.pregenerate_ticks), stats.pregenerated_used,
+		Common::Timer::ConvertValueToMilliseconds(stats.avoided_ticks));
+}
+
+void GSRasterizerList::GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds)
+{
+	for (const std::unique_ptr<GSRasterizer>& r : m_r)
+	{
+		r->GetUsedSelectors(sp, ds);
+	}
+}
+
+void GSRasterizerList::PregenerateSetupPrim(u64 key)
+{
+	for (const std::unique_ptr<GSRasterizer>& r : m_r)
+	{
+		r->PregenerateSetupPrim(key);
+	}
+}
+
+void GSRasterizerList::PregenerateDrawScanline(u64 key)
+{
+	for (const std::unique_ptr<GSRasterizer>& r : m_r)
+	{
+		r->PregenerateDrawScanline(key);
+	}
+}
+
+GSCodeGenStats GSRasterizerList::GetCodeGenStats()
+{
+	GSCodeGenStats stats = {};
+
+	for (const std::unique_ptr<GSRasterizer>& r : m_r)
+	{
+		stats += r->GetCodeGenStats();
+	}
+
+	return stats;
+}
@@ -18,6 +18,7 @@
 #include "GSVertexSW.h"
 #include "GS/Renderers/Common/GSFunctionMap.h"
 #include "GS/GSAlignedClass.h"
+#include "GS/GSDrawProfiler.h"
 #include "GS/GSPerfMon.h"
 #include "GS/GSThread_CXX11.h"
 #include "GS/GSRingHeap.h"
@@ -43,6 +44,7 @@ public:
 	int pixels;
 	int counter;
 	u8 scanmsk_value;
+	std::shared_ptr<GSDrawProfiler::RasterStats> profile; // only while a frame is profiled
 
 	GSRasterizerData()
 		: scissor(GSVector4i::zero())
@@ -112,6 +114,15 @@ public:
 
 	virtual void PrintStats() = 0;
 
+	/// Appends the selectors of the functions which were used for drawing.
+	virtual void GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds) {}
+
+	/// Generates a function ahead of time, so the first draw needing it doesn't have to. Can be called from any thread.
+	virtual void PregenerateSetupPrim(u64 key) {}
+	virtual void PregenerateDrawScanline(u64 key) {}
+
+	virtual GSCodeGenStats GetCodeGenStats() { return {}; }
+
 	__forceinline bool HasEdge() const { return m_de != NULL; }
 	__forceinline bool IsSolidRect() const { return m_dr != NULL; }
 };
@@ -126,6 +137,11 @@ public:
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
 	virtual void PrintStats() = 0;
+
+	virtual void GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds) = 0;
+	virtual void PregenerateSetupPrim(u64 key) = 0;
+	virtual void PregenerateDrawScanline(u64 key) = 0;
+	virtual GSCodeGenStats GetCodeGenStats() = 0;
 };
 
 class alignas(32) GSRasterizer : public IRasterizer
@@ -174,6 +190,9 @@ public:
 	__forceinline bool IsOneOfMyScanlines(int top, int bottom) const;
 	__forceinline int FindMyNextScanline(int top) const;
 
+	/// Selects which of the interleaved screen segments the following draws go to.
+	__forceinline void SetTile(int id) { m_id = id; }
+
 	void Draw(GSRasterizerData* data);
 
 	// IRasterizer
@@ -183,21 +202,56 @@ public:
 	bool IsSynced() const { return true; }
 	int GetPixels(bool reset);
 	void PrintStats() { m_ds->PrintStats(); }
+
+	void GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds) { m_ds->GetUsedSelectors(sp, ds); }
+	void PregenerateSetupPrim(u64 key) { m_ds->PregenerateSetupPrim(key); }
+	void PregenerateDrawScanline(u64 key) { m_ds->PregenerateDrawScanline(key); }
+	GSCodeGenStats GetCodeGenStats() { return m_ds->GetCodeGenStats(); }
 };
 
+// Splits draws over a pool of worker threads.
+//
+// The screen is cut into horizontal segments of 1 << m_thread_height scanlines, which are interleaved
+// over a few tiles per worker. Every tile has its own queue, whose draws must be rasterized in order,
+// but different tiles never touch the same pixels. Workers claim a tile, drain its queue, and move on
+// to the next tile with work, starting with the ones they usually own. So when a draw only covers one
+// band of the screen, the workers whose tiles are idle help out instead of waiting.
 class GSRasterizerList : public IRasterizer
 {
 protected:
-	using GSWorker = GSJobQueue<GSRingHeap::SharedPtr<GSRasterizerData>, 65536>;
+	static constexpr int TILES_PER_WORKER = 2;
+	static constexpr int TILE_QUEUE_SIZE = 16384;
 
-	// Worker threads depend on the rasterizers, so don't change the order.
+	struct alignas(64) Tile
+	{
+		// Only one worker at a time may consume, the one which set claimed.
+		ringbuffer_base<GSRingHeap::SharedPtr<GSRasterizerData>, TILE_QUEUE_SIZE> queue;
+		std::atomic<bool> claimed{false};
+	};
+
+	struct Worker
+	{
+		std::thread thread;
+		Threading::WorkSema sema;
+		std::vector<u8> order; // own tiles first, then the others
+		u64 tiles_drawn = 0;
+		u64 tiles_stolen = 0;
+	};
+
+	// Worker threads depend on the tiles and rasterizers, so don't change the order.
+	std::vector<std::unique_ptr<Tile>> m_tiles;
 	std::vector<std::unique_ptr<GSRasterizer>> m_r;
-	std::vector<std::unique_ptr<GSWorker>> m_workers;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::atomic<bool> m_exit{false};
 	u8* m_scanline;
 	int m_thread_height;
 
 	GSRasterizerList(int threads);
 
+	void StartWorkers();
+	void WorkerThread(int i);
+	bool DrawTile(int worker, int tile);
+
 	static void OnWorkerStartup(int i);
 	static void OnWorkerShutdown(int i);
 
@@ -218,14 +272,11 @@ public:
 
 		for (int i = 0; i < threads; i++)
 		{
-			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), i, threads)));
-			auto& r = *rl->m_r[i];
-			rl->m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker(
-				[i]() { GSRasterizerList::OnWorkerStartup(i); },
-				[&r](GSRingHeap::SharedPtr<GSRasterizerData>& item) { r.Draw(item.get()); },
-				[i]() { GSRasterizerList::OnWorkerShutdown(i); })));
+			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), 0, static_cast<int>(rl->m_tiles.size()))));
 		}
 
+		rl->StartWorkers();
+
 		return rl;
 	}
 
@@ -235,7 +286,13 @@ public:
 	void Sync();
 	bool IsSynced() const;
 	int GetPixels(bool reset);
-	void PrintStats() {}
+	void PrintStats();
+
+	// Every worker has its own copy of the functions, they're generated for its local data.
+	void GetUsedSelectors(std::vector<u64>& sp, std::vector<u64>& ds);
+	void PregenerateSetupPrim(u64 key);
+	void PregenerateDrawScanline(u64 key);
+	GSCodeGenStats GetCodeGenStats();
 };
 
 MULTI_ISA_UNSHARED_END
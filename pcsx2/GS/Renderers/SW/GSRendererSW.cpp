@@ -16,7 +16,13 @@
 #include "PrecompiledHeader.h"
 #include "GSRendererSW.h"
 #include "GS/GSGL.h"
+#include "common/FileSystem.h"
+#include "common/Path.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
+#include "pcsx2/Config.h"
+
+#include <algorithm>
 
 MULTI_ISA_UNSHARED_IMPL;
 
@@ -31,6 +37,51 @@ static FILE* s_fp = LOG ? fopen("c:\\temp1\\_.txt", "w") : NULL;
 
 static constexpr GSVector4 s_pos_scale = GSVector4::cxpr(1.0f / 16, 1.0f / 16, 1.0f, 128.0f);
 
+// Bump whenever the meaning of the GSScanlineSelector bits changes.
+static constexpr u32 SELECTOR_CACHE_MAGIC = 0x4C535753; // SWSL
+static constexpr u32 SELECTOR_CACHE_VERSION = 1;
+
+// Per list. Past a few hundred it's variants which were only ever used for a handful of draws.
+static constexpr u32 MAX_SELECTORS = 1024;
+
+struct SelectorCacheHeader
+{
+	u32 magic;
+	u32 version;
+	u32 game_crc;
+	u32 sp_count;
+	u32 ds_count;
+	u32 pad;
+};
+
+struct SelectorCacheEntry
+{
+	u64 key;
+	u64 uses;
+};
+
+static std::string GetSelectorCacheFileName(u32 crc)
+{
+	return Path::Combine(EmuFolders::Cache, StringUtil::StdStringFromFormat("sw_selectors_%08X.bin", crc));
+}
+
+// Most used first.
+static std::vector<SelectorCacheEntry> SortSelectors(const std::unordered_map<u64, u64>& selectors)
+{
+	std::vector<SelectorCacheEntry> sorted;
+	sorted.reserve(selectors.size());
+	for (const auto& it : selectors)
+		sorted.push_back({it.first, it.second});
+
+	std::sort(sorted.begin(), sorted.end(), [](const SelectorCacheEntry& lhs, const SelectorCacheEntry& rhs) {
+		return (lhs.uses != rhs.uses) ? (lhs.uses > rhs.uses) : (lhs.key < rhs.key);
+	});
+	if (sorted.size() > MAX_SELECTORS)
+		sorted.resize(MAX_SELECTORS);
+
+	return sorted;
+}
+
 GSRendererSW::GSRendererSW(int threads)
 	: GSRenderer(), m_fzb(NULL)
 {
@@ -66,6 +117,9 @@ void GSRendererSW::Reset(bool hardware_reset)
 
 void GSRendererSW::Destroy()
 {
+	StopPregeneration();
+	SaveSelectors();
+
 	// Need to destroy worker queue first to stop any pending thread work
 	m_rl.reset();
 	m_tc.reset();
@@ -80,6 +134,145 @@ void GSRendererSW::Destroy()
 	m_output = nullptr;
 }
 
+void GSRendererSW::SetGameCRC(u32 crc, int options)
+{
+	GSRenderer::SetGameCRC(crc, options);
+
+	// Also called when settings change, keep going with the same game.
+	if (crc == m_selector_crc || !m_rl)
+		return;
+
+	StopPregeneration();
+	SaveSelectors();
+
+	m_selector_crc = crc;
+	LoadSelectors();
+	StartPregeneration();
+}
+
+void GSRendererSW::LoadSelectors()
+{
+	m_sp_selectors.clear();
+	m_ds_selectors.clear();
+	if (m_selector_crc == 0)
+		return;
+
+	std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetSelectorCacheFileName(m_selector_crc).c_str());
+	if (!data.has_value() || data->size() < sizeof(SelectorCacheHeader))
+		return;
+
+	SelectorCacheHeader header;
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != SELECTOR_CACHE_MAGIC || header.version != SELECTOR_CACHE_VERSION ||
+		header.game_crc != m_selector_crc || header.sp_count > MAX_SELECTORS || header.ds_count > MAX_SELECTORS ||
+		data->size() != sizeof(header) + (header.sp_count + header.ds_count) * sizeof(SelectorCacheEntry))
+	{
+		Console.Warning("(GSRendererSW) Ignoring invalid selector cache for CRC %08X", m_selector_crc);
+		return;
+	}
+
+	const u8* ptr = data->data() + sizeof(header);
+	for (u32 i = 0; i < header.sp_count + header.ds_count; i++, ptr += sizeof(SelectorCacheEntry))
+	{
+		SelectorCacheEntry entry;
+		std::memcpy(&entry, ptr, sizeof(entry));
+		(i < header.sp_count ? m_sp_selectors : m_ds_selectors)[entry.key] = entry.uses;
+	}
+
+	DevCon.WriteLn("(GSRendererSW) Loaded %zu setup and %zu scanline selectors for CRC %08X",
+		m_sp_selectors.size(), m_ds_selectors.size(), m_selector_crc);
+}
+
+void GSRendererSW::SaveSelectors()
+{
+	if (m_selector_crc == 0 || !m_rl)
+		return;
+
+	std::vector<u64> sp, ds;
+	m_rl->GetUsedSelectors(sp, ds);
+	if (sp.empty() && ds.empty())
+		return;
+
+	// Every worker has its own copy of the functions, only count a run once.
+	std::sort(sp.begin(), sp.end());
+	sp.erase(std::unique(sp.begin(), sp.end()), sp.end());
+	std::sort(ds.begin(), ds.end());
+	ds.erase(std::unique(ds.begin(), ds.end()), ds.end());
+
+	for (u64 key : sp)
+		m_sp_selectors[key]++;
+	for (u64 key : ds)
+		m_ds_selectors[key]++;
+
+	const std::vector<SelectorCacheEntry> sorted_sp = SortSelectors(m_sp_selectors);
+	const std::vector<SelectorCacheEntry> sorted_ds = SortSelectors(m_ds_selectors);
+
+	const SelectorCacheHeader header = {SELECTOR_CACHE_MAGIC, SELECTOR_CACHE_VERSION, m_selector_crc,
+		static_cast<u32>(sorted_sp.size()), static_cast<u32>(sorted_ds.size()), 0};
+	std::vector<u8> data(sizeof(header) + (sorted_sp.size() + sorted_ds.size()) * sizeof(SelectorCacheEntry));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), sorted_sp.data(), sorted_sp.size() * sizeof(SelectorCacheEntry));
+	std::memcpy(data.data() + sizeof(header) + sorted_sp.size() * sizeof(SelectorCacheEntry), sorted_ds.data(),
+		sorted_ds.size() * sizeof(SelectorCacheEntry));
+
+	const std::string filename(GetSelectorCacheFileName(m_selector_crc));
+	if (!FileSystem::WriteBinaryFile(filename.c_str(), data.data(), data.size()))
+	{
+		Console.Error("(GSRendererSW) Failed to write '%s'", filename.c_str());
+		return;
+	}
+
+	const GSCodeGenStats stats = m_rl->GetCodeGenStats();
+	DevCon.WriteLn("(GSRendererSW) Saved %zu setup and %zu scanline selectors for CRC %08X. %u functions generated while drawing "
+				   "(%.2f ms), %u of %u pregenerated ones used (%.2f ms of codegen avoided)",
+		sorted_sp.size(), sorted_ds.size(), m_selector_crc, stats.generated,
+		Common::Timer::ConvertValueToMilliseconds(stats.generate_ticks), stats.pregenerated_used, stats.pregenerated,
+		Common::Timer::ConvertValueToMilliseconds(stats.avoided_ticks));
+}
+
+void GSRendererSW::StartPregeneration()
+{
+	if (m_sp_selectors.empty() && m_ds_selectors.empty())
+		return;
+
+	// The draw threads generate whatever they need first themselves, this only has to get ahead of them.
+	m_pregen_cancel.store(false, std::memory_order_relaxed);
+	m_pregen_thread = std::thread([this, sp = SortSelectors(m_sp_selectors), ds = SortSelectors(m_ds_selectors)]() {
+		Threading::SetNameOfCurrentThread("GS-SW-Pregen");
+
+		Common::Timer timer;
+		size_t count = 0;
+		for (const SelectorCacheEntry& entry : sp)
+		{
+			if (m_pregen_cancel.load(std::memory_order_relaxed))
+				return;
+
+			m_rl->PregenerateSetupPrim(entry.key);
+			count++;
+		}
+
+		for (const SelectorCacheEntry& entry : ds)
+		{
+			if (m_pregen_cancel.load(std::memory_order_relaxed))
+				return;
+
+			m_rl->PregenerateDrawScanline(entry.key);
+			count++;
+		}
+
+		DevCon.WriteLn("(GSRendererSW) Pregenerated %zu scanline functions in %.2f ms", count, timer.GetTimeMilliseconds());
+	});
+}
+
+void GSRendererSW::StopPregeneration()
+{
+	if (!m_pregen_thread.joinable())
+		return;
+
+	m_pregen_cancel.store(true, std::memory_order_relaxed);
+	m_pregen_thread.join();
+}
+
 void GSRendererSW::VSync(u32 field, bool registers_written)
 {
 	Sync(0); // IncAge might delete a cached texture in use
@@ -393,6 +586,14 @@ void GSRendererSW::Draw()
 		return;
 	}
 
+	if (GSDrawProfiler::DrawRecord* profile = GSDrawProfiler::GetCurrentDraw())
+	{
+		profile->selector = sd->global.sel.key;
+		if (const GSTextureCacheSW::Texture* t = sd->m_tex[0].t)
+			profile->texture = t->m_complete ? GSDrawProfiler::TextureLookup::Hit : GSDrawProfiler::TextureLookup::Upload;
+		sd->profile = GSDrawProfiler::GetRasterStats();
+	}
+
 	if (0) if (LOG)
 	{
 		int n = GSUtil::GetVertexCount(PRIM->PRIM);
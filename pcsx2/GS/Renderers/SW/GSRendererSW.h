@@ -70,6 +70,18 @@ protected:
 	std::atomic<u32> m_fzb_pages[512]; // u16 frame/zbuf pages interleaved
 	std::atomic<u16> m_tex_pages[512];
 
+	// Scanline functions the current game used in previous runs, key -> number of runs it was used in.
+	u32 m_selector_crc = 0;
+	std::unordered_map<u64, u64> m_sp_selectors;
+	std::unordered_map<u64, u64> m_ds_selectors;
+	std::thread m_pregen_thread;
+	std::atomic<bool> m_pregen_cancel{false};
+
+	void LoadSelectors();
+	void SaveSelectors();
+	void StartPregeneration();
+	void StopPregeneration();
+
 	void Reset(bool hardware_reset) override;
 	void VSync(u32 field, bool registers_written) override;
 	GSTexture* GetOutput(int i, int& y_offset) override;
@@ -97,6 +109,7 @@ public:
 	__fi static GSRendererSW* GetInstance() { return static_cast<GSRendererSW*>(g_gs_renderer.get()); }
 
 	void Destroy() override;
+	void SetGameCRC(u32 crc, int options) override;
 };
 
 MULTI_ISA_UNSHARED_END
@@ -90,14 +90,17 @@ bool GSDumpReplayer::Initialize(const char* filename)
 	Console.WriteLn("(GSDumpReplayer) Reading file...");
 
 	s_dump_file = GSDumpFile::OpenGSDump(filename);
-	if (!s_dump_file || !s_dump_file->ReadFile())
+	if (!s_dump_file || !s_dump_file->ReadHeader())
 	{
 		Host::ReportFormattedErrorAsync("GSDumpReplayer", "Failed to open or read '%s'.", filename);
 		s_dump_file.reset();
 		return false;
 	}
 
-	Console.WriteLn("(GSDumpReplayer) Read file in %.2f ms.", timer.GetTimeMilliseconds());
+	// Packets are decoded in the background as they're needed, huge dumps don't have to fit in memory.
+	s_dump_file->StartStreaming();
+
+	Console.WriteLn("(GSDumpReplayer) Read header in %.2f ms.", timer.GetTimeMilliseconds());
 
 	// We replace all CPUs.
 	Cpu = &GSDumpReplayerCpu;
@@ -168,6 +171,9 @@ void GSDumpReplayerCpuShutdown()
 
 void GSDumpReplayerCpuReset()
 {
+	if (s_current_packet != 0)
+		s_dump_file->SeekToFrame(0);
+
 	s_needs_state_loaded = true;
 	s_current_packet = 0;
 	s_dump_frame_number = 0;
@@ -237,11 +243,21 @@ void GSDumpReplayerCpuStep()
 		s_needs_state_loaded = false;
 	}
 
-	const GSDumpFile::GSData& packet = s_dump_file->GetPackets()[s_current_packet];
-	s_current_packet = (s_current_packet + 1) % static_cast<u32>(s_dump_file->GetPackets().size());
-	if (s_current_packet == 0)
+	const GSDumpFile::GSData* next_packet = s_dump_file->GetNextPacket();
+	if (!next_packet)
 	{
+		if (s_current_packet == 0)
+		{
+			Host::ReportFormattedErrorAsync("GSDumpReplayer", "Dump does not contain any packets.");
+			Host::RequestVMShutdown(false, false, false);
+			s_dump_running = false;
+			return;
+		}
+
+		s_current_packet = 0;
 		s_dump_frame_number = 0;
+		s_dump_file->SeekToFrame(0);
+
 		if (s_dump_loop_count > 0)
 			s_dump_loop_count--;
 		else if (s_dump_loop_count == 0)
@@ -249,8 +265,13 @@ void GSDumpReplayerCpuStep()
 			Host::RequestVMShutdown(false, false, false);
 			s_dump_running = false;
 		}
+
+		return;
 	}
 
+	const GSDumpFile::GSData& packet = *next_packet;
+	s_current_packet++;
+
 	switch (packet.id)
 	{
 		case GSDumpTypes::GSType::Transfer:
@@ -366,7 +387,12 @@ void GSDumpReplayer::RenderUI()
 	DRAW_LINE(font, text.c_str(), IM_COL32(255, 255, 255, 255));
 
 	text.clear();
-	fmt::format_to(std::back_inserter(text), "Packet Number: {}/{}", s_current_packet, static_cast<u32>(s_dump_file->GetPackets().size()));
+	// The packet count is only known after the reader has been through the whole dump once.
+	const u32 packet_count = s_dump_file->GetPacketCount();
+	if (packet_count > 0)
+		fmt::format_to(std::back_inserter(text), "Packet Number: {}/{}", s_current_packet, packet_count);
+	else
+		fmt::format_to(std::back_inserter(text), "Packet Number: {}", s_current_packet);
 	DRAW_LINE(font, text.c_str(), IM_COL32(255, 255, 255, 255));
 
 #undef DRAW_LINE
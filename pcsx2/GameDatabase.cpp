@@ -15,6 +15,8 @@
 
 #include "PrecompiledHeader.h"
 
+#include "AsyncFileReader.h"
+#include "Config.h"
 #include "GameDatabase.h"
 #include "Host.h"
 #include "Patch.h"
@@ -33,6 +35,7 @@
 #include <fstream>
 #include <mutex>
 #include <optional>
+#include <zlib.h>
 
 namespace GameDatabaseSchema
 {
@@ -45,12 +48,55 @@ namespace GameDatabase
 {
 	static void parseAndInsert(const std::string_view& serial, const c4::yml::NodeRef& node);
 	static void initDatabase();
+	static void parseYaml(const std::string& buf);
+
+	static std::string getSnapshotPath();
+	static u32 getSchemaHash();
+	static bool openSnapshot(const std::string& path, std::optional<u32> yaml_hash, std::time_t yaml_timestamp);
+	static void writeSnapshot(const std::string& path, u32 yaml_hash, std::time_t yaml_timestamp);
+	static const GameDatabaseSchema::GameEntry* loadSnapshotEntry(const std::string& serial);
 } // namespace GameDatabase
 
 static constexpr char GAMEDB_YAML_FILE_NAME[] = "GameIndex.yaml";
+static constexpr char GAMEDB_SNAPSHOT_FILE_NAME[] = "gamedb.cache";
+
+// The YAML is compiled into a snapshot in the cache directory the first time it's loaded, and whenever it changes.
+// The snapshot is a sorted serial index, the entries as u32 fields, and a pool of all the strings they refer to.
+// It's mapped as is, and entries are only turned into GameEntry objects when they're looked up.
+static constexpr u32 GAMEDB_SNAPSHOT_MAGIC = 0x53424447; // GDBS
+static constexpr u32 GAMEDB_SNAPSHOT_VERSION = 1;
+
+struct GameDBSnapshotHeader
+{
+	u32 magic;
+	u32 version;
+	u32 schema_hash;
+	u32 yaml_hash;
+	u64 yaml_timestamp;
+	u32 num_entries;
+	u32 data_size; // in u32s
+	u32 pool_size; // in bytes
+	u32 reserved;
+};
+
+struct GameDBSnapshotIndexEntry
+{
+	u32 serial_offset;
+	u32 serial_length;
+	u32 data_offset; // in u32s
+	u32 data_size; // in u32s
+};
 
+// Entries which have been looked up, or all of them when the YAML was parsed this run.
 static std::unordered_map<std::string, GameDatabaseSchema::GameEntry> s_game_db;
 static std::once_flag s_load_once_flag;
+static std::mutex s_game_db_mutex;
+
+static std::unique_ptr<MappedFileReader> s_snapshot_reader;
+static const GameDBSnapshotIndexEntry* s_snapshot_index = nullptr;
+static const u32* s_snapshot_data = nullptr;
+static const char* s_snapshot_pool = nullptr;
+static GameDBSnapshotHeader s_snapshot_header = {};
 
 std::string GameDatabaseSchema::GameEntry::memcardFiltersAsString() const
 {
@@ -688,7 +734,301 @@ u32 GameDatabaseSchema::GameEntry::applyGSHardwareFixes(Pcsx2Config::GSOptions&
 	return num_applied_fixes;
 }
 
+std::string GameDatabase::getSnapshotPath()
+{
+	return EmuFolders::Cache.empty() ? std::string() : Path::Combine(EmuFolders::Cache, GAMEDB_SNAPSHOT_FILE_NAME);
+}
+
+u32 GameDatabase::getSchemaHash()
+{
+	// Fixes are stored by their enum value, so the snapshot can't be used by a build where they're numbered differently.
+	u32 hash = crc32(0, nullptr, 0);
+	const auto add = [&hash](const char* name) {
+		hash = static_cast<u32>(crc32(hash, reinterpret_cast<const Bytef*>(name), static_cast<uInt>(std::strlen(name) + 1)));
+	};
+	for (GamefixId id = GamefixId_FIRST; id < pxEnumEnd; ++id)
+		add(EnumToString(id));
+	for (SpeedhackId id = SpeedhackId_FIRST; id < pxEnumEnd; ++id)
+		add(EnumToString(id));
+	for (const char* name : s_gs_hw_fix_names)
+		add(name);
+
+	return hash;
+}
+
+bool GameDatabase::openSnapshot(const std::string& path, std::optional<u32> yaml_hash, std::time_t yaml_timestamp)
+{
+	std::unique_ptr<MappedFileReader> reader = std::make_unique<MappedFileReader>();
+	reader->SetBlockSize(1);
+	if (!reader->Open(path))
+		return false;
+
+	const u32 size = reader->GetBlockCount();
+	const u8* data = reader->GetMappedSectors(0, size);
+	if (!data || size < sizeof(GameDBSnapshotHeader))
+		return false;
+
+	GameDBSnapshotHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != GAMEDB_SNAPSHOT_MAGIC || header.version != GAMEDB_SNAPSHOT_VERSION ||
+		header.schema_hash != getSchemaHash() ||
+		(yaml_hash.has_value() ? (header.yaml_hash != yaml_hash.value()) : (header.yaml_timestamp != static_cast<u64>(yaml_timestamp))))
+	{
+		return false;
+	}
+
+	const u64 expected_size = sizeof(header) + static_cast<u64>(header.num_entries) * sizeof(GameDBSnapshotIndexEntry) +
+							  static_cast<u64>(header.data_size) * sizeof(u32) + header.pool_size;
+	if (expected_size != size)
+	{
+		Console.Error("[GameDB] Snapshot '%s' is %u bytes, expected %llu", path.c_str(), size, expected_size);
+		return false;
+	}
+
+	s_snapshot_header = header;
+	s_snapshot_index = reinterpret_cast<const GameDBSnapshotIndexEntry*>(data + sizeof(header));
+	s_snapshot_data = reinterpret_cast<const u32*>(s_snapshot_index + header.num_entries);
+	s_snapshot_pool = reinterpret_cast<const char*>(s_snapshot_data + header.data_size);
+	s_snapshot_reader = std::move(reader);
+	return true;
+}
+
+void GameDatabase::writeSnapshot(const std::string& path, u32 yaml_hash, std::time_t yaml_timestamp)
+{
+	std::vector<const std::pair<const std::string, GameDatabaseSchema::GameEntry>*> sorted;
+	sorted.reserve(s_game_db.size());
+	for (const auto& it : s_game_db)
+		sorted.push_back(&it);
+	std::sort(sorted.begin(), sorted.end(), [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+
+	std::vector<GameDBSnapshotIndexEntry> index;
+	std::vector<u32> data;
+	std::string pool;
+	std::unordered_map<std::string, u32> pool_offsets;
+	index.reserve(sorted.size());
+
+	// Names and regions repeat a lot, so strings are only stored once.
+	const auto add_string = [&](const std::string& str) {
+		auto it = pool_offsets.find(str);
+		if (it == pool_offsets.end())
+		{
+			it = pool_offsets.emplace(str, static_cast<u32>(pool.size())).first;
+			pool.append(str);
+		}
+
+		data.push_back(it->second);
+		data.push_back(static_cast<u32>(str.size()));
+	};
+
+	for (const auto* it : sorted)
+	{
+		const GameDatabaseSchema::GameEntry& entry = it->second;
+
+		GameDBSnapshotIndexEntry& ie = index.emplace_back();
+		ie.serial_offset = static_cast<u32>(pool.size());
+		ie.serial_length = static_cast<u32>(it->first.size());
+		ie.data_offset = static_cast<u32>(data.size());
+		pool.append(it->first);
+
+		add_string(entry.name);
+		add_string(entry.region);
+		data.push_back(static_cast<u32>(entry.compat));
+		data.push_back(static_cast<u32>(entry.eeRoundMode));
+		data.push_back(static_cast<u32>(entry.vuRoundMode));
+		data.push_back(static_cast<u32>(entry.eeClampMode));
+		data.push_back(static_cast<u32>(entry.vuClampMode));
+
+		data.push_back(static_cast<u32>(entry.gameFixes.size()));
+		for (const GamefixId id : entry.gameFixes)
+			data.push_back(static_cast<u32>(id));
+
+		data.push_back(static_cast<u32>(entry.speedHacks.size()));
+		for (const auto& [id, value] : entry.speedHacks)
+		{
+			data.push_back(static_cast<u32>(id));
+			data.push_back(static_cast<u32>(value));
+		}
+
+		data.push_back(static_cast<u32>(entry.gsHWFixes.size()));
+		for (const auto& [id, value] : entry.gsHWFixes)
+		{
+			data.push_back(static_cast<u32>(id));
+			data.push_back(static_cast<u32>(value));
+		}
+
+		data.push_back(static_cast<u32>(entry.memcardFilters.size()));
+		for (const std::string& filter : entry.memcardFilters)
+			add_string(filter);
+
+		data.push_back(static_cast<u32>(entry.patches.size()));
+		for (const auto& [crc, patch] : entry.patches)
+		{
+			data.push_back(crc);
+			add_string(patch);
+		}
+
+		ie.data_size = static_cast<u32>(data.size()) - ie.data_offset;
+	}
+
+	GameDBSnapshotHeader header = {};
+	header.magic = GAMEDB_SNAPSHOT_MAGIC;
+	header.version = GAMEDB_SNAPSHOT_VERSION;
+	header.schema_hash = getSchemaHash();
+	header.yaml_hash = yaml_hash;
+	header.yaml_timestamp = static_cast<u64>(yaml_timestamp);
+	header.num_entries = static_cast<u32>(index.size());
+	header.data_size = static_cast<u32>(data.size());
+	header.pool_size = static_cast<u32>(pool.size());
+
+	// Written under another name first, so another instance never maps a half written snapshot.
+	const std::string temp_path(path + ".tmp");
+	auto fp = FileSystem::OpenManagedCFile(temp_path.c_str(), "wb");
+	if (!fp)
+	{
+		Console.Warning("[GameDB] Failed to open '%s' for writing", temp_path.c_str());
+		return;
+	}
+
+	const bool written = (std::fwrite(&header, sizeof(header), 1, fp.get()) == 1 &&
+						  (index.empty() || std::fwrite(index.data(), sizeof(GameDBSnapshotIndexEntry) * index.size(), 1, fp.get()) == 1) &&
+						  (data.empty() || std::fwrite(data.data(), sizeof(u32) * data.size(), 1, fp.get()) == 1) &&
+						  (pool.empty() || std::fwrite(pool.data(), pool.size(), 1, fp.get()) == 1) && std::fflush(fp.get()) == 0);
+	fp.reset();
+
+	if (!written || !FileSystem::RenamePath(temp_path.c_str(), path.c_str()))
+	{
+		Console.Warning("[GameDB] Failed to write snapshot '%s'", path.c_str());
+		FileSystem::DeleteFilePath(temp_path.c_str());
+		return;
+	}
+
+	DevCon.WriteLn("[GameDB] Wrote snapshot of %zu games (%zu bytes of strings) to '%s'", index.size(), pool.size(), path.c_str());
+}
+
+const GameDatabaseSchema::GameEntry* GameDatabase::loadSnapshotEntry(const std::string& serial)
+{
+	if (!s_snapshot_reader)
+		return nullptr;
+
+	const GameDBSnapshotIndexEntry* begin = s_snapshot_index;
+	const GameDBSnapshotIndexEntry* end = s_snapshot_index + s_snapshot_header.num_entries;
+	const auto get_serial = [](const GameDBSnapshotIndexEntry& ie) {
+		return std::string_view(s_snapshot_pool + ie.serial_offset, ie.serial_length);
+	};
+	const GameDBSnapshotIndexEntry* ie = std::lower_bound(begin, end, std::string_view(serial),
+		[&get_serial](const GameDBSnapshotIndexEntry& lhs, const std::string_view& rhs) { return get_serial(lhs) < rhs; });
+	if (ie == end || get_serial(*ie) != serial)
+		return nullptr;
+
+	// Everything is bounds checked, a damaged snapshot shouldn't take us down with it.
+	const u32* data = s_snapshot_data + ie->data_offset;
+	const u32* data_end = data + ie->data_size;
+	bool valid = (ie->data_offset <= s_snapshot_header.data_size && ie->data_size <= (s_snapshot_header.data_size - ie->data_offset));
+	const auto read = [&data, data_end, &valid]() -> u32 {
+		if (!valid || data == data_end)
+		{
+			valid = false;
+			return 0;
+		}
+
+		return *(data++);
+	};
+	const auto read_string = [&read, &valid]() {
+		const u32 offset = read();
+		const u32 length = read();
+		if (!valid || offset > s_snapshot_header.pool_size || length > (s_snapshot_header.pool_size - offset))
+		{
+			valid = false;
+			return std::string();
+		}
+
+		return std::string(s_snapshot_pool + offset, length);
+	};
+
+	GameDatabaseSchema::GameEntry entry;
+	entry.name = read_string();
+	entry.region = read_string();
+	entry.compat = static_cast<GameDatabaseSchema::Compatibility>(read());
+	entry.eeRoundMode = static_cast<GameDatabaseSchema::RoundMode>(static_cast<s32>(read()));
+	entry.vuRoundMode = static_cast<GameDatabaseSchema::RoundMode>(static_cast<s32>(read()));
+	entry.eeClampMode = static_cast<GameDatabaseSchema::ClampMode>(static_cast<s32>(read()));
+	entry.vuClampMode = static_cast<GameDatabaseSchema::ClampMode>(static_cast<s32>(read()));
+
+	for (u32 i = 0, count = read(); valid && i < count; i++)
+	{
+		const u32 id = read();
+		valid &= (id < GamefixId_COUNT);
+		entry.gameFixes.push_back(static_cast<GamefixId>(id));
+	}
+
+	for (u32 i = 0, count = read(); valid && i < count; i++)
+	{
+		const u32 id = read();
+		const s32 value = static_cast<s32>(read());
+		valid &= (id < SpeedhackId_COUNT);
+		entry.speedHacks.emplace_back(static_cast<SpeedhackId>(id), value);
+	}
+
+	for (u32 i = 0, count = read(); valid && i < count; i++)
+	{
+		const u32 id = read();
+		const s32 value = static_cast<s32>(read());
+		valid &= (id < static_cast<u32>(GameDatabaseSchema::GSHWFixId::Count));
+		entry.gsHWFixes.emplace_back(static_cast<GameDatabaseSchema::GSHWFixId>(id), value);
+	}
+
+	for (u32 i = 0, count = read(); valid && i < count; i++)
+		entry.memcardFilters.push_back(read_string());
+
+	for (u32 i = 0, count = read(); valid && i < count; i++)
+	{
+		const u32 crc = read();
+		entry.patches.emplace(crc, read_string());
+	}
+
+	if (!valid)
+	{
+		Console.Error("[GameDB] Snapshot entry for '%s' is corrupted", serial.c_str());
+		return nullptr;
+	}
+
+	return &s_game_db.emplace(serial, std::move(entry)).first->second;
+}
+
 void GameDatabase::initDatabase()
+{
+	const std::string snapshot_path(getSnapshotPath());
+	const std::time_t yaml_timestamp = Host::GetResourceFileTimestamp(GAMEDB_YAML_FILE_NAME).value_or(0);
+
+	// When the YAML hasn't been touched since the snapshot was written, don't even read it.
+	if (!snapshot_path.empty() && yaml_timestamp != 0 && openSnapshot(snapshot_path, std::nullopt, yaml_timestamp))
+	{
+		DevCon.WriteLn("[GameDB] Using snapshot '%s'", snapshot_path.c_str());
+		return;
+	}
+
+	auto buf = Host::ReadResourceFileToString(GAMEDB_YAML_FILE_NAME);
+	if (!buf.has_value())
+	{
+		Console.Error("[GameDB] Unable to open GameDB file, file does not exist.");
+		return;
+	}
+
+	// Otherwise it's only parsed again if the contents actually changed.
+	const u32 yaml_hash = static_cast<u32>(crc32(0, reinterpret_cast<const Bytef*>(buf->data()), static_cast<uInt>(buf->size())));
+	if (!snapshot_path.empty() && openSnapshot(snapshot_path, yaml_hash, yaml_timestamp))
+	{
+		DevCon.WriteLn("[GameDB] Using snapshot '%s', GameDB is unchanged", snapshot_path.c_str());
+		return;
+	}
+
+	parseYaml(buf.value());
+
+	if (!snapshot_path.empty() && !s_game_db.empty())
+		writeSnapshot(snapshot_path, yaml_hash, yaml_timestamp);
+}
+
+void GameDatabase::parseYaml(const std::string& buf)
 {
 	ryml::Callbacks rymlCallbacks = ryml::get_callbacks();
 	rymlCallbacks.m_error = [](const char* msg, size_t msg_len, ryml::Location loc, void*) {
@@ -702,14 +1042,7 @@ void GameDatabase::initDatabase()
 	});
 	try
 	{
-		auto buf = Host::ReadResourceFileToString(GAMEDB_YAML_FILE_NAME);
-		if (!buf.has_value())
-		{
-			Console.Error("[GameDB] Unable to open GameDB file, file does not exist.");
-			return;
-		}
-
-		ryml::Tree tree = ryml::parse_in_arena(c4::to_csubstr(buf.value()));
+		ryml::Tree tree = ryml::parse_in_arena(c4::to_csubstr(buf));
 		ryml::NodeRef root = tree.rootref();
 
 		for (const ryml::NodeRef& n : root.children())
@@ -744,7 +1077,8 @@ void GameDatabase::ensureLoaded()
 		Common::Timer timer;
 		Console.WriteLn(fmt::format("[GameDB] Has not been initialized yet, initializing..."));
 		initDatabase();
-		Console.WriteLn("[GameDB] %zu games on record (loaded in %.2fms)", s_game_db.size(), timer.GetTimeMilliseconds());
+		Console.WriteLn("[GameDB] %zu games on record (loaded in %.2fms)",
+			s_snapshot_reader ? static_cast<size_t>(s_snapshot_header.num_entries) : s_game_db.size(), timer.GetTimeMilliseconds());
 	});
 }
 
@@ -754,6 +1088,9 @@ const GameDatabaseSchema::GameEntry* GameDatabase::findGame(const std::string_vi
 
 	std::string serialLower = StringUtil::toLower(serial);
 	Console.WriteLn(fmt::format("[GameDB] Searching for '{}' in GameDB", serialLower));
+
+	// Entries are never removed, so the pointer stays valid after the lock is released.
+	std::unique_lock lock(s_game_db_mutex);
 	const auto gameEntry = s_game_db.find(serialLower);
 	if (gameEntry != s_game_db.end())
 	{
@@ -761,6 +1098,12 @@ const GameDatabaseSchema::GameEntry* GameDatabase::findGame(const std::string_vi
 		return &gameEntry->second;
 	}
 
+	if (const GameDatabaseSchema::GameEntry* snapshotEntry = loadSnapshotEntry(serialLower))
+	{
+		Console.WriteLn(fmt::format("[GameDB] Found '{}' in GameDB", serialLower));
+		return snapshotEntry;
+	}
+
 	Console.Error(fmt::format("[GameDB] Could not find '{}' in GameDB", serialLower));
 	return nullptr;
 }
@@ -20,6 +20,7 @@
 
 #include "common/ScopedGuard.h"
 #include "common/StringUtil.h"
+#include "common/Tracing.h"
 
 #include "GS.h"
 #include "Gif_Unit.h"
@@ -114,6 +115,7 @@ void SysMtgsThread::ShutdownThread()
 void SysMtgsThread::ThreadEntryPoint()
 {
 	Threading::SetNameOfCurrentThread("GS");
+	Tracing::SetThreadName("GS");
 
 	if (GSinit() != 0)
 	{
@@ -431,6 +433,7 @@ void SysMtgsThread::MainLoop()
 					Gif_Path& path = gifUnit.gifPath[tag.data[2]];
 					u32 offset = tag.data[0];
 					u32 size = tag.data[1];
+					Tracing::ScopedZone zone("GIF Transfer");
 					if (offset != ~0u)
 						GSgifTransfer((u8*)&path.buffer[offset], size / 16);
 					path.readAmount.fetch_sub(size, std::memory_order_acq_rel);
@@ -449,6 +452,7 @@ void SysMtgsThread::MainLoop()
 					}
 					Gif_Path& path = gifUnit.gifPath[GIF_PATH_1];
 					GS_Packet gsPack = path.GetGSPacketMTVU(); // Get vu1 program's xgkick packet(s)
+					Tracing::ScopedZone zone("GIF Transfer (MTVU)");
 					if (gsPack.size)
 						GSgifTransfer((u8*)&path.buffer[gsPack.offset], gsPack.size / 16);
 					path.readAmount.fetch_sub(gsPack.size + gsPack.readAmount, std::memory_order_acq_rel);
@@ -480,6 +484,7 @@ void SysMtgsThread::MainLoop()
 							((GSRegSIGBLID&)RingBuffer.Regs[0x1080]) = (GSRegSIGBLID&)remainder[2];
 
 							// CSR & 0x2000; is the pageflip id.
+							Tracing::ScopedZone zone("GS VSync", Tracing::Tier::Frame);
 							GSvsync((((u32&)RingBuffer.Regs[0x1000]) & 0x2000) ? 0 : 1, remainder[4] != 0);
 
 							m_QueuedFrameCount.fetch_sub(1);
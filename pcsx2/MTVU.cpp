@@ -19,6 +19,7 @@
 #include "newVif.h"
 #include "Gif_Unit.h"
 #include "common/Threading.h"
+#include "common/Tracing.h"
 #include <thread>
 
 VU_Thread vu1Thread;
@@ -136,6 +137,7 @@ void VU_Thread::Reset()
 void VU_Thread::ExecuteRingBuffer()
 {
 	Threading::SetNameOfCurrentThread("MTVU");
+	Tracing::SetThreadName("MTVU");
 
 	for (;;)
 	{
@@ -158,7 +160,10 @@ void VU_Thread::ExecuteRingBuffer()
 					if (addr != -1)
 						VU1.VI[REG_TPC].UL = addr & 0x7FF;
 					CpuVU1->SetStartPC(VU1.VI[REG_TPC].UL << 3);
-					CpuVU1->Execute(vu1RunCycles);
+					{
+						Tracing::ScopedZone zone("VU1 Program");
+						CpuVU1->Execute(vu1RunCycles);
+					}
 					gifUnit.gifPath[GIF_PATH_1].FinishGSPacketMTVU();
 					semaXGkick.Post(); // Tell MTGS a path1 packet is complete
 					vuCycles[vuCycleIdx].store(VU1.cycle, std::memory_order_release);
@@ -169,6 +174,7 @@ void VU_Thread::ExecuteRingBuffer()
 				{
 					u32 vu_micro_addr = Read();
 					u32 size = Read();
+					Tracing::ScopedZone zone("VU1 Micro Upload");
 					CpuVU1->Clear(vu_micro_addr, size);
 					Read(&VU1.Micro[vu_micro_addr], size);
 					break;
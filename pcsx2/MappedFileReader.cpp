@@ -0,0 +1,238 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "common/FileSystem.h"
+#include "common/StringUtil.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// How much we ask the OS to page in ahead of the current read position.
+// Large enough to cover a typical streaming read, small enough not to thrash the page cache on seeks.
+static constexpr u64 READAHEAD_WINDOW = 4 * 1024 * 1024;
+
+MappedFileReader::MappedFileReader()
+{
+	m_blocksize = 2048;
+#ifdef _WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+#else
+	m_fd = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_lastReadSize = 0;
+	m_hintStart = 0;
+	m_hintEnd = 0;
+}
+
+MappedFileReader::~MappedFileReader(void)
+{
+	Close();
+}
+
+bool MappedFileReader::Open(std::string fileName)
+{
+	Close();
+	m_filename = std::move(fileName);
+
+#ifdef _WIN32
+	m_file = CreateFile(StringUtil::UTF8StringToWideString(m_filename).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	m_size = static_cast<u64>(size.QuadPart);
+
+	m_mapping = CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping)
+		m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (!m_data)
+	{
+		DevCon.Warning("MappedFileReader: Failed to map %s (%u)", m_filename.c_str(), GetLastError());
+		Close();
+		return false;
+	}
+#else
+	m_fd = FileSystem::OpenFDFile(m_filename.c_str(), O_RDONLY, 0);
+	if (m_fd < 0)
+		return false;
+
+	struct stat sd;
+	if (fstat(m_fd, &sd) != 0 || sd.st_size <= 0)
+	{
+		Close();
+		return false;
+	}
+	m_size = static_cast<u64>(sd.st_size);
+
+	void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+	if (ptr == MAP_FAILED)
+	{
+		DevCon.Warning("MappedFileReader: Failed to map %s (%d)", m_filename.c_str(), errno);
+		Close();
+		return false;
+	}
+	m_data = static_cast<const u8*>(ptr);
+#endif
+
+	return true;
+}
+
+bool MappedFileReader::GetSectorRange(uint sector, uint count, u64* offset, u64* size) const
+{
+	const s64 start = sector * static_cast<s64>(m_blocksize) + m_dataoffset;
+	if (start < 0 || static_cast<u64>(start) >= m_size)
+		return false;
+
+	*offset = static_cast<u64>(start);
+	*size = std::min<u64>(static_cast<u64>(count) * m_blocksize, m_size - *offset);
+	return true;
+}
+
+void MappedFileReader::HintRange(u64 offset, u64 size, bool sequential)
+{
+	if (offset >= m_size)
+		return;
+
+	// The OS wants page aligned ranges.
+	const u64 start = offset & ~static_cast<u64>(__pagemask);
+	const u64 end = std::min(offset + size, m_size);
+	m_hintStart = start;
+	m_hintEnd = end;
+
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<u8*>(m_data + start);
+	range.NumberOfBytes = static_cast<SIZE_T>(end - start);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	// Streaming reads also get aggressive kernel readahead, with the pages behind them dropped early.
+	// Seek targets go back to the default, in case a stream passed over them before.
+	madvise(const_cast<u8*>(m_data + start), end - start, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+	madvise(const_cast<u8*>(m_data + start), end - start, MADV_WILLNEED);
+#endif
+}
+
+void MappedFileReader::AdvanceReadahead(u64 offset, u64 size)
+{
+	// Reads outside the hinted window are seeks which PrefetchHint() deals with.
+	// Inside it, keep the window ahead of us so sequential streaming never waits on a page fault.
+	if (offset < m_hintStart || offset > m_hintEnd || m_hintEnd >= m_size)
+		return;
+
+	if (offset + size + READAHEAD_WINDOW / 2 > m_hintEnd)
+	{
+		const u64 start = m_hintStart;
+		HintRange(m_hintEnd, READAHEAD_WINDOW, true);
+		m_hintStart = start;
+	}
+}
+
+int MappedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+{
+	u64 offset, size;
+	if (!m_data || !GetSectorRange(sector, count, &offset, &size))
+		return 0;
+
+	AdvanceReadahead(offset, size);
+	std::memcpy(pBuffer, m_data + offset, size);
+	return static_cast<int>(size);
+}
+
+void MappedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+{
+	// Nothing to wait for, the OS pages the data in as we copy it.
+	m_lastReadSize = ReadSync(pBuffer, sector, count);
+}
+
+int MappedFileReader::FinishRead(void)
+{
+	return m_lastReadSize;
+}
+
+void MappedFileReader::CancelRead(void)
+{
+}
+
+void MappedFileReader::Close(void)
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+#else
+	if (m_data)
+		munmap(const_cast<u8*>(m_data), m_size);
+	if (m_fd != -1)
+		close(m_fd);
+
+	m_fd = -1;
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+	m_lastReadSize = 0;
+	m_hintStart = 0;
+	m_hintEnd = 0;
+}
+
+uint MappedFileReader::GetBlockCount(void) const
+{
+	return static_cast<uint>(m_size / m_blocksize);
+}
+
+void MappedFileReader::PrefetchHint(uint sector, uint count)
+{
+	u64 offset, size;
+	if (!m_data || !GetSectorRange(sector, count, &offset, &size))
+		return;
+
+	// Skip the syscall if we already asked for this range.
+	if (offset >= m_hintStart && offset + size <= m_hintEnd)
+		return;
+
+	HintRange(offset, std::max(size, READAHEAD_WINDOW), false);
+}
+
+const u8* MappedFileReader::GetMappedSectors(uint sector, uint count)
+{
+	u64 offset, size;
+	if (!m_data || !GetSectorRange(sector, count, &offset, &size) || size != static_cast<u64>(count) * m_blocksize)
+		return nullptr;
+
+	AdvanceReadahead(offset, size);
+	return m_data + offset;
+}
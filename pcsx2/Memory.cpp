@@ -912,9 +912,17 @@ struct vtlb_PageProtectionInfo
 	u32 ReverseRamMap;
 
 	vtlb_ProtectionMode Mode;
+
+	// Dirty tracking for incremental savestates. DirtyTracked is set while the page is write protected
+	// for the sake of dirty tracking alone, i.e. a write to it doesn't involve any recompiled code.
+	bool DirtyTracked;
+	bool Dirty;
 };
 
-alignas(16) static vtlb_PageProtectionInfo m_PageProtectInfo[Ps2MemSize::MainRam >> __pageshift];
+static constexpr u32 RamPageCount = Ps2MemSize::MainRam >> __pageshift;
+
+alignas(16) static vtlb_PageProtectionInfo m_PageProtectInfo[RamPageCount];
+static bool s_dirty_tracking_active = false;
 
 
 // returns:
@@ -983,9 +991,27 @@ static __fi void mmap_ClearCpuBlock( uint offset )
 	HostSys::MemProtect( &eeMem->Main[rampage<<__pageshift], __pagesize, PageAccess_ReadWrite() );
 	vtlb_UpdateFastmemProtection(rampage << __pageshift, __pagesize, PageAccess_ReadWrite());
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
+	m_PageProtectInfo[rampage].DirtyTracked = false;
+	m_PageProtectInfo[rampage].Dirty = true;
 	Cpu->Clear( m_PageProtectInfo[rampage].ReverseRamMap, __pagesize );
 }
 
+// offset - offset of address relative to psM.
+// Handles a write to a page which is only protected for dirty tracking, returns false for any other page.
+static __fi bool mmap_ClearDirtyTrackingProtection( uint offset )
+{
+	int rampage = offset >> __pageshift;
+	vtlb_PageProtectionInfo& info = m_PageProtectInfo[rampage];
+	if( !info.DirtyTracked || info.Mode == ProtMode_Write )
+		return false;
+
+	HostSys::MemProtect( &eeMem->Main[rampage<<__pageshift], __pagesize, PageAccess_ReadWrite() );
+	vtlb_UpdateFastmemProtection(rampage << __pageshift, __pagesize, PageAccess_ReadWrite());
+	info.DirtyTracked = false;
+	info.Dirty = true;
+	return true;
+}
+
 void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& handled )
 {
 	pxAssert( eeMem );
@@ -1004,6 +1030,10 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 			mmap_ClearCpuBlock(offset);
 			handled = true;
 		}
+		else if (ptr && offset < Ps2MemSize::MainRam && mmap_ClearDirtyTrackingProtection(offset))
+		{
+			handled = true;
+		}
 		else
 		{
 			// fprintf(stderr, "Trying backpatching vaddr %08X\n", vaddr);
@@ -1018,7 +1048,8 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 		if (offset >= Ps2MemSize::MainRam)
 			return;
 
-		mmap_ClearCpuBlock(offset);
+		if (!mmap_ClearDirtyTrackingProtection(offset))
+			mmap_ClearCpuBlock(offset);
 		handled = true;
 	}
 }
@@ -1031,6 +1062,77 @@ void mmap_ResetBlockTracking()
 {
 	//DbgCon.WriteLn( "vtlb/mmap: Block Tracking reset..." );
 	memzero( m_PageProtectInfo );
+	s_dirty_tracking_active = false;
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
 	vtlb_UpdateFastmemProtection(0, Ps2MemSize::MainRam, PageAccess_ReadWrite());
 }
+
+// Write protects every page which isn't already, and clears the dirty flags. Code pages under write
+// protection are picked up by mmap_ClearCpuBlock(), while pages under manual protection can't be
+// trapped at all, so those are always considered dirty.
+void mmap_StartDirtyTracking()
+{
+	pxAssert( eeMem );
+
+	u32 run_start = 0;
+	u32 run_length = 0;
+	const auto protect_run = [&run_start, &run_length]() {
+		if (run_length == 0)
+			return;
+
+		HostSys::MemProtect( &eeMem->Main[run_start << __pageshift], run_length << __pageshift, PageAccess_ReadOnly() );
+		vtlb_UpdateFastmemProtection(run_start << __pageshift, run_length << __pageshift, PageAccess_ReadOnly());
+		run_length = 0;
+	};
+
+	for (u32 rampage = 0; rampage < RamPageCount; rampage++)
+	{
+		vtlb_PageProtectionInfo& info = m_PageProtectInfo[rampage];
+		info.Dirty = (info.Mode == ProtMode_Manual);
+		info.DirtyTracked = (info.Mode == ProtMode_None);
+		if (!info.DirtyTracked)
+		{
+			protect_run();
+			continue;
+		}
+
+		// Batch contiguous pages, protecting them one by one would mean thousands of syscalls.
+		if (run_length == 0)
+			run_start = rampage;
+		run_length++;
+	}
+
+	protect_run();
+	s_dirty_tracking_active = true;
+}
+
+bool mmap_IsDirtyTrackingActive()
+{
+	return s_dirty_tracking_active;
+}
+
+// offset - offset of address relative to psM.
+bool mmap_IsDirtyTrackedPage( u32 offset )
+{
+	return m_PageProtectInfo[offset >> __pageshift].DirtyTracked;
+}
+
+// Returns the number of dirty pages, and if bitmap isn't null, fills it with one bit per EE RAM page.
+u32 mmap_GetDirtyPages( u8* bitmap )
+{
+	u32 count = 0;
+	if (bitmap)
+		std::memset(bitmap, 0, RamPageCount / 8);
+
+	for (u32 rampage = 0; rampage < RamPageCount; rampage++)
+	{
+		if (!m_PageProtectInfo[rampage].Dirty)
+			continue;
+
+		if (bitmap)
+			bitmap[rampage / 8] |= static_cast<u8>(1u << (rampage % 8));
+		count++;
+	}
+
+	return count;
+}
@@ -119,6 +119,14 @@ extern vtlb_ProtectionMode mmap_GetRamPageInfo( u32 paddr );
 extern void mmap_MarkCountedRamPage( u32 paddr );
 extern void mmap_ResetBlockTracking();
 
+// Dirty page tracking for incremental savestates. Once started, every EE RAM page is write protected
+// (or already is, for code pages), and flagged dirty the first time it's written to. Resetting block
+// tracking drops all protection, which also stops dirty tracking.
+extern void mmap_StartDirtyTracking();
+extern bool mmap_IsDirtyTrackingActive();
+extern bool mmap_IsDirtyTrackedPage( u32 offset );
+extern u32 mmap_GetDirtyPages( u8* bitmap );
+
 #define memRead8 vtlb_memRead<mem8_t>
 #define memRead16 vtlb_memRead<mem16_t>
 #define memRead32 vtlb_memRead<mem32_t>
@@ -18,9 +18,13 @@
 #include "common/SafeArray.inl"
 #include "common/Path.h"
 #include "common/StringUtil.h"
+#include "common/Threading.h"
 
 #include <array>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "MemoryCardFile.h"
 #include "MemoryCardFolder.h"
@@ -40,6 +44,11 @@ static const int MCD_SIZE = 1024 * 8 * 16; // Legacy PSX card default size
 
 static const int MC2_MBSIZE = 1024 * 528 * 2; // Size of a single megabyte of card data
 
+// Dirty blocks are written back once the game has stopped writing for this long, or at the latest
+// this long after the first unwritten change. Saves are bursts of a few hundred sector writes.
+static constexpr auto MCD_FLUSH_IDLE_TIME = std::chrono::milliseconds(500);
+static constexpr auto MCD_FLUSH_MAX_DELAY = std::chrono::seconds(5);
+
 static const char* s_folder_mem_card_id_file = "_pcsx2_superblock";
 
 bool FileMcd_Open = false;
@@ -161,22 +170,43 @@ static bool ConvertRAWtoNoECC(const char* file_in, const char* file_out)
 // --------------------------------------------------------------------------------------
 //  FileMemoryCard
 // --------------------------------------------------------------------------------------
-// Provides thread-safe direct file IO mapping.
+// Keeps the whole card image in memory, so SIO reads and writes never touch the disk. Written
+// erase blocks are marked dirty and written back by a background thread when the game stops
+// writing for a moment, instead of seeking and writing every sector on the EE thread.
+//
+// Only the EE thread modifies the image, so it can read it without locking. The flush thread
+// copies the dirty blocks out under the lock, and writes them without it. Blocks which fail to
+// write are marked dirty again, and the card reports write errors to the game until they succeed.
 //
 class FileMemoryCard
 {
 protected:
+	using Clock = std::chrono::steady_clock;
+
 	std::FILE* m_file[8];
 	std::string m_filenames[8];
 	u8 m_effeffs[528 * 16];
 	SafeArray<u8> m_currentdata;
+	std::vector<u8> m_data[8]; // the whole file, including any header before the card data
+	std::vector<bool> m_dirty[8]; // per m_effeffs sized block of the file
+	u32 m_offset[8]; // of the card data in the file
+	u32 m_crcsize[8]; // PSX cards, number of bytes of card data which are part of the checksum
 	u64 m_chksum[8];
 	bool m_ispsx[8];
 	u32 m_chkaddr;
+	bool m_write_failed[8]; // guarded by m_flush_mutex
+
+	std::thread m_flush_thread;
+	std::mutex m_flush_mutex;
+	std::condition_variable m_flush_cv;
+	Clock::time_point m_first_write;
+	Clock::time_point m_last_write;
+	bool m_has_dirty = false;
+	bool m_flush_shutdown = false;
 
 public:
 	FileMemoryCard();
-	virtual ~FileMemoryCard() = default;
+	virtual ~FileMemoryCard();
 
 	void Lock();
 	void Unlock();
@@ -193,8 +223,15 @@ public:
 	u64 GetCRC(uint slot);
 
 protected:
-	bool Seek(std::FILE* f, u32 adr);
+	u32 GetDataOffset(u32 size);
 	bool Create(const char* mcdFile, uint sizeInMB);
+
+	bool LoadImage(uint slot);
+	u8* GetImagePtr(uint slot, u32 adr, int size);
+	bool WriteImage(uint slot, u32 adr, const u8* src, int size);
+	void StopFlushThread();
+	void FlushThread();
+	bool FlushDirtyBlocks(std::unique_lock<std::mutex>& lock);
 };
 
 uint FileMcd_GetMtapPort(uint slot)
@@ -269,6 +306,12 @@ FileMemoryCard::FileMemoryCard()
 	: m_chkaddr(0)
 {
 	memset8<0xff>(m_effeffs);
+	std::fill(std::begin(m_write_failed), std::end(m_write_failed), false);
+}
+
+FileMemoryCard::~FileMemoryCard()
+{
+	StopFlushThread();
 }
 
 void FileMemoryCard::Open()
@@ -364,29 +407,90 @@ void FileMemoryCard::Open()
 #endif
 				);
 		}
-		else // Load checksum
+		else if (!LoadImage(slot))
+		{
+			Host::ReportFormattedErrorAsync("Memory Card", "Error reading memcard.\n");
+			std::fclose(m_file[slot]);
+			m_file[slot] = nullptr;
+		}
+		else
 		{
 			m_filenames[slot] = std::move(fname);
-			m_ispsx[slot] = FileSystem::FSize64(m_file[slot]) == 0x20000;
-			m_chkaddr = 0x210;
+		}
+	}
 
-			if (!m_ispsx[slot] && FileSystem::FSeek64(m_file[slot], m_chkaddr, SEEK_SET) == 0)
-			{
-				const size_t read_result = std::fread(&m_chksum[slot], sizeof(m_chksum[slot]), 1, m_file[slot]);
-				if (read_result == 0)
-					Host::ReportFormattedErrorAsync("Memory Card", "Error reading memcard.\n");
-			}
+	m_has_dirty = false;
+	m_flush_shutdown = false;
+	m_flush_thread = std::thread(&FileMemoryCard::FlushThread, this);
+}
+
+bool FileMemoryCard::LoadImage(uint slot)
+{
+	const s64 size = FileSystem::FSize64(m_file[slot]);
+	if (size <= 0 || size > std::numeric_limits<s32>::max() || FileSystem::FSeek64(m_file[slot], 0, SEEK_SET) != 0)
+		return false;
+
+	std::vector<u8>& data = m_data[slot];
+	data.resize(static_cast<size_t>(size));
+	if (std::fread(data.data(), data.size(), 1, m_file[slot]) != 1)
+	{
+		data = {};
+		return false;
+	}
+
+	m_dirty[slot].assign((data.size() + sizeof(m_effeffs) - 1) / sizeof(m_effeffs), false);
+	m_write_failed[slot] = false;
+	m_offset[slot] = GetDataOffset(static_cast<u32>(data.size()));
+	m_ispsx[slot] = (data.size() == 0x20000);
+	m_chkaddr = 0x210;
+	m_chksum[slot] = 0;
+
+	if (m_ispsx[slot])
+	{
+		// The checksum is the XOR of the card data as 64-bit words, in 528 sector chunks, dropping the
+		// last partial chunk. Writes keep it up to date from here on.
+		static constexpr u32 chunk_size = 528 * 8 * sizeof(u64);
+		const u32 size = (static_cast<u32>(data.size()) / chunk_size) * chunk_size;
+		m_crcsize[slot] = std::min(size, static_cast<u32>(data.size()) - m_offset[slot]);
+		for (u32 pos = 0; (pos + sizeof(u64)) <= m_crcsize[slot]; pos += sizeof(u64))
+		{
+			u64 value;
+			std::memcpy(&value, &data[m_offset[slot] + pos], sizeof(value));
+			m_chksum[slot] ^= value;
 		}
 	}
+	else
+	{
+		if ((m_chkaddr + sizeof(m_chksum[slot])) > data.size())
+			return false;
+
+		std::memcpy(&m_chksum[slot], &data[m_chkaddr], sizeof(m_chksum[slot]));
+	}
+
+	return true;
 }
 
 void FileMemoryCard::Close()
 {
+	StopFlushThread();
+
 	for (int slot = 0; slot < 8; ++slot)
 	{
 		if (!m_file[slot])
 			continue;
 
+		// whatever the flush thread couldn't write is lost now
+		if (m_write_failed[slot])
+		{
+			Console.Error("(FileMcd) Closing '%s' with unwritten changes", m_filenames[slot].c_str());
+			Host::ReportFormattedErrorAsync("Memory Card", "Memory card '%s' could not be saved, recent changes are lost.\n",
+				m_filenames[slot].c_str());
+		}
+
+		m_data[slot] = {};
+		m_dirty[slot] = {};
+		m_write_failed[slot] = false;
+
 		// Store checksum
 		if (!m_ispsx[slot] && FileSystem::FSeek64(m_file[slot], m_chkaddr, SEEK_SET) == 0)
 			std::fwrite(&m_chksum[slot], sizeof(m_chksum[slot]), 1, m_file[slot]);
@@ -405,11 +509,8 @@ void FileMemoryCard::Close()
 	}
 }
 
-// Returns FALSE if the seek failed (is outside the bounds of the file).
-bool FileMemoryCard::Seek(std::FILE* f, u32 adr)
+u32 FileMemoryCard::GetDataOffset(u32 size)
 {
-	const s64 size = FileSystem::FSize64(f);
-
 	// If anyone knows why this filesize logic is here (it appears to be related to legacy PSX
 	// cards, perhaps hacked support for some special emulator-specific memcard formats that
 	// had header info?), then please replace this comment with something useful.  Thanks!  -- air
@@ -425,7 +526,221 @@ bool FileMemoryCard::Seek(std::FILE* f, u32 adr)
 		// perform sanity checks here?
 	}
 
-	return (FileSystem::FSeek64(f, adr + offset, SEEK_SET) == 0);
+	return offset;
+}
+
+u8* FileMemoryCard::GetImagePtr(uint slot, u32 adr, int size)
+{
+	const u64 pos = static_cast<u64>(adr) + m_offset[slot];
+	if (size < 0 || (pos + static_cast<u32>(size)) > m_data[slot].size())
+		return nullptr;
+
+	return &m_data[slot][pos];
+}
+
+bool FileMemoryCard::WriteImage(uint slot, u32 adr, const u8* src, int size)
+{
+	u8* dst = GetImagePtr(slot, adr, size);
+
+	if (m_ispsx[slot])
+	{
+		// Keep the checksum of the card data up to date, a byte at a time since writes needn't be aligned.
+		for (int i = 0; i < size; i++)
+		{
+			const u32 pos = adr + i;
+			if (pos < m_crcsize[slot])
+				m_chksum[slot] ^= static_cast<u64>(dst[i] ^ src[i]) << ((pos % sizeof(u64)) * 8);
+		}
+	}
+
+	std::unique_lock lock(m_flush_mutex);
+	std::memcpy(dst, src, size);
+
+	const u32 pos = adr + m_offset[slot];
+	for (u32 block = pos / sizeof(m_effeffs); block <= ((pos + size - 1) / sizeof(m_effeffs)); block++)
+		m_dirty[slot][block] = true;
+
+	const Clock::time_point now = Clock::now();
+	if (!m_has_dirty)
+	{
+		m_has_dirty = true;
+		m_first_write = now;
+	}
+	m_last_write = now;
+
+	const bool result = !m_write_failed[slot];
+	lock.unlock();
+	m_flush_cv.notify_one();
+	return result;
+}
+
+void FileMemoryCard::StopFlushThread()
+{
+	if (!m_flush_thread.joinable())
+		return;
+
+	// writes back everything which is still dirty before exiting
+	{
+		std::unique_lock lock(m_flush_mutex);
+		m_flush_shutdown = true;
+	}
+	m_flush_cv.notify_one();
+	m_flush_thread.join();
+}
+
+void FileMemoryCard::FlushThread()
+{
+	Threading::SetNameOfCurrentThread("Memory Card Flush");
+
+	std::unique_lock lock(m_flush_mutex);
+	for (;;)
+	{
+		if (!m_has_dirty)
+		{
+			if (m_flush_shutdown)
+				break;
+
+			m_flush_cv.wait(lock);
+			continue;
+		}
+
+		const Clock::time_point deadline = std::min(m_last_write + MCD_FLUSH_IDLE_TIME, m_first_write + MCD_FLUSH_MAX_DELAY);
+		if (!m_flush_shutdown && Clock::now() < deadline)
+		{
+			m_flush_cv.wait_until(lock, deadline);
+			continue;
+		}
+
+		// don't spin on a failing write when shutting down, Close() reports what's left
+		if (!FlushDirtyBlocks(lock) && m_flush_shutdown)
+			break;
+	}
+}
+
+bool FileMemoryCard::FlushDirtyBlocks(std::unique_lock<std::mutex>& lock)
+{
+	struct Run
+	{
+		uint slot;
+		size_t first_block;
+		size_t end_block;
+		u32 offset;
+		std::vector<u8> data;
+	};
+
+	// consecutive dirty blocks go out in a single write
+	std::vector<Run> runs;
+	for (uint slot = 0; slot < 8; slot++)
+	{
+		std::vector<bool>& dirty = m_dirty[slot];
+		for (size_t block = 0; block < dirty.size();)
+		{
+			if (!dirty[block])
+			{
+				block++;
+				continue;
+			}
+
+			const size_t first = block;
+			for (; block < dirty.size() && dirty[block]; block++)
+				dirty[block] = false;
+
+			const u32 offset = static_cast<u32>(first * sizeof(m_effeffs));
+			const u32 end = std::min(static_cast<u32>(block * sizeof(m_effeffs)), static_cast<u32>(m_data[slot].size()));
+			runs.push_back({slot, first, block, offset, std::vector<u8>(m_data[slot].begin() + offset, m_data[slot].begin() + end)});
+		}
+	}
+	m_has_dirty = false;
+
+	// only log the first failure of a slot, not every retry
+	std::array<bool, 8> was_failing;
+	std::copy(std::begin(m_write_failed), std::end(m_write_failed), was_failing.begin());
+
+	lock.unlock();
+
+	// the files are only closed after this thread exits
+	std::array<bool, 8> written = {};
+	std::array<bool, 8> failed = {};
+	for (const Run& run : runs)
+	{
+		std::FILE* const fp = m_file[run.slot];
+		if (FileSystem::FSeek64(fp, run.offset, SEEK_SET) != 0 || std::fwrite(run.data.data(), run.data.size(), 1, fp) != 1)
+		{
+			if (!was_failing[run.slot])
+			{
+				Console.Error("(FileMcd) Failed to write %zu bytes at %08X to '%s'", run.data.size(), run.offset,
+					m_filenames[run.slot].c_str());
+			}
+			failed[run.slot] = true;
+			continue;
+		}
+
+		written[run.slot] = true;
+	}
+
+	for (uint slot = 0; slot < 8; slot++)
+	{
+		if (!written[slot])
+			continue;
+
+		if (std::fflush(m_file[slot]) != 0)
+		{
+			if (!was_failing[slot])
+				Console.Error("(FileMcd) Failed to flush '%s'", m_filenames[slot].c_str());
+			failed[slot] = true;
+			continue;
+		}
+
+		if (failed[slot])
+			continue;
+
+		static auto last = std::chrono::time_point<std::chrono::system_clock>();
+
+		std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - last;
+		if (elapsed > std::chrono::seconds(5))
+		{
+			Host::AddIconOSDMessage(fmt::format("MemoryCardSave{}", slot), ICON_FA_SD_CARD,
+				fmt::format("Memory card '{}' was saved to storage.", Path::GetFileName(m_filenames[slot])),
+				Host::OSD_INFO_DURATION);
+			last = std::chrono::system_clock::now();
+		}
+	}
+
+	lock.lock();
+
+	// put the blocks of a failed slot back, they go out again on the next flush
+	bool result = true;
+	const Clock::time_point now = Clock::now();
+	for (const Run& run : runs)
+	{
+		if (!failed[run.slot])
+			continue;
+
+		for (size_t block = run.first_block; block < run.end_block; block++)
+			m_dirty[run.slot][block] = true;
+
+		if (!m_has_dirty)
+		{
+			m_has_dirty = true;
+			m_first_write = now;
+			m_last_write = now;
+		}
+		result = false;
+	}
+
+	for (uint slot = 0; slot < 8; slot++)
+	{
+		// Close() reports failures of the final flush
+		if (failed[slot] && !m_write_failed[slot] && !m_flush_shutdown)
+			Host::ReportFormattedErrorAsync("Memory Card", "Error writing memcard '%s'.\n", m_filenames[slot].c_str());
+		else if (written[slot] && !failed[slot] && m_write_failed[slot])
+			Console.WriteLn("(FileMcd) Writing to '%s' succeeded again", m_filenames[slot].c_str());
+
+		if (written[slot] || failed[slot])
+			m_write_failed[slot] = failed[slot];
+	}
+
+	return result;
 }
 
 // returns FALSE if an error occurred (either permission denied or disk full)
@@ -459,7 +774,7 @@ void FileMemoryCard::GetSizeInfo(uint slot, McdSizeInfo& outways)
 	outways.Xor = 18;                     // 0x12, XOR 02 00 00 10
 
 	if (pxAssert(m_file[slot]))
-		outways.McdSizeInSectors = static_cast<u32>(FileSystem::FSize64(m_file[slot])) / (outways.SectorSize + outways.EraseBlockSizeInSectors);
+		outways.McdSizeInSectors = static_cast<u32>(m_data[slot].size()) / (outways.SectorSize + outways.EraseBlockSizeInSectors);
 	else
 		outways.McdSizeInSectors = 0x4000;
 
@@ -474,46 +789,44 @@ bool FileMemoryCard::IsPSX(uint slot)
 
 s32 FileMemoryCard::Read(uint slot, u8* dest, u32 adr, int size)
 {
-	std::FILE* mcfp = m_file[slot];
-	if (!mcfp)
+	if (!m_file[slot])
 	{
 		DevCon.Error("(FileMcd) Ignoring attempted read from disabled slot.");
 		memset(dest, 0, size);
 		return 1;
 	}
-	if (!Seek(mcfp, adr))
+
+	const u8* src = GetImagePtr(slot, adr, size);
+	if (!src)
 		return 0;
-	return std::fread(dest, size, 1, mcfp) == 1;
+
+	std::memcpy(dest, src, size);
+	return 1;
 }
 
 s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 {
-	std::FILE* mcfp = m_file[slot];
-
-	if (!mcfp)
+	if (!m_file[slot])
 	{
 		DevCon.Error("(FileMcd) Ignoring attempted save/write to disabled slot.");
 		return 1;
 	}
 
+	const u8* current = GetImagePtr(slot, adr, size);
+	if (!current)
+		return 0;
+
+	m_currentdata.MakeRoomFor(size);
 	if (m_ispsx[slot])
 	{
-		m_currentdata.MakeRoomFor(size);
 		for (int i = 0; i < size; i++)
 			m_currentdata[i] = src[i];
 	}
 	else
 	{
-		if (!Seek(mcfp, adr))
-			return 0;
-		m_currentdata.MakeRoomFor(size);
-
-		const size_t read_result = std::fread(m_currentdata.GetPtr(), size, 1, mcfp);
-		if (read_result == 0)
-			Host::ReportFormattedErrorAsync("Memory Card", "Error reading memcard.\n");
-
 		for (int i = 0; i < size; i++)
 		{
+			m_currentdata[i] = current[i];
 			if ((m_currentdata[i] & src[i]) != src[i])
 				Console.Warning("(FileMcd) Warning: writing to uncleared data. (%d) [%08X]", slot, adr);
 			m_currentdata[i] &= src[i];
@@ -532,78 +845,30 @@ s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 		}
 	}
 
-	if (!Seek(mcfp, adr))
-		return 0;
-
-	if (std::fwrite(m_currentdata.GetPtr(), size, 1, mcfp) == 1)
-	{
-		static auto last = std::chrono::time_point<std::chrono::system_clock>();
-
-		std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - last;
-		if (elapsed > std::chrono::seconds(5))
-		{
-			Host::AddIconOSDMessage(fmt::format("MemoryCardSave{}", slot), ICON_FA_SD_CARD,
-				fmt::format("Memory card '{}' was saved to storage.", Path::GetFileName(m_filenames[slot])),
-				Host::OSD_INFO_DURATION);
-			last = std::chrono::system_clock::now();
-		}
-		return 1;
-	}
-
-	return 0;
+	return WriteImage(slot, adr, m_currentdata.GetPtr(), size) ? 1 : 0;
 }
 
 s32 FileMemoryCard::EraseBlock(uint slot, u32 adr)
 {
-	std::FILE* mcfp = m_file[slot];
-	if (!mcfp)
+	if (!m_file[slot])
 	{
 		DevCon.Error("MemoryCard: Ignoring erase for disabled slot.");
 		return 1;
 	}
 
-	if (!Seek(mcfp, adr))
+	if (!GetImagePtr(slot, adr, sizeof(m_effeffs)))
 		return 0;
-	return std::fwrite(m_effeffs, sizeof(m_effeffs), 1, mcfp) == 1;
+
+	return WriteImage(slot, adr, m_effeffs, sizeof(m_effeffs)) ? 1 : 0;
 }
 
 u64 FileMemoryCard::GetCRC(uint slot)
 {
-	std::FILE* mcfp = m_file[slot];
-	if (!mcfp)
+	if (!m_file[slot])
 		return 0;
 
-	u64 retval = 0;
-
-	if (m_ispsx[slot])
-	{
-		if (!Seek(mcfp, 0))
-			return 0;
-
-		const s64 mcfpsize = FileSystem::FSize64(mcfp);
-		if (mcfpsize < 0)
-			return 0;
-
-		// Process the file in 4k chunks.  Speeds things up significantly.
-
-		u64 buffer[528 * 8]; // use 528 (sector size), ensures even divisibility
-
-		const uint filesize = static_cast<uint>(mcfpsize) / sizeof(buffer);
-		for (uint i = filesize; i; --i)
-		{
-			if (std::fread(buffer, sizeof(buffer), 1, mcfp) != 1)
-				return 0;
-
-			for (uint t = 0; t < std::size(buffer); ++t)
-				retval ^= buffer[t];
-		}
-	}
-	else
-	{
-		retval = m_chksum[slot];
-	}
-
-	return retval;
+	// PSX cards are checksummed as a whole, PS2 cards by what was written, both are kept up to date by Save().
+	return m_chksum[slot];
 }
 
 // --------------------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <thread>
+#include <utility>
 #include <sys/types.h>
 #if _WIN32
 #define read_portable(a, b, c) (recv(a, b, c, 0))
@@ -37,7 +38,6 @@
 #endif
 
 #include "Common.h"
-#include "Memory.h"
 #include "gui/AppSaveStates.h"
 #include "gui/AppCoreThread.h"
 #include "gui/SysThreads.h"
@@ -130,19 +130,29 @@ PINEServer::PINEServer(SysCoreThread* vm, unsigned int slot)
 	Start();
 }
 
-char* PINEServer::MakeOkIPC(char* ret_buffer, uint32_t size = 5)
+#ifdef __linux__
+// sends a reply along with a file descriptor, which the client receives as
+// SCM_RIGHTS ancillary data
+static ssize_t write_with_fd(int sock, char* buf, size_t size, int fd)
 {
-	ToArray<uint32_t>(ret_buffer, size, 0);
-	ret_buffer[4] = IPC_OK;
-	return ret_buffer;
-}
-
-char* PINEServer::MakeFailIPC(char* ret_buffer, uint32_t size = 5)
-{
-	ToArray<uint32_t>(ret_buffer, size, 0);
-	ret_buffer[4] = IPC_FAIL;
-	return ret_buffer;
+	iovec iov = {buf, size};
+	char control[CMSG_SPACE(sizeof(int))] = {};
+
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	return sendmsg(sock, &msg, 0);
 }
+#endif
 
 int PINEServer::StartSocket()
 {
@@ -167,6 +177,9 @@ int PINEServer::StartSocket()
 			return -1;
 		}
 	}
+
+	// a new client starts without a watch list or shared memory
+	ResetClient();
 	return 0;
 }
 
@@ -229,8 +242,16 @@ void PINEServer::ExecuteTaskInThread()
 		{
 			res = ParseCommand(&m_ipc_buffer[4], m_ret_buffer, (u32)end_length - 4);
 
+#ifdef __linux__
+			// the memfd only goes along with a successful MsgShmOpen
+			const int fd = std::exchange(m_shm_send_fd, -1);
+			const auto sent = (fd >= 0 && res.buffer[4] == IPC_OK) ? write_with_fd(m_msgsock, res.buffer, res.size, fd) : write_portable(m_msgsock, res.buffer, res.size);
+#else
+			const auto sent = write_portable(m_msgsock, res.buffer, res.size);
+#endif
+
 			// if we cannot send back our answer restart the socket
-			if (write_portable(m_msgsock, res.buffer, res.size) < 0)
+			if (sent < 0)
 			{
 				if (StartSocket() < 0)
 					return;
@@ -260,266 +281,58 @@ PINEServer::~PINEServer()
 	DESTRUCTOR_CATCHALL
 }
 
-PINEServer::IPCBuffer PINEServer::ParseCommand(char* buf, char* ret_buffer, u32 buf_size)
+bool PINEServer::HasActiveMachine()
 {
-	u32 ret_cnt = 5;
-	u32 buf_cnt = 0;
+	return m_vm->HasActiveMachine();
+}
 
-	while (buf_cnt < buf_size)
+PINEProtocol::EmuStatus PINEServer::GetStatus()
+{
+	if (!m_vm->HasActiveMachine())
+		return Shutdown;
+	return GetCoreThread().IsClosing() ? Paused : Running;
+}
+
+void PINEServer::SaveState(u8 slot)
+{
+	StateCopy_SaveToSlot(slot);
+}
+
+void PINEServer::LoadState(u8 slot)
+{
+	StateCopy_LoadFromSlot(slot, false);
+}
+
+std::string PINEServer::GetInfo(IPCCommand command)
+{
+	switch (command)
 	{
-		if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
-			return IPCBuffer{5, MakeFailIPC(ret_buffer)};
-		buf_cnt++;
-		// example IPC messages: MsgRead/Write
-		// refer to the client doc for more info on the format
-		//         IPC Message event (1 byte)
-		//         |  Memory address (4 byte)
-		//         |  |           argument (VLE)
-		//         |  |           |
-		// format: XX YY YY YY YY ZZ ZZ ZZ ZZ
-		//        reply code: 00 = OK, FF = NOT OK
-		//        |  return value (VLE)
-		//        |  |
-		// reply: XX ZZ ZZ ZZ ZZ
-		switch ((IPCCommand)buf[buf_cnt - 1])
+		case MsgVersion:
 		{
-			case MsgRead8:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 1, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				const u8 res = memRead8(a);
-				ToArray(ret_buffer, res, ret_cnt);
-				ret_cnt += 1;
-				buf_cnt += 4;
-				break;
-			}
-			case MsgRead16:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 2, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				const u16 res = memRead16(a);
-				ToArray(ret_buffer, res, ret_cnt);
-				ret_cnt += 2;
-				buf_cnt += 4;
-				break;
-			}
-			case MsgRead32:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 4, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				const u32 res = memRead32(a);
-				ToArray(ret_buffer, res, ret_cnt);
-				ret_cnt += 4;
-				buf_cnt += 4;
-				break;
-			}
-			case MsgRead64:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 8, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				const u64 res = memRead64(a);
-				ToArray(ret_buffer, res, ret_cnt);
-				ret_cnt += 8;
-				buf_cnt += 4;
-				break;
-			}
-			case MsgWrite8:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 1 + 4, ret_cnt, 0, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				memWrite8(a, FromArray<u8>(&buf[buf_cnt], 4));
-				buf_cnt += 5;
-				break;
-			}
-			case MsgWrite16:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 2 + 4, ret_cnt, 0, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				memWrite16(a, FromArray<u16>(&buf[buf_cnt], 4));
-				buf_cnt += 6;
-				break;
-			}
-			case MsgWrite32:
+			char version[256] = {};
+			if (GIT_TAGGED_COMMIT) // Nightly builds
 			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 4 + 4, ret_cnt, 0, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				memWrite32(a, FromArray<u32>(&buf[buf_cnt], 4));
-				buf_cnt += 8;
-				break;
-			}
-			case MsgWrite64:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 8 + 4, ret_cnt, 0, buf_size))
-					goto error;
-				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
-				memWrite64(a, FromArray<u64>(&buf[buf_cnt], 4));
-				buf_cnt += 12;
-				break;
-			}
-			case MsgVersion:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				char version[256] = {};
-				if (GIT_TAGGED_COMMIT) // Nightly builds
-				{
-					// tagged commit - more modern implementation of dev build versioning
-					// - there is no need to include the commit - that is associated with the tag, git is implied
-					sprintf(version, "PCSX2 Nightly - %s", GIT_TAG);
-				}
-				else
-				{
-					sprintf(version, "PCSX2 %u.%u.%u-%lld", PCSX2_VersionHi, PCSX2_VersionMid, PCSX2_VersionLo, SVN_REV);
-				}
-				const u32 size = strlen(version) + 1;
-				version[size] = 0x00;
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
-					goto error;
-				ToArray(ret_buffer, size, ret_cnt);
-				ret_cnt += 4;
-				memcpy(&ret_buffer[ret_cnt], version, size);
-				ret_cnt += size;
-				break;
-			}
-			case MsgSaveState:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
-					goto error;
-				StateCopy_SaveToSlot(FromArray<u8>(&buf[buf_cnt], 0));
-				buf_cnt += 1;
-				break;
-			}
-			case MsgLoadState:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
-					goto error;
-				StateCopy_LoadFromSlot(FromArray<u8>(&buf[buf_cnt], 0), false);
-				buf_cnt += 1;
-				break;
-			}
-			case MsgTitle:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				char* title = new char[GameInfo::gameName.size() + 1];
-				sprintf(title, "%s", GameInfo::gameName.ToUTF8().data());
-				const u32 size = strlen(title) + 1;
-				title[size] = 0x00;
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
-					goto error;
-				ToArray(ret_buffer, size, ret_cnt);
-				ret_cnt += 4;
-				memcpy(&ret_buffer[ret_cnt], title, size);
-				ret_cnt += size;
-				delete[] title;
-				break;
-			}
-			case MsgID:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				char* title = new char[GameInfo::gameSerial.size() + 1];
-				sprintf(title, "%s", GameInfo::gameSerial.ToUTF8().data());
-				const u32 size = strlen(title) + 1;
-				title[size] = 0x00;
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
-					goto error;
-				ToArray(ret_buffer, size, ret_cnt);
-				ret_cnt += 4;
-				memcpy(&ret_buffer[ret_cnt], title, size);
-				ret_cnt += size;
-				delete[] title;
-				break;
-			}
-			case MsgUUID:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				char* title = new char[GameInfo::gameCRC.size() + 1];
-				sprintf(title, "%s", GameInfo::gameCRC.ToUTF8().data());
-				const u32 size = strlen(title) + 1;
-				title[size] = 0x00;
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
-					goto error;
-				ToArray(ret_buffer, size, ret_cnt);
-				ret_cnt += 4;
-				memcpy(&ret_buffer[ret_cnt], title, size);
-				ret_cnt += size;
-				delete[] title;
-				break;
-			}
-			case MsgGameVersion:
-			{
-				if (!m_vm->HasActiveMachine())
-					goto error;
-				char* title = new char[GameInfo::gameVersion.size() + 1];
-				sprintf(title, "%s", GameInfo::gameVersion.ToUTF8().data());
-				const u32 size = strlen(title) + 1;
-				title[size] = 0x00;
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
-					goto error;
-				ToArray(ret_buffer, size, ret_cnt);
-				ret_cnt += 4;
-				memcpy(&ret_buffer[ret_cnt], title, size);
-				ret_cnt += size;
-				delete[] title;
-				break;
-			}
-			case MsgStatus:
-			{
-				if (!SafetyChecks(buf_cnt, 0, ret_cnt, 4, buf_size))
-					goto error;
-				EmuStatus status;
-				if (m_vm->HasActiveMachine())
-				{
-					if (GetCoreThread().IsClosing())
-						status = Paused;
-					else
-						status = Running;
-				}
-				else
-				{
-					status = Shutdown;
-				}
-				ToArray(ret_buffer, status, ret_cnt);
-				ret_cnt += 4;
-				break;
+				// tagged commit - more modern implementation of dev build versioning
+				// - there is no need to include the commit - that is associated with the tag, git is implied
+				sprintf(version, "PCSX2 Nightly - %s", GIT_TAG);
 			}
-			default:
+			else
 			{
-			error:
-				return IPCBuffer{5, MakeFailIPC(ret_buffer)};
+				sprintf(version, "PCSX2 %u.%u.%u-%lld", PCSX2_VersionHi, PCSX2_VersionMid, PCSX2_VersionLo, SVN_REV);
 			}
+			return version;
 		}
+		case MsgTitle:
+			return StringUtil::wxStringToUTF8String(GameInfo::gameName);
+		case MsgID:
+			return StringUtil::wxStringToUTF8String(GameInfo::gameSerial);
+		case MsgUUID:
+			return StringUtil::wxStringToUTF8String(GameInfo::gameCRC);
+		case MsgGameVersion:
+			return StringUtil::wxStringToUTF8String(GameInfo::gameVersion);
+		default:
+			return {};
 	}
-	return IPCBuffer{(int)ret_cnt, MakeOkIPC(ret_buffer, ret_cnt)};
 }
 
 #endif
\ No newline at end of file
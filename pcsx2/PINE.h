@@ -29,6 +29,7 @@
 
 #include "gui/PersistentThread.h"
 #include "gui/SysThreads.h"
+#include "PINEProtocol.h"
 #include <string>
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -39,7 +40,7 @@ using namespace Threading;
 
 class SysCoreThread;
 
-class PINEServer : public pxThread
+class PINEServer : public pxThread, public PINEProtocol
 {
 	// parent thread
 	typedef pxThread _parent;
@@ -60,18 +61,6 @@ protected:
 #endif
 
 
-	/**
-	 * Maximum memory used by an IPC message request.
-	 * Equivalent to 50,000 Write64 requests.
-	 */
-#define MAX_IPC_SIZE 650000
-
-	/**
-	 * Maximum memory used by an IPC message reply.
-	 * Equivalent to 50,000 Read64 replies.
-	 */
-#define MAX_IPC_RETURN_SIZE 450000
-
 	/**
 	 * IPC return buffer.
 	 * A preallocated buffer used to store all IPC replies.
@@ -85,142 +74,25 @@ protected:
 	 */
 	char* m_ipc_buffer;
 
-	/**
-	 * IPC Command messages opcodes.
-	 * A list of possible operations possible by the IPC.
-	 * Each one of them is what we call an "opcode" and is the first
-	 * byte sent by the IPC to differentiate between commands.
-	 */
-	enum IPCCommand : unsigned char
-	{
-		MsgRead8 = 0, /**< Read 8 bit value to memory. */
-		MsgRead16 = 1, /**< Read 16 bit value to memory. */
-		MsgRead32 = 2, /**< Read 32 bit value to memory. */
-		MsgRead64 = 3, /**< Read 64 bit value to memory. */
-		MsgWrite8 = 4, /**< Write 8 bit value to memory. */
-		MsgWrite16 = 5, /**< Write 16 bit value to memory. */
-		MsgWrite32 = 6, /**< Write 32 bit value to memory. */
-		MsgWrite64 = 7, /**< Write 64 bit value to memory. */
-		MsgVersion = 8, /**< Returns PCSX2 version. */
-		MsgSaveState = 9, /**< Saves a savestate. */
-		MsgLoadState = 0xA, /**< Loads a savestate. */
-		MsgTitle = 0xB, /**< Returns the game title. */
-		MsgID = 0xC, /**< Returns the game ID. */
-		MsgUUID = 0xD, /**< Returns the game UUID. */
-		MsgGameVersion = 0xE, /**< Returns the game verion. */
-		MsgStatus = 0xF, /**< Returns the emulator status. */
-		MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
-	};
-
-	/**
-	 * Emulator status enum.
-	 * A list of possible emulator statuses.
-	 */
-	enum EmuStatus : uint32_t
-	{
-		Running = 0, /**< Game is running */
-		Paused = 1, /**< Game is paused */
-		Shutdown = 2 /**< Game is shutdown */
-	};
-
-	/**
-	 * IPC message buffer.
-	 * A list of all needed fields to store an IPC message.
-	 */
-	struct IPCBuffer
-	{
-		int size; /**< Size of the buffer. */
-		char* buffer; /**< Buffer. */
-	};
-
-	/**
-	 * IPC result codes.
-	 * A list of possible result codes the IPC can send back.
-	 * Each one of them is what we call an "opcode" or "tag" and is the
-	 * first byte sent by the IPC to differentiate between results.
-	 */
-	enum IPCResult : unsigned char
-	{
-		IPC_OK = 0, /**< IPC command successfully completed. */
-		IPC_FAIL = 0xFF /**< IPC command failed to complete. */
-	};
-
 	// handle to the main vm thread
 	SysCoreThread* m_vm;
 
 	// Thread used to relay IPC commands.
 	void ExecuteTaskInThread();
 
-	/**
-	 * Internal function, Parses an IPC command.
-	 * buf: buffer containing the IPC command.
-	 * buf_size: size of the buffer announced.
-	 * ret_buffer: buffer that will be used to send the reply.
-	 * return value: IPCBuffer containing a buffer with the result
-	 *               of the command and its size.
-	 */
-	IPCBuffer ParseCommand(char* buf, char* ret_buffer, u32 buf_size);
-
-	/**
-	 * Formats an IPC buffer
-	 * ret_buffer: return buffer to use.
-	 * size: size of the IPC buffer.
-	 * return value: buffer containing the status code allocated of size
-	 */
-	static inline char* MakeOkIPC(char* ret_buffer, uint32_t size);
-	static inline char* MakeFailIPC(char* ret_buffer, uint32_t size);
-
 	/**
 	 * Initializes an open socket for IPC communication.
 	 * return value: -1 if a fatal failure happened, 0 otherwise.
 	 */
 	int StartSocket();
 
-	/**
-	 * Converts an uint to an char* in little endian
-	 * res_array: the array to modify
-	 * res: the value to convert
-	 * i: when to insert it into the array
-	 * return value: res_array
-	 * NB: implicitely inlined
-	 */
-	template <typename T>
-	static char* ToArray(char* res_array, T res, int i)
-	{
-		memcpy((res_array + i), (char*)&res, sizeof(T));
-		return res_array;
-	}
-
-	/**
-	 * Converts a char* to an uint in little endian
-	 * arr: the array to convert
-	 * i: when to load it from the array
-	 * return value: the converted value
-	 * NB: implicitely inlined
-	 */
-	template <typename T>
-	static T FromArray(char* arr, int i)
-	{
-		return *(T*)(arr + i);
-	}
-
-	/**
-	 * Ensures an IPC message isn't too big.
-	 * return value: false if checks failed, true otherwise.
-	 */
-	static inline bool SafetyChecks(u32 command_len, int command_size, u32 reply_len, int reply_size = 0, u32 buf_size = MAX_IPC_SIZE - 1)
-	{
-		bool res = ((command_len + command_size) > buf_size ||
-					(reply_len + reply_size) >= MAX_IPC_RETURN_SIZE);
-		if (unlikely(res))
-			return false;
-		return true;
-	}
+	bool HasActiveMachine() override;
+	EmuStatus GetStatus() override;
+	void SaveState(u8 slot) override;
+	void LoadState(u8 slot) override;
+	std::string GetInfo(IPCCommand command) override;
 
 public:
-	// Whether the socket processing thread should stop executing/is stopped.
-	bool m_end = true;
-
 	/* Initializers */
 	PINEServer(SysCoreThread* vm, unsigned int slot = PINE_DEFAULT_SLOT);
 	virtual ~PINEServer();
@@ -0,0 +1,416 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include <chrono>
+#include <utility>
+
+#include "Memory.h"
+#include "vtlb.h"
+#include "PINEProtocol.h"
+
+PINEProtocol::~PINEProtocol()
+{
+	m_shm.reset();
+	delete[] m_shm_ret_buffer;
+	delete[] m_shm_ipc_buffer;
+}
+
+char* PINEProtocol::MakeOkIPC(char* ret_buffer, uint32_t size)
+{
+	ToArray<uint32_t>(ret_buffer, size, 0);
+	ret_buffer[4] = IPC_OK;
+	return ret_buffer;
+}
+
+char* PINEProtocol::MakeFailIPC(char* ret_buffer, uint32_t size)
+{
+	ToArray<uint32_t>(ret_buffer, size, 0);
+	ret_buffer[4] = IPC_FAIL;
+	return ret_buffer;
+}
+
+void PINEProtocol::ResetClient()
+{
+	{
+		std::unique_lock lock(m_watch_mutex);
+		m_watch_ranges.clear();
+		m_watch_data.clear();
+	}
+	std::unique_lock lock(m_shm_mutex);
+	m_shm.reset();
+}
+
+void PINEProtocol::OnVSync()
+{
+	bool captured = false;
+	{
+		std::unique_lock lock(m_watch_mutex);
+		if (!m_watch_ranges.empty())
+		{
+			// the game may have remapped a range since it was set, those read as zeroes
+			u32 pos = 0;
+			for (const WatchRange& range : m_watch_ranges)
+			{
+				vtlb_ramReadRange(range.address, &m_watch_data[pos], range.size);
+				pos += range.size;
+			}
+			m_watch_frame++;
+			captured = true;
+		}
+	}
+
+	if (captured)
+		m_watch_cv.notify_one();
+
+	ProcessShmRequests();
+}
+
+void PINEProtocol::ProcessShmRequests()
+{
+	std::unique_lock lock(m_shm_mutex);
+	if (!m_shm || !m_shm->TakeDoorbell())
+		return;
+
+	bool replied = false;
+	while (true)
+	{
+		// the client is behind on reading replies, carry on at the next VSync
+		if (!m_shm->CanPush(MAX_IPC_RETURN_SIZE))
+		{
+			m_shm->RingDoorbell();
+			break;
+		}
+
+		const int size = m_shm->PopRequest(m_shm_ipc_buffer, MAX_IPC_SIZE);
+		if (size == 0)
+			break;
+
+		// same as the socket, a malformed request gets a failure and the
+		// ones queued after it are dropped. this runs on the EE thread, where
+		// a TLB miss can't be taken, so memory commands only accept RAM
+		const IPCBuffer res = (size < 0) ?
+			IPCBuffer{5, MakeFailIPC(m_shm_ret_buffer)} :
+			ParseCommand(&m_shm_ipc_buffer[4], m_shm_ret_buffer, (u32)size - 4, true);
+		m_shm->PushReply(res.buffer, res.size);
+		replied = true;
+	}
+
+	if (replied)
+		m_shm->WakeClient();
+}
+
+PINEProtocol::IPCBuffer PINEProtocol::ParseCommand(char* buf, char* ret_buffer, u32 buf_size, bool from_vsync)
+{
+	u32 ret_cnt = 5;
+	u32 buf_cnt = 0;
+
+	while (buf_cnt < buf_size)
+	{
+		if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
+			return IPCBuffer{5, MakeFailIPC(ret_buffer)};
+		buf_cnt++;
+		// example IPC messages: MsgRead/Write
+		// refer to the client doc for more info on the format
+		//         IPC Message event (1 byte)
+		//         |  Memory address (4 byte)
+		//         |  |           argument (VLE)
+		//         |  |           |
+		// format: XX YY YY YY YY ZZ ZZ ZZ ZZ
+		//        reply code: 00 = OK, FF = NOT OK
+		//        |  return value (VLE)
+		//        |  |
+		// reply: XX ZZ ZZ ZZ ZZ
+		switch ((IPCCommand)buf[buf_cnt - 1])
+		{
+			case MsgRead8:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 1, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 1))
+					goto error;
+				const u8 res = memRead8(a);
+				ToArray(ret_buffer, res, ret_cnt);
+				ret_cnt += 1;
+				buf_cnt += 4;
+				break;
+			}
+			case MsgRead16:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 2, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 2))
+					goto error;
+				const u16 res = memRead16(a);
+				ToArray(ret_buffer, res, ret_cnt);
+				ret_cnt += 2;
+				buf_cnt += 4;
+				break;
+			}
+			case MsgRead32:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 4, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 4))
+					goto error;
+				const u32 res = memRead32(a);
+				ToArray(ret_buffer, res, ret_cnt);
+				ret_cnt += 4;
+				buf_cnt += 4;
+				break;
+			}
+			case MsgRead64:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 8, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 8))
+					goto error;
+				const u64 res = memRead64(a);
+				ToArray(ret_buffer, res, ret_cnt);
+				ret_cnt += 8;
+				buf_cnt += 4;
+				break;
+			}
+			case MsgWrite8:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 1 + 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 1))
+					goto error;
+				memWrite8(a, FromArray<u8>(&buf[buf_cnt], 4));
+				buf_cnt += 5;
+				break;
+			}
+			case MsgWrite16:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 2 + 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 2))
+					goto error;
+				memWrite16(a, FromArray<u16>(&buf[buf_cnt], 4));
+				buf_cnt += 6;
+				break;
+			}
+			case MsgWrite32:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4 + 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 4))
+					goto error;
+				memWrite32(a, FromArray<u32>(&buf[buf_cnt], 4));
+				buf_cnt += 8;
+				break;
+			}
+			case MsgWrite64:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8 + 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				if (from_vsync && !vtlb_IsRamRange(a, 8))
+					goto error;
+				memWrite64(a, FromArray<u64>(&buf[buf_cnt], 4));
+				buf_cnt += 12;
+				break;
+			}
+			case MsgSaveState:
+			{
+				if (!HasActiveMachine() || from_vsync)
+					goto error;
+				if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
+					goto error;
+				SaveState(FromArray<u8>(&buf[buf_cnt], 0));
+				buf_cnt += 1;
+				break;
+			}
+			case MsgLoadState:
+			{
+				if (!HasActiveMachine() || from_vsync)
+					goto error;
+				if (!SafetyChecks(buf_cnt, 1, ret_cnt, 0, buf_size))
+					goto error;
+				LoadState(FromArray<u8>(&buf[buf_cnt], 0));
+				buf_cnt += 1;
+				break;
+			}
+			case MsgVersion:
+			case MsgTitle:
+			case MsgID:
+			case MsgUUID:
+			case MsgGameVersion:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				const std::string info = GetInfo((IPCCommand)buf[buf_cnt - 1]);
+				const u32 size = static_cast<u32>(info.size()) + 1;
+				if (!SafetyChecks(buf_cnt, 0, ret_cnt, size + 4, buf_size))
+					goto error;
+				ToArray(ret_buffer, size, ret_cnt);
+				ret_cnt += 4;
+				memcpy(&ret_buffer[ret_cnt], info.c_str(), size);
+				ret_cnt += size;
+				break;
+			}
+			case MsgStatus:
+			{
+				if (!SafetyChecks(buf_cnt, 0, ret_cnt, 4, buf_size))
+					goto error;
+				const EmuStatus status = GetStatus();
+				ToArray(ret_buffer, status, ret_cnt);
+				ret_cnt += 4;
+				break;
+			}
+			case MsgReadRange:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size > MAX_IPC_RETURN_SIZE || !SafetyChecks(buf_cnt, 8, ret_cnt, size, buf_size))
+					goto error;
+				if (from_vsync && !vtlb_IsRamRange(a, size))
+					goto error;
+				vtlb_memReadRange(a, &ret_buffer[ret_cnt], size);
+				ret_cnt += size;
+				buf_cnt += 8;
+				break;
+			}
+			case MsgWriteRange:
+			{
+				if (!HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size > MAX_IPC_SIZE || !SafetyChecks(buf_cnt, 8 + size, ret_cnt, 0, buf_size))
+					goto error;
+				if (from_vsync && !vtlb_IsRamRange(a, size))
+					goto error;
+				vtlb_memWriteRange(a, &buf[buf_cnt + 8], size);
+				buf_cnt += 8 + size;
+				break;
+			}
+			case MsgWatchSet:
+			{
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 count = FromArray<u32>(&buf[buf_cnt], 0);
+				if (count > (MAX_IPC_SIZE / 8) || !SafetyChecks(buf_cnt, 4 + count * 8, ret_cnt, 0, buf_size))
+					goto error;
+
+				// everything has to fit in a single MsgWatchWait reply, and is read at VSync
+				// on the EE thread, so only RAM can be watched
+				std::vector<WatchRange> ranges(count);
+				u64 total_size = 0;
+				for (u32 i = 0; i < count; i++)
+				{
+					ranges[i].address = FromArray<u32>(&buf[buf_cnt], 4 + i * 8);
+					ranges[i].size = FromArray<u32>(&buf[buf_cnt], 8 + i * 8);
+					total_size += ranges[i].size;
+				}
+				if (total_size >= (MAX_IPC_RETURN_SIZE - 5 - 4))
+					goto error;
+				for (const WatchRange& range : ranges)
+				{
+					if (!vtlb_IsRamRange(range.address, range.size))
+						goto error;
+				}
+
+				std::unique_lock lock(m_watch_mutex);
+				m_watch_ranges = std::move(ranges);
+				m_watch_data.resize(static_cast<size_t>(total_size));
+				m_watch_sent_frame = m_watch_frame;
+				buf_cnt += 4 + count * 8;
+				break;
+			}
+			case MsgWatchWait:
+			{
+				// shared memory requests are already answered at VSync
+				if (!HasActiveMachine() || from_vsync)
+					goto error;
+
+				// replies with the first capture the client hasn't seen yet, the frame
+				// counter tells it how many it missed in between
+				std::unique_lock lock(m_watch_mutex);
+				if (m_watch_ranges.empty() ||
+					!m_watch_cv.wait_for(lock, std::chrono::milliseconds(WATCH_WAIT_TIMEOUT_MS),
+						[this]() { return (m_watch_frame != m_watch_sent_frame || m_end); }) ||
+					m_end)
+				{
+					goto error;
+				}
+				if (!SafetyChecks(buf_cnt, 0, ret_cnt, 4 + static_cast<int>(m_watch_data.size()), buf_size))
+					goto error;
+				ToArray(ret_buffer, m_watch_frame, ret_cnt);
+				ret_cnt += 4;
+				memcpy(&ret_buffer[ret_cnt], m_watch_data.data(), m_watch_data.size());
+				ret_cnt += static_cast<u32>(m_watch_data.size());
+				m_watch_sent_frame = m_watch_frame;
+				break;
+			}
+			case MsgShmOpen:
+			{
+				// the memfd can only be passed over the socket
+				if (from_vsync)
+					goto error;
+
+				std::unique_lock lock(m_shm_mutex);
+				std::unique_ptr<PINEShmRing> shm = std::make_unique<PINEShmRing>();
+				if (!shm->Create())
+					goto error;
+				if (!m_shm_ipc_buffer)
+				{
+					m_shm_ret_buffer = new char[MAX_IPC_RETURN_SIZE];
+					m_shm_ipc_buffer = new char[MAX_IPC_SIZE];
+				}
+				m_shm = std::move(shm);
+				m_shm_send_fd = m_shm->GetFd();
+				break;
+			}
+			default:
+			{
+			error:
+				return IPCBuffer{5, MakeFailIPC(ret_buffer)};
+			}
+		}
+	}
+	return IPCBuffer{(int)ret_cnt, MakeOkIPC(ret_buffer, ret_cnt)};
+}
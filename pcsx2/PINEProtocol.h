@@ -0,0 +1,252 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+#include "PINEShm.h"
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * PINE commands, independent of the transport and of the frontend.
+ * The socket server and the shared memory transport both hand their
+ * requests to ParseCommand(), the frontend provides the few bits of
+ * emulator state the commands need.
+ */
+class PINEProtocol
+{
+public:
+	/**
+	 * Maximum memory used by an IPC message request.
+	 * Equivalent to 50,000 Write64 requests.
+	 */
+#define MAX_IPC_SIZE 650000
+
+	/**
+	 * Maximum memory used by an IPC message reply.
+	 * Equivalent to 50,000 Read64 replies.
+	 */
+#define MAX_IPC_RETURN_SIZE 450000
+
+	/**
+	 * IPC Command messages opcodes.
+	 * A list of possible operations possible by the IPC.
+	 * Each one of them is what we call an "opcode" and is the first
+	 * byte sent by the IPC to differentiate between commands.
+	 */
+	enum IPCCommand : unsigned char
+	{
+		MsgRead8 = 0, /**< Read 8 bit value to memory. */
+		MsgRead16 = 1, /**< Read 16 bit value to memory. */
+		MsgRead32 = 2, /**< Read 32 bit value to memory. */
+		MsgRead64 = 3, /**< Read 64 bit value to memory. */
+		MsgWrite8 = 4, /**< Write 8 bit value to memory. */
+		MsgWrite16 = 5, /**< Write 16 bit value to memory. */
+		MsgWrite32 = 6, /**< Write 32 bit value to memory. */
+		MsgWrite64 = 7, /**< Write 64 bit value to memory. */
+		MsgVersion = 8, /**< Returns PCSX2 version. */
+		MsgSaveState = 9, /**< Saves a savestate. */
+		MsgLoadState = 0xA, /**< Loads a savestate. */
+		MsgTitle = 0xB, /**< Returns the game title. */
+		MsgID = 0xC, /**< Returns the game ID. */
+		MsgUUID = 0xD, /**< Returns the game UUID. */
+		MsgGameVersion = 0xE, /**< Returns the game verion. */
+		MsgStatus = 0xF, /**< Returns the emulator status. */
+		MsgReadRange = 0x10, /**< Reads a block of memory. */
+		MsgWriteRange = 0x11, /**< Writes a block of memory. */
+		MsgWatchSet = 0x12, /**< Sets the ranges captured at every VSync, which have to be RAM. */
+		MsgWatchWait = 0x13, /**< Waits for the next VSync and returns the watched ranges. */
+		MsgShmOpen = 0x14, /**< Opens the shared memory transport, replies with its memfd. */
+		MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
+	};
+
+	/**
+	 * Emulator status enum.
+	 * A list of possible emulator statuses.
+	 */
+	enum EmuStatus : uint32_t
+	{
+		Running = 0, /**< Game is running */
+		Paused = 1, /**< Game is paused */
+		Shutdown = 2 /**< Game is shutdown */
+	};
+
+	/**
+	 * IPC result codes.
+	 * A list of possible result codes the IPC can send back.
+	 * Each one of them is what we call an "opcode" or "tag" and is the
+	 * first byte sent by the IPC to differentiate between results.
+	 */
+	enum IPCResult : unsigned char
+	{
+		IPC_OK = 0, /**< IPC command successfully completed. */
+		IPC_FAIL = 0xFF /**< IPC command failed to complete. */
+	};
+
+	// Whether the socket processing thread should stop executing/is stopped.
+	bool m_end = true;
+
+	virtual ~PINEProtocol();
+
+	/**
+	 * Captures the watched ranges, called by the VM thread at VSync so
+	 * they're all from the same frame, then answers shared memory requests.
+	 */
+	void OnVSync();
+
+protected:
+	/**
+	 * IPC message buffer.
+	 * A list of all needed fields to store an IPC message.
+	 */
+	struct IPCBuffer
+	{
+		int size; /**< Size of the buffer. */
+		char* buffer; /**< Buffer. */
+	};
+
+	/**
+	 * Maximum time MsgWatchWait waits for a VSync, so a paused
+	 * emulator doesn't hang the client forever.
+	 */
+#define WATCH_WAIT_TIMEOUT_MS 1000
+
+	/**
+	 * Memory range watched by MsgWatchSet.
+	 */
+	struct WatchRange
+	{
+		u32 address; /**< Start address. */
+		u32 size; /**< Size in bytes. */
+	};
+
+	/**
+	 * Watch list state, shared between the socket thread and the
+	 * VM thread which captures the ranges at VSync.
+	 * m_watch_frame counts captures, so clients can tell if they
+	 * missed a frame.
+	 */
+	std::mutex m_watch_mutex;
+	std::condition_variable m_watch_cv;
+	std::vector<WatchRange> m_watch_ranges;
+	std::vector<u8> m_watch_data;
+	u32 m_watch_frame = 0;
+	u32 m_watch_sent_frame = 0;
+
+	/**
+	 * Shared memory transport of the current client, answered by the
+	 * VM thread at VSync with its own buffers.
+	 * m_shm_send_fd is set by MsgShmOpen, the socket thread then
+	 * attaches the memfd to the reply.
+	 */
+	std::mutex m_shm_mutex;
+	std::unique_ptr<PINEShmRing> m_shm;
+	char* m_shm_ret_buffer = nullptr;
+	char* m_shm_ipc_buffer = nullptr;
+	int m_shm_send_fd = -1;
+
+	/* Emulator state, provided by the frontend */
+
+	virtual bool HasActiveMachine() = 0;
+	virtual EmuStatus GetStatus() = 0;
+	virtual void SaveState(u8 slot) = 0;
+	virtual void LoadState(u8 slot) = 0;
+
+	/**
+	 * Strings returned by MsgVersion, MsgTitle, MsgID, MsgUUID and
+	 * MsgGameVersion.
+	 */
+	virtual std::string GetInfo(IPCCommand command) = 0;
+
+	/**
+	 * Internal function, Parses an IPC command.
+	 * buf: buffer containing the IPC command.
+	 * buf_size: size of the buffer announced.
+	 * ret_buffer: buffer that will be used to send the reply.
+	 * from_vsync: called by the VM thread at VSync, commands which
+	 *             need it to keep running fail, and so do memory
+	 *             commands on anything but RAM.
+	 * return value: IPCBuffer containing a buffer with the result
+	 *               of the command and its size.
+	 */
+	IPCBuffer ParseCommand(char* buf, char* ret_buffer, u32 buf_size, bool from_vsync = false);
+
+	/**
+	 * Answers the requests queued on the shared memory transport, if
+	 * the client rang the doorbell since the last VSync.
+	 */
+	void ProcessShmRequests();
+
+	/**
+	 * Drops the watch list and the shared memory transport, when a new
+	 * client connects.
+	 */
+	void ResetClient();
+
+	/**
+	 * Formats an IPC buffer
+	 * ret_buffer: return buffer to use.
+	 * size: size of the IPC buffer.
+	 * return value: buffer containing the status code allocated of size
+	 */
+	static char* MakeOkIPC(char* ret_buffer, uint32_t size = 5);
+	static char* MakeFailIPC(char* ret_buffer, uint32_t size = 5);
+
+	/**
+	 * Converts an uint to an char* in little endian
+	 * res_array: the array to modify
+	 * res: the value to convert
+	 * i: when to insert it into the array
+	 * return value: res_array
+	 * NB: implicitely inlined
+	 */
+	template <typename T>
+	static char* ToArray(char* res_array, T res, int i)
+	{
+		memcpy((res_array + i), (char*)&res, sizeof(T));
+		return res_array;
+	}
+
+	/**
+	 * Converts a char* to an uint in little endian
+	 * arr: the array to convert
+	 * i: when to load it from the array
+	 * return value: the converted value
+	 * NB: implicitely inlined
+	 */
+	template <typename T>
+	static T FromArray(char* arr, int i)
+	{
+		return *(T*)(arr + i);
+	}
+
+	/**
+	 * Ensures an IPC message isn't too big.
+	 * return value: false if checks failed, true otherwise.
+	 */
+	static inline bool SafetyChecks(u32 command_len, int command_size, u32 reply_len, int reply_size = 0, u32 buf_size = MAX_IPC_SIZE - 1)
+	{
+		bool res = ((command_len + command_size) > buf_size ||
+					(reply_len + reply_size) >= MAX_IPC_RETURN_SIZE);
+		if (unlikely(res))
+			return false;
+		return true;
+	}
+};
@@ -0,0 +1,261 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "PINEShm.h"
+
+PINEShmRing::~PINEShmRing()
+{
+	Close();
+}
+
+void PINEShmRing::CopyIn(u8* ring, u32 pos, const char* data, u32 size)
+{
+	const u32 offset = pos & (RING_SIZE - 1);
+	const u32 first = std::min(size, RING_SIZE - offset);
+	memcpy(&ring[offset], data, first);
+	memcpy(ring, &data[first], size - first);
+}
+
+void PINEShmRing::CopyOut(char* data, const u8* ring, u32 pos, u32 size)
+{
+	const u32 offset = pos & (RING_SIZE - 1);
+	const u32 first = std::min(size, RING_SIZE - offset);
+	memcpy(data, &ring[offset], first);
+	memcpy(&data[first], ring, size - first);
+}
+
+int PINEShmRing::Pop(std::atomic<u32>& head, std::atomic<u32>& tail, const u8* ring, char* buffer, u32 max_size)
+{
+	// the other side of the ring may be a misbehaving process, so nothing read
+	// from the mapping is trusted
+	const u32 read_pos = tail.load(std::memory_order_relaxed);
+	const u32 write_pos = head.load(std::memory_order_acquire);
+	const u32 available = write_pos - read_pos;
+	if (available == 0)
+		return 0;
+
+	u32 size = 0;
+	if (available >= 4)
+		CopyOut(reinterpret_cast<char*>(&size), ring, read_pos, 4);
+
+	// messages are published whole, so anything partial is malformed
+	if (available > RING_SIZE || size < 4 || size > available || size > max_size)
+	{
+		tail.store(write_pos, std::memory_order_release);
+		return -1;
+	}
+
+	CopyOut(buffer, ring, read_pos, size);
+	tail.store(read_pos + size, std::memory_order_release);
+	return static_cast<int>(size);
+}
+
+void PINEShmRing::Push(std::atomic<u32>& head, u8* ring, const char* data, u32 size)
+{
+	const u32 write_pos = head.load(std::memory_order_relaxed);
+	CopyIn(ring, write_pos, data, size);
+	head.store(write_pos + size, std::memory_order_release);
+}
+
+#ifdef __linux__
+
+static long futex(std::atomic<u32>* address, int op, u32 value, const timespec* timeout)
+{
+	return syscall(SYS_futex, reinterpret_cast<u32*>(address), op, value, timeout, nullptr, 0);
+}
+
+bool PINEShmRing::Map()
+{
+	void* mapping = mmap(nullptr, MAPPING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+	m_mapping = static_cast<u8*>(mapping);
+	return true;
+}
+
+bool PINEShmRing::Create()
+{
+	Close();
+
+	m_fd = memfd_create("pcsx2-pine", MFD_CLOEXEC);
+	if (m_fd < 0)
+		return false;
+	if (ftruncate(m_fd, MAPPING_SIZE) != 0)
+	{
+		Close();
+		return false;
+	}
+	if (!Map())
+		return false;
+
+	// a new memfd is zero filled, which is also the initial state of all positions
+	Header* header = GetHeader();
+	header->magic = MAGIC;
+	header->version = VERSION;
+	header->ring_size = RING_SIZE;
+	return true;
+}
+
+bool PINEShmRing::Attach(int fd)
+{
+	Close();
+
+	m_fd = fd;
+	struct stat info;
+	if (fstat(m_fd, &info) != 0 || info.st_size < static_cast<off_t>(MAPPING_SIZE))
+	{
+		Close();
+		return false;
+	}
+	if (!Map())
+		return false;
+
+	const Header* header = GetHeader();
+	if (header->magic != MAGIC || header->version != VERSION || header->ring_size != RING_SIZE)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void PINEShmRing::Close()
+{
+	if (m_mapping)
+	{
+		munmap(m_mapping, MAPPING_SIZE);
+		m_mapping = nullptr;
+	}
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+}
+
+void PINEShmRing::WakeClient()
+{
+	GetHeader()->reply_seq.fetch_add(1, std::memory_order_release);
+	// shared between processes, so no FUTEX_PRIVATE_FLAG
+	futex(&GetHeader()->reply_seq, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+void PINEShmRing::WaitReply(u32 seen_seq, int timeout_ms)
+{
+	const timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+	// returns straight away if the server already bumped reply_seq
+	futex(&GetHeader()->reply_seq, FUTEX_WAIT, seen_seq, &timeout);
+}
+
+#else
+
+bool PINEShmRing::Map()
+{
+	return false;
+}
+
+bool PINEShmRing::Create()
+{
+	return false;
+}
+
+bool PINEShmRing::Attach(int fd)
+{
+	return false;
+}
+
+void PINEShmRing::Close()
+{
+}
+
+void PINEShmRing::WakeClient()
+{
+}
+
+void PINEShmRing::WaitReply(u32 seen_seq, int timeout_ms)
+{
+}
+
+#endif
+
+bool PINEShmRing::TakeDoorbell()
+{
+	return GetHeader()->doorbell.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+int PINEShmRing::PopRequest(char* buffer, u32 max_size)
+{
+	Header* header = GetHeader();
+	return Pop(header->request_head, header->request_tail, GetRequestRing(), buffer, max_size);
+}
+
+bool PINEShmRing::CanPush(u32 size) const
+{
+	const Header* header = GetHeader();
+	const u32 used = header->reply_head.load(std::memory_order_relaxed) - header->reply_tail.load(std::memory_order_acquire);
+	// a client moving its tail past our head is treated as a full ring
+	return used <= RING_SIZE && size <= RING_SIZE - used;
+}
+
+void PINEShmRing::PushReply(const char* data, u32 size)
+{
+	Push(GetHeader()->reply_head, GetReplyRing(), data, size);
+}
+
+bool PINEShmRing::PushRequest(const char* data, u32 size)
+{
+	Header* header = GetHeader();
+	const u32 used = header->request_head.load(std::memory_order_relaxed) - header->request_tail.load(std::memory_order_acquire);
+	if (size > RING_SIZE - used)
+		return false;
+
+	Push(header->request_head, GetRequestRing(), data, size);
+	return true;
+}
+
+void PINEShmRing::RingDoorbell()
+{
+	// the server only looks at the doorbell at VSync, so there's nobody to wake
+	GetHeader()->doorbell.store(1, std::memory_order_release);
+}
+
+u32 PINEShmRing::GetReplySeq() const
+{
+	return GetHeader()->reply_seq.load(std::memory_order_acquire);
+}
+
+int PINEShmRing::PopReply(char* buffer, u32 max_size)
+{
+	Header* header = GetHeader();
+	return Pop(header->reply_head, header->reply_tail, GetReplyRing(), buffer, max_size);
+}
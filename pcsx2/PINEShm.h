@@ -0,0 +1,139 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "common/Pcsx2Types.h"
+
+/**
+ * Shared memory transport for local PINE clients, Linux only.
+ *
+ * A memfd holds a header page followed by a request ring and a reply ring.
+ * Both rings carry the same framing as the socket: a u32 total size followed
+ * by IPC commands, or by the result code and reply data.
+ *
+ * The client appends requests and sets the doorbell. The server checks the
+ * doorbell at VSync, answers every complete request, bumps reply_seq and
+ * wakes anyone waiting on it with a futex. Clients get the memfd from
+ * MsgShmOpen on the PINE socket, as SCM_RIGHTS ancillary data.
+ */
+class PINEShmRing
+{
+public:
+	static constexpr u32 MAGIC = 0x454E4950; // "PINE"
+	static constexpr u32 VERSION = 1;
+	static constexpr u32 HEADER_SIZE = 4096;
+	// Power of 2, so the free running positions wrap cleanly
+	static constexpr u32 RING_SIZE = 1 << 20;
+	static constexpr u32 MAPPING_SIZE = HEADER_SIZE + RING_SIZE * 2;
+
+	struct Header
+	{
+		u32 magic;
+		u32 version;
+		u32 ring_size;
+		// Futex, set to 1 by the client when it queued requests, cleared by the server
+		alignas(64) std::atomic<u32> doorbell;
+		// Free running byte positions, the client owns the request head and the reply tail
+		alignas(64) std::atomic<u32> request_head;
+		std::atomic<u32> request_tail;
+		alignas(64) std::atomic<u32> reply_head;
+		std::atomic<u32> reply_tail;
+		// Futex, incremented by the server after it wrote replies
+		alignas(64) std::atomic<u32> reply_seq;
+	};
+	static_assert(sizeof(Header) <= HEADER_SIZE);
+	static_assert(std::atomic<u32>::is_always_lock_free);
+
+	PINEShmRing() = default;
+	~PINEShmRing();
+	PINEShmRing(const PINEShmRing&) = delete;
+	PINEShmRing& operator=(const PINEShmRing&) = delete;
+
+	/**
+	 * Creates and maps a new memfd, server side.
+	 * return value: false if shared memory isn't available.
+	 */
+	bool Create();
+
+	/**
+	 * Maps a memfd received from the server, client side.
+	 * Takes ownership of fd.
+	 */
+	bool Attach(int fd);
+
+	void Close();
+
+	int GetFd() const { return m_fd; }
+
+	/* Server side */
+
+	/**
+	 * Clears the doorbell.
+	 * return value: true if the client rang it since the last call.
+	 */
+	bool TakeDoorbell();
+
+	/**
+	 * Copies the next complete request, including its size field, into buffer.
+	 * return value: size of the request, 0 if there is none, -1 if the client
+	 *               sent something malformed. The request ring is emptied then.
+	 */
+	int PopRequest(char* buffer, u32 max_size);
+
+	/**
+	 * Whether a reply of size bytes fits without overwriting unread replies.
+	 */
+	bool CanPush(u32 size) const;
+
+	void PushReply(const char* data, u32 size);
+
+	/**
+	 * Bumps reply_seq, waking clients waiting for replies.
+	 */
+	void WakeClient();
+
+	/* Client side */
+
+	bool PushRequest(const char* data, u32 size);
+	void RingDoorbell();
+	u32 GetReplySeq() const;
+
+	/**
+	 * Waits until reply_seq differs from seen_seq or timeout_ms elapsed.
+	 */
+	void WaitReply(u32 seen_seq, int timeout_ms);
+
+	/**
+	 * Same as PopRequest, for replies.
+	 */
+	int PopReply(char* buffer, u32 max_size);
+
+private:
+	int m_fd = -1;
+	u8* m_mapping = nullptr;
+
+	Header* GetHeader() const { return reinterpret_cast<Header*>(m_mapping); }
+	u8* GetRequestRing() const { return m_mapping + HEADER_SIZE; }
+	u8* GetReplyRing() const { return m_mapping + HEADER_SIZE + RING_SIZE; }
+
+	bool Map();
+	static void CopyIn(u8* ring, u32 pos, const char* data, u32 size);
+	static void CopyOut(char* data, const u8* ring, u32 pos, u32 size);
+	static int Pop(std::atomic<u32>& head, std::atomic<u32>& tail, const u8* ring, char* buffer, u32 max_size);
+	static void Push(std::atomic<u32>& head, u8* ring, const char* data, u32 size);
+};
@@ -215,6 +215,7 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 	EnableVU0 = true;
 	EnableVU1 = true;
 	EnableFastmem = true;
+	EnableBlockCache = false;
 
 	// vu and fpu clamping default to standard overflow.
 	vuOverflow = true;
@@ -272,6 +273,7 @@ void Pcsx2Config::RecompilerOptions::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(EnableVU0);
 	SettingsWrapBitBool(EnableVU1);
 	SettingsWrapBitBool(EnableFastmem);
+	SettingsWrapBitBool(EnableBlockCache);
 
 	SettingsWrapBitBool(vuOverflow);
 	SettingsWrapBitBool(vuExtraOverflow);
@@ -1200,6 +1202,11 @@ Pcsx2Config::Pcsx2Config()
 	}
 
 	GzipIsoIndexTemplate = "$(f).pindex.tmp";
+	CdvdPrefetchDepth = 8;
+	SavestateCompressionLevel = 3;
+	RewindFrequency = 30;
+	RewindBufferSize = 32;
+	TracingTier = 1;
 }
 
 void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
@@ -1214,6 +1221,7 @@ void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
 	SettingsWrapBitBool(CdvdVerboseReads);
 	SettingsWrapBitBool(CdvdDumpBlocks);
 	SettingsWrapBitBool(CdvdShareWrite);
+	SettingsWrapBitBool(CdvdMapImages);
 	SettingsWrapBitBool(EnablePatches);
 	SettingsWrapBitBool(EnableCheats);
 	SettingsWrapBitBool(EnablePINE);
@@ -1231,6 +1239,8 @@ void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
 
 	SettingsWrapBitBool(BackupSavestate);
 	SettingsWrapBitBool(SavestateZstdCompression);
+	SettingsWrapBitBool(EnableRewind);
+	SettingsWrapBitBool(IncrementalSavestates);
 	SettingsWrapBitBool(McdEnableEjection);
 	SettingsWrapBitBool(McdFolderAutoManage);
 #ifndef PCSX2_CORE
@@ -1265,6 +1275,11 @@ void Pcsx2Config::LoadSave(SettingsWrapper& wrap)
 #endif
 
 	SettingsWrapEntry(GzipIsoIndexTemplate);
+	SettingsWrapEntry(CdvdPrefetchDepth);
+	SettingsWrapEntry(SavestateCompressionLevel);
+	SettingsWrapEntry(RewindFrequency);
+	SettingsWrapEntry(RewindBufferSize);
+	SettingsWrapEntry(TracingTier);
 
 	// For now, this in the derived config for backwards ini compatibility.
 #ifdef PCSX2_CORE
@@ -1342,7 +1357,12 @@ bool Pcsx2Config::operator==(const Pcsx2Config& right) const
 		OpEqu(Framerate) &&
 		OpEqu(Trace) &&
 		OpEqu(BaseFilenames) &&
-		OpEqu(GzipIsoIndexTemplate);
+		OpEqu(GzipIsoIndexTemplate) &&
+		OpEqu(CdvdPrefetchDepth) &&
+		OpEqu(SavestateCompressionLevel) &&
+		OpEqu(RewindFrequency) &&
+		OpEqu(RewindBufferSize) &&
+		OpEqu(TracingTier);
 	for (u32 i = 0; i < sizeof(Mcd) / sizeof(Mcd[0]); i++)
 	{
 		equal &= OpEqu(Mcd[i].Enabled);
@@ -1374,10 +1394,16 @@ void Pcsx2Config::CopyConfig(const Pcsx2Config& cfg)
 	}
 
 	GzipIsoIndexTemplate = cfg.GzipIsoIndexTemplate;
+	CdvdPrefetchDepth = cfg.CdvdPrefetchDepth;
+	SavestateCompressionLevel = cfg.SavestateCompressionLevel;
+	RewindFrequency = cfg.RewindFrequency;
+	RewindBufferSize = cfg.RewindBufferSize;
+	TracingTier = cfg.TracingTier;
 
 	CdvdVerboseReads = cfg.CdvdVerboseReads;
 	CdvdDumpBlocks = cfg.CdvdDumpBlocks;
 	CdvdShareWrite = cfg.CdvdShareWrite;
+	CdvdMapImages = cfg.CdvdMapImages;
 	EnablePatches = cfg.EnablePatches;
 	EnableCheats = cfg.EnableCheats;
 	EnablePINE = cfg.EnablePINE;
@@ -1387,6 +1413,8 @@ void Pcsx2Config::CopyConfig(const Pcsx2Config& cfg)
 	UseBOOT2Injection = cfg.UseBOOT2Injection;
 	BackupSavestate = cfg.BackupSavestate;
 	SavestateZstdCompression = cfg.SavestateZstdCompression;
+	EnableRewind = cfg.EnableRewind;
+	IncrementalSavestates = cfg.IncrementalSavestates;
 	McdEnableEjection = cfg.McdEnableEjection;
 	McdFolderAutoManage = cfg.McdFolderAutoManage;
 	MultitapPort0_Enabled = cfg.MultitapPort0_Enabled;
@@ -0,0 +1,289 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include "common/SafeArray.inl"
+#include "common/ThreadPool.h"
+#include "common/Timer.h"
+
+#include "Config.h"
+#include "Rewind.h"
+#include "SaveState.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <zstd.h>
+
+// The ring is made of reverse deltas: the newest state is kept uncompressed, and every older snapshot
+// is stored as the XOR against the snapshot after it. Consecutive states only differ in the memory the
+// game touched in between, so the deltas are mostly zeros and compress extremely well. Stepping back is
+// then a single decompress and XOR against the newest state, and the oldest snapshot can be dropped
+// without affecting the others.
+struct RewindSnapshot
+{
+	std::vector<ArchiveEntry> entries;
+	std::vector<u8> data; // zstd compressed delta against the next state if delta is set, otherwise the whole state
+	u32 size;
+	bool delta;
+};
+
+// Deltas are mostly zeros, higher levels cost a lot more time for very little gain.
+static constexpr int COMPRESSION_LEVEL = 1;
+
+static std::unique_ptr<cb::ThreadPool> s_worker;
+static std::atomic_bool s_compressing{false};
+
+// Newest state, only touched by the CPU thread, or by the worker while s_compressing is set.
+static std::unique_ptr<ArchiveEntryList> s_head;
+static u32 s_frames_since_capture = 0;
+
+static std::mutex s_mutex;
+static std::deque<RewindSnapshot> s_snapshots; // oldest first
+static Rewind::Stats s_stats = {};
+
+static u32 GetStateSize(const ArchiveEntryList& list)
+{
+	size_t size = 0;
+	for (size_t i = 0; i < list.GetLength(); i++)
+		size = std::max<size_t>(size, list[i].GetDataIndex() + list[i].GetDataSize());
+
+	return static_cast<u32>(size);
+}
+
+static bool HasSameLayout(const ArchiveEntryList& lhs, const ArchiveEntryList& rhs)
+{
+	if (lhs.GetLength() != rhs.GetLength())
+		return false;
+
+	for (size_t i = 0; i < lhs.GetLength(); i++)
+	{
+		if (lhs[i].GetDataIndex() != rhs[i].GetDataIndex() || lhs[i].GetDataSize() != rhs[i].GetDataSize())
+			return false;
+	}
+
+	return true;
+}
+
+static void XorState(u8* dst, const u8* src, u32 size)
+{
+	u32 pos = 0;
+	for (; (pos + sizeof(u64)) <= size; pos += sizeof(u64))
+	{
+		u64 a, b;
+		std::memcpy(&a, dst + pos, sizeof(a));
+		std::memcpy(&b, src + pos, sizeof(b));
+		a ^= b;
+		std::memcpy(dst + pos, &a, sizeof(a));
+	}
+
+	for (; pos < size; pos++)
+		dst[pos] ^= src[pos];
+}
+
+// Runs on the worker. prev is consumed, the delta is built in place in its buffer. Snapshots are
+// dropped from the front until the ring fits in budget bytes.
+static void CompressSnapshot(std::unique_ptr<ArchiveEntryList> prev, const ArchiveEntryList& next, u64 budget)
+{
+	Common::Timer timer;
+
+	RewindSnapshot snapshot;
+	snapshot.size = GetStateSize(*prev);
+	snapshot.delta = HasSameLayout(*prev, next);
+	for (size_t i = 0; i < prev->GetLength(); i++)
+		snapshot.entries.push_back((*prev)[i]);
+
+	u8* const data = prev->GetPtr(0);
+	if (snapshot.delta)
+		XorState(data, next.GetPtr(0), snapshot.size);
+
+	snapshot.data.resize(ZSTD_compressBound(snapshot.size));
+	const size_t compressed_size = ZSTD_compress(snapshot.data.data(), snapshot.data.size(), data, snapshot.size, COMPRESSION_LEVEL);
+
+	std::unique_lock lock(s_mutex);
+	if (ZSTD_isError(compressed_size))
+	{
+		// Everything older is a delta against this one, so none of it can be restored anymore.
+		Console.Error("(Rewind) Failed to compress snapshot: %s", ZSTD_getErrorName(compressed_size));
+		s_snapshots.clear();
+		s_stats.buffer_bytes = 0;
+		s_stats.num_snapshots = 0;
+		return;
+	}
+
+	snapshot.data.resize(compressed_size);
+	snapshot.data.shrink_to_fit();
+
+	s_stats.last_snapshot_bytes = compressed_size;
+	s_stats.buffer_bytes += compressed_size;
+	s_snapshots.push_back(std::move(snapshot));
+
+	while (!s_snapshots.empty() && s_stats.buffer_bytes > budget)
+	{
+		s_stats.buffer_bytes -= s_snapshots.front().data.size();
+		s_snapshots.pop_front();
+	}
+
+	s_stats.num_snapshots = static_cast<u32>(s_snapshots.size());
+	s_stats.last_compress_ms = static_cast<float>(timer.GetTimeMilliseconds());
+}
+
+static void WaitForWorker()
+{
+	if (s_worker)
+		s_worker->Wait();
+}
+
+static void CaptureSnapshot()
+{
+	if (s_compressing.load(std::memory_order_acquire))
+	{
+		// Don't stall the CPU thread, just try again next interval.
+		std::unique_lock lock(s_mutex);
+		s_stats.skipped_captures++;
+		return;
+	}
+
+	Common::Timer timer;
+	std::unique_ptr<ArchiveEntryList> state;
+	try
+	{
+		state = SaveState_DownloadState();
+	}
+	catch (Exception::BaseException& e)
+	{
+		Console.Error("(Rewind) Failed to capture snapshot: %s", e.DiagMsg().c_str());
+		return;
+	}
+
+	{
+		std::unique_lock lock(s_mutex);
+		s_stats.last_capture_ms = static_cast<float>(timer.GetTimeMilliseconds());
+		s_stats.state_bytes = GetStateSize(*state);
+		s_stats.total_captures++;
+	}
+
+	std::unique_ptr<ArchiveEntryList> prev = std::move(s_head);
+	s_head = std::move(state);
+	if (!prev)
+		return;
+
+	if (!s_worker)
+		s_worker = std::make_unique<cb::ThreadPool>(1);
+
+	// ThreadPool wants copyable functions, so ownership goes through a raw pointer. The config
+	// belongs to the CPU thread, so the budget is read here rather than on the worker.
+	ArchiveEntryList* const prev_ptr = prev.release();
+	const ArchiveEntryList* const next_ptr = s_head.get();
+	const u64 budget = static_cast<u64>(EmuConfig.RewindBufferSize) * _1mb;
+	s_compressing.store(true, std::memory_order_release);
+	s_worker->Schedule([prev_ptr, next_ptr, budget]() {
+		CompressSnapshot(std::unique_ptr<ArchiveEntryList>(prev_ptr), *next_ptr, budget);
+		s_compressing.store(false, std::memory_order_release);
+	});
+}
+
+void Rewind::OnVSync()
+{
+	if (!EmuConfig.EnableRewind)
+		return;
+
+	if (++s_frames_since_capture < std::max(EmuConfig.RewindFrequency, 1u))
+		return;
+
+	s_frames_since_capture = 0;
+	CaptureSnapshot();
+}
+
+bool Rewind::StepBack()
+{
+	WaitForWorker();
+	if (!s_head)
+		return false;
+
+	RewindSnapshot snapshot;
+	{
+		std::unique_lock lock(s_mutex);
+		if (s_snapshots.empty())
+			return false;
+
+		snapshot = std::move(s_snapshots.back());
+		s_snapshots.pop_back();
+		s_stats.buffer_bytes -= snapshot.data.size();
+		s_stats.num_snapshots = static_cast<u32>(s_snapshots.size());
+	}
+
+	Common::Timer timer;
+
+	std::unique_ptr<ArchiveEntryList> state = std::make_unique<ArchiveEntryList>(
+		new VmStateBuffer(static_cast<int>(snapshot.size), "Rewind Snapshot"));
+	const size_t size = ZSTD_decompress(state->GetPtr(0), snapshot.size, snapshot.data.data(), snapshot.data.size());
+	if (ZSTD_isError(size) || size != snapshot.size)
+	{
+		Console.Error("(Rewind) Failed to decompress snapshot.");
+		Clear();
+		return false;
+	}
+
+	if (snapshot.delta)
+		XorState(state->GetPtr(0), s_head->GetPtr(0), snapshot.size);
+
+	for (const ArchiveEntry& entry : snapshot.entries)
+		state->Add(entry);
+
+	// If this throws, the VM is in an unknown state anyway, and the caller resets it.
+	s_head.reset();
+	s_frames_since_capture = 0;
+	SaveState_UploadState(*state);
+	s_head = std::move(state);
+
+	DevCon.WriteLn("(Rewind) Stepped back in %.2f ms, %u snapshots left", timer.GetTimeMilliseconds(), s_stats.num_snapshots);
+	return true;
+}
+
+void Rewind::Clear()
+{
+	WaitForWorker();
+	s_head.reset();
+	s_frames_since_capture = 0;
+
+	std::unique_lock lock(s_mutex);
+	s_snapshots.clear();
+	s_stats.num_snapshots = 0;
+	s_stats.buffer_bytes = 0;
+}
+
+void Rewind::Shutdown()
+{
+	Clear();
+	s_worker.reset();
+
+	if (s_stats.total_captures > 0)
+	{
+		DevCon.WriteLn("(Rewind) %u captures (%u skipped), last state %llu bytes compressed to %llu bytes, capture %.2f ms, compress %.2f ms",
+			s_stats.total_captures, s_stats.skipped_captures, static_cast<unsigned long long>(s_stats.state_bytes),
+			static_cast<unsigned long long>(s_stats.last_snapshot_bytes),
+			s_stats.last_capture_ms, s_stats.last_compress_ms);
+	}
+
+	s_stats = {};
+}
+
+Rewind::Stats Rewind::GetStats()
+{
+	std::unique_lock lock(s_mutex);
+	return s_stats;
+}
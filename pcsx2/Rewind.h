@@ -0,0 +1,48 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+namespace Rewind
+{
+	struct Stats
+	{
+		u32 num_snapshots; // snapshots which can currently be stepped back to
+		u64 buffer_bytes; // compressed size of those snapshots
+		u64 state_bytes; // uncompressed size of the last captured state
+		u64 last_snapshot_bytes; // compressed size of the last snapshot added to the ring
+		float last_capture_ms; // time the CPU thread spent serializing the last state
+		float last_compress_ms; // time the worker spent delta'ing and compressing the last snapshot
+		u32 total_captures;
+		u32 skipped_captures; // captures dropped because the worker hadn't finished the previous one
+	};
+
+	/// Captures a snapshot every RewindFrequency frames when rewind is enabled. Call once per vsync on the CPU thread.
+	void OnVSync();
+
+	/// Loads the snapshot preceding the current one. Returns false if there is none.
+	/// Throws if the state could not be loaded, in which case the VM should be reset.
+	bool StepBack();
+
+	/// Drops all snapshots, e.g. after a reset, or when the settings change.
+	void Clear();
+
+	/// Drops all snapshots and stops the compression worker.
+	void Shutdown();
+
+	Stats GetStats();
+} // namespace Rewind
@@ -0,0 +1,159 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Assertions.h"
+#include "common/Pcsx2Types.h"
+
+#include "interpolate_table.h"
+
+// Performs a 64-bit multiplication between two values and returns the
+// high 32 bits as a result (discarding the fractional 32 bits).
+// The combined fractional bits of both inputs must be 32 bits for this
+// to work properly.
+//
+// This is meant to be a drop-in replacement for times when the 'div' part
+// of a MulDiv is a constant.  (example: 1<<8, or 4096, etc)
+//
+// [Air] Performance breakdown: This is over 10 times faster than MulDiv in
+//   a *worst case* scenario.  It's also more accurate since it forces the
+//   caller to  extend the inputs so that they make use of all 32 bits of
+//   precision.
+//
+static __forceinline s32 MulShr32(s32 srcval, s32 mulval)
+{
+	return (s64)srcval * mulval >> 32;
+}
+
+// Data is expected to be 16 bit signed (typical stuff!).
+// volume is expected to be 32 bit signed (31 bits with reverse phase)
+// Data is shifted up by 1 bit to give the output an effective 16 bit range.
+static __forceinline s32 ApplyVolume(s32 data, s32 volume)
+{
+	//return (volume * data) >> 15;
+	return MulShr32(data << 1, volume);
+}
+
+__forceinline static s32 GaussianInterpolate(s32 pv4, s32 pv3, s32 pv2, s32 pv1, s32 i)
+{
+	s32 out = 0;
+	out =  (interpTable[0x0FF - i] * pv4) >> 15;
+	out += (interpTable[0x1FF - i] * pv3) >> 15;
+	out += (interpTable[0x100 + i] * pv2) >> 15;
+	out += (interpTable[0x000 + i] * pv1) >> 15;
+
+	return out;
+}
+
+/*
+   Tension: 65535 is high, 32768 is normal, 0 is low
+*/
+
+template <s32 i_tension>
+__forceinline static s32 HermiteInterpolate(
+	s32 y0, // 16.0
+	s32 y1, // 16.0
+	s32 y2, // 16.0
+	s32 y3, // 16.0
+	s32 mu  //  0.12
+)
+{
+	s32 m00 = ((y1 - y0) * i_tension) >> 16; // 16.0
+	s32 m01 = ((y2 - y1) * i_tension) >> 16; // 16.0
+	s32 m0 = m00 + m01;
+
+	s32 m10 = ((y2 - y1) * i_tension) >> 16; // 16.0
+	s32 m11 = ((y3 - y2) * i_tension) >> 16; // 16.0
+	s32 m1 = m10 + m11;
+
+	s32 val = ((2 * y1 + m0 + m1 - 2 * y2) * mu) >> 12;       // 16.0
+	val = ((val - 3 * y1 - 2 * m0 - m1 + 3 * y2) * mu) >> 12; // 16.0
+	val = ((val + m0) * mu) >> 12;                            // 16.0
+
+	return (val + (y1));
+}
+
+__forceinline static s32 CatmullRomInterpolate(
+	s32 y0, // 16.0
+	s32 y1, // 16.0
+	s32 y2, // 16.0
+	s32 y3, // 16.0
+	s32 mu  //  0.12
+)
+{
+	//q(t) = 0.5 *(    	(2 * P1) +
+	//	(-P0 + P2) * t +
+	//	(2*P0 - 5*P1 + 4*P2 - P3) * t2 +
+	//	(-P0 + 3*P1- 3*P2 + P3) * t3)
+
+	s32 a3 = (-y0 + 3 * y1 - 3 * y2 + y3);
+	s32 a2 = (2 * y0 - 5 * y1 + 4 * y2 - y3);
+	s32 a1 = (-y0 + y2);
+	s32 a0 = (2 * y1);
+
+	s32 val = ((a3)*mu) >> 12;
+	val = ((a2 + val) * mu) >> 12;
+	val = ((a1 + val) * mu) >> 12;
+
+	return (a0 + val) >> 1;
+}
+
+__forceinline static s32 CubicInterpolate(
+	s32 y0, // 16.0
+	s32 y1, // 16.0
+	s32 y2, // 16.0
+	s32 y3, // 16.0
+	s32 mu  //  0.12
+)
+{
+	const s32 a0 = y3 - y2 - y0 + y1;
+	const s32 a1 = y0 - y1 - a0;
+	const s32 a2 = y2 - y0;
+
+	s32 val = ((a0)*mu) >> 12;
+	val = ((val + a1) * mu) >> 12;
+	val = ((val + a2) * mu) >> 12;
+
+	return (val + y1);
+}
+
+// Returns a 16 bit result.
+// Uses standard template-style optimization techniques to statically generate five different
+// versions of this function (one for each type of interpolation).
+template <int InterpType>
+static __forceinline s32 InterpolateVoice(s32 pv4, s32 pv3, s32 pv2, s32 pv1, s32 mu)
+{
+	switch (InterpType)
+	{
+		case 0:
+			return pv1;
+		case 1:
+			return (pv1) - (((pv2 - pv1) * mu) >> 12);
+
+		case 2:
+			return CubicInterpolate(pv4, pv3, pv2, pv1, mu);
+		case 3:
+			return HermiteInterpolate<16384>(pv4, pv3, pv2, pv1, mu);
+		case 4:
+			return CatmullRomInterpolate(pv4, pv3, pv2, pv1, mu);
+		case 5:
+			return GaussianInterpolate(pv4, pv3, pv2, pv1, (mu & 0x0ff0) >> 4);
+
+			jNO_DEFAULT;
+	}
+
+	return 0; // technically unreachable!
+}
@@ -30,6 +30,8 @@
 
 #include "spu2.h" // needed until I figure out a nice solution for irqcallback dependencies.
 
+#include "common/Tracing.h"
+
 s16* spu2regs = nullptr;
 s16* _spu2mem = nullptr;
 
@@ -414,6 +416,7 @@ __forceinline void TimeUpdate(u32 cClocks)
 		TickInterval = 768; // Reset to default, in case the user hotswitched from async to something else.
 
 	//Update Mixing Progress
+	Tracing::ScopedZone mix_zone("SPU2 Mix", Tracing::Tier::Detail, dClocks >= TickInterval);
 	while (dClocks >= TickInterval)
 	{
 		for (int i = 0; i < 2; i++)
@@ -22,6 +22,7 @@
 #include "common/SafeArray.inl"
 #include "common/ScopedGuard.h"
 #include "common/StringUtil.h"
+#include "common/ThreadPool.h"
 #include "common/ZipHelpers.h"
 
 #include "ps2/BiosTools.h"
@@ -58,8 +59,11 @@
 
 #include "fmt/core.h"
 
+#include <bitset>
 #include <csetjmp>
 #include <png.h>
+#include <zlib.h>
+#include <zstd.h>
 
 using namespace R5900;
 
@@ -403,6 +407,24 @@ std::string Exception::SaveStateLoadError::FormatDisplayMessage() const
 static const char* EntryFilename_StateVersion = "PCSX2 Savestate Version.id";
 static const char* EntryFilename_Screenshot = "Screenshot.png";
 static const char* EntryFilename_InternalStructures = "PCSX2 Internal Structures.dat";
+static const char* EntryFilename_BaseStateId = "PCSX2 Base State.id";
+static const char* EntryFilename_EEMemoryDelta = "eeMemoryDelta.bin";
+
+// Incremental states replace eeMemory.bin with eeMemoryDelta.bin, which starts with this header, followed
+// by the file name of the base state, a bitmap with one bit per EE RAM page, and the contents of every page
+// set in the bitmap. The rest of the EE RAM comes from the base state, which must carry the same id.
+struct EEMemoryDeltaHeader
+{
+	u32 magic;
+	u32 page_size;
+	u32 page_count;
+	u32 dirty_count;
+	u64 base_id;
+	u32 base_filename_length;
+	u32 reserved;
+};
+
+static constexpr u32 EEMemoryDeltaMagic = 0x444D4545; // EEMD
 
 struct SysState_Component
 {
@@ -461,6 +483,23 @@ static void SysState_ComponentFreezeIn(zip_file_t* zf, SysState_Component comp)
 		throw std::runtime_error(std::string(" * ") + comp.name + std::string(": Error loading state!\n"));
 }
 
+static void SysState_ComponentFreezeIn(const u8* data, u32 size, SysState_Component comp)
+{
+	if (!size)
+		return;
+
+	freezeData fP = { 0, nullptr };
+	if (comp.freeze(FreezeAction::Size, &fP) != 0)
+		fP.size = 0;
+
+	Console.Indent().WriteLn("Loading %s", comp.name);
+
+	// Plugins don't write to the buffer when loading, it's only non-const because freezeData is shared with saving.
+	fP.data = const_cast<u8*>(data);
+	if (static_cast<u32>(fP.size) != size || comp.freeze(FreezeAction::Load, &fP) != 0)
+		throw std::runtime_error(std::string(" * ") + comp.name + std::string(": Error loading state!\n"));
+}
+
 static void SysState_ComponentFreezeOut(SaveStateBase& writer, SysState_Component comp)
 {
 	freezeData fP = { 0, NULL };
@@ -487,6 +526,7 @@ public:
 
 	virtual const char* GetFilename() const = 0;
 	virtual void FreezeIn(zip_file_t* zf) const = 0;
+	virtual void FreezeIn(const u8* data, u32 size) const = 0;
 	virtual void FreezeOut(SaveStateBase& writer) const = 0;
 	virtual bool IsRequired() const = 0;
 };
@@ -499,6 +539,7 @@ protected:
 
 public:
 	virtual void FreezeIn(zip_file_t* zf) const;
+	virtual void FreezeIn(const u8* data, u32 size) const;
 	virtual void FreezeOut(SaveStateBase& writer) const;
 	virtual bool IsRequired() const { return true; }
 
@@ -518,6 +559,17 @@ void MemorySavestateEntry::FreezeIn(zip_file_t* zf) const
 	}
 }
 
+void MemorySavestateEntry::FreezeIn(const u8* data, u32 size) const
+{
+	const u32 expectedSize = GetDataSize();
+	std::memcpy(GetDataPtr(), data, std::min(size, expectedSize));
+	if (size != expectedSize)
+	{
+		Console.WriteLn(Color_Yellow, " '%s' is incomplete (expected 0x%x bytes, loading only 0x%x bytes)",
+			GetFilename(), expectedSize, std::min(size, expectedSize));
+	}
+}
+
 void MemorySavestateEntry::FreezeOut(SaveStateBase& writer) const
 {
 	writer.FreezeMem(GetDataPtr(), GetDataSize());
@@ -546,6 +598,12 @@ public:
 		SysClearExecutionCache();
 		MemorySavestateEntry::FreezeIn(zf);
 	}
+
+	virtual void FreezeIn(const u8* data, u32 size) const
+	{
+		SysClearExecutionCache();
+		MemorySavestateEntry::FreezeIn(data, size);
+	}
 };
 
 class SavestateEntry_IopMemory : public MemorySavestateEntry
@@ -635,6 +693,7 @@ public:
 
 	const char* GetFilename() const { return "SPU2.bin"; }
 	void FreezeIn(zip_file_t* zf) const { return SysState_ComponentFreezeIn(zf, SPU2); }
+	void FreezeIn(const u8* data, u32 size) const { return SysState_ComponentFreezeIn(data, size, SPU2); }
 	void FreezeOut(SaveStateBase& writer) const { return SysState_ComponentFreezeOut(writer, SPU2); }
 	bool IsRequired() const { return true; }
 };
@@ -646,6 +705,7 @@ public:
 
 	const char* GetFilename() const { return "USB.bin"; }
 	void FreezeIn(zip_file_t* zf) const { return SysState_ComponentFreezeIn(zf, USB_); }
+	void FreezeIn(const u8* data, u32 size) const { return SysState_ComponentFreezeIn(data, size, USB_); }
 	void FreezeOut(SaveStateBase& writer) const { return SysState_ComponentFreezeOut(writer, USB_); }
 	bool IsRequired() const { return false; }
 };
@@ -657,6 +717,7 @@ public:
 
 	const char* GetFilename() const { return "PAD.bin"; }
 	void FreezeIn(zip_file_t* zf) const { return SysState_ComponentFreezeIn(zf, PAD_); }
+	void FreezeIn(const u8* data, u32 size) const { return SysState_ComponentFreezeIn(data, size, PAD_); }
 	void FreezeOut(SaveStateBase& writer) const { return SysState_ComponentFreezeOut(writer, PAD_); }
 	bool IsRequired() const { return true; }
 };
@@ -668,6 +729,7 @@ public:
 
 	const char* GetFilename() const { return "GS.bin"; }
 	void FreezeIn(zip_file_t* zf) const { return SysState_ComponentFreezeIn(zf, GS); }
+	void FreezeIn(const u8* data, u32 size) const { return SysState_ComponentFreezeIn(data, size, GS); }
 	void FreezeOut(SaveStateBase& writer) const { return SysState_ComponentFreezeOut(writer, GS); }
 	bool IsRequired() const { return true; }
 };
@@ -693,6 +755,14 @@ class SaveStateEntry_Achievements : public BaseSavestateEntry
 			Achievements::LoadState(nullptr, 0);
 	}
 
+	void FreezeIn(const u8* data, u32 size) const override
+	{
+		if (!Achievements::IsActive())
+			return;
+
+		Achievements::LoadState(size ? data : nullptr, size);
+	}
+
 	void FreezeOut(SaveStateBase& writer) const override
 	{
 		if (!Achievements::IsActive())
@@ -737,7 +807,33 @@ static const std::unique_ptr<BaseSavestateEntry> SavestateEntries[] = {
 #endif
 };
 
-std::unique_ptr<ArchiveEntryList> SaveState_DownloadState()
+static bool IsEEMemoryEntry(const BaseSavestateEntry& entry)
+{
+	return (dynamic_cast<const SavestateEntry_EmotionMemory*>(&entry) != nullptr);
+}
+
+static void SaveState_FreezeOutEEMemoryDelta(SaveStateBase& writer, const SaveStateIncrementalInfo& incremental)
+{
+	u8 bitmap[(Ps2MemSize::MainRam >> __pageshift) / 8];
+	EEMemoryDeltaHeader header = {};
+	header.magic = EEMemoryDeltaMagic;
+	header.page_size = __pagesize;
+	header.page_count = Ps2MemSize::MainRam >> __pageshift;
+	header.dirty_count = mmap_GetDirtyPages(bitmap);
+	header.base_id = incremental.base_id;
+	header.base_filename_length = static_cast<u32>(incremental.base_filename.size());
+
+	writer.Freeze(header);
+	writer.FreezeMem(const_cast<char*>(incremental.base_filename.data()), header.base_filename_length);
+	writer.FreezeMem(bitmap, sizeof(bitmap));
+	for (u32 page = 0; page < header.page_count; page++)
+	{
+		if (bitmap[page / 8] & (1u << (page % 8)))
+			writer.FreezeMem(&eeMem->Main[page << __pageshift], __pagesize);
+	}
+}
+
+static std::unique_ptr<ArchiveEntryList> SaveState_DownloadState(const SaveStateIncrementalInfo* incremental, u64 base_id)
 {
 #ifndef PCSX2_CORE
 	if (!GetCoreThread().HasActiveMachine())
@@ -760,17 +856,78 @@ std::unique_ptr<ArchiveEntryList> SaveState_DownloadState()
 
 	for (const std::unique_ptr<BaseSavestateEntry>& entry : SavestateEntries)
 	{
+		// Empty entries aren't written to the zip, the dirty pages get their own entry below.
 		uint startpos = saveme.GetCurrentPos();
-		entry->FreezeOut(saveme);
+		if (!incremental || !IsEEMemoryEntry(*entry))
+			entry->FreezeOut(saveme);
 		destlist->Add(
 			ArchiveEntry(entry->GetFilename())
 				.SetDataIndex(startpos)
 				.SetDataSize(saveme.GetCurrentPos() - startpos));
 	}
 
+	if (incremental)
+	{
+		uint startpos = saveme.GetCurrentPos();
+		SaveState_FreezeOutEEMemoryDelta(saveme, *incremental);
+		destlist->Add(
+			ArchiveEntry(EntryFilename_EEMemoryDelta)
+				.SetDataIndex(startpos)
+				.SetDataSize(saveme.GetCurrentPos() - startpos));
+	}
+	else if (base_id != 0)
+	{
+		uint startpos = saveme.GetCurrentPos();
+		saveme.Freeze(base_id);
+		destlist->Add(
+			ArchiveEntry(EntryFilename_BaseStateId)
+				.SetDataIndex(startpos)
+				.SetDataSize(saveme.GetCurrentPos() - startpos));
+	}
+
 	return destlist;
 }
 
+std::unique_ptr<ArchiveEntryList> SaveState_DownloadState()
+{
+	return SaveState_DownloadState(nullptr, 0);
+}
+
+std::unique_ptr<ArchiveEntryList> SaveState_DownloadBaseState(u64 base_id)
+{
+	pxAssert(base_id != 0);
+	return SaveState_DownloadState(nullptr, base_id);
+}
+
+std::unique_ptr<ArchiveEntryList> SaveState_DownloadIncrementalState(const SaveStateIncrementalInfo& incremental)
+{
+	return SaveState_DownloadState(&incremental, 0);
+}
+
+void SaveState_UploadState(const ArchiveEntryList& srclist)
+{
+	// Only lists produced by SaveState_DownloadState() are accepted, i.e. the internal structures at the
+	// start of the buffer, followed by one entry for each of SavestateEntries in order.
+	if (srclist.GetLength() != std::size(SavestateEntries) + 1 || srclist[0].GetDataIndex() != 0 ||
+		srclist[0].GetFilename() != EntryFilename_InternalStructures)
+	{
+		throw Exception::RuntimeError()
+			.SetDiagMsg("SaveState_UploadState: State does not match the current savestate layout.");
+	}
+
+	PreLoadPrep();
+
+	memLoadingState(srclist.GetBuffer()).FreezeBios().FreezeInternals();
+
+	for (u32 i = 0; i < std::size(SavestateEntries); ++i)
+	{
+		const ArchiveEntry& entry = srclist[i + 1];
+		SavestateEntries[i]->FreezeIn(srclist.GetPtr(entry.GetDataIndex()), entry.GetDataSize());
+	}
+
+	PostLoadPrep();
+}
+
 std::unique_ptr<SaveStateScreenshotData> SaveState_SaveScreenshot()
 {
 	static constexpr u32 SCREENSHOT_WIDTH = 640;
@@ -791,17 +948,17 @@ std::unique_ptr<SaveStateScreenshotData> SaveState_SaveScreenshot()
 	return data;
 }
 
-static bool SaveState_CompressScreenshot(SaveStateScreenshotData* data, zip_t* zf)
+static zip_source_t* SaveState_CompressScreenshot(SaveStateScreenshotData* data)
 {
 	zip_error_t ze = {};
 	zip_source_t* const zs = zip_source_buffer_create(nullptr, 0, 0, &ze);
 	if (!zs)
-		return false;
+		return nullptr;
 
 	if (zip_source_begin_write(zs) != 0)
 	{
 		zip_source_free(zs);
-		return false;
+		return nullptr;
 	}
 
 	ScopedGuard zs_free([zs]() { zip_source_free(zs); });
@@ -809,7 +966,7 @@ static bool SaveState_CompressScreenshot(SaveStateScreenshotData* data, zip_t* z
 	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
 	png_infop info_ptr = nullptr;
 	if (!png_ptr)
-		return false;
+		return nullptr;
 
 	ScopedGuard cleanup([&png_ptr, &info_ptr]() {
 		if (png_ptr)
@@ -818,10 +975,10 @@ static bool SaveState_CompressScreenshot(SaveStateScreenshotData* data, zip_t* z
 
 	info_ptr = png_create_info_struct(png_ptr);
 	if (!info_ptr)
-		return false;
+		return nullptr;
 
 	if (setjmp(png_jmpbuf(png_ptr)))
-		return false;
+		return nullptr;
 
 	png_set_write_fn(png_ptr, zs, [](png_structp png_ptr, png_bytep data_ptr, png_size_t size) {
 		zip_source_write(static_cast<zip_source_t*>(png_get_io_ptr(png_ptr)), data_ptr, size);
@@ -844,17 +1001,25 @@ static bool SaveState_CompressScreenshot(SaveStateScreenshotData* data, zip_t* z
 	png_write_end(png_ptr, nullptr);
 
 	if (zip_source_commit_write(zs) != 0)
-		return false;
+		return nullptr;
 
+	zs_free.Cancel();
+	return zs;
+}
+
+static bool SaveState_AddScreenshot(zip_t* zf, zip_source_t* zs)
+{
 	const s64 file_index = zip_file_add(zf, EntryFilename_Screenshot, zs, 0);
 	if (file_index < 0)
+	{
+		zip_source_free(zs);
 		return false;
+	}
 
 	// png is already compressed, no point doing it twice
 	zip_set_file_compression(zf, file_index, ZIP_CM_STORE, 0);
 
-	// source is now owned by the zip file for later compression
-	zs_free.Cancel();
+	// source is now owned by the zip file
 	return true;
 }
 
@@ -940,11 +1105,99 @@ static bool SaveState_ReadScreenshot(zip_t* zf, u32* out_width, u32* out_height,
 // --------------------------------------------------------------------------------------
 //  CompressThread_VmState
 // --------------------------------------------------------------------------------------
+// libzip compresses entries one at a time when the archive is closed, which for EE RAM, VU
+// memory and the GS state adds up to hundreds of milliseconds. Instead, every component is
+// compressed with zstd on its own worker, and the resulting frames are handed to libzip as
+// already compressed data, so zip_close() only has to copy them into place. The archive
+// layout is unchanged, and loading goes through libzip's regular zstd decompression.
+struct SaveStateCompressedEntry
+{
+	const char* name;
+	const u8* src;
+	size_t src_size;
+
+	std::vector<u8> data;
+	u32 crc;
+	bool ok;
+
+	zip_uint64_t read_pos;
+	zip_error_t error;
+};
+
+static void SaveState_CompressEntry(SaveStateCompressedEntry* entry, int level)
+{
+	entry->data.resize(ZSTD_compressBound(entry->src_size));
+	const size_t size = ZSTD_compress(entry->data.data(), entry->data.size(), entry->src, entry->src_size, level);
+	if (ZSTD_isError(size))
+	{
+		Console.Error("(SaveState) Failed to compress '%s': %s", entry->name, ZSTD_getErrorName(size));
+		entry->ok = false;
+		return;
+	}
+
+	entry->data.resize(size);
+	entry->crc = static_cast<u32>(crc32(crc32(0L, Z_NULL, 0), entry->src, static_cast<uInt>(entry->src_size)));
+	entry->ok = true;
+}
+
+// Source for a precompressed entry. Since the stat reports the data as zstd already, and the
+// entry is set to zstd as well, libzip copies it through without recompressing it.
+static zip_int64_t SaveState_CompressedEntrySource(void* userdata, void* data, zip_uint64_t len, zip_source_cmd_t cmd)
+{
+	SaveStateCompressedEntry* entry = static_cast<SaveStateCompressedEntry*>(userdata);
+	switch (cmd)
+	{
+		case ZIP_SOURCE_OPEN:
+			entry->read_pos = 0;
+			return 0;
+
+		case ZIP_SOURCE_READ:
+		{
+			const zip_uint64_t count = std::min<zip_uint64_t>(len, entry->data.size() - entry->read_pos);
+			std::memcpy(data, entry->data.data() + entry->read_pos, count);
+			entry->read_pos += count;
+			return static_cast<zip_int64_t>(count);
+		}
+
+		case ZIP_SOURCE_CLOSE:
+			return 0;
+
+		case ZIP_SOURCE_STAT:
+		{
+			zip_stat_t* st = static_cast<zip_stat_t*>(data);
+			zip_stat_init(st);
+			st->valid = ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_COMP_METHOD | ZIP_STAT_CRC | ZIP_STAT_ENCRYPTION_METHOD;
+			st->size = entry->src_size;
+			st->comp_size = entry->data.size();
+			st->comp_method = ZIP_CM_ZSTD;
+			st->crc = entry->crc;
+			st->encryption_method = ZIP_EM_NONE;
+			return sizeof(zip_stat_t);
+		}
+
+		case ZIP_SOURCE_ERROR:
+			return zip_error_to_data(&entry->error, data, len);
+
+		case ZIP_SOURCE_FREE:
+			zip_error_fini(&entry->error);
+			delete entry;
+			return 0;
+
+		case ZIP_SOURCE_SUPPORTS:
+			return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+				ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, -1);
+
+		default:
+			zip_error_set(&entry->error, ZIP_ER_OPNOTSUPP, 0);
+			return -1;
+	}
+}
+
 static bool SaveState_AddToZip(zip_t* zf, ArchiveEntryList* srclist, SaveStateScreenshotData* screenshot)
 {
 	// use zstd compression, it can be 10x+ faster for saving.
-	const u32 compression = EmuConfig.SavestateZstdCompression ? ZIP_CM_ZSTD : ZIP_CM_DEFLATE;
-	const u32 compression_level = 0;
+	const bool use_zstd = EmuConfig.SavestateZstdCompression;
+	const int zstd_level = std::clamp(EmuConfig.SavestateCompressionLevel, 1, ZSTD_maxCLevel());
 
 	// version indicator
 	{
@@ -963,6 +1216,7 @@ static bool SaveState_AddToZip(zip_t* zf, ArchiveEntryList* srclist, SaveStateSc
 		zip_set_file_compression(zf, fi, ZIP_CM_STORE, 0);
 	}
 
+	std::vector<std::unique_ptr<SaveStateCompressedEntry>> entries;
 	const uint listlen = srclist->GetLength();
 	for (uint i = 0; i < listlen; ++i)
 	{
@@ -970,23 +1224,85 @@ static bool SaveState_AddToZip(zip_t* zf, ArchiveEntryList* srclist, SaveStateSc
 		if (!entry.GetDataSize())
 			continue;
 
-		zip_source_t* const zs = zip_source_buffer(zf, srclist->GetPtr(entry.GetDataIndex()), entry.GetDataSize(), 0);
+		std::unique_ptr<SaveStateCompressedEntry> centry = std::make_unique<SaveStateCompressedEntry>();
+		centry->name = entry.GetFilename().c_str();
+		centry->src = srclist->GetPtr(entry.GetDataIndex());
+		centry->src_size = entry.GetDataSize();
+		centry->crc = 0;
+		centry->ok = false;
+		centry->read_pos = 0;
+		zip_error_init(&centry->error);
+		entries.push_back(std::move(centry));
+	}
+
+	zip_source_t* screenshot_zs = nullptr;
+	{
+		// Largest components first, so the big EE RAM block doesn't end up starting last.
+		std::vector<SaveStateCompressedEntry*> order;
+		if (use_zstd)
+		{
+			for (const std::unique_ptr<SaveStateCompressedEntry>& entry : entries)
+				order.push_back(entry.get());
+			std::sort(order.begin(), order.end(), [](const SaveStateCompressedEntry* lhs, const SaveStateCompressedEntry* rhs) {
+				return lhs->src_size > rhs->src_size;
+			});
+		}
+
+		const int jobs = static_cast<int>(order.size()) + (screenshot ? 1 : 0);
+		const int workers = std::max(1, std::min<int>(jobs, cb::ThreadPool::GetNumLogicalCores()));
+		cb::ThreadPool pool(workers);
+
+		if (screenshot)
+			pool.Schedule([screenshot, &screenshot_zs]() { screenshot_zs = SaveState_CompressScreenshot(screenshot); });
+		for (SaveStateCompressedEntry* entry : order)
+			pool.Schedule([entry, zstd_level]() { SaveState_CompressEntry(entry, zstd_level); });
+
+		pool.Wait();
+	}
+
+	for (std::unique_ptr<SaveStateCompressedEntry>& entry : entries)
+	{
+		if (!use_zstd)
+		{
+			// deflate is left to libzip, since it can't take precompressed data with our own settings.
+			zip_source_t* const zs = zip_source_buffer(zf, entry->src, entry->src_size, 0);
+			if (!zs)
+				return false;
+
+			const s64 fi = zip_file_add(zf, entry->name, zs, ZIP_FL_ENC_UTF_8);
+			if (fi < 0)
+			{
+				zip_source_free(zs);
+				return false;
+			}
+
+			zip_set_file_compression(zf, fi, ZIP_CM_DEFLATE, 0);
+			continue;
+		}
+
+		if (!entry->ok)
+			return false;
+
+		// The source owns the entry from here on, and frees it in ZIP_SOURCE_FREE.
+		SaveStateCompressedEntry* const centry = entry.get();
+		zip_source_t* const zs = zip_source_function(zf, SaveState_CompressedEntrySource, centry);
 		if (!zs)
 			return false;
+		entry.release();
 
-		const s64 fi = zip_file_add(zf, entry.GetFilename().c_str(), zs, ZIP_FL_ENC_UTF_8);
+		const s64 fi = zip_file_add(zf, centry->name, zs, ZIP_FL_ENC_UTF_8);
 		if (fi < 0)
 		{
 			zip_source_free(zs);
 			return false;
 		}
 
-		zip_set_file_compression(zf, fi, compression, compression_level);
+		zip_set_file_compression(zf, fi, ZIP_CM_ZSTD, static_cast<zip_uint32_t>(zstd_level));
 	}
 
 	if (screenshot)
 	{
-		if (!SaveState_CompressScreenshot(screenshot, zf))
+		if (!screenshot_zs || !SaveState_AddScreenshot(zf, screenshot_zs))
 			return false;
 	}
 
@@ -1094,6 +1410,102 @@ static bool LoadInternalStructuresState(zip_t* zf, s64 index)
 	return true;
 }
 
+std::string SaveState_GetIncrementalBaseFilename(const char* filename)
+{
+	zip_error_t ze = {};
+	auto zf = zip_open_managed(filename, ZIP_RDONLY, &ze);
+	if (!zf)
+		return {};
+
+	// Only the header and the name, the pages can be megabytes
+	auto zff = zip_fopen_managed(zf.get(), EntryFilename_EEMemoryDelta, 0);
+	EEMemoryDeltaHeader header;
+	if (!zff || zip_fread(zff.get(), &header, sizeof(header)) != sizeof(header) ||
+		header.magic != EEMemoryDeltaMagic || header.base_filename_length > 4096)
+	{
+		return {};
+	}
+
+	std::string base_filename(header.base_filename_length, '\0');
+	if (zip_fread(zff.get(), base_filename.data(), base_filename.size()) != static_cast<zip_int64_t>(base_filename.size()))
+		return {};
+
+	return base_filename;
+}
+
+static void LoadEEMemoryDelta(const std::string& filename, zip_t* zf, s64 index, const BaseSavestateEntry& eemem_entry)
+{
+	std::optional<std::vector<u8>> delta;
+	if (auto zff = zip_fopen_index_managed(zf, index, 0); zff)
+		delta = ReadBinaryFileInZip(zff.get());
+
+	EEMemoryDeltaHeader header;
+	if (!delta.has_value() || delta->size() < sizeof(header))
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg("EE memory delta is incomplete.");
+	}
+
+	std::memcpy(&header, delta->data(), sizeof(header));
+	const size_t bitmap_size = header.page_count / 8;
+	if (header.magic != EEMemoryDeltaMagic || header.page_size != __pagesize ||
+		header.page_count != (Ps2MemSize::MainRam >> __pageshift) ||
+		delta->size() != sizeof(header) + header.base_filename_length + bitmap_size + static_cast<size_t>(header.dirty_count) * __pagesize)
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg("EE memory delta is corrupted.");
+	}
+
+	const u8* const bitmap = delta->data() + sizeof(header) + header.base_filename_length;
+	u32 dirty_count = 0;
+	for (size_t i = 0; i < bitmap_size; i++)
+		dirty_count += static_cast<u32>(std::bitset<8>(bitmap[i]).count());
+	if (dirty_count != header.dirty_count)
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg("EE memory delta is corrupted.");
+	}
+
+	// The base lives next to the delta, see VMManager.
+	const std::string base_filename(reinterpret_cast<const char*>(delta->data() + sizeof(header)), header.base_filename_length);
+	const std::string base_path(Path::Combine(Path::GetDirectory(filename), base_filename));
+	Console.WriteLn("(SaveState) Loading %u changed EE memory pages on top of '%s'", dirty_count, base_path.c_str());
+
+	zip_error_t ze = {};
+	auto base_zf = zip_open_managed(base_path.c_str(), ZIP_RDONLY, &ze);
+	std::optional<std::vector<u8>> base_id;
+	if (base_zf)
+		base_id = ReadBinaryFileInZip(base_zf.get(), EntryFilename_BaseStateId);
+	if (!base_id.has_value() || base_id->size() != sizeof(header.base_id) ||
+		std::memcmp(base_id->data(), &header.base_id, sizeof(header.base_id)) != 0)
+	{
+		throw Exception::SaveStateLoadError(filename)
+			.SetDiagMsg(fmt::format("Base state '{}' is missing or does not match the incremental state.", base_path))
+			.SetUserMsg("This savestate only contains the changes since an earlier savestate, which is missing or has been replaced.");
+	}
+
+	{
+		auto eemem_zff = zip_fopen_managed(base_zf.get(), eemem_entry.GetFilename(), 0);
+		if (!eemem_zff)
+		{
+			throw Exception::SaveStateLoadError(base_path)
+				.SetDiagMsg("Base state does not contain EE memory.");
+		}
+
+		eemem_entry.FreezeIn(eemem_zff.get());
+	}
+
+	const u8* page_data = bitmap + bitmap_size;
+	for (u32 page = 0; page < header.page_count; page++)
+	{
+		if (!(bitmap[page / 8] & (1u << (page % 8))))
+			continue;
+
+		std::memcpy(&eeMem->Main[page << __pageshift], page_data, __pagesize);
+		page_data += __pagesize;
+	}
+}
+
 void SaveState_UnzipFromDisk(const std::string& filename)
 {
 	zip_error_t ze = {};
@@ -1111,13 +1523,16 @@ void SaveState_UnzipFromDisk(const std::string& filename)
 
 	// check that all parts are included
 	const s64 internal_index = CheckFileExistsInState(zf.get(), EntryFilename_InternalStructures, true);
+	const s64 eemem_delta_index = CheckFileExistsInState(zf.get(), EntryFilename_EEMemoryDelta, false);
 	s64 entryIndices[std::size(SavestateEntries)];
 
 	// Log any parts and pieces that are missing, and then generate an exception.
 	bool throwIt = (internal_index < 0);
 	for (u32 i = 0; i < std::size(SavestateEntries); i++)
 	{
-		const bool required = SavestateEntries[i]->IsRequired();
+		// incremental states get EE memory from their base instead
+		const bool required = SavestateEntries[i]->IsRequired() &&
+							  !(eemem_delta_index >= 0 && IsEEMemoryEntry(*SavestateEntries[i]));
 		entryIndices[i] = CheckFileExistsInState(zf.get(), SavestateEntries[i]->GetFilename(), required);
 		if (entryIndices[i] < 0 && required)
 			throwIt = true;
@@ -1135,7 +1550,10 @@ void SaveState_UnzipFromDisk(const std::string& filename)
 		{
 			if (entryIndices[i] < 0)
 			{
-				SavestateEntries[i]->FreezeIn(nullptr);
+				if (eemem_delta_index >= 0 && IsEEMemoryEntry(*SavestateEntries[i]))
+					LoadEEMemoryDelta(filename, zf.get(), eemem_delta_index, *SavestateEntries[i]);
+				else
+					SavestateEntries[i]->FreezeIn(nullptr);
 				continue;
 			}
 
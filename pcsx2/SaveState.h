@@ -58,14 +58,30 @@ struct SaveStateScreenshotData
 	std::vector<u32> pixels;
 };
 
+// Incremental states only hold the EE RAM pages written since a base state was downloaded, and dirty
+// page tracking was started (see mmap_StartDirtyTracking()). The base is a complete state carrying an id,
+// which has to be stored next to the incremental state for it to be loaded.
+struct SaveStateIncrementalInfo
+{
+	u64 base_id;
+	std::string base_filename;
+};
+
 class ArchiveEntryList;
 
 // Wrappers to generate a save state compatible across all frontends.
 // These functions assume that the caller has paused the core thread.
 extern std::unique_ptr<ArchiveEntryList> SaveState_DownloadState();
+extern std::unique_ptr<ArchiveEntryList> SaveState_DownloadBaseState(u64 base_id);
+extern std::unique_ptr<ArchiveEntryList> SaveState_DownloadIncrementalState(const SaveStateIncrementalInfo& incremental);
+extern void SaveState_UploadState(const ArchiveEntryList& srclist);
 extern std::unique_ptr<SaveStateScreenshotData> SaveState_SaveScreenshot();
 extern bool SaveState_ZipToDisk(std::unique_ptr<ArchiveEntryList> srclist, std::unique_ptr<SaveStateScreenshotData> screenshot, const char* filename);
 extern bool SaveState_ReadScreenshot(const std::string& filename, u32* out_width, u32* out_height, std::vector<u32>* out_pixels);
+
+// Returns the file name of the base an incremental state depends on, or an empty string for
+// complete states and files which can't be read.
+extern std::string SaveState_GetIncrementalBaseFilename(const char* filename);
 extern void SaveState_UnzipFromDisk(const std::string& filename);
 
 // --------------------------------------------------------------------------------------
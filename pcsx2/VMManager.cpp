@@ -20,6 +20,7 @@
 #include <atomic>
 #include <sstream>
 #include <mutex>
+#include <random>
 
 #include "common/Console.h"
 #include "common/FileSystem.h"
@@ -28,6 +29,7 @@
 #include "common/SettingsWrapper.h"
 #include "common/Timer.h"
 #include "common/Threading.h"
+#include "common/Tracing.h"
 #include "fmt/core.h"
 
 #include "Achievements.h"
@@ -47,6 +49,7 @@
 #include "Patch.h"
 #include "PerformanceMetrics.h"
 #include "R5900.h"
+#include "Rewind.h"
 #include "SPU2/spu2.h"
 #include "DEV9/DEV9.h"
 #include "USB/USB.h"
@@ -54,6 +57,7 @@
 #include "Sio.h"
 #include "ps2/BiosTools.h"
 #include "Recording/InputRecordingControls.h"
+#include "x86/BaseblockCache.h"
 
 #include "DebugTools/MIPSAnalyst.h"
 #include "DebugTools/SymbolMap.h"
@@ -99,6 +103,8 @@ namespace VMManager
 	static std::string GetCurrentSaveStateFileName(s32 slot);
 	static bool DoLoadState(const char* filename);
 	static bool DoSaveState(const char* filename, s32 slot_for_message, bool zip_on_thread, bool backup_old_state);
+	static std::unique_ptr<ArchiveEntryList> DownloadIncrementalState(const char* filename);
+	static void DeleteUnusedBaseStates(const char* filename);
 	static void ZipSaveState(std::unique_ptr<ArchiveEntryList> elist,
 		std::unique_ptr<SaveStateScreenshotData> screenshot, std::string osd_key,
 		const char* filename, s32 slot_for_message);
@@ -140,6 +146,9 @@ static bool s_no_interlacing_cheats_loaded = false;
 static s32 s_active_widescreen_patches = 0;
 static u32 s_active_no_interlacing_patches = 0;
 static u32 s_frame_advance_count = 0;
+static std::string s_incremental_state_filename;
+static std::string s_incremental_base_filename;
+static u64 s_incremental_base_id = 0;
 static u32 s_mxcsr_saved;
 static bool s_gs_open_on_initialize = false;
 
@@ -1123,6 +1132,11 @@ void VMManager::Shutdown(bool save_resume_state)
 	a64_setfpcr(s_mxcsr_saved);
 #endif
 
+	Rewind::Shutdown();
+	BaseBlockCache::SaveAll();
+	s_incremental_state_filename.clear();
+	s_incremental_base_filename.clear();
+	s_incremental_base_id = 0;
 	ForgetLoadedPatches();
 	R3000A::ioman::reset();
 	vtlb_Shutdown();
@@ -1166,6 +1180,7 @@ void VMManager::Reset()
 	s_active_widescreen_patches = 0;
 	s_active_no_interlacing_patches = 0;
 
+	Rewind::Clear();
 	SysClearExecutionCache();
 	memBindConditionalHandlers();
 	UpdateVSyncRate();
@@ -1232,6 +1247,7 @@ bool VMManager::DoLoadState(const char* filename)
 	try
 	{
 		Host::OnSaveStateLoading(filename);
+		Rewind::Clear();
 		SaveState_UnzipFromDisk(filename);
 		UpdateRunningGame(false, false);
 		Host::OnSaveStateLoaded(filename, true);
@@ -1259,7 +1275,11 @@ bool VMManager::DoSaveState(const char* filename, s32 slot_for_message, bool zip
 
 	try
 	{
-		std::unique_ptr<ArchiveEntryList> elist(SaveState_DownloadState());
+		// The HDD image isn't part of the state, write back anything the drive has cached so the
+		// two match on disk. Rewind snapshots never leave memory, so they don't need it.
+		DEV9FlushHDD();
+
+		std::unique_ptr<ArchiveEntryList> elist(EmuConfig.IncrementalSavestates ? DownloadIncrementalState(filename) : SaveState_DownloadState());
 		std::unique_ptr<SaveStateScreenshotData> screenshot(SaveState_SaveScreenshot());
 
 		if (FileSystem::FileExists(filename) && backup_old_state)
@@ -1297,6 +1317,66 @@ bool VMManager::DoSaveState(const char* filename, s32 slot_for_message, bool zip
 	}
 }
 
+std::unique_ptr<ArchiveEntryList> VMManager::DownloadIncrementalState(const char* filename)
+{
+	// Past a quarter of memory, the delta isn't saving enough to be worth keeping the old base around.
+	static constexpr u32 REBASE_THRESHOLD = (Ps2MemSize::MainRam >> __pageshift) / 4;
+
+	if (!mmap_IsDirtyTrackingActive() || s_incremental_state_filename != filename ||
+		!FileSystem::FileExists(s_incremental_base_filename.c_str()) || mmap_GetDirtyPages(nullptr) >= REBASE_THRESHOLD)
+	{
+		// The state and its backup must be final before we look at which bases they use.
+		WaitForSaveStateFlush();
+		s_incremental_state_filename.clear();
+		s_incremental_base_filename.clear();
+		DeleteUnusedBaseStates(filename);
+
+		// Every base gets its own file, so the current state and its backup keep theirs.
+		Common::Timer timer;
+		const u64 base_id = (static_cast<u64>(std::random_device()()) << 32) ^ Common::Timer::GetCurrentValue();
+		std::string base_filename(fmt::format("{}.{:016x}.base", filename, base_id));
+		std::unique_ptr<ArchiveEntryList> base(SaveState_DownloadBaseState(base_id));
+		mmap_StartDirtyTracking();
+		if (!SaveState_ZipToDisk(std::move(base), nullptr, base_filename.c_str()))
+		{
+			Console.Error("Failed to write base state '%s', saving a full state instead.", base_filename.c_str());
+			return SaveState_DownloadState();
+		}
+
+		DevCon.WriteLn("Wrote base state to '%s' in %.2f ms", base_filename.c_str(), timer.GetTimeMilliseconds());
+		s_incremental_state_filename = filename;
+		s_incremental_base_filename = std::move(base_filename);
+		s_incremental_base_id = base_id;
+	}
+
+	SaveStateIncrementalInfo info;
+	info.base_id = s_incremental_base_id;
+	info.base_filename = Path::GetFileName(s_incremental_base_filename);
+	return SaveState_DownloadIncrementalState(info);
+}
+
+void VMManager::DeleteUnusedBaseStates(const char* filename)
+{
+	FileSystem::FindResultsArray bases;
+	const std::string pattern(fmt::format("{}.*.base", Path::GetFileName(filename)));
+	if (!FileSystem::FindFiles(std::string(Path::GetDirectory(filename)).c_str(), pattern.c_str(), FILESYSTEM_FIND_FILES, &bases))
+		return;
+
+	const std::string backup_filename(fmt::format("{}.backup", filename));
+	const std::string used = SaveState_GetIncrementalBaseFilename(filename);
+	const std::string used_by_backup = SaveState_GetIncrementalBaseFilename(backup_filename.c_str());
+
+	for (const FILESYSTEM_FIND_DATA& base : bases)
+	{
+		const std::string_view name(Path::GetFileName(base.FileName));
+		if (name == used || name == used_by_backup)
+			continue;
+
+		DevCon.WriteLn("Deleting unused base state '%s'", base.FileName.c_str());
+		FileSystem::DeleteFilePath(base.FileName.c_str());
+	}
+}
+
 void VMManager::ZipSaveState(std::unique_ptr<ArchiveEntryList> elist,
 	std::unique_ptr<SaveStateScreenshotData> screenshot, std::string osd_key,
 	const char* filename, s32 slot_for_message)
@@ -1315,7 +1395,8 @@ void VMManager::ZipSaveState(std::unique_ptr<ArchiveEntryList> elist,
 			Host::OSD_ERROR_DURATION);
 	}
 
-	DevCon.WriteLn("Zipping save state to '%s' took %.2f ms", filename, timer.GetTimeMilliseconds());
+	DevCon.WriteLn("Zipping save state to '%s' took %.2f ms (%lld bytes)", filename, timer.GetTimeMilliseconds(),
+		static_cast<long long>(FileSystem::GetPathFileSize(filename)));
 
 	Host::InvalidateSaveStateCache();
 }
@@ -1367,10 +1448,13 @@ u32 VMManager::DeleteSaveStates(const char* game_serial, u32 game_crc, bool also
 
 		if (also_backups)
 		{
-			filename += ".backup";
-			if (FileSystem::FileExists(filename.c_str()) && FileSystem::DeleteFilePath(filename.c_str()))
+			const std::string backup_filename(filename + ".backup");
+			if (FileSystem::FileExists(backup_filename.c_str()) && FileSystem::DeleteFilePath(backup_filename.c_str()))
 				deleted++;
 		}
+
+		// bases for incremental states, not save states by themselves
+		DeleteUnusedBaseStates(filename.c_str());
 	}
 
 	return deleted;
@@ -1445,6 +1529,42 @@ void VMManager::SetLimiterMode(LimiterModeType type)
 	gsUpdateFrequency(EmuConfig);
 }
 
+bool VMManager::RewindState()
+{
+	if (!HasValidVM() || GSDumpReplayer::IsReplayingDump())
+		return false;
+
+#ifdef ENABLE_ACHIEVEMENTS
+	if (Achievements::ChallengeModeActive() && !Achievements::ConfirmChallengeModeDisable("Rewinding"))
+		return false;
+#endif
+
+	try
+	{
+		if (!Rewind::StepBack())
+			return false;
+	}
+	catch (const std::exception& e)
+	{
+		Host::ReportErrorAsync("Failed to rewind", e.what());
+		Rewind::Clear();
+		Reset();
+		return false;
+	}
+	catch (Exception::BaseException& e)
+	{
+		Host::ReportErrorAsync("Failed to rewind", e.UserMsg());
+		Rewind::Clear();
+		Reset();
+		return false;
+	}
+
+	if (g_InputRecording.isActive())
+		g_InputRecording.handleLoadingSavestate();
+	GetMTGS().PresentCurrentFrame();
+	return true;
+}
+
 void VMManager::FrameAdvance(u32 num_frames /*= 1*/)
 {
 	if (!HasValidVM())
@@ -1589,6 +1709,8 @@ void VMManager::Internal::GameStartingOnCPUThread()
 
 void VMManager::Internal::VSyncOnCPUThread()
 {
+	Tracing::Instant("VSync");
+
 	// TODO: Move frame limiting here to reduce CPU usage after sleeping...
 	ApplyLoadedPatches(PPT_CONTINUOUSLY);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
@@ -1605,6 +1727,12 @@ void VMManager::Internal::VSyncOnCPUThread()
 		}
 	}
 
+	if (!GSDumpReplayer::IsReplayingDump())
+	{
+		Tracing::ScopedZone zone("Rewind", Tracing::Tier::Frame);
+		Rewind::OnVSync();
+	}
+
 	Host::CPUThreadVSync();
 
 	if (EmuConfig.EnableRecordingTools)
@@ -1811,6 +1939,12 @@ void VMManager::CheckForConfigChanges(const Pcsx2Config& old_config)
 		CheckForMemoryCardConfigChanges(old_config);
 		USB::CheckForConfigChanges(old_config);
 
+		if (EmuConfig.EnableRewind != old_config.EnableRewind || EmuConfig.RewindFrequency != old_config.RewindFrequency ||
+			EmuConfig.RewindBufferSize != old_config.RewindBufferSize)
+		{
+			Rewind::Clear();
+		}
+
 		if (EmuConfig.EnableCheats != old_config.EnableCheats ||
 			EmuConfig.EnableWideScreenPatches != old_config.EnableWideScreenPatches ||
 			EmuConfig.EnableNoInterlacingPatches != old_config.EnableNoInterlacingPatches)
@@ -2100,9 +2234,13 @@ static void InitializeCPUInfo()
 	}
 	// find the large and small clusters based on frequency
 	// this is assuming the large cluster is always clocked higher
-	// sort based on core, so that hyperthreads get pushed down
-	std::sort(ordered_processors.begin(), ordered_processors.end(), [](const cpuinfo_processor* lhs, const cpuinfo_processor* rhs) {
-		return (lhs->core->frequency > rhs->core->frequency || lhs->smt_id < rhs->smt_id);
+	// hyperthreads go after every physical core, so threads pinned in order don't share a core
+	// the sort is stable, so processors of the same cluster (and the same cache) stay next to each other
+	std::stable_sort(ordered_processors.begin(), ordered_processors.end(), [](const cpuinfo_processor* lhs, const cpuinfo_processor* rhs) {
+		if (lhs->smt_id != rhs->smt_id)
+			return lhs->smt_id < rhs->smt_id;
+
+		return lhs->core->frequency > rhs->core->frequency;
 	});
 
 	s_processor_list.reserve(ordered_processors.size());
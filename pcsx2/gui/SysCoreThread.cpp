@@ -264,6 +264,9 @@ void SysCoreThread::VsyncInThread()
 {
 	ApplyLoadedPatches(PPT_CONTINUOUSLY);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
+
+	if (m_pineServer)
+		m_pineServer->OnVSync();
 }
 
 void SysCoreThread::GameStartingInThread()
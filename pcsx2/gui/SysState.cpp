@@ -35,6 +35,7 @@
 
 // Required for savestate folder creation
 #include "CDVD/CDVD.h"
+#include "DEV9/DEV9.h"
 #include "ps2/BiosTools.h"
 #include "Elfheader.h"
 
@@ -58,6 +59,8 @@ protected:
 	void InvokeEvent()
 	{
 		ScopedCoreThreadPause paused_core;
+		// the HDD image isn't part of the state, make sure it matches the one on disk
+		DEV9FlushHDD();
 		std::unique_ptr<ArchiveEntryList> elist = SaveState_DownloadState();
 		UI_EnableStateActions();
 		paused_core.AllowResume();
@@ -351,6 +351,93 @@ template bool vtlb_ramWrite<mem32_t>(u32 mem, const mem32_t& data);
 template bool vtlb_ramWrite<mem64_t>(u32 mem, const mem64_t& data);
 template bool vtlb_ramWrite<mem128_t>(u32 mem, const mem128_t& data);
 
+void vtlb_memReadRange(u32 addr, void* dst, u32 size)
+{
+	u8* out = static_cast<u8*>(dst);
+	while (size > 0)
+	{
+		const u32 count = std::min(size, VTLB_PAGE_SIZE - (addr & VTLB_PAGE_MASK));
+		const auto vmv = vtlbdata.vmap[addr >> VTLB_PAGE_BITS];
+		if (!vmv.isHandler(addr))
+		{
+			std::memcpy(out, reinterpret_cast<const u8*>(vmv.assumePtr(addr)), count);
+		}
+		else
+		{
+			for (u32 i = 0; i < count; i++)
+				out[i] = vtlb_memRead<mem8_t>(addr + i);
+		}
+
+		addr += count;
+		out += count;
+		size -= count;
+	}
+}
+
+void vtlb_memWriteRange(u32 addr, const void* src, u32 size)
+{
+	const u8* in = static_cast<const u8*>(src);
+	while (size > 0)
+	{
+		const u32 count = std::min(size, VTLB_PAGE_SIZE - (addr & VTLB_PAGE_MASK));
+		const auto vmv = vtlbdata.vmap[addr >> VTLB_PAGE_BITS];
+		if (!vmv.isHandler(addr))
+		{
+			std::memcpy(reinterpret_cast<u8*>(vmv.assumePtr(addr)), in, count);
+		}
+		else
+		{
+			for (u32 i = 0; i < count; i++)
+				vtlb_memWrite<mem8_t>(addr + i, in[i]);
+		}
+
+		addr += count;
+		in += count;
+		size -= count;
+	}
+}
+
+bool vtlb_IsRamRange(u32 addr, u32 size)
+{
+	while (size > 0)
+	{
+		const u32 count = std::min(size, VTLB_PAGE_SIZE - (addr & VTLB_PAGE_MASK));
+		if (vtlbdata.vmap[addr >> VTLB_PAGE_BITS].isHandler(addr))
+			return false;
+
+		addr += count;
+		size -= count;
+	}
+
+	return true;
+}
+
+bool vtlb_ramReadRange(u32 addr, void* dst, u32 size)
+{
+	bool result = true;
+	u8* out = static_cast<u8*>(dst);
+	while (size > 0)
+	{
+		const u32 count = std::min(size, VTLB_PAGE_SIZE - (addr & VTLB_PAGE_MASK));
+		const auto vmv = vtlbdata.vmap[addr >> VTLB_PAGE_BITS];
+		if (!vmv.isHandler(addr))
+		{
+			std::memcpy(out, reinterpret_cast<const u8*>(vmv.assumePtr(addr)), count);
+		}
+		else
+		{
+			std::memset(out, 0, count);
+			result = false;
+		}
+
+		addr += count;
+		out += count;
+		size -= count;
+	}
+
+	return result;
+}
+
 // --------------------------------------------------------------------------------------
 //  TLB Miss / BusError Handlers
 // --------------------------------------------------------------------------------------
@@ -761,7 +848,8 @@ static bool vtlb_GetMainMemoryOffsetFromPtr(uptr ptr, u32* mainmem_offset, u32*
 	if (ptr >= (uptr)eeMem->Main && page_end <= (uptr)eeMem->ZeroRead)
 	{
 		const u32 eemem_offset = static_cast<u32>(ptr - (uptr)eeMem->Main);
-		const bool writeable = ((eemem_offset < Ps2MemSize::MainRam) ? (mmap_GetRamPageInfo(eemem_offset) != ProtMode_Write) : true);
+		const bool writeable = ((eemem_offset < Ps2MemSize::MainRam) ?
+			(mmap_GetRamPageInfo(eemem_offset) != ProtMode_Write && !mmap_IsDirtyTrackedPage(eemem_offset)) : true);
 		*mainmem_offset = (eemem_offset + HostMemoryMap::EEmemOffset);
 		*mainmem_size = (offsetof(EEVM_MemoryAllocMess, ZeroRead) - eemem_offset);
 		*prot = PageProtectionMode().Read().Write(writeable);
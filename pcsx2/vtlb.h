@@ -111,6 +111,18 @@ extern DataType vtlb_ramRead(u32 mem);
 template <typename DataType>
 extern bool vtlb_ramWrite(u32 mem, const DataType& value);
 
+// Copies a range of memory a page at a time, for external tools reading whole structures.
+// Pages which aren't RAM go through the handlers a byte at a time, like memRead8() would.
+extern void vtlb_memReadRange(u32 mem, void* dst, u32 size);
+extern void vtlb_memWriteRange(u32 mem, const void* src, u32 size);
+
+// Whether the whole range is RAM, which the range and "safe" routines access without any handlers.
+// Anything which runs on the EE thread for an external tool, where a TLB miss can't be taken,
+// should only touch ranges this accepts.
+extern bool vtlb_IsRamRange(u32 mem, u32 size);
+// Same as vtlb_memReadRange(), but zero fills the pages which aren't RAM. Returns false if there were any.
+extern bool vtlb_ramReadRange(u32 mem, void* dst, u32 size);
+
 using vtlb_ReadRegAllocCallback = int(*)();
 extern int vtlb_DynGenReadNonQuad(u32 bits, bool sign, bool xmm, int addr_reg, vtlb_ReadRegAllocCallback dest_reg_alloc = nullptr);
 extern int vtlb_DynGenReadNonQuad_Const(u32 bits, bool sign, bool xmm, u32 addr_const, vtlb_ReadRegAllocCallback dest_reg_alloc = nullptr);
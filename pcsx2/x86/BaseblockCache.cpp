@@ -0,0 +1,233 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "BaseblockCache.h"
+#include "Config.h"
+
+#include "common/FileSystem.h"
+#include "common/Path.h"
+#include "common/StringUtil.h"
+
+#include <algorithm>
+#include <zlib.h>
+
+static constexpr u32 BLOCK_CACHE_MAGIC = 0x4B4C4252; // RBLK
+static constexpr u32 BLOCK_CACHE_VERSION = 1;
+
+// Beyond this it's mostly blocks which only ran once, e.g. during boot.
+static constexpr u32 MAX_BLOCKS = 256 * 1024;
+
+struct BlockCacheHeader
+{
+	u32 magic;
+	u32 version;
+	u32 game_crc;
+	u32 settings_hash;
+	u32 count;
+};
+
+// Static constructors in other translation units register themselves, so this can't be a plain global.
+static std::vector<BaseBlockCache*>& GetCaches()
+{
+	static std::vector<BaseBlockCache*> caches;
+	return caches;
+}
+
+// Everything which changes how a block is split or what code is generated for it.
+static u32 GetSettingsHash()
+{
+	const u32 values[] = {
+		BLOCK_CACHE_VERSION,
+		EmuConfig.Cpu.Recompiler.bitset,
+		EmuConfig.Cpu.sseMXCSR.bitmask,
+		EmuConfig.Cpu.sseVUMXCSR.bitmask,
+		EmuConfig.Speedhacks.bitset,
+		static_cast<u32>(EmuConfig.Speedhacks.EECycleRate),
+		EmuConfig.Speedhacks.EECycleSkip,
+		EmuConfig.Gamefixes.bitset,
+	};
+	return static_cast<u32>(crc32(0, reinterpret_cast<const Bytef*>(values), sizeof(values)));
+}
+
+BaseBlockCache::BaseBlockCache(const char* name, u32 ram_size)
+	: m_name(name)
+	, m_ram_size(ram_size)
+{
+	GetCaches().push_back(this);
+}
+
+BaseBlockCache::~BaseBlockCache()
+{
+	std::vector<BaseBlockCache*>& caches = GetCaches();
+	caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+}
+
+u32 BaseBlockCache::HashCode(const u32* code, u32 size)
+{
+	return static_cast<u32>(crc32(0, reinterpret_cast<const Bytef*>(code), size * sizeof(u32)));
+}
+
+void BaseBlockCache::SaveAll()
+{
+	for (BaseBlockCache* cache : GetCaches())
+		cache->Save();
+}
+
+std::string BaseBlockCache::GetFileName() const
+{
+	return Path::Combine(EmuFolders::Cache, StringUtil::StdStringFromFormat("blocks_%s_%08X.bin", m_name, m_game_crc));
+}
+
+void BaseBlockCache::SetGame(u32 crc)
+{
+	m_recheck_settings = false;
+
+	const bool enable = (crc != 0 && EmuConfig.Cpu.Recompiler.EnableBlockCache);
+	const u32 settings_hash = GetSettingsHash();
+	if (enable && m_active && crc == m_game_crc && settings_hash == m_settings_hash)
+		return;
+
+	Save();
+
+	m_game_crc = crc;
+	m_settings_hash = settings_hash;
+	m_active = enable;
+	m_blocks.clear();
+	m_new_blocks.clear();
+	m_pages_taken.assign(m_ram_size >> PAGE_SHIFT, false);
+	m_precompiled = 0;
+
+	if (m_active && Load())
+		Console.WriteLn("(BlockCache) Loaded %zu %s blocks for CRC %08X", m_blocks.size(), m_name, m_game_crc);
+}
+
+void BaseBlockCache::Reset()
+{
+	Save();
+	std::fill(m_pages_taken.begin(), m_pages_taken.end(), false);
+
+	// Settings changes go through a recompiler reset, so that's when they need to be looked at.
+	m_recheck_settings = true;
+}
+
+bool BaseBlockCache::Load()
+{
+	std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(GetFileName().c_str());
+	if (!data.has_value() || data->size() < sizeof(BlockCacheHeader))
+		return false;
+
+	BlockCacheHeader header;
+	std::memcpy(&header, data->data(), sizeof(header));
+	if (header.magic != BLOCK_CACHE_MAGIC || header.version != BLOCK_CACHE_VERSION ||
+		header.game_crc != m_game_crc || header.count > MAX_BLOCKS ||
+		data->size() != sizeof(header) + header.count * sizeof(Entry))
+	{
+		Console.Warning("(BlockCache) Ignoring invalid %s block cache for CRC %08X", m_name, m_game_crc);
+		return false;
+	}
+
+	// Different settings produce different blocks, start over rather than precompiling the wrong ones.
+	if (header.settings_hash != m_settings_hash)
+	{
+		DevCon.WriteLn("(BlockCache) Settings changed, discarding %s block cache for CRC %08X", m_name, m_game_crc);
+		return false;
+	}
+
+	m_blocks.resize(header.count);
+	std::memcpy(m_blocks.data(), data->data() + sizeof(header), header.count * sizeof(Entry));
+
+	// Don't trust the file to not send us outside of RAM.
+	m_blocks.erase(std::remove_if(m_blocks.begin(), m_blocks.end(), [this](const Entry& e) {
+		return (e.size == 0 || e.startpc >= m_ram_size || e.size > ((m_ram_size - e.startpc) / sizeof(u32)));
+	}), m_blocks.end());
+	std::sort(m_blocks.begin(), m_blocks.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.startpc < rhs.startpc; });
+	return true;
+}
+
+void BaseBlockCache::Save()
+{
+	if (!m_active || m_new_blocks.empty())
+		return;
+
+	std::vector<Entry> merged;
+	merged.reserve(m_blocks.size() + m_new_blocks.size());
+	for (const Entry& e : m_blocks)
+	{
+		if (m_new_blocks.find(e.startpc) == m_new_blocks.end())
+			merged.push_back(e);
+	}
+	for (const auto& it : m_new_blocks)
+	{
+		if (merged.size() >= MAX_BLOCKS)
+			break;
+
+		merged.push_back(it.second);
+	}
+	std::sort(merged.begin(), merged.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.startpc < rhs.startpc; });
+
+	const BlockCacheHeader header = {BLOCK_CACHE_MAGIC, BLOCK_CACHE_VERSION, m_game_crc, m_settings_hash, static_cast<u32>(merged.size())};
+	std::vector<u8> data(sizeof(header) + merged.size() * sizeof(Entry));
+	std::memcpy(data.data(), &header, sizeof(header));
+	std::memcpy(data.data() + sizeof(header), merged.data(), merged.size() * sizeof(Entry));
+
+	const std::string filename(GetFileName());
+	if (!FileSystem::WriteBinaryFile(filename.c_str(), data.data(), data.size()))
+	{
+		Console.Error("(BlockCache) Failed to write '%s'", filename.c_str());
+		return;
+	}
+
+	DevCon.WriteLn("(BlockCache) Saved %zu %s blocks for CRC %08X (%zu new, %u precompiled this session)",
+		merged.size(), m_name, m_game_crc, m_new_blocks.size(), m_precompiled);
+
+	m_blocks = std::move(merged);
+	m_new_blocks.clear();
+}
+
+void BaseBlockCache::Record(u32 startpc, u32 size, const u32* code)
+{
+	if (!m_active || size == 0 || startpc >= m_ram_size || size > ((m_ram_size - startpc) / sizeof(u32)))
+		return;
+
+	const Entry entry = {startpc, size, HashCode(code, size)};
+
+	const auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), startpc,
+		[](const Entry& e, u32 pc) { return e.startpc < pc; });
+	if (it != m_blocks.end() && it->startpc == startpc && it->size == size && it->hash == entry.hash)
+		return;
+
+	m_new_blocks[startpc] = entry;
+}
+
+bool BaseBlockCache::TakePage(u32 addr, const Entry** begin, const Entry** end)
+{
+	const u32 page = addr >> PAGE_SHIFT;
+	if (!m_active || page >= m_pages_taken.size() || m_pages_taken[page])
+		return false;
+
+	m_pages_taken[page] = true;
+
+	const auto first = std::lower_bound(m_blocks.begin(), m_blocks.end(), page << PAGE_SHIFT,
+		[](const Entry& e, u32 pc) { return e.startpc < pc; });
+	const auto last = std::lower_bound(first, m_blocks.end(), (page + 1) << PAGE_SHIFT,
+		[](const Entry& e, u32 pc) { return e.startpc < pc; });
+	if (first == last)
+		return false;
+
+	*begin = &*first;
+	*end = &*first + (last - first);
+	return true;
+}
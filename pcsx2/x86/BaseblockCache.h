@@ -0,0 +1,92 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/Pcsx2Defs.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers which blocks a game compiled in previous runs, so they can be compiled in batches
+// instead of one at a time as execution first reaches each of them.
+//
+// The translated code itself can't be kept: it embeds absolute host addresses (cpuRegs, the
+// dispatchers, the lookup tables, the fastmem base), blocks are linked by patching jumps, and the
+// page protection state is baked in. What is stored is the list of guest blocks, per game CRC and
+// per set of settings affecting code generation, along with a hash of each block's instructions.
+// The first time the recompiler compiles a block in a page, the other known blocks of that page
+// whose instructions still hash the same are compiled right after it.
+class BaseBlockCache
+{
+public:
+	struct Entry
+	{
+		u32 startpc; // physical address
+		u32 size; // in instructions
+		u32 hash;
+	};
+
+	BaseBlockCache(const char* name, u32 ram_size);
+	~BaseBlockCache();
+
+	/// Switches to the blocks of the given game, loading them on first use. A zero CRC disables the cache.
+	__fi void Update(u32 crc)
+	{
+		if (crc != m_game_crc || m_recheck_settings)
+			SetGame(crc);
+	}
+
+	__fi bool IsActive() const { return m_active; }
+
+	/// Call when the recompiler drops all its code. Writes out new blocks, and allows every page to be precompiled again.
+	void Reset();
+
+	/// Call after compiling a block of RAM. code points to the block's guest instructions.
+	void Record(u32 startpc, u32 size, const u32* code);
+
+	/// The first time a block is compiled in the page containing addr since the last Reset(), returns the other
+	/// known blocks of that page. Callers must check their hash against memory before compiling them.
+	bool TakePage(u32 addr, const Entry** begin, const Entry** end);
+
+	__fi void AddPrecompiled(u32 count) { m_precompiled += count; }
+
+	static u32 HashCode(const u32* code, u32 size);
+
+	/// Writes out the new blocks of all caches, e.g. when the VM shuts down.
+	static void SaveAll();
+
+private:
+	static constexpr u32 PAGE_SHIFT = 12;
+
+	void SetGame(u32 crc);
+	bool Load();
+	void Save();
+	std::string GetFileName() const;
+
+	const char* m_name;
+	u32 m_ram_size;
+
+	u32 m_game_crc = 0;
+	u32 m_settings_hash = 0;
+	bool m_active = false;
+	bool m_recheck_settings = true;
+
+	std::vector<Entry> m_blocks; // sorted by startpc
+	std::unordered_map<u32, Entry> m_new_blocks;
+	std::vector<bool> m_pages_taken;
+	u32 m_precompiled = 0;
+};
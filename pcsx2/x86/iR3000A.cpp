@@ -23,6 +23,7 @@
 #include "iR3000A.h"
 #include "R3000A.h"
 #include "BaseblockEx.h"
+#include "BaseblockCache.h"
 #include "System/RecTypes.h"
 #include "R5900OpcodeTables.h"
 #include "IopBios.h"
@@ -38,6 +39,7 @@
 #include "iCore.h"
 
 #include "Config.h"
+#include "Elfheader.h"
 
 #include "common/AlignedMalloc.h"
 #include "common/FileSystem.h"
@@ -83,6 +85,8 @@ static BASEBLOCK* recROM = NULL; // and here
 static BASEBLOCK* recROM1 = NULL; // also here
 static BASEBLOCK* recROM2 = NULL; // also here
 static BaseBlocks recBlocks;
+static BaseBlockCache recBlockCache("IOP", Ps2MemSize::IopRam);
+static bool s_precompilingBlocks = false;
 static u8* recPtr = NULL;
 u32 psxpc; // recompiler psxpc
 int psxbranch; // set for branch
@@ -1087,6 +1091,7 @@ void recResetIOP()
 		memset(s_pInstCache, 0, sizeof(EEINST) * s_nInstCacheSize);
 
 	recBlocks.Reset();
+	recBlockCache.Reset();
 	g_psxMaxRecMem = 0;
 
 	recPtr = *recMem;
@@ -1095,6 +1100,8 @@ void recResetIOP()
 
 static void recShutdown()
 {
+	recBlockCache.Reset();
+
 	safe_delete(recMem);
 
 	safe_aligned_free(m_recBlockAlloc);
@@ -1675,13 +1682,65 @@ static void PreBlockCheck(u32 blockpc)
 #endif
 }
 
+// Entry point of the block iopRecRecompile() injects the IRX from.
+static constexpr u32 IOP_IRX_INJECT_PC = 0x1630;
+
+// BIOS call vectors, which get a psxBiosCall() hook when HLE of the IOP BIOS is enabled.
+static __fi bool IsIopBiosCallEntry(u32 pc)
+{
+	return pc == 0xa0 || pc == 0xb0 || pc == 0xc0;
+}
+
+// Blocks whose code depends on emulator state at the time they're compiled, not only on IOP memory.
+static __fi bool IsIopSpecialEntry(u32 pc)
+{
+	return pc == IOP_IRX_INJECT_PC || IsIopBiosCallEntry(pc);
+}
+
+// Compiles the blocks which previous runs of the game had in the same page as startpc.
+static void iopPrecompileCachedBlocks(u32 startpc)
+{
+	const BaseBlockCache::Entry* begin;
+	const BaseBlockCache::Entry* end;
+	if (!recBlockCache.TakePage(HWADDR(startpc), &begin, &end))
+		return;
+
+	// Entries are physical, compile them in the same segment as the block which got us here.
+	const u32 segment = startpc - HWADDR(startpc);
+	u32 count = 0;
+
+	s_precompilingBlocks = true;
+	for (const BaseBlockCache::Entry* it = begin; it != end; ++it)
+	{
+		// Resetting from in here would throw away the block the dispatcher is about to jump to.
+		if (recPtr >= (recMem->GetPtrEnd() - _64kb))
+			break;
+
+		if (IsIopSpecialEntry(it->startpc))
+			continue;
+
+		const u32 blockpc = it->startpc + segment;
+		if (PSX_GETBLOCK(blockpc)->GetFnptr() != (uptr)iopJITCompile ||
+			BaseBlockCache::HashCode((const u32*)iopPhysMem(it->startpc), it->size) != it->hash)
+		{
+			continue;
+		}
+
+		iopRecRecompile(blockpc);
+		count++;
+	}
+	s_precompilingBlocks = false;
+
+	recBlockCache.AddPrecompiled(count);
+}
+
 static void iopRecRecompile(const u32 startpc)
 {
 	u32 i;
 	u32 willbranch3 = 0;
 
 	// Inject IRX hack
-	if (startpc == 0x1630 && EmuConfig.CurrentIRX.length() > 3)
+	if (startpc == IOP_IRX_INJECT_PC && EmuConfig.CurrentIRX.length() > 3)
 	{
 		if (iopMemRead32(0x20018) == 0x1F)
 		{
@@ -1704,6 +1763,8 @@ static void iopRecRecompile(const u32 startpc)
 		recResetIOP();
 	}
 
+	recBlockCache.Update(ElfCRC);
+
 	x86SetPtr(recPtr);
 	x86Align(16);
 	recPtr = x86Ptr;
@@ -1728,7 +1789,7 @@ static void iopRecRecompile(const u32 startpc)
 
 	_initX86regs();
 
-	if ((psxHu32(HW_ICFG) & 8) && (HWADDR(startpc) == 0xa0 || HWADDR(startpc) == 0xb0 || HWADDR(startpc) == 0xc0))
+	if ((psxHu32(HW_ICFG) & 8) && IsIopBiosCallEntry(HWADDR(startpc)))
 	{
 		xFastCall((void*)psxBiosCall);
 		xTEST(al, al);
@@ -1874,6 +1935,9 @@ StartRecomp:
 	pxAssert((psxpc - startpc) >> 2 <= 0xffff);
 	s_pCurBlockEx->size = (psxpc - startpc) >> 2;
 
+	if (HWADDR(startpc) < Ps2MemSize::IopRam)
+		recBlockCache.Record(HWADDR(startpc), s_pCurBlockEx->size, (const u32*)iopPhysMem(HWADDR(startpc)));
+
 	for (i = 1; i < (u32)s_pCurBlockEx->size; ++i)
 	{
 		if (s_pCurBlock[i].GetFnptr() == (uptr)iopJITCompile)
@@ -1924,6 +1988,9 @@ StartRecomp:
 
 	s_pCurBlock = NULL;
 	s_pCurBlockEx = NULL;
+
+	if (recBlockCache.IsActive() && !s_precompilingBlocks && HWADDR(startpc) < Ps2MemSize::IopRam)
+		iopPrecompileCachedBlocks(startpc);
 }
 
 R3000Acpu psxRec = {
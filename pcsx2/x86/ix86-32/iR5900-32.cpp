@@ -24,6 +24,7 @@
 #include "iR5900.h"
 #include "iR5900Analysis.h"
 #include "BaseblockEx.h"
+#include "BaseblockCache.h"
 #include "System/RecTypes.h"
 
 #include "vtlb.h"
@@ -110,6 +111,8 @@ static BASEBLOCK* recROM1 = NULL; // also here
 static BASEBLOCK* recROM2 = NULL; // also here
 
 static BaseBlocks recBlocks;
+static BaseBlockCache recBlockCache("EE", Ps2MemSize::MainRam);
+static bool s_precompilingBlocks = false;
 static u8* recPtr = NULL;
 EEINST* s_pInstCache = NULL;
 static u32 s_nInstCacheSize = 0;
@@ -654,6 +657,7 @@ static void recResetRaw()
 		memset(s_pInstCache, 0, sizeof(EEINST) * s_nInstCacheSize);
 
 	recBlocks.Reset();
+	recBlockCache.Reset();
 	mmap_ResetBlockTracking();
 	vtlb_ClearLoadStoreInfo();
 
@@ -675,6 +679,7 @@ static void recShutdown()
 	safe_aligned_free(recLutReserve_RAM);
 
 	recBlocks.Reset();
+	recBlockCache.Reset();
 
 	recRAM = recROM = recROM1 = recROM2 = NULL;
 
@@ -2227,6 +2232,47 @@ static void doPlace0Patches()
 }
 #endif
 
+// Compiles the blocks which previous runs of the game had in the same page as startpc.
+static void recPrecompileCachedBlocks(u32 startpc)
+{
+	const BaseBlockCache::Entry* begin;
+	const BaseBlockCache::Entry* end;
+	if (!recBlockCache.TakePage(HWADDR(startpc), &begin, &end))
+		return;
+
+	// Entries are physical, compile them in the same segment as the block which got us here.
+	const u32 segment = startpc - HWADDR(startpc);
+	u32 count = 0;
+
+	s_precompilingBlocks = true;
+	for (const BaseBlockCache::Entry* it = begin; it != end; ++it)
+	{
+		// Resetting from in here would throw away the block the dispatcher is about to jump to.
+		if (eeRecNeedsReset || recPtr >= (recMem->GetPtrEnd() - _64kb))
+			break;
+
+		// These install hooks which have to run when execution gets there, not now.
+		if (it->startpc == EELOAD_START || (g_eeloadMain && it->startpc == HWADDR(g_eeloadMain)) ||
+			(g_eeloadExec && it->startpc == HWADDR(g_eeloadExec)) || it->startpc == ElfEntry)
+		{
+			continue;
+		}
+
+		const u32 blockpc = it->startpc + segment;
+		if (PC_GETBLOCK(blockpc)->GetFnptr() != (uptr)JITCompile ||
+			BaseBlockCache::HashCode((const u32*)PSM(blockpc), it->size) != it->hash)
+		{
+			continue;
+		}
+
+		recRecompile(blockpc);
+		count++;
+	}
+	s_precompilingBlocks = false;
+
+	recBlockCache.AddPrecompiled(count);
+}
+
 static void recRecompile(const u32 startpc)
 {
 	u32 i = 0;
@@ -2246,6 +2292,8 @@ static void recRecompile(const u32 startpc)
 	if (eeRecNeedsReset)
 		recResetRaw();
 
+	recBlockCache.Update(ElfCRC);
+
 	xSetPtr(recPtr);
 	recPtr = xGetAlignedCallTarget();
 
@@ -2718,6 +2766,7 @@ StartRecomp:
 		}
 
 		memcpy(&recRAMCopy[HWADDR(startpc) / 4], PSM(startpc), pc - startpc);
+		recBlockCache.Record(HWADDR(startpc), (pc - startpc) / 4, (const u32*)PSM(startpc));
 	}
 
 	s_pCurBlock->SetFnptr((uptr)recPtr);
@@ -2789,6 +2838,9 @@ StartRecomp:
 
 	s_pCurBlock = NULL;
 	s_pCurBlockEx = NULL;
+
+	if (recBlockCache.IsActive() && !s_precompilingBlocks && HWADDR(startpc) < Ps2MemSize::MainRam)
+		recPrecompileCachedBlocks(startpc);
 }
 
 // The only *safe* way to throw exceptions from the context of recompiled code.
@@ -108,23 +108,32 @@ void mVUreset(microVU& mVU, bool resetReserve)
 	mVU.prog.x86ptr   = z;
 	mVU.prog.x86end   = z + ((mVU.cacheSize - mVUcacheSafeZone) * _1mb);
 
+	u64 evicted = 0;
 	for (u32 i = 0; i < (mVU.progSize / 2); i++)
 	{
 		if (!mVU.prog.prog[i])
 		{
-			mVU.prog.prog[i] = new std::deque<microProgram*>();
+			mVU.prog.prog[i] = new microProgramList();
 			continue;
 		}
-		std::deque<microProgram*>::iterator it(mVU.prog.prog[i]->begin());
-		for (; it != mVU.prog.prog[i]->end(); ++it)
+		std::deque<microProgram*>::iterator it(mVU.prog.prog[i]->progs.begin());
+		for (; it != mVU.prog.prog[i]->progs.end(); ++it)
 		{
 			mVUdeleteProg(mVU, it[0]);
 		}
-		mVU.prog.prog[i]->clear();
+		evicted += mVU.prog.prog[i]->progs.size();
+		mVU.prog.prog[i]->progs.clear();
+		mVU.prog.prog[i]->layouts.clear();
 		mVU.prog.quick[i].block = NULL;
 		mVU.prog.quick[i].prog = NULL;
 	}
 
+	if (evicted > 0)
+	{
+		mVU.prog.stats.evicted += evicted;
+		mVUprintStats(mVU);
+	}
+
 	HostSys::MemProtect(mVU.dispCache, mVUdispCacheSize, PageAccess_ExecOnly());
 
 	if (mVU.index)
@@ -139,13 +148,15 @@ void mVUclose(microVU& mVU)
 
 	safe_delete(mVU.cache_reserve);
 
+	mVUprintStats(mVU);
+
 	// Delete Programs and Block Managers
 	for (u32 i = 0; i < (mVU.progSize / 2); i++)
 	{
 		if (!mVU.prog.prog[i])
 			continue;
-		std::deque<microProgram*>::iterator it(mVU.prog.prog[i]->begin());
-		for (; it != mVU.prog.prog[i]->end(); ++it)
+		std::deque<microProgram*>::iterator it(mVU.prog.prog[i]->progs.begin());
+		for (; it != mVU.prog.prog[i]->progs.end(); ++it)
 		{
 			mVUdeleteProg(mVU, it[0]);
 		}
@@ -198,7 +209,7 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC)
 	double cachePerc = ((double)((uptr)mVU.prog.x86ptr - (uptr)mVU.prog.x86start)) / cacheSize * 100;
 	ConsoleColors c = mVU.index ? Color_Orange : Color_Magenta;
 	DevCon.WriteLn(c, "microVU%d: Cached Prog = [%03d] [PC=%04x] [List=%02d] (Cache=%3.3f%%) [%3.1fmb]",
-		mVU.index, prog->idx, startPC * 8, mVU.prog.prog[startPC]->size() + 1, cachePerc, cacheUsed);
+		mVU.index, prog->idx, startPC * 8, mVU.prog.prog[startPC]->progs.size() + 1, cachePerc, cacheUsed);
 	return prog;
 }
 
@@ -217,32 +228,126 @@ __ri void mVUcacheProg(microVU& mVU, microProgram& prog)
 		else
 			memcpy(prog.data, mVU.regs().Micro, 0x4000);
 	}
+	prog.dirty = true;
 	mVUdumpProg(mVU, prog);
 }
 
-// Generate Hash for partial program based on compiled ranges...
-u64 mVUrangesHash(microVU& mVU, microProgram& prog)
+// Generate Hash for data over the given ranges, in four independent lanes so it runs at memory speed.
+// Ranges are always made of whole 64bit instructions.
+template <typename Ranges>
+static u64 mVUhashData(const u32* data, const Ranges& ranges)
 {
-	union
-	{
-		u64 v64;
-		u32 v32[2];
-	} hash = {0};
+	static constexpr u64 prime = 0x9E3779B97F4A7C15ULL;
+	u64 lane[4] = {prime, prime ^ 1, prime ^ 2, prime ^ 3};
 
-	std::deque<microRange>::const_iterator it(prog.ranges->begin());
-	for (; it != prog.ranges->end(); ++it)
+	for (const microRange& range : ranges)
 	{
-		if ((it[0].start < 0) || (it[0].end < 0))
+		const u8* ptr = reinterpret_cast<const u8*>(data) + range.start;
+		const u8* const end = reinterpret_cast<const u8*>(data) + range.end;
+		for (; (ptr + 32) <= end; ptr += 32)
 		{
-			DevCon.Error("microVU%d: Negative Range![%d][%d]", mVU.index, it[0].start, it[0].end);
+			for (int i = 0; i < 4; i++)
+			{
+				u64 v;
+				std::memcpy(&v, ptr + i * 8, sizeof(v));
+				lane[i] = (lane[i] ^ v) * prime;
+				lane[i] ^= lane[i] >> 29;
+			}
 		}
-		for (int i = it[0].start / 4; i < it[0].end / 4; i++)
+		for (; (ptr + 8) <= end; ptr += 8)
 		{
-			hash.v32[0] -= prog.data[i];
-			hash.v32[1] ^= prog.data[i];
+			u64 v;
+			std::memcpy(&v, ptr, sizeof(v));
+			lane[0] = (lane[0] ^ v) * prime;
+			lane[0] ^= lane[0] >> 29;
 		}
 	}
-	return hash.v64;
+
+	u64 hash = lane[0];
+	for (int i = 1; i < 4; i++)
+		hash = (hash ^ lane[i]) * prime;
+	return hash ^ (hash >> 32);
+}
+
+// Returns the valid ranges of a program sorted by start, which is what programs are indexed by
+static std::vector<microRange> mVUgetLayout(microVU& mVU, const microProgram& prog)
+{
+	std::vector<microRange> ranges;
+	if (doWholeProgCompare)
+	{
+		ranges.push_back({0, static_cast<s32>(mVU.microMemSize)});
+		return ranges;
+	}
+
+	for (const microRange& range : *prog.ranges)
+	{
+		if ((range.start < 0) || (range.end < 0))
+			DevCon.Error("microVU%d: Negative Range![%d][%d]", mVU.index, range.start, range.end);
+		else if (range.end > range.start)
+			ranges.push_back(range);
+	}
+	std::sort(ranges.begin(), ranges.end(), [](const microRange& lhs, const microRange& rhs) {
+		return (lhs.start < rhs.start) || (lhs.start == rhs.start && lhs.end < rhs.end);
+	});
+	return ranges;
+}
+
+static u64 mVUlayoutKey(const std::vector<microRange>& ranges)
+{
+	u64 key = ranges.size();
+	for (const microRange& range : ranges)
+		key = (key ^ ((static_cast<u64>(range.start) << 32) | static_cast<u32>(range.end))) * 0x9E3779B97F4A7C15ULL;
+	return key;
+}
+
+static void mVUunindexProg(microProgramList& list, microProgram& prog)
+{
+	const auto layout = list.layouts.find(prog.layoutKey);
+	if (layout == list.layouts.end())
+		return;
+
+	auto range = layout->second.progs.equal_range(prog.hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second != &prog)
+			continue;
+
+		layout->second.progs.erase(it);
+		if (layout->second.progs.empty())
+			list.layouts.erase(layout);
+		prog.indexed = false;
+		return;
+	}
+}
+
+// (Re)indexes a program under the layout of its current ranges
+static void mVUindexProg(microVU& mVU, microProgram& prog)
+{
+	microProgramList& list = *mVU.prog.prog[prog.startPC];
+	if (prog.indexed)
+		mVUunindexProg(list, prog);
+
+	std::vector<microRange> ranges(mVUgetLayout(mVU, prog));
+	const u64 key = mVUlayoutKey(ranges);
+
+	// Should two layouts ever share a key, the program is hashed over the other ranges. It can then
+	// only fail to be found, mVUcmpProg() still checks its own ranges before it is used.
+	const auto [layout, created] = list.layouts.try_emplace(key);
+	if (created)
+		layout->second.ranges = std::move(ranges);
+
+	prog.layoutKey = key;
+	prog.hash = mVUhashData(prog.data, layout->second.ranges);
+	prog.indexed = true;
+	prog.dirty = false;
+	layout->second.progs.emplace(prog.hash, &prog);
+	list.curLayout = key;
+}
+
+// Generate Hash for partial program based on compiled ranges...
+u64 mVUrangesHash(microVU& mVU, microProgram& prog)
+{
+	return mVUhashData(prog.data, mVUgetLayout(mVU, prog));
 }
 
 // Prints the ratio of unique programs to total programs
@@ -254,8 +359,8 @@ void mVUprintUniqueRatio(microVU& mVU)
 		microProgramList* list = mVU.prog.prog[pc];
 		if (!list)
 			continue;
-		std::deque<microProgram*>::iterator it(list->begin());
-		for (; it != list->end(); ++it)
+		std::deque<microProgram*>::iterator it(list->progs.begin());
+		for (; it != list->progs.end(); ++it)
 		{
 			v.push_back(mVUrangesHash(mVU, *it[0]));
 		}
@@ -268,6 +373,19 @@ void mVUprintUniqueRatio(microVU& mVU)
 	DevCon.WriteLn("%d / %d [%3.1f%%]", v.size(), total, 100. - (double)v.size() / (double)total * 100.);
 }
 
+// Prints how well the program cache has been doing
+void mVUprintStats(microVU& mVU)
+{
+	const microProgStats& stats = mVU.prog.stats;
+	if (!stats.searches)
+		return;
+
+	DevCon.WriteLn(mVU.index ? Color_Orange : Color_Magenta,
+		"microVU%d: %llu program searches, %.1f%% hits, %.2f layouts hashed and %.2f programs compared per search, %llu programs evicted",
+		mVU.index, static_cast<unsigned long long>(stats.searches), 100.0 * stats.hits / stats.searches, (double)stats.hashed / stats.searches,
+		(double)stats.compares / stats.searches, static_cast<unsigned long long>(stats.evicted));
+}
+
 // Compare Cached microProgram to mVU.regs().Micro
 __fi bool mVUcmpProg(microVU& mVU, microProgram& prog)
 {
@@ -305,26 +423,52 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState)
 
 	if (!quick.prog) // If null, we need to search for new program
 	{
-		std::deque<microProgram*>::iterator it(list->begin());
-		for (; it != list->end(); ++it)
-		{
-			bool b = mVUcmpProg(mVU, *it[0]);
-
-			if (b)
+		// Only the current program gets recompiled into, so it's the only one whose index can be stale
+		if (mVU.prog.cur && mVU.prog.cur->dirty)
+			mVUindexProg(mVU, *mVU.prog.cur);
+
+		// Programs of a start PC nearly always end up recompiled over the same ranges, so VU memory is
+		// hashed once over the layout of the last program found here, and looked up with a single find.
+		// Only when that misses are the other layouts tried.
+		mVU.prog.stats.searches++;
+		const auto searchLayout = [&](const u64 key, const microRangeLayout& layout) -> microProgram* {
+			mVU.prog.stats.hashed++;
+			auto range = layout.progs.equal_range(mVUhashData(reinterpret_cast<const u32*>(mVU.regs().Micro), layout.ranges));
+			for (auto it = range.first; it != range.second; ++it)
 			{
-				quick.block = it[0]->block[startPC / 8];
-				quick.prog  = it[0];
-				list->erase(it);
-				list->push_front(quick.prog);
-
-				// Sanity check, in case for some reason the program compilation aborted half way through (JALR for example)
-				if (quick.block == nullptr)
+				mVU.prog.stats.compares++;
+				if (mVUcmpProg(mVU, *it->second))
 				{
-					void* entryPoint = mVUblockFetch(mVU, startPC, pState);
-					return entryPoint;
+					list->curLayout = key;
+					return it->second;
 				}
-				return mVUentryGet(mVU, quick.block, startPC, pState);
 			}
+			return nullptr;
+		};
+
+		microProgram* found = nullptr;
+		const auto last = list->layouts.find(list->curLayout);
+		if (last != list->layouts.end())
+			found = searchLayout(last->first, last->second);
+		for (auto it = list->layouts.begin(); !found && it != list->layouts.end(); ++it)
+		{
+			if (it != last)
+				found = searchLayout(it->first, it->second);
+		}
+
+		if (found)
+		{
+			mVU.prog.stats.hits++;
+			quick.block = found->block[startPC / 8];
+			quick.prog  = found;
+
+			// Sanity check, in case for some reason the program compilation aborted half way through (JALR for example)
+			if (quick.block == nullptr)
+			{
+				void* entryPoint = mVUblockFetch(mVU, startPC, pState);
+				return entryPoint;
+			}
+			return mVUentryGet(mVU, quick.block, startPC, pState);
 		}
 
 		// If cleared and program not found, make a new program instance
@@ -334,13 +478,15 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState)
 		void* entryPoint = mVUblockFetch(mVU,  startPC, pState);
 		quick.block      = mVU.prog.cur->block[startPC/8];
 		quick.prog       = mVU.prog.cur;
-		list->push_front(mVU.prog.cur);
+		list->progs.push_front(mVU.prog.cur);
 		//mVUprintUniqueRatio(mVU);
 		return entryPoint;
 	}
 
 	// If list.quick, then we've already found and recompiled the program ;)
 	mVU.prog.isSame = -1;
+	if (mVU.prog.cur != quick.prog && mVU.prog.cur && mVU.prog.cur->dirty)
+		mVUindexProg(mVU, *mVU.prog.cur);
 	mVU.prog.cur = quick.prog;
 	// Because the VU's can now run in sections and not whole programs at once
 	// we need to set the current block so it gets the right program back
@@ -23,6 +23,8 @@ using namespace x86Emitter;
 #include <deque>
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "Common.h"
 #include "VU.h"
 #include "MTVU.h"
@@ -192,9 +194,35 @@ struct microProgram
 	std::deque<microRange>* ranges;          // The ranges of the microProgram that have already been recompiled
 	u32 startPC; // Start PC of this program
 	int idx;     // Program index
+	u64 layoutKey; // Key of the layout this program is indexed under
+	u64 hash;      // Hash of data over the program's ranges
+	bool indexed;  // Program is in its list's layout index
+	bool dirty;    // Ranges or data changed since the program was indexed
 };
 
-typedef std::deque<microProgram*> microProgramList;
+// Programs of a list which have been recompiled over the same ranges. Hashing VU memory over
+// those ranges once is enough to find the matching program, however many there are.
+struct microRangeLayout
+{
+	std::vector<microRange> ranges;                    // Sorted by start
+	std::unordered_multimap<u64, microProgram*> progs; // Programs by hash of their data over ranges
+};
+
+struct microProgramList
+{
+	std::deque<microProgram*> progs;                    // Every program for this startPC, newest first
+	std::unordered_map<u64, microRangeLayout> layouts; // Index of progs, by key of the layout of their ranges
+	u64 curLayout;                                      // Key of the layout the last program found or indexed is in
+};
+
+struct microProgStats
+{
+	u64 searches; // Searches which missed the quick reference
+	u64 hits;     // Searches which found a cached program
+	u64 hashed;   // Layouts hashed while searching
+	u64 compares; // Programs fully compared while searching (the search length)
+	u64 evicted;  // Programs dropped when the cache was reset
+};
 
 struct microProgramQuick
 {
@@ -216,6 +244,7 @@ struct microProgManager
 	u8*                x86start;           // Start of program's rec-cache
 	u8*                x86end;             // Limit of program's rec-cache
 	microRegInfo       lpState;            // Pipeline state from where program left off (useful for continuing execution)
+	microProgStats     stats;              // Program cache statistics
 };
 
 static const uint mVUdispCacheSize = __pagesize; // Dispatcher Cache Size (in bytes)
@@ -297,6 +326,7 @@ mVUop(mVUopL);
 // Private Functions
 extern void mVUcacheProg(microVU& mVU, microProgram& prog);
 extern void mVUdeleteProg(microVU& mVU, microProgram*& prog);
+extern void mVUprintStats(microVU& mVU);
 _mVUt extern void* mVUsearchProg(u32 startPC, uptr pState);
 extern void* mVUexecuteVU0(u32 startPC, u32 cycles);
 extern void* mVUexecuteVU1(u32 startPC, u32 cycles);
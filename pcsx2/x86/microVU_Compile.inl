@@ -48,6 +48,7 @@ __fi void mVUcheckIsSame(mV)
 void mVUsetupRange(microVU& mVU, s32 pc, bool isStartPC)
 {
 	std::deque<microRange>*& ranges = mVUcurProg.ranges;
+	mVUcurProg.dirty = true; // Needs reindexing before the next search
 	if (pc > (s64)mVU.microMemSize)
 	{
 		Console.Error("microVU%d: PC outside of VU memory PC=0x%04x", mVU.index, pc);
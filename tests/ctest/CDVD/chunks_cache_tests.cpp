@@ -0,0 +1,279 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "ChunksCache.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Same geometry as GzippedFileReader
+static constexpr u32 CHUNK_SIZE = 256 * 1024;
+static constexpr u32 SECTOR_SIZE = 2048;
+
+struct TraceRead
+{
+	u32 sector;
+	u32 count;
+};
+
+// Every byte of the fake image is derived from its offset, so any read can be verified.
+static u8 ImageByte(s64 offset)
+{
+	return static_cast<u8>((offset >> 11) * 31 + (offset & 0x7FF));
+}
+
+static void FillChunk(std::vector<u8>& buffer, s64 offset, int size)
+{
+	buffer.resize(size);
+	for (int i = 0; i < size; i++)
+		buffer[i] = ImageByte(offset + i);
+}
+
+// Parses the output of a session with CdvdVerboseReads enabled, i.e. lines like
+// "CDRead: Reading Sector 0001234 (016 Blocks of Size 2048) at Speed=...".
+static std::vector<TraceRead> LoadTrace(const char* path)
+{
+	std::vector<TraceRead> trace;
+	std::FILE* fp = std::fopen(path, "r");
+	if (!fp)
+		return trace;
+
+	char line[512];
+	while (std::fgets(line, sizeof(line), fp))
+	{
+		const char* p = std::strstr(line, "Reading Sector ");
+		u32 sector, count, size;
+		if (p && std::sscanf(p, "Reading Sector %u (%u Blocks of Size %u)", &sector, &count, &size) == 3 && size == SECTOR_SIZE)
+			trace.push_back({sector, count});
+	}
+
+	std::fclose(fp);
+	return trace;
+}
+
+// Without a recorded trace, approximate one: long streaming runs (FMVs, level loads) interleaved with
+// seeks to a small set of hot files and occasional scattered single sector reads (filesystem lookups).
+static std::vector<TraceRead> GenerateTrace()
+{
+	std::vector<TraceRead> trace;
+	std::mt19937 rng(0x50435832);
+	std::uniform_int_distribution<u32> disc(0, 2000000);
+	std::uniform_int_distribution<u32> hot(0, 15);
+	std::uniform_int_distribution<u32> pick(0, 99);
+	std::vector<u32> hot_files;
+	for (int i = 0; i < 16; i++)
+		hot_files.push_back(disc(rng));
+
+	while (trace.size() < 200000)
+	{
+		const u32 kind = pick(rng);
+		if (kind < 40)
+		{
+			u32 sector = disc(rng);
+			for (int i = 0; i < 2000; i++, sector += 16)
+				trace.push_back({sector, 16});
+		}
+		else if (kind < 80)
+		{
+			u32 sector = hot_files[hot(rng)];
+			for (int i = 0; i < 64; i++, sector += 16)
+				trace.push_back({sector, 16});
+		}
+		else
+		{
+			for (int i = 0; i < 32; i++)
+				trace.push_back({disc(rng), 1});
+		}
+	}
+
+	return trace;
+}
+
+// Mirrors the cache usage of GzippedFileReader::_ReadSync
+static bool ReplayRead(ChunksCache& cache, std::vector<u8>& scratch, s64 offset, u32 size, u8* dst, u64* hits, u64* misses)
+{
+	while (size > 0)
+	{
+		const u32 in_chunk = std::min<u32>(size, CHUNK_SIZE - static_cast<u32>(offset % CHUNK_SIZE));
+		if (cache.Read(dst, offset, in_chunk) == static_cast<int>(in_chunk))
+		{
+			(*hits)++;
+		}
+		else
+		{
+			(*misses)++;
+			const s64 chunk_offset = offset - (offset % CHUNK_SIZE);
+			FillChunk(scratch, chunk_offset, CHUNK_SIZE);
+			cache.Take(scratch.data(), chunk_offset, CHUNK_SIZE, CHUNK_SIZE);
+			if (cache.Read(dst, offset, in_chunk) != static_cast<int>(in_chunk))
+				return false;
+		}
+
+		offset += in_chunk;
+		dst += in_chunk;
+		size -= in_chunk;
+	}
+
+	return true;
+}
+
+TEST(ChunksCache, ReadRequiresSingleChunk)
+{
+	ChunksCache cache(1, CHUNK_SIZE);
+	std::vector<u8> chunk;
+	FillChunk(chunk, CHUNK_SIZE, CHUNK_SIZE);
+	cache.Take(chunk.data(), CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+
+	u8 buffer[SECTOR_SIZE];
+	ASSERT_EQ(cache.Read(buffer, CHUNK_SIZE + SECTOR_SIZE, SECTOR_SIZE), static_cast<int>(SECTOR_SIZE));
+	for (u32 i = 0; i < SECTOR_SIZE; i++)
+		ASSERT_EQ(buffer[i], ImageByte(CHUNK_SIZE + SECTOR_SIZE + i));
+
+	EXPECT_EQ(cache.Read(buffer, 0, SECTOR_SIZE), -1);
+	EXPECT_EQ(cache.Read(buffer, CHUNK_SIZE * 2 - SECTOR_SIZE / 2, SECTOR_SIZE), -1);
+}
+
+TEST(ChunksCache, PartialChunkAtEndOfFile)
+{
+	ChunksCache cache(1, CHUNK_SIZE);
+	std::vector<u8> chunk;
+	FillChunk(chunk, 0, SECTOR_SIZE * 3);
+	cache.Take(chunk.data(), 0, SECTOR_SIZE * 3, CHUNK_SIZE);
+
+	u8 buffer[SECTOR_SIZE];
+	EXPECT_EQ(cache.Read(buffer, SECTOR_SIZE * 2, SECTOR_SIZE), static_cast<int>(SECTOR_SIZE));
+	EXPECT_EQ(cache.Read(buffer, SECTOR_SIZE * 4, SECTOR_SIZE), 0);
+}
+
+TEST(ChunksCache, EvictsLeastRecentlyUsed)
+{
+	// One megabyte holds four chunks
+	ChunksCache cache(1, CHUNK_SIZE);
+	std::vector<u8> chunk;
+	for (s64 i = 0; i < 4; i++)
+	{
+		FillChunk(chunk, i * CHUNK_SIZE, CHUNK_SIZE);
+		cache.Take(chunk.data(), i * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+	}
+
+	u8 buffer[SECTOR_SIZE];
+	ASSERT_GE(cache.Read(buffer, 0, SECTOR_SIZE), 0);
+
+	FillChunk(chunk, 4 * CHUNK_SIZE, CHUNK_SIZE);
+	cache.Take(chunk.data(), 4 * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+
+	EXPECT_GE(cache.Read(buffer, 0, SECTOR_SIZE), 0);
+	EXPECT_EQ(cache.Read(buffer, CHUNK_SIZE, SECTOR_SIZE), -1);
+	EXPECT_GE(cache.Read(buffer, 4 * CHUNK_SIZE, SECTOR_SIZE), 0);
+
+	cache.SetLimit(0);
+	EXPECT_EQ(cache.Read(buffer, 0, SECTOR_SIZE), -1);
+	EXPECT_GE(cache.Read(buffer, 4 * CHUNK_SIZE, SECTOR_SIZE), 0);
+}
+
+TEST(ChunksCache, ShrinkingReleasesSlabs)
+{
+	// Eight megabytes hold 32 chunks, in two slabs
+	ChunksCache cache(8, CHUNK_SIZE);
+	std::vector<u8> chunk;
+	for (s64 i = 0; i < 32; i++)
+	{
+		FillChunk(chunk, i * CHUNK_SIZE, CHUNK_SIZE);
+		cache.Take(chunk.data(), i * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+	}
+	EXPECT_EQ(cache.GetAllocatedSize(), 32u * CHUNK_SIZE);
+
+	// The most recently used chunks are at the end of the second slab, and have to move
+	u8 buffer[SECTOR_SIZE];
+	ASSERT_GE(cache.Read(buffer, 2 * CHUNK_SIZE, SECTOR_SIZE), 0);
+	cache.SetLimit(1);
+	EXPECT_EQ(cache.GetAllocatedSize(), 16u * CHUNK_SIZE);
+
+	for (s64 i : {2, 29, 30, 31})
+	{
+		ASSERT_EQ(cache.Read(buffer, i * CHUNK_SIZE + SECTOR_SIZE, SECTOR_SIZE), static_cast<int>(SECTOR_SIZE));
+		for (u32 j = 0; j < SECTOR_SIZE; j++)
+			ASSERT_EQ(buffer[j], ImageByte(i * CHUNK_SIZE + SECTOR_SIZE + j));
+	}
+	EXPECT_EQ(cache.Read(buffer, 28 * CHUNK_SIZE, SECTOR_SIZE), -1);
+
+	// Still in LRU order after the move, 2 was read first
+	FillChunk(chunk, 40 * CHUNK_SIZE, CHUNK_SIZE);
+	cache.Take(chunk.data(), 40 * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+	EXPECT_EQ(cache.Read(buffer, 2 * CHUNK_SIZE, SECTOR_SIZE), -1);
+	EXPECT_GE(cache.Read(buffer, 29 * CHUNK_SIZE, SECTOR_SIZE), 0);
+	EXPECT_EQ(cache.GetAllocatedSize(), 16u * CHUNK_SIZE);
+
+	// And grows back
+	cache.SetLimit(8);
+	for (s64 i = 0; i < 32; i++)
+	{
+		FillChunk(chunk, i * CHUNK_SIZE, CHUNK_SIZE);
+		cache.Take(chunk.data(), i * CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+	}
+	EXPECT_EQ(cache.GetAllocatedSize(), 32u * CHUNK_SIZE);
+	EXPECT_GE(cache.Read(buffer, 0, SECTOR_SIZE), 0);
+
+	cache.SetLimit(0);
+	EXPECT_EQ(cache.GetAllocatedSize(), 16u * CHUNK_SIZE);
+	EXPECT_GE(cache.Read(buffer, 0, SECTOR_SIZE), 0);
+}
+
+// Set PCSX2_CDVD_TRACE to a log captured with CdvdVerboseReads to replay real game access.
+TEST(ChunksCache, TraceReplayBenchmark)
+{
+	const char* trace_path = std::getenv("PCSX2_CDVD_TRACE");
+	std::vector<TraceRead> trace = trace_path ? LoadTrace(trace_path) : GenerateTrace();
+	ASSERT_FALSE(trace.empty());
+
+	// Same limit as GzippedFileReader, which is where the old linear search hurt the most
+	ChunksCache cache(200, CHUNK_SIZE);
+	std::vector<u8> scratch;
+	std::vector<u8> dst;
+	u64 hits = 0, misses = 0, bytes = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (const TraceRead& read : trace)
+	{
+		const s64 offset = static_cast<s64>(read.sector) * SECTOR_SIZE;
+		const u32 size = read.count * SECTOR_SIZE;
+		dst.resize(size);
+		ASSERT_TRUE(ReplayRead(cache, scratch, offset, size, dst.data(), &hits, &misses));
+		ASSERT_EQ(dst.front(), ImageByte(offset));
+		ASSERT_EQ(dst.back(), ImageByte(offset + size - 1));
+		bytes += size;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("Replayed %zu reads (%.1f MB): %llu hits, %llu misses, %.3f s (includes fake decompression)\n",
+		trace.size(), bytes / 1048576.0, static_cast<unsigned long long>(hits), static_cast<unsigned long long>(misses), seconds);
+
+	// Time the lookups alone, everything is warm now so this is what the hashed index buys us.
+	u8 sector[SECTOR_SIZE];
+	u64 lookups = 0;
+	const auto lookup_start = std::chrono::steady_clock::now();
+	for (const TraceRead& read : trace)
+	{
+		const s64 offset = static_cast<s64>(read.sector) * SECTOR_SIZE;
+		cache.Read(sector, offset, SECTOR_SIZE);
+		lookups++;
+	}
+	const double lookup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lookup_start).count();
+	std::printf("%llu sector lookups: %.1f ns per lookup\n", static_cast<unsigned long long>(lookups), lookup_seconds * 1e9 / lookups);
+}
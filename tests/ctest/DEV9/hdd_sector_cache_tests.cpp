@@ -0,0 +1,190 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "ATA/HddSectorCache.h"
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr u32 SECTOR_SIZE = 512;
+
+static std::vector<u8> Sectors(u32 count, u8 value)
+{
+	return std::vector<u8>(count * SECTOR_SIZE, value);
+}
+
+// Stands in for the image file, with the ioThread writing back to it
+class FakeImage
+{
+public:
+	std::vector<u8> data;
+
+	explicit FakeImage(u32 sectors)
+		: data(sectors * SECTOR_SIZE, 0xEE)
+	{
+	}
+
+	void ReadInto(HddSectorCache& cache, u64 sector, u32 count, u8* buffer)
+	{
+		if (cache.Read(sector, count, buffer))
+			return;
+		memcpy(buffer, &data[sector * SECTOR_SIZE], count * SECTOR_SIZE);
+		cache.Fill(sector, count, buffer);
+	}
+
+	int WriteBack(HddSectorCache& cache)
+	{
+		std::vector<u8> buffer(HddSectorCache::BLOCK_SIZE);
+		u64 sector;
+		u32 count;
+		int runs = 0;
+		while (cache.TakeDirty(&sector, &count, buffer.data()))
+		{
+			memcpy(&data[sector * SECTOR_SIZE], buffer.data(), count * SECTOR_SIZE);
+			runs++;
+		}
+		return runs;
+	}
+};
+
+TEST(HddSectorCache, ReadsBackWrites)
+{
+	HddSectorCache cache(4);
+	const std::vector<u8> written = Sectors(3, 0x11);
+	cache.Write(126, 3, written.data());
+
+	// Spans two blocks
+	std::vector<u8> read = Sectors(3, 0);
+	ASSERT_TRUE(cache.Read(126, 3, read.data()));
+	EXPECT_EQ(read, written);
+
+	EXPECT_FALSE(cache.Read(125, 2, read.data()));
+	EXPECT_TRUE(cache.Contains(127, 2));
+	EXPECT_FALSE(cache.Contains(120, 8));
+}
+
+TEST(HddSectorCache, FillKeepsNewerSectors)
+{
+	HddSectorCache cache(4);
+	const std::vector<u8> written = Sectors(1, 0x22);
+	cache.Write(5, 1, written.data());
+
+	// Image still has the old data for sector 5
+	std::vector<u8> image = Sectors(8, 0xEE);
+	cache.Fill(2, 8, image.data());
+
+	for (u32 i = 0; i < 8; i++)
+		EXPECT_EQ(image[i * SECTOR_SIZE], (i + 2 == 5) ? 0x22 : 0xEE) << "sector " << i + 2;
+
+	std::vector<u8> read = Sectors(1, 0);
+	ASSERT_TRUE(cache.Read(5, 1, read.data()));
+	EXPECT_EQ(read, written);
+}
+
+TEST(HddSectorCache, WritesBackCoalescedRunsInOrder)
+{
+	HddSectorCache cache(4);
+	EXPECT_FALSE(cache.HasDirty());
+
+	const std::vector<u8> data = Sectors(4, 0x33);
+	cache.Write(300, 2, data.data());
+	cache.Write(10, 2, data.data());
+	cache.Write(12, 2, data.data());
+	cache.Write(20, 1, data.data());
+	// Rewriting before write back only writes once
+	cache.Write(10, 1, data.data());
+	EXPECT_TRUE(cache.HasDirty());
+
+	std::vector<u8> buffer(HddSectorCache::BLOCK_SIZE);
+	u64 sector;
+	u32 count;
+
+	ASSERT_TRUE(cache.TakeDirty(&sector, &count, buffer.data()));
+	EXPECT_EQ(sector, 10u);
+	EXPECT_EQ(count, 4u);
+	ASSERT_TRUE(cache.TakeDirty(&sector, &count, buffer.data()));
+	EXPECT_EQ(sector, 20u);
+	EXPECT_EQ(count, 1u);
+	ASSERT_TRUE(cache.TakeDirty(&sector, &count, buffer.data()));
+	EXPECT_EQ(sector, 300u);
+	EXPECT_EQ(count, 2u);
+	EXPECT_FALSE(cache.TakeDirty(&sector, &count, buffer.data()));
+	EXPECT_FALSE(cache.HasDirty());
+
+	// Still cached once clean
+	EXPECT_TRUE(cache.Contains(10, 4));
+}
+
+TEST(HddSectorCache, NeverEvictsDirtyBlocks)
+{
+	HddSectorCache cache(1);
+	const std::vector<u8> data = Sectors(1, 0x44);
+	for (u32 block = 0; block < 8; block++)
+		cache.Write(block * HddSectorCache::BLOCK_SECTORS, 1, data.data());
+
+	for (u32 block = 0; block < 8; block++)
+		EXPECT_TRUE(cache.Contains(block * HddSectorCache::BLOCK_SECTORS, 1));
+
+	FakeImage image(8 * HddSectorCache::BLOCK_SECTORS);
+	EXPECT_EQ(image.WriteBack(cache), 8);
+
+	// Only one clean block is kept
+	int cached = 0;
+	for (u32 block = 0; block < 8; block++)
+		cached += cache.Contains(block * HddSectorCache::BLOCK_SECTORS, 1);
+	EXPECT_EQ(cached, 1);
+}
+
+// Random reads, writes and write backs against a small cache must always read what was last written
+TEST(HddSectorCache, MatchesUncachedImage)
+{
+	constexpr u32 IMAGE_SECTORS = 16 * HddSectorCache::BLOCK_SECTORS;
+	HddSectorCache cache(3);
+	FakeImage image(IMAGE_SECTORS);
+	std::vector<u8> expected = image.data;
+
+	std::mt19937 rng(1234);
+	std::vector<u8> buffer(256 * SECTOR_SIZE);
+	for (int i = 0; i < 5000; i++)
+	{
+		const u32 count = 1 + rng() % 256;
+		const u64 sector = rng() % (IMAGE_SECTORS - count);
+		switch (rng() % 4)
+		{
+			case 0:
+			{
+				const u8 value = static_cast<u8>(rng());
+				for (u32 j = 0; j < count * SECTOR_SIZE; j++)
+					buffer[j] = value + static_cast<u8>(j / SECTOR_SIZE);
+				cache.Write(sector, count, buffer.data());
+				memcpy(&expected[sector * SECTOR_SIZE], buffer.data(), count * SECTOR_SIZE);
+				break;
+			}
+			case 1:
+				image.WriteBack(cache);
+				break;
+			default:
+				image.ReadInto(cache, sector, count, buffer.data());
+				ASSERT_EQ(memcmp(buffer.data(), &expected[sector * SECTOR_SIZE], count * SECTOR_SIZE), 0) << "iteration " << i;
+				break;
+		}
+	}
+
+	image.WriteBack(cache);
+	EXPECT_EQ(image.data, expected);
+}
@@ -0,0 +1,164 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "DEV9/net.h"
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The pool is shared by the whole process, so the tests only look at how the counts change.
+
+TEST(NetPacketPool, AllocateAndRelease)
+{
+	const size_t inUse = NetPacketPool::GetInUseCount();
+
+	NetPacketRef ref = NetPacketRef::Allocate();
+	ASSERT_TRUE(ref);
+	EXPECT_EQ(ref->size, 0);
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+	EXPECT_GE(NetPacketPool::GetAllocatedCount(), NetPacketPool::GetInUseCount());
+
+	ref.reset();
+	EXPECT_FALSE(ref);
+	EXPECT_EQ(ref.get(), nullptr);
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+
+	// Resetting an empty reference does nothing.
+	ref.reset();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+}
+
+TEST(NetPacketPool, CopiesShareThePacket)
+{
+	const size_t inUse = NetPacketPool::GetInUseCount();
+
+	NetPacketRef first = NetPacketRef::Allocate();
+	NetPacketRef second = first;
+	NetPacketRef third;
+	third = second;
+	EXPECT_EQ(first.get(), second.get());
+	EXPECT_EQ(first.get(), third.get());
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+
+	first->size = 42;
+	EXPECT_EQ(third->size, 42);
+
+	// The packet stays out until the last reference goes.
+	first.reset();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+	second.reset();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+	third.reset();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+}
+
+TEST(NetPacketPool, MoveTransfersTheReference)
+{
+	const size_t inUse = NetPacketPool::GetInUseCount();
+
+	NetPacketRef first = NetPacketRef::Allocate();
+	NetPacket* const pkt = first.get();
+
+	NetPacketRef second = std::move(first);
+	EXPECT_FALSE(first);
+	EXPECT_EQ(second.get(), pkt);
+
+	NetPacketRef third;
+	third = std::move(second);
+	EXPECT_FALSE(second);
+	EXPECT_EQ(third.get(), pkt);
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+
+	// Self assignment must not drop the packet.
+	NetPacketRef& alias = third;
+	third = alias;
+	third = std::move(alias);
+	EXPECT_EQ(third.get(), pkt);
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+
+	// Assigning over a reference releases what it held.
+	third = NetPacketRef::Allocate();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse + 1);
+	third.reset();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+}
+
+TEST(NetPacketPool, LastReferenceReturnsThePacket)
+{
+	NetPacketRef ref = NetPacketRef::Allocate();
+	NetPacket* const pkt = ref.get();
+	ref->size = 1500;
+
+	NetPacketRef copy = ref;
+	ref.reset();
+	copy.reset();
+
+	// The packet just returned is the first one handed out again, and comes back empty.
+	const size_t allocated = NetPacketPool::GetAllocatedCount();
+	ref = NetPacketRef::Allocate();
+	EXPECT_EQ(ref.get(), pkt);
+	EXPECT_EQ(ref->size, 0);
+	EXPECT_EQ(NetPacketPool::GetAllocatedCount(), allocated);
+}
+
+TEST(NetPacketPool, GrowsWhenExhausted)
+{
+	const size_t inUse = NetPacketPool::GetInUseCount();
+	const size_t allocated = NetPacketPool::GetAllocatedCount();
+
+	// Take every free packet, then one more.
+	std::vector<NetPacketRef> refs;
+	std::set<NetPacket*> packets;
+	for (size_t i = inUse; i <= allocated; i++)
+	{
+		refs.push_back(NetPacketRef::Allocate());
+		packets.insert(refs.back().get());
+	}
+
+	EXPECT_EQ(packets.size(), refs.size());
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), allocated + 1);
+	const size_t grown = NetPacketPool::GetAllocatedCount();
+	EXPECT_GT(grown, allocated);
+
+	// Everything goes back to the pool, which then serves the same number of packets without growing.
+	refs.clear();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+	for (size_t i = inUse; i <= allocated; i++)
+		refs.push_back(NetPacketRef::Allocate());
+	EXPECT_EQ(NetPacketPool::GetAllocatedCount(), grown);
+	refs.clear();
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+}
+
+TEST(NetPacketPool, ReleasedFromOtherThreads)
+{
+	const size_t inUse = NetPacketPool::GetInUseCount();
+
+	std::vector<NetPacketRef> refs;
+	for (int i = 0; i < 256; i++)
+		refs.push_back(NetPacketRef::Allocate());
+
+	// Each packet is referenced from two threads, the last one to let go returns it.
+	std::vector<NetPacketRef> copies = refs;
+	std::thread other([&copies]() { copies.clear(); });
+	refs.clear();
+	other.join();
+
+	EXPECT_EQ(NetPacketPool::GetInUseCount(), inUse);
+}
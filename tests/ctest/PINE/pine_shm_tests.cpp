@@ -0,0 +1,429 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2022 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Memory.h"
+#include "PINEProtocol.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr u8 MSG_READ32 = PINEProtocol::MsgRead32;
+static constexpr u8 IPC_OK = PINEProtocol::IPC_OK;
+static constexpr u8 IPC_FAIL = PINEProtocol::IPC_FAIL;
+
+// Stands in for EE memory, everything inside it is RAM
+static std::vector<u8> s_memory(1024 * 1024);
+
+static bool InMemory(u32 mem, u32 size)
+{
+	return mem < s_memory.size() && size <= s_memory.size() - mem;
+}
+
+template <typename DataType>
+DataType vtlb_memRead(u32 mem)
+{
+	DataType value = 0;
+	if (InMemory(mem, sizeof(value)))
+		memcpy(&value, &s_memory[mem], sizeof(value));
+	return value;
+}
+
+template <typename DataType>
+void vtlb_memWrite(u32 mem, DataType value)
+{
+	if (InMemory(mem, sizeof(value)))
+		memcpy(&s_memory[mem], &value, sizeof(value));
+}
+
+template mem8_t vtlb_memRead<mem8_t>(u32 mem);
+template mem16_t vtlb_memRead<mem16_t>(u32 mem);
+template mem32_t vtlb_memRead<mem32_t>(u32 mem);
+template mem64_t vtlb_memRead<mem64_t>(u32 mem);
+template void vtlb_memWrite<mem8_t>(u32 mem, mem8_t data);
+template void vtlb_memWrite<mem16_t>(u32 mem, mem16_t data);
+template void vtlb_memWrite<mem32_t>(u32 mem, mem32_t data);
+template void vtlb_memWrite<mem64_t>(u32 mem, mem64_t data);
+
+void vtlb_memReadRange(u32 mem, void* dst, u32 size)
+{
+	for (u32 i = 0; i < size; i++)
+		static_cast<u8*>(dst)[i] = vtlb_memRead<mem8_t>(mem + i);
+}
+
+void vtlb_memWriteRange(u32 mem, const void* src, u32 size)
+{
+	for (u32 i = 0; i < size; i++)
+		vtlb_memWrite<mem8_t>(mem + i, static_cast<const u8*>(src)[i]);
+}
+
+bool vtlb_IsRamRange(u32 mem, u32 size)
+{
+	return InMemory(mem, size);
+}
+
+bool vtlb_ramReadRange(u32 mem, void* dst, u32 size)
+{
+	vtlb_memReadRange(mem, dst, size);
+	return InMemory(mem, size);
+}
+
+// PINEServer without the socket thread, the requests go through the real ParseCommand()
+class TestServer : public PINEProtocol
+{
+public:
+	int saved_slot = -1;
+
+	IPCBuffer Parse(char* request, char* reply)
+	{
+		u32 size;
+		memcpy(&size, request, 4);
+		return ParseCommand(&request[4], reply, size - 4);
+	}
+
+	// Opens the shared memory transport like a client would, returns a dup of its memfd
+	int OpenShm()
+	{
+		char request[5] = {5, 0, 0, 0, MsgShmOpen};
+		std::vector<char> reply(MAX_IPC_RETURN_SIZE);
+		const IPCBuffer res = Parse(request, reply.data());
+		const int fd = std::exchange(m_shm_send_fd, -1);
+		if (res.buffer[4] != IPC_OK || fd < 0)
+			return -1;
+		return dup(fd);
+	}
+
+protected:
+	bool HasActiveMachine() override { return true; }
+	EmuStatus GetStatus() override { return Running; }
+	void SaveState(u8 slot) override { saved_slot = slot; }
+	void LoadState(u8 slot) override {}
+	std::string GetInfo(IPCCommand command) override { return "PCSX2 test"; }
+};
+
+static std::vector<char> Frame(const std::vector<char>& payload)
+{
+	std::vector<char> frame(4 + payload.size());
+	const u32 size = static_cast<u32>(frame.size());
+	memcpy(frame.data(), &size, 4);
+	memcpy(&frame[4], payload.data(), payload.size());
+	return frame;
+}
+
+TEST(PINEShm, CarriesFramesAcrossTheRingEnd)
+{
+	PINEShmRing server;
+	ASSERT_TRUE(server.Create());
+	PINEShmRing client;
+	ASSERT_TRUE(client.Attach(dup(server.GetFd())));
+
+	std::vector<char> buffer(MAX_IPC_SIZE);
+	// Odd sizes, so the frames end up straddling the end of the ring
+	for (u32 i = 0; i < 64; i++)
+	{
+		std::vector<char> payload(40000 + i * 7);
+		for (size_t j = 0; j < payload.size(); j++)
+			payload[j] = static_cast<char>(i + j);
+		const std::vector<char> request = Frame(payload);
+
+		ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+		client.RingDoorbell();
+
+		ASSERT_TRUE(server.TakeDoorbell());
+		EXPECT_FALSE(server.TakeDoorbell());
+		ASSERT_EQ(server.PopRequest(buffer.data(), MAX_IPC_SIZE), static_cast<int>(request.size()));
+		EXPECT_EQ(memcmp(buffer.data(), request.data(), request.size()), 0);
+		EXPECT_EQ(server.PopRequest(buffer.data(), MAX_IPC_SIZE), 0);
+
+		const u32 seq = client.GetReplySeq();
+		ASSERT_TRUE(server.CanPush(request.size()));
+		server.PushReply(request.data(), request.size());
+		server.WakeClient();
+		client.WaitReply(seq, 1000);
+		EXPECT_NE(client.GetReplySeq(), seq);
+
+		ASSERT_EQ(client.PopReply(buffer.data(), MAX_IPC_SIZE), static_cast<int>(request.size()));
+		EXPECT_EQ(memcmp(buffer.data(), request.data(), request.size()), 0);
+	}
+}
+
+TEST(PINEShm, DropsMalformedRequests)
+{
+	PINEShmRing server;
+	ASSERT_TRUE(server.Create());
+	PINEShmRing client;
+	ASSERT_TRUE(client.Attach(dup(server.GetFd())));
+
+	// Claims to be bigger than what was queued
+	std::vector<char> bogus = Frame({MSG_READ32, 0, 0, 0, 0});
+	const u32 size = 1000;
+	memcpy(bogus.data(), &size, 4);
+	ASSERT_TRUE(client.PushRequest(bogus.data(), bogus.size()));
+	const std::vector<char> request = Frame({MSG_READ32, 0, 0, 0, 0});
+	ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+
+	std::vector<char> buffer(MAX_IPC_SIZE);
+	EXPECT_EQ(server.PopRequest(buffer.data(), MAX_IPC_SIZE), -1);
+	EXPECT_EQ(server.PopRequest(buffer.data(), MAX_IPC_SIZE), 0);
+
+	// Attaching to something else fails
+	PINEShmRing other;
+	EXPECT_FALSE(other.Attach(dup(STDIN_FILENO)));
+}
+
+static std::vector<char> Read32(u32 address)
+{
+	std::vector<char> payload = {static_cast<char>(MSG_READ32)};
+	payload.insert(payload.end(), reinterpret_cast<const char*>(&address), reinterpret_cast<const char*>(&address) + 4);
+	return Frame(payload);
+}
+
+TEST(PINEShm, AnswersAtVSync)
+{
+	TestServer pine;
+	PINEShmRing client;
+	ASSERT_TRUE(client.Attach(pine.OpenShm()));
+
+	const u32 value = 0x12345678;
+	memcpy(&s_memory[0x100], &value, 4);
+	const u32 outside = static_cast<u32>(s_memory.size());
+
+	// Nothing is answered before the doorbell rings
+	std::vector<char> request = Read32(0x100);
+	ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+	pine.OnVSync();
+	std::vector<char> reply(MAX_IPC_RETURN_SIZE);
+	EXPECT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 0);
+
+	// Memory outside RAM and savestates are refused at VSync
+	request = Read32(outside);
+	ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+	request = Frame({static_cast<char>(PINEProtocol::MsgSaveState), 1});
+	ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+	client.RingDoorbell();
+	pine.OnVSync();
+
+	ASSERT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 9);
+	EXPECT_EQ(reply[4], static_cast<char>(IPC_OK));
+	u32 read;
+	memcpy(&read, &reply[5], 4);
+	EXPECT_EQ(read, value);
+	ASSERT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 5);
+	EXPECT_EQ(reply[4], static_cast<char>(IPC_FAIL));
+	ASSERT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 5);
+	EXPECT_EQ(reply[4], static_cast<char>(IPC_FAIL));
+	EXPECT_EQ(pine.saved_slot, -1);
+	EXPECT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 0);
+
+	// The socket path goes through the handlers for both
+	request = Read32(outside);
+	EXPECT_EQ(pine.Parse(request.data(), reply.data()).buffer[4], static_cast<char>(IPC_OK));
+	request = Frame({static_cast<char>(PINEProtocol::MsgSaveState), 1});
+	EXPECT_EQ(pine.Parse(request.data(), reply.data()).buffer[4], static_cast<char>(IPC_OK));
+	EXPECT_EQ(pine.saved_slot, 1);
+
+	// A malformed request fails, and what was queued after it is dropped
+	std::vector<char> bogus = Read32(0x100);
+	const u32 size = 1000;
+	memcpy(bogus.data(), &size, 4);
+	ASSERT_TRUE(client.PushRequest(bogus.data(), bogus.size()));
+	request = Read32(0x100);
+	ASSERT_TRUE(client.PushRequest(request.data(), request.size()));
+	client.RingDoorbell();
+	pine.OnVSync();
+
+	ASSERT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 5);
+	EXPECT_EQ(reply[4], static_cast<char>(IPC_FAIL));
+	EXPECT_EQ(client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE), 0);
+}
+
+static std::vector<char> ReadBatch(u32 reads)
+{
+	std::vector<char> payload;
+	for (u32 i = 0; i < reads; i++)
+	{
+		const u32 address = i * 4;
+		payload.push_back(MSG_READ32);
+		payload.insert(payload.end(), reinterpret_cast<const char*>(&address), reinterpret_cast<const char*>(&address) + 4);
+	}
+	return Frame(payload);
+}
+
+static bool ReadExact(int fd, char* buffer, u32 size)
+{
+	for (u32 received = 0; received < size;)
+	{
+		const ssize_t len = read(fd, &buffer[received], size - received);
+		if (len <= 0)
+			return false;
+		received += len;
+	}
+	return true;
+}
+
+static bool ReadFrame(int fd, char* buffer)
+{
+	u32 size;
+	if (!ReadExact(fd, buffer, 4))
+		return false;
+	memcpy(&size, buffer, 4);
+	return ReadExact(fd, &buffer[4], size - 4);
+}
+
+static constexpr auto BENCHMARK_TIME = std::chrono::milliseconds(500);
+
+struct BenchmarkResult
+{
+	u64 requests = 0;
+	double seconds = 0;
+	double latency_us = 0;
+};
+
+static void Report(const char* name, u32 reads_per_request, const BenchmarkResult& result)
+{
+	std::printf("%-22s %9.0f requests/s %11.0f reads/s, %8.1f us avg latency\n", name,
+		result.requests / result.seconds, result.requests * reads_per_request / result.seconds, result.latency_us);
+}
+
+// The socket path, one blocking round-trip per request
+static BenchmarkResult RunSocket(u32 reads_per_request)
+{
+	int fds[2];
+	EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+	// same as PINEServer::ExecuteTaskInThread()
+	TestServer pine;
+	std::thread server([fd = fds[1], &pine]() {
+		std::vector<char> request(MAX_IPC_SIZE);
+		std::vector<char> reply(MAX_IPC_RETURN_SIZE);
+		while (ReadFrame(fd, request.data()))
+		{
+			const auto res = pine.Parse(request.data(), reply.data());
+			if (write(fd, res.buffer, res.size) != static_cast<ssize_t>(res.size))
+				break;
+		}
+	});
+
+	const std::vector<char> request = ReadBatch(reads_per_request);
+	std::vector<char> reply(MAX_IPC_RETURN_SIZE);
+	BenchmarkResult result;
+	const auto start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < BENCHMARK_TIME)
+	{
+		EXPECT_EQ(write(fds[0], request.data(), request.size()), static_cast<ssize_t>(request.size()));
+		EXPECT_TRUE(ReadFrame(fds[0], reply.data()));
+		EXPECT_EQ(reply[4], static_cast<char>(IPC_OK));
+		result.requests++;
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.latency_us = result.seconds * 1e6 / result.requests;
+
+	close(fds[0]);
+	server.join();
+	close(fds[1]);
+	return result;
+}
+
+// The shared memory path. The client queues a frame worth of requests, the
+// server answers them at its next VSync, a period of 0 polls continuously
+static BenchmarkResult RunShm(u32 reads_per_request, u32 requests_per_frame, std::chrono::microseconds vsync_period)
+{
+	TestServer pine;
+	PINEShmRing client;
+	EXPECT_TRUE(client.Attach(pine.OpenShm()));
+
+	// the VM thread, answering the queued requests at VSync
+	std::atomic_bool stop{false};
+	std::thread server([&]() {
+		auto next_vsync = std::chrono::steady_clock::now();
+		while (!stop.load())
+		{
+			if (vsync_period.count() != 0)
+			{
+				next_vsync += vsync_period;
+				std::this_thread::sleep_until(next_vsync);
+			}
+			pine.OnVSync();
+		}
+	});
+
+	const std::vector<char> request = ReadBatch(reads_per_request);
+	std::vector<char> reply(MAX_IPC_RETURN_SIZE);
+	BenchmarkResult result;
+	double total_latency = 0;
+	u64 frames = 0;
+	const auto start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < BENCHMARK_TIME)
+	{
+		u32 queued = 0;
+		while (queued < requests_per_frame && client.PushRequest(request.data(), request.size()))
+			queued++;
+
+		const u32 seq = client.GetReplySeq();
+		const auto sent = std::chrono::steady_clock::now();
+		client.RingDoorbell();
+
+		u32 answered = 0;
+		while (answered < queued)
+		{
+			const int size = client.PopReply(reply.data(), MAX_IPC_RETURN_SIZE);
+			if (size == 0)
+			{
+				client.WaitReply(seq, 100);
+				continue;
+			}
+			EXPECT_GT(size, 0);
+			EXPECT_EQ(reply[4], static_cast<char>(IPC_OK));
+			answered++;
+		}
+		total_latency += std::chrono::duration<double>(std::chrono::steady_clock::now() - sent).count();
+		result.requests += answered;
+		frames++;
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.latency_us = total_latency * 1e6 / frames;
+
+	stop.store(true);
+	server.join();
+	return result;
+}
+
+TEST(PINEShm, Benchmark)
+{
+	// A frame of telemetry: 16 requests of 256 reads
+	constexpr u32 READS = 256;
+	constexpr u32 REQUESTS_PER_FRAME = 16;
+
+	const BenchmarkResult socket = RunSocket(READS);
+	Report("socket", READS, socket);
+	const BenchmarkResult shm_polled = RunShm(READS, REQUESTS_PER_FRAME, std::chrono::microseconds(0));
+	Report("shm, polled", READS, shm_polled);
+	const BenchmarkResult shm_vsync = RunShm(READS, REQUESTS_PER_FRAME, std::chrono::microseconds(16683));
+	Report("shm, 59.94Hz VSync", READS, shm_vsync);
+
+	EXPECT_GT(socket.requests, 0u);
+	EXPECT_GT(shm_polled.requests, 0u);
+	// At least one frame of requests per VSync
+	EXPECT_GE(shm_vsync.requests, REQUESTS_PER_FRAME * 20);
+}
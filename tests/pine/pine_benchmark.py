@@ -0,0 +1,247 @@
+import argparse
+import ctypes
+import mmap
+import os
+import platform
+import socket
+import struct
+import sys
+import time
+
+# Measures PINE memory read throughput: one MsgRead32 per round-trip, batched MsgRead64s,
+# and MsgReadRange, then how many frames of a VSync watch list MsgWatchWait delivers.
+# On Linux, -shm repeats the MsgRead32 and batched MsgRead64 passes over the shared
+# memory ring from MsgShmOpen. Needs a running game with PINE enabled.
+
+MSG_READ32 = 2
+MSG_READ64 = 3
+MSG_READ_RANGE = 0x10
+MSG_WATCH_SET = 0x12
+MSG_WATCH_WAIT = 0x13
+MSG_SHM_OPEN = 0x14
+
+IPC_OK = 0
+
+# replies, including their 5 byte header, must be smaller than 450000 bytes
+MAX_REPLY_DATA = 450000 - 5 - 4 - 1
+
+# layout of PINEShmRing
+SHM_MAGIC = 0x454E4950
+SHM_HEADER_SIZE = 4096
+SHM_RING_SIZE = 1 << 20
+SHM_DOORBELL = 64
+SHM_REQUEST_HEAD = 128
+SHM_REQUEST_TAIL = 132
+SHM_REPLY_HEAD = 192
+SHM_REPLY_TAIL = 196
+SHM_REPLY_SEQ = 256
+
+FUTEX_WAIT = 0
+SYS_FUTEX = {"x86_64": 202, "aarch64": 98}
+
+
+def connect(slot):
+    if sys.platform == "win32":
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.connect(("127.0.0.1", slot))
+        return sock
+
+    runtime_dir = os.environ.get("TMPDIR" if sys.platform == "darwin" else "XDG_RUNTIME_DIR", "/tmp")
+    path = os.path.join(runtime_dir, "pcsx2.sock")
+    if slot != 28011:
+        path += ".%u" % slot
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    return sock
+
+
+def recv_exact(sock, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("PINE server closed the connection")
+        data += chunk
+    return bytes(data)
+
+
+def command(sock, payload):
+    sock.sendall(struct.pack("<I", len(payload) + 4) + payload)
+    size = struct.unpack("<I", recv_exact(sock, 4))[0]
+    reply = recv_exact(sock, size - 4)
+    if reply[0] != IPC_OK:
+        raise RuntimeError("PINE command 0x%02x failed" % payload[0])
+    return reply[1:]
+
+
+class ShmRing:
+    def __init__(self, sock):
+        sock.sendall(struct.pack("<IB", 5, MSG_SHM_OPEN))
+        reply, fds, _, _ = socket.recv_fds(sock, 5, 1)
+        reply += recv_exact(sock, 5 - len(reply))
+        if reply[4] != IPC_OK or not fds:
+            raise RuntimeError("MsgShmOpen failed")
+        self.map = mmap.mmap(fds[0], SHM_HEADER_SIZE + SHM_RING_SIZE * 2)
+        os.close(fds[0])
+        if self.get(0) != SHM_MAGIC:
+            raise RuntimeError("unknown shared memory layout")
+        self.libc = ctypes.CDLL(None, use_errno=True)
+        self.seq_address = ctypes.addressof(ctypes.c_char.from_buffer(self.map, SHM_REPLY_SEQ))
+
+    def get(self, offset):
+        return struct.unpack_from("<I", self.map, offset)[0]
+
+    def put(self, offset, value):
+        struct.pack_into("<I", self.map, offset, value & 0xFFFFFFFF)
+
+    def copy_in(self, pos, data):
+        ring = SHM_HEADER_SIZE
+        offset = pos % SHM_RING_SIZE
+        first = min(len(data), SHM_RING_SIZE - offset)
+        self.map[ring + offset:ring + offset + first] = data[:first]
+        self.map[ring:ring + len(data) - first] = data[first:]
+
+    def copy_out(self, pos, size):
+        ring = SHM_HEADER_SIZE + SHM_RING_SIZE
+        offset = pos % SHM_RING_SIZE
+        first = min(size, SHM_RING_SIZE - offset)
+        return self.map[ring + offset:ring + offset + first] + self.map[ring:ring + size - first]
+
+    def wait(self, seq):
+        # polls where the futex syscall number isn't known
+        timeout = struct.pack("<qq", 0, 100 * 1000 * 1000)
+        if platform.machine() in SYS_FUTEX:
+            self.libc.syscall(SYS_FUTEX[platform.machine()], ctypes.c_void_p(self.seq_address), FUTEX_WAIT, ctypes.c_uint(seq),
+                              ctypes.c_char_p(timeout), None, 0)
+        else:
+            time.sleep(0.001)
+
+    def commands(self, payloads):
+        """Queues every payload and rings the doorbell once, the server answers them all at its next VSync."""
+        seq = self.get(SHM_REPLY_SEQ)
+        head = self.get(SHM_REQUEST_HEAD)
+        for payload in payloads:
+            request = struct.pack("<I", len(payload) + 4) + payload
+            if len(request) > SHM_RING_SIZE - ((head - self.get(SHM_REQUEST_TAIL)) & 0xFFFFFFFF):
+                raise RuntimeError("request ring is full")
+            self.copy_in(head, request)
+            head = (head + len(request)) & 0xFFFFFFFF
+            self.put(SHM_REQUEST_HEAD, head)
+        self.put(SHM_DOORBELL, 1)
+
+        replies = []
+        tail = self.get(SHM_REPLY_TAIL)
+        while len(replies) < len(payloads):
+            if self.get(SHM_REPLY_HEAD) == tail:
+                self.wait(seq)
+                seq = self.get(SHM_REPLY_SEQ)
+                continue
+            size = struct.unpack("<I", self.copy_out(tail, 4))[0]
+            reply = self.copy_out(tail, size)
+            tail = (tail + size) & 0xFFFFFFFF
+            self.put(SHM_REPLY_TAIL, tail)
+            if reply[4] != IPC_OK:
+                raise RuntimeError("PINE command 0x%02x failed" % payloads[len(replies)][0])
+            replies.append(reply[5:])
+        return replies
+
+
+def report(name, size, elapsed, round_trips):
+    print("%-24s %8.2f MB/s  %8.0f round-trips/s" % (name, size / elapsed / (1024 * 1024), round_trips / elapsed))
+
+
+def bench_read32(sock, address, size):
+    start = time.perf_counter()
+    for offset in range(0, size, 4):
+        command(sock, struct.pack("<BI", MSG_READ32, address + offset))
+    report("MsgRead32", size, time.perf_counter() - start, size // 4)
+
+
+def bench_read64_batched(sock, address, size):
+    # as many reads as fit in a single reply
+    per_batch = MAX_REPLY_DATA // 8
+    start = time.perf_counter()
+    round_trips = 0
+    for offset in range(0, size, per_batch * 8):
+        count = min(per_batch, (size - offset) // 8)
+        command(sock, b"".join(struct.pack("<BI", MSG_READ64, address + offset + i * 8) for i in range(count)))
+        round_trips += 1
+    report("MsgRead64 (batched)", size, time.perf_counter() - start, round_trips)
+
+
+def bench_read_range(sock, address, size, iterations):
+    start = time.perf_counter()
+    round_trips = 0
+    for _ in range(iterations):
+        for offset in range(0, size, MAX_REPLY_DATA):
+            command(sock, struct.pack("<BII", MSG_READ_RANGE, address + offset, min(MAX_REPLY_DATA, size - offset)))
+            round_trips += 1
+    report("MsgReadRange", size * iterations, time.perf_counter() - start, round_trips)
+
+
+def bench_shm(ring, address, size):
+    # one frame worth of requests per doorbell, as many as fit in the request ring
+    per_frame = SHM_RING_SIZE // 9 - 1
+    start = time.perf_counter()
+    frames = 0
+    for offset in range(0, size, per_frame * 4):
+        count = min(per_frame, (size - offset) // 4)
+        ring.commands([struct.pack("<BI", MSG_READ32, address + offset + i * 4) for i in range(count)])
+        frames += 1
+    report("MsgRead32 (shm)", size, time.perf_counter() - start, frames)
+
+    per_batch = MAX_REPLY_DATA // 8
+    batches = [b"".join(struct.pack("<BI", MSG_READ64, address + offset + i * 8) for i in range(min(per_batch, (size - offset) // 8)))
+               for offset in range(0, size, per_batch * 8)]
+    start = time.perf_counter()
+    ring.commands(batches)
+    report("MsgRead64 (shm, batched)", size, time.perf_counter() - start, 1)
+
+
+def bench_watch(sock, address, size, ranges, frames):
+    range_size = size // ranges
+    payload = struct.pack("<BI", MSG_WATCH_SET, ranges)
+    for i in range(ranges):
+        payload += struct.pack("<II", address + i * range_size, range_size)
+    command(sock, payload)
+
+    first_frame = None
+    last_frame = None
+    start = time.perf_counter()
+    for _ in range(frames):
+        reply = command(sock, struct.pack("<B", MSG_WATCH_WAIT))
+        last_frame = struct.unpack("<I", reply[0:4])[0]
+        if first_frame is None:
+            first_frame = last_frame
+            start = time.perf_counter()
+    elapsed = time.perf_counter() - start
+
+    captured = last_frame - first_frame
+    missed = captured - (frames - 1)
+    print("%-24s %8.2f frames/s  %u ranges, %u bytes per frame, %u frames missed" %
+          ("MsgWatchWait", (frames - 1) / elapsed, ranges, range_size * ranges, missed))
+
+    command(sock, struct.pack("<BI", MSG_WATCH_SET, 0))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark PINE memory access")
+    parser.add_argument("-slot", action="store", type=int, default=28011, help="PINE slot")
+    parser.add_argument("-address", action="store", type=lambda x: int(x, 0), default=0x00100000, help="Guest address to read from")
+    parser.add_argument("-size", action="store", type=int, default=256 * 1024, help="Bytes to read")
+    parser.add_argument("-iterations", action="store", type=int, default=64, help="Passes for MsgReadRange")
+    parser.add_argument("-ranges", action="store", type=int, default=64, help="Watch list ranges")
+    parser.add_argument("-frames", action="store", type=int, default=300, help="Frames to receive from the watch list")
+    parser.add_argument("-shm", action="store_true", help="Also benchmark the shared memory ring (Linux only)")
+
+    args = parser.parse_args()
+
+    sock = connect(args.slot)
+    bench_read32(sock, args.address, args.size)
+    bench_read64_batched(sock, args.address, args.size)
+    bench_read_range(sock, args.address, args.size, args.iterations)
+    bench_watch(sock, args.address, min(args.size, MAX_REPLY_DATA), args.ranges, args.frames)
+    if args.shm:
+        bench_shm(ShmRing(sock), args.address, args.size)
+    sock.close()